@@ -5,8 +5,16 @@
  * Copyright © 2020 Gustavo C. Viegas.
  */
 
+#ifdef __linux__
+# define _GNU_SOURCE
+# include <sched.h>
+#endif
+
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <math.h>
+#include <time.h>
 
 #include "test.h"
 
@@ -18,12 +26,408 @@
     ln[sz-1] = '\0'; \
     printf("\n%s\n[%s]\n%s\n\n", ln, id, ln); } while (0)
 
+/* Default benchmark options. */
+#define YF_BENCH_REPS   10
+#define YF_BENCH_WARMUP 2
+#define YF_BENCH_TIME   100.0
+#define YF_BENCH_THRES  10.0
+
+/* Limits of benchmark options. */
+#define YF_BENCH_MAXREPS 1000
+#define YF_BENCH_MAXN    ((size_t)1 << 32)
+
+/* Benchmark options. */
+typedef struct {
+    const char *id;
+    unsigned reps;
+    unsigned warmup;
+    /* minimum duration of each repetition, in milliseconds */
+    double time;
+    int cpu;
+    const char *json;
+    const char *baseline;
+    /* regression threshold, in percent */
+    double thres;
+} opts_t;
+
+/* Benchmark result. */
+typedef struct {
+    const char *id;
+    size_t n;
+    double min;
+    double med;
+    double sdev;
+    double bps;
+    double base;
+} result_t;
+
+/* Gets the current time in nanoseconds. */
+static unsigned long long get_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void yf_bench_reset(yf_bench_t *bench)
+{
+    bench->beg = get_ns();
+    bench->end = 0;
+}
+
+void yf_bench_stop(yf_bench_t *bench)
+{
+    bench->end = get_ns();
+}
+
+/* Executes a benchmark function once, returning the time taken in
+   nanoseconds or a negative value on failure. */
+static double run_once(int (*fn)(yf_bench_t *), size_t n, size_t *bytes)
+{
+    yf_bench_t bench = {.n = n, .bytes = 0};
+    yf_bench_reset(&bench);
+    if (fn(&bench) != 0)
+        return -1.0;
+
+    const unsigned long long end = bench.end != 0 ? bench.end : get_ns();
+    *bytes = bench.bytes;
+    return (double)(end - bench.beg);
+}
+
+/* Compares times for sorting. */
+static int cmp_time(const void *a, const void *b)
+{
+    const double x = *(const double *)a;
+    const double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Runs a benchmark, filling its result. */
+static int run_bench(int (*fn)(yf_bench_t *), const opts_t *opts,
+                     result_t *res)
+{
+    /* find how many operations take at least the requested time */
+    const double target = opts->time * 1.0e6;
+    size_t n = 1;
+    size_t bytes;
+    double t;
+
+    while (1) {
+        if ((t = run_once(fn, n, &bytes)) < 0.0)
+            return -1;
+        if (t >= target || n >= YF_BENCH_MAXN)
+            break;
+
+        double scale = t > 0.0 ? target / t * 1.2 : 100.0;
+        if (scale > 100.0)
+            scale = 100.0;
+        else if (scale < 2.0)
+            scale = 2.0;
+        n = n * scale < YF_BENCH_MAXN ? n * scale : YF_BENCH_MAXN;
+    }
+
+    for (unsigned i = 0; i < opts->warmup; i++) {
+        if (run_once(fn, n, &bytes) < 0.0)
+            return -1;
+    }
+
+    double per_op[YF_BENCH_MAXREPS];
+    double sum = 0.0;
+    for (unsigned i = 0; i < opts->reps; i++) {
+        if ((t = run_once(fn, n, &bytes)) < 0.0)
+            return -1;
+        per_op[i] = t / (double)n;
+        sum += per_op[i];
+    }
+    qsort(per_op, opts->reps, sizeof *per_op, cmp_time);
+
+    const double mean = sum / opts->reps;
+    double var = 0.0;
+    for (unsigned i = 0; i < opts->reps; i++)
+        var += (per_op[i] - mean) * (per_op[i] - mean);
+    if (opts->reps > 1)
+        var /= opts->reps - 1;
+
+    const unsigned mid = opts->reps / 2;
+    res->n = n;
+    res->min = per_op[0];
+    res->med = opts->reps & 1 ? per_op[mid] :
+               (per_op[mid-1] + per_op[mid]) * 0.5;
+    res->sdev = sqrt(var);
+    res->bps = bytes > 0 && res->med > 0.0 ? bytes / res->med * 1.0e9 : 0.0;
+
+    return 0;
+}
+
+/* Pins the calling thread to a CPU. */
+static int pin_cpu(int cpu)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof set, &set);
+#else
+    (void)cpu;
+    return -1;
+#endif
+}
+
+/* Writes benchmark results as JSON. */
+static int write_json(const char *pathname, const result_t *res, size_t n)
+{
+    FILE *file = fopen(pathname, "w");
+    if (file == NULL)
+        return -1;
+
+    fprintf(file, "{\n  \"name\": \"%s\",\n  \"benchmarks\": [",
+            yf_g_test.name);
+
+    const char *sep = "";
+    for (size_t i = 0; i < n; i++) {
+        /* failed benchmarks are left out */
+        if (res[i].n == 0)
+            continue;
+        fprintf(file, "%s\n    {\"id\": \"%s\", \"n\": %zu, "
+                "\"min_ns\": %.3f, \"median_ns\": %.3f, "
+                "\"stddev_ns\": %.3f, \"bytes_per_sec\": %.1f}",
+                sep, res[i].id, res[i].n, res[i].min, res[i].med,
+                res[i].sdev, res[i].bps);
+        sep = ",";
+    }
+    fputs("\n  ]\n}\n", file);
+
+    return fclose(file) != 0 ? -1 : 0;
+}
+
+/* Reads the baseline medians of benchmark results.
+   The baseline must have been written by 'write_json()'. Results that are
+   missing from the baseline get a negative median. */
+static int read_baseline(const char *pathname, result_t *res, size_t n)
+{
+    FILE *file = fopen(pathname, "r");
+    if (file == NULL)
+        return -1;
+
+    fseek(file, 0, SEEK_END);
+    const long len = ftell(file);
+    rewind(file);
+
+    char *s = len > 0 ? malloc(len + 1) : NULL;
+    if (s == NULL || fread(s, 1, len, file) != (size_t)len) {
+        free(s);
+        fclose(file);
+        return -1;
+    }
+    s[len] = '\0';
+    fclose(file);
+
+    for (size_t i = 0; i < n; i++) {
+        char key[128];
+        snprintf(key, sizeof key, "\"id\": \"%s\",", res[i].id);
+        const char *p = strstr(s, key);
+        if (p != NULL && (p = strstr(p, "\"median_ns\": ")) != NULL)
+            res[i].base = strtod(p + 13, NULL);
+        else
+            res[i].base = -1.0;
+    }
+
+    free(s);
+    return 0;
+}
+
+/* Parses benchmark options. */
+static int parse_opts(int argc, char *argv[], opts_t *opts)
+{
+    *opts = (opts_t){
+        .id = YF_TEST_ALL,
+        .reps = YF_BENCH_REPS,
+        .warmup = YF_BENCH_WARMUP,
+        .time = YF_BENCH_TIME,
+        .cpu = -1,
+        .thres = YF_BENCH_THRES
+    };
+
+    int i = 2;
+    if (i < argc && strncmp(argv[i], "--", 2) != 0)
+        opts->id = argv[i++];
+
+    for (; i < argc; i++) {
+        if (i + 1 == argc) {
+            printf("\n! Error: missing value for '%s'\n", argv[i]);
+            return -1;
+        }
+
+        const char *opt = argv[i];
+        const char *val = argv[++i];
+        if (strcmp(opt, "--reps") == 0)
+            opts->reps = strtoul(val, NULL, 10);
+        else if (strcmp(opt, "--warmup") == 0)
+            opts->warmup = strtoul(val, NULL, 10);
+        else if (strcmp(opt, "--time") == 0)
+            opts->time = strtod(val, NULL);
+        else if (strcmp(opt, "--cpu") == 0)
+            opts->cpu = atoi(val);
+        else if (strcmp(opt, "--json") == 0)
+            opts->json = val;
+        else if (strcmp(opt, "--baseline") == 0)
+            opts->baseline = val;
+        else if (strcmp(opt, "--threshold") == 0)
+            opts->thres = strtod(val, NULL);
+        else {
+            printf("\n! Error: unknown option '%s'\n", opt);
+            return -1;
+        }
+    }
+
+    if (opts->reps == 0 || opts->reps > YF_BENCH_MAXREPS) {
+        printf("\n! Error: '--reps' must be in [1, %d]\n", YF_BENCH_MAXREPS);
+        return -1;
+    }
+    return 0;
+}
+
+/* Prints the benchmark usage. */
+static void print_bench_usage(const char *prog)
+{
+    printf("\n! Usage: %s %s [BENCH_ID] [OPTIONS]\n"
+           "\nOptions:\n"
+           "  --reps N         repetitions (default: %d)\n"
+           "  --warmup N       discarded repetitions (default: %d)\n"
+           "  --time MS        minimum time per repetition (default: %.0f)\n"
+           "  --cpu N          CPU to pin the benchmarks to\n"
+           "  --json PATH      file to write results to\n"
+           "  --baseline PATH  results to compare against\n"
+           "  --threshold PCT  slowdown deemed a regression (default: %.0f)\n"
+           "\nPossible values for BENCH_ID:\n", prog, YF_TEST_BENCH,
+           YF_BENCH_REPS, YF_BENCH_WARMUP, YF_BENCH_TIME, YF_BENCH_THRES);
+
+    for (size_t i = 0; i < yf_g_test.bench_n; i++)
+        printf("* %s\n", yf_g_test.bench_ids[i]);
+}
+
+/* Executes benchmarks, returning the number of failures.
+   Invalid options and unknown IDs also count as failures. */
+static size_t bench(int argc, char *argv[], size_t *bench_n)
+{
+    *bench_n = 0;
+
+    opts_t opts;
+    if (parse_opts(argc, argv, &opts) != 0) {
+        print_bench_usage(argv[0]);
+        return 1;
+    }
+
+    if (opts.cpu >= 0) {
+        if (pin_cpu(opts.cpu) != 0)
+            printf("\n! Warning: could not pin to CPU %d\n", opts.cpu);
+        else
+            printf("\n- pinned to CPU %d -\n", opts.cpu);
+    }
+
+    result_t *res = calloc(yf_g_test.bench_n + 1, sizeof *res);
+    int *fails = calloc(yf_g_test.bench_n + 1, sizeof *fails);
+    if (res == NULL || fails == NULL) {
+        free(res);
+        free(fails);
+        return 1;
+    }
+
+    size_t n = 0;
+    for (size_t i = 0; i < yf_g_test.bench_n; i++) {
+        if (strcmp(opts.id, YF_TEST_ALL) != 0 &&
+            strcmp(opts.id, yf_g_test.bench_ids[i]) != 0)
+            continue;
+
+        YF_SUBTITLE(yf_g_test.bench_ids[i]);
+        res[n].id = yf_g_test.bench_ids[i];
+        fails[n] = run_bench(yf_g_test.bench_fns[i], &opts, res+n) != 0;
+        if (fails[n])
+            printf("! failed\n");
+        else
+            printf("- n: %zu, median: %.3f ns/op -\n", res[n].n, res[n].med);
+        n++;
+    }
+
+    if (n == 0) {
+        printf("\n! Error: unknown BENCH_ID '%s'\n", opts.id);
+        print_bench_usage(argv[0]);
+        free(res);
+        free(fails);
+        return 1;
+    }
+
+    for (size_t i = 0; i < n; i++)
+        res[i].base = -1.0;
+    if (opts.baseline != NULL && read_baseline(opts.baseline, res, n) != 0)
+        printf("\n! Warning: could not read baseline '%s'\n", opts.baseline);
+
+    printf("\n %-20s %12s %12s %12s %10s %12s %9s\n", "bench", "n",
+           "min ns/op", "median ns/op", "stddev", "MB/s", "vs base");
+
+    size_t failed = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (fails[i]) {
+            printf(" %-20s %12s\n", res[i].id, "(failed)");
+            failed++;
+            continue;
+        }
+
+        char mbs[32] = "-";
+        if (res[i].bps > 0.0)
+            snprintf(mbs, sizeof mbs, "%.1f", res[i].bps * 1.0e-6);
+
+        char cmp[32] = "-";
+        if (res[i].base > 0.0) {
+            const double dif = (res[i].med / res[i].base - 1.0) * 100.0;
+            snprintf(cmp, sizeof cmp, "%+.1f%%", dif);
+            if (dif > opts.thres) {
+                fails[i] = 1;
+                failed++;
+            }
+        }
+
+        printf(" %-20s %12zu %12.3f %12.3f %10.3f %12s %9s%s\n", res[i].id,
+               res[i].n, res[i].min, res[i].med, res[i].sdev, mbs, cmp,
+               fails[i] ? " REGRESSION" : "");
+    }
+
+    if (opts.json != NULL && write_json(opts.json, res, n) != 0) {
+        printf("\n! Error: could not write '%s'\n", opts.json);
+        failed++;
+    }
+
+    free(res);
+    free(fails);
+    *bench_n = n;
+    return failed;
+}
+
 int main(int argc, char *argv[])
 {
     char line[80+1];
     memset(line, '#', sizeof line - 1);
     line[sizeof line - 1] = '\0';
 
+    if (argc > 1 && strcmp(argv[1], YF_TEST_BENCH) == 0) {
+        printf("%s\n[YF][%s] - Benchmark\n%s\n", line, yf_g_test.name, line);
+
+        size_t bench_n;
+        const size_t failed = bench(argc, argv, &bench_n);
+
+        if (bench_n == 0)
+            puts("\n! No benchmarks executed");
+        else
+            printf("\nDONE!\n"
+                   "\nNumber of benchmarks executed: %zu\n"
+                   " Passed: %zu\n"
+                   " Failed: %zu\n",
+                   bench_n, bench_n - failed, failed);
+
+        printf("\n%s\nEnd of benchmark\n%s\n", line, line);
+        return failed != 0;
+    }
+
     printf("%s\n[YF][%s] - Test\n%s\n", line, yf_g_test.name, line);
 
     size_t test_n = 0;
@@ -37,6 +441,10 @@ int main(int argc, char *argv[])
         for (size_t i = 0; i < yf_g_test.n; i++)
             printf("* %s\n", yf_g_test.ids[i]);
 
+        if (yf_g_test.bench_n > 0)
+            printf("\n! Usage: %s %s [BENCH_ID] [OPTIONS]\n", argv[0],
+                   YF_TEST_BENCH);
+
     } else {
         if (strcmp(argv[1], YF_TEST_ALL) == 0) {
             test_n = yf_g_test.n;
@@ -16,12 +16,36 @@
 
 #define YF_TEST_ALL "all"
 
-/* Type defining test(s) to execute. */
+#define YF_TEST_BENCH "bench"
+
+/* Type defining a benchmark run.
+   A benchmark function must execute its operation 'n' times, and may set
+   'bytes' to the number of bytes processed by each operation. Setup work
+   can be excluded from timing by calling 'yf_bench_reset()', and teardown
+   work by calling 'yf_bench_stop()'. */
+typedef struct yf_bench {
+    size_t n;
+    size_t bytes;
+    unsigned long long beg;
+    unsigned long long end;
+} yf_bench_t;
+
+/* Restarts the timing of a benchmark run. */
+void yf_bench_reset(yf_bench_t *bench);
+
+/* Stops the timing of a benchmark run. */
+void yf_bench_stop(yf_bench_t *bench);
+
+/* Type defining test(s) to execute.
+   Benchmarks are optional. */
 typedef struct yf_test {
     char name[64];
     const char *const *ids;
     int (*const *fns)(void);
     size_t n;
+    const char *const *bench_ids;
+    int (*const *bench_fns)(yf_bench_t *bench);
+    size_t bench_n;
 } yf_test_t;
 
 extern const yf_test_t yf_g_test;
@@ -0,0 +1,118 @@
+/*
+ * YF
+ * yf-arena.h
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#ifndef YF_YF_ARENA_H
+#define YF_YF_ARENA_H
+
+#include <stddef.h>
+
+#include "yf-defs.h"
+
+YF_DECLS_BEGIN
+
+/**
+ * Opaque type defining a linear allocator.
+ */
+typedef struct yf_arena yf_arena_t;
+
+/**
+ * Initializes a new arena.
+ *
+ * Memory is obtained from the system in blocks, which are kept for reuse
+ * until the arena is deinitialized. Allocations cannot be freed
+ * individually - instead, the arena is reset to a previously obtained mark.
+ *
+ * @param size: The size of the first block, in bytes. If zero, a default
+ *  size is used.
+ * @return: On success, returns a new arena. Otherwise, 'NULL' is returned
+ *  and the global error is set to indicate the cause.
+ */
+yf_arena_t *yf_arena_init(size_t size);
+
+/**
+ * Allocates memory from an arena.
+ *
+ * The memory is suitably aligned for any type and remains valid until the
+ * arena is reset to a mark obtained before this call.
+ *
+ * @param arena: The arena.
+ * @param size: The size of the allocation, in bytes.
+ * @return: On success, returns a pointer to the allocated memory. Otherwise,
+ *  'NULL' is returned and the global error is set to indicate the cause.
+ */
+void *yf_arena_alloc(yf_arena_t *arena, size_t size);
+
+/**
+ * Allocates zero-initialized memory from an arena.
+ *
+ * @param arena: The arena.
+ * @param n: The number of elements.
+ * @param size: The size of each element, in bytes.
+ * @return: On success, returns a pointer to the allocated memory. Otherwise,
+ *  'NULL' is returned and the global error is set to indicate the cause.
+ */
+void *yf_arena_calloc(yf_arena_t *arena, size_t n, size_t size);
+
+/**
+ * Changes the size of memory allocated from an arena.
+ *
+ * When 'ptr' is the most recent allocation, it is resized in place if
+ * possible. Otherwise, new memory is allocated and the contents are copied.
+ *
+ * @param arena: The arena.
+ * @param ptr: The memory to resize. Can be 'NULL'.
+ * @param old_size: The current size of 'ptr', in bytes.
+ * @param new_size: The new size, in bytes.
+ * @return: On success, returns a pointer to the resized memory. Otherwise,
+ *  'NULL' is returned, the global error is set to indicate the cause and
+ *  'ptr' is left unchanged.
+ */
+void *yf_arena_realloc(yf_arena_t *arena, void *ptr, size_t old_size,
+                       size_t new_size);
+
+/**
+ * Gets the current position of an arena.
+ *
+ * @param arena: The arena.
+ * @return: A mark that can be given to 'yf_arena_reset()'.
+ */
+size_t yf_arena_getmark(yf_arena_t *arena);
+
+/**
+ * Resets an arena to a given mark.
+ *
+ * Every allocation made after the mark was obtained becomes invalid.
+ * Marks obtained after 'mark' become invalid as well.
+ *
+ * @param arena: The arena.
+ * @param mark: The mark to reset to. If zero, all allocations are released.
+ */
+void yf_arena_reset(yf_arena_t *arena, size_t mark);
+
+/**
+ * Deinitializes an arena.
+ *
+ * @param arena: The arena to deinitialize. Can be 'NULL'.
+ */
+void yf_arena_deinit(yf_arena_t *arena);
+
+/**
+ * Gets the arena of the calling thread.
+ *
+ * This arena is meant for transient allocations, such as those made while
+ * rendering a frame. Callers must restore the position they found it in,
+ * by obtaining a mark before allocating and resetting to it when done.
+ * It is deinitialized when the thread exits.
+ *
+ * @return: On success, returns the thread's arena. Otherwise, 'NULL' is
+ *  returned and the global error is set to indicate the cause.
+ */
+yf_arena_t *yf_arena_getthrd(void);
+
+YF_DECLS_END
+
+#endif /* YF_YF_ARENA_H */
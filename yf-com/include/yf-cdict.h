@@ -0,0 +1,150 @@
+/*
+ * YF
+ * yf-cdict.h
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#ifndef YF_YF_CDICT_H
+#define YF_YF_CDICT_H
+
+#include "yf-defs.h"
+#include "yf-hashfn.h"
+#include "yf-cmpfn.h"
+
+YF_DECLS_BEGIN
+
+/**
+ * Opaque type defining a concurrent dictionary.
+ *
+ * Pairs are split in a number of shards, each one being a dictionary guarded
+ * by a reader/writer lock. Lookups in the same shard proceed in parallel,
+ * and updates only block operations on the shard they change.
+ *
+ * Unlike 'yf_dict_t', concurrent dictionaries provide no iterators, since
+ * these would be invalidated by other threads. 'yf_cdict_each' should be
+ * used instead.
+ */
+typedef struct yf_cdict yf_cdict_t;
+
+/**
+ * Initializes a new concurrent dictionary.
+ *
+ * @param hash: The hashing function to use. Can be 'NULL'.
+ * @param cmp: The comparison function to use. Can be 'NULL'.
+ * @return: On success, returns a new concurrent dictionary. Otherwise,
+ *  'NULL' is returned and the global error is set to indicate the cause.
+ */
+yf_cdict_t *yf_cdict_init(yf_hashfn_t hash, yf_cmpfn_t cmp);
+
+/**
+ * Inserts a key/value pair in a concurrent dictionary.
+ *
+ * @param cdict: The concurrent dictionary.
+ * @param key: The key.
+ * @param val: The value.
+ * @return: On success, returns zero. Otherwise, a non-zero value is returned
+ *  and the global error is set to indicate the cause.
+ */
+int yf_cdict_insert(yf_cdict_t *cdict, const void *key, const void *val);
+
+/**
+ * Searches for a key in a concurrent dictionary, inserting a new pair if
+ * not found.
+ *
+ * The 'make' callback is called at most once, with the key's shard locked
+ * for writing, so that concurrent calls for the same key create a single
+ * value. It must set 'new_key' (initially 'key') to the key to store, which
+ * must compare equal to 'key', and return the new value, or 'NULL' to fail
+ * the call. The callback must not access 'cdict'. Should the pair fail to
+ * be inserted afterwards, the created value is not stored and 'NULL' is
+ * returned, so it is up to 'make' to keep track of it if needed.
+ *
+ * @param cdict: The concurrent dictionary.
+ * @param key: The key.
+ * @param make: The callback that creates the value.
+ * @param arg: The generic argument to pass on 'make' calls. Can be 'NULL'.
+ * @return: On success, returns the stored or the newly created value.
+ *  Otherwise, 'NULL' is returned and the global error is set to indicate
+ *  the cause.
+ */
+void *yf_cdict_findins(yf_cdict_t *cdict, const void *key,
+                       void *(*make)(const void *key, const void **new_key,
+                                     void *arg),
+                       void *arg);
+
+/**
+ * Removes a key/value pair from a concurrent dictionary.
+ *
+ * @param cdict: The concurrent dictionary.
+ * @param key: The key.
+ * @return: If 'cdict' does not contain 'key', returns 'NULL' and sets the
+ *  global error to 'YF_ERR_NOTFND'. Otherwise, returns the removed value.
+ */
+void *yf_cdict_remove(yf_cdict_t *cdict, const void *key);
+
+/**
+ * Searches for a key in a concurrent dictionary.
+ *
+ * @param cdict: The concurrent dictionary.
+ * @param key: The key.
+ * @return: If 'cdict' does not contain 'key', returns 'NULL' and sets the
+ *  global error to 'YF_ERR_NOTFND'. Otherwise, returns the stored value.
+ */
+void *yf_cdict_search(yf_cdict_t *cdict, const void *key);
+
+/**
+ * Checks whether or not a concurrent dictionary contains a given key.
+ *
+ * @param cdict: The concurrent dictionary.
+ * @param key: The key.
+ * @return: If 'cdict' contains 'key', returns a non-zero value. Otherwise,
+ *  zero is returned.
+ */
+int yf_cdict_contains(yf_cdict_t *cdict, const void *key);
+
+/**
+ * Executes a given function for each key/value pair in a concurrent
+ * dictionary.
+ *
+ * Shards are visited one at a time, locked for reading, so pairs that
+ * other threads insert or remove meanwhile may or may not be visited.
+ * The callback must not modify 'cdict'.
+ *
+ * This function completes when the end of the dictionary is reached or when
+ * the provided callback returns a non-zero value.
+ *
+ * @param cdict: The concurrent dictionary.
+ * @param callb: The callback to execute for each key/value pair.
+ * @param arg: The generic argument to pass on 'callb' calls. Can be 'NULL'.
+ */
+void yf_cdict_each(yf_cdict_t *cdict,
+                   int (*callb)(void *key, void *val, void *arg), void *arg);
+
+/**
+ * Gets the number of key/value pairs stored in a concurrent dictionary.
+ *
+ * @param cdict: The concurrent dictionary.
+ * @return: The length of the concurrent dictionary.
+ */
+size_t yf_cdict_getlen(yf_cdict_t *cdict);
+
+/**
+ * Removes all key/value pairs from a concurrent dictionary.
+ *
+ * @param cdict: The concurrent dictionary.
+ */
+void yf_cdict_clear(yf_cdict_t *cdict);
+
+/**
+ * Deinitializes a concurrent dictionary.
+ *
+ * No other thread may be using the dictionary.
+ *
+ * @param cdict: The concurrent dictionary to deinitialize. Can be 'NULL'.
+ */
+void yf_cdict_deinit(yf_cdict_t *cdict);
+
+YF_DECLS_END
+
+#endif /* YF_YF_CDICT_H */
@@ -8,6 +8,8 @@
 #ifndef YF_YF_CLOCK_H
 #define YF_YF_CLOCK_H
 
+#include <stdint.h>
+
 #include "yf-defs.h"
 
 YF_DECLS_BEGIN
@@ -32,6 +34,95 @@ double yf_gettime(void);
  */
 void yf_sleep(double seconds);
 
+/**
+ * Gets the elapsed time relative to some unspecified point in the past, in
+ * nanoseconds.
+ *
+ * On x86 processors whose time-stamp counter is invariant, the counter is
+ * read directly, after being calibrated against the system's monotonic
+ * clock on first use. Otherwise, the system's monotonic clock is used.
+ *
+ * Calibration busy-waits for about 10 milliseconds, so the first call in
+ * the process stalls, as do calls from other threads made meanwhile.
+ * Programs that cannot afford the stall at an arbitrary point should call
+ * this function once during initialization.
+ *
+ * @return: The elapsed time, in nanoseconds.
+ */
+uint64_t yf_getns(void);
+
+/**
+ * Suspends execution of the calling thread until a given deadline.
+ *
+ * The thread sleeps for most of the interval and then spins for the
+ * remainder, so that the deadline is met more precisely than by sleeping
+ * alone. The length of the spin adapts to how much the thread oversleeps.
+ *
+ * @param deadline: The time to wait for, as returned by 'yf_getns()'.
+ */
+void yf_waituntil(uint64_t deadline);
+
+/**
+ * Opaque type defining a rolling histogram of frame times.
+ */
+typedef struct yf_frmhist yf_frmhist_t;
+
+/**
+ * Type defining statistics of frame times, in nanoseconds.
+ */
+typedef struct yf_frmstats {
+    uint64_t p50;
+    uint64_t p99;
+    uint64_t max;
+    unsigned n;
+} yf_frmstats_t;
+
+/**
+ * Initializes a new frame time histogram.
+ *
+ * @param window: The number of most recent frame times to keep. Must be
+ *  greater than zero.
+ * @return: On success, returns a new histogram. Otherwise, 'NULL' is
+ *  returned and the global error is set to indicate the cause.
+ */
+yf_frmhist_t *yf_frmhist_init(unsigned window);
+
+/**
+ * Adds a frame time to a histogram.
+ *
+ * If the histogram's window is full, the oldest frame time is discarded.
+ *
+ * @param hist: The histogram.
+ * @param ns: The frame time, in nanoseconds.
+ */
+void yf_frmhist_add(yf_frmhist_t *hist, uint64_t ns);
+
+/**
+ * Gets statistics of the frame times in a histogram.
+ *
+ * Percentiles are approximated to within about 3% of the true values.
+ * The maximum is exact.
+ *
+ * @param hist: The histogram.
+ * @param stats: The destination for the statistics. All values are zero
+ *  if the histogram is empty.
+ */
+void yf_frmhist_getstats(yf_frmhist_t *hist, yf_frmstats_t *stats);
+
+/**
+ * Discards all frame times in a histogram.
+ *
+ * @param hist: The histogram.
+ */
+void yf_frmhist_clear(yf_frmhist_t *hist);
+
+/**
+ * Deinitializes a frame time histogram.
+ *
+ * @param hist: The histogram to deinitialize. Can be 'NULL'.
+ */
+void yf_frmhist_deinit(yf_frmhist_t *hist);
+
 YF_DECLS_END
 
 #endif /* YF_YF_CLOCK_H */
@@ -11,6 +11,8 @@
 /**
  * Common interface.
  */
+#include "yf-arena.h"
+#include "yf-cdict.h"
 #include "yf-clock.h"
 #include "yf-cmpfn.h"
 #include "yf-defs.h"
@@ -18,9 +20,14 @@
 #include "yf-error.h"
 #include "yf-hashfn.h"
 #include "yf-iter.h"
+#include "yf-job.h"
 #include "yf-list.h"
+#include "yf-mem.h"
+#include "yf-prof.h"
 #include "yf-pubsub.h"
+#include "yf-ring.h"
 #include "yf-types.h"
 #include "yf-util.h"
+#include "yf-vec.h"
 
 #endif /* YF_YF_COM_H */
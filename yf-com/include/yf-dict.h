@@ -30,6 +30,42 @@ typedef struct yf_dict yf_dict_t;
  */
 yf_dict_t *yf_dict_init(yf_hashfn_t hash, yf_cmpfn_t cmp);
 
+/**
+ * Rehashing modes.
+ */
+#define YF_DICT_REHASH_ALL  0
+#define YF_DICT_REHASH_INCR 1
+
+/**
+ * Sets how a dictionary rehashes.
+ *
+ * By default ('YF_DICT_REHASH_ALL'), all pairs are moved to the new table as
+ * soon as the dictionary is resized. When rehashing incrementally
+ * ('YF_DICT_REHASH_INCR'), pairs are moved a few at a time by subsequent
+ * insertions and removals, which bounds the cost of every operation at the
+ * expense of keeping both tables around for a while.
+ *
+ * @param dict: The dictionary.
+ * @param rehash: The 'YF_DICT_REHASH' value indicating the rehashing mode.
+ */
+void yf_dict_setrehash(yf_dict_t *dict, int rehash);
+
+/**
+ * Reserves capacity in a dictionary.
+ *
+ * After this call, 'n' pairs can be stored without growing the dictionary,
+ * and it will not shrink below this capacity. Reserving zero pairs removes
+ * the restriction.
+ *
+ * Non-nil iterators that refer to 'dict' become invalid.
+ *
+ * @param dict: The dictionary.
+ * @param n: The number of pairs to reserve space for.
+ * @return: On success, returns zero. Otherwise, a non-zero value is returned
+ *  and the global error is set to indicate the cause.
+ */
+int yf_dict_reserve(yf_dict_t *dict, size_t n);
+
 /**
  * Inserts a key/value pair in a dictionary.
  *
@@ -98,6 +134,21 @@ void *yf_dict_search(yf_dict_t *dict, const void *key);
  */
 void *yf_dict_lookup(yf_dict_t *dict, void **key);
 
+/**
+ * Searches for a key in a dictionary, without setting the global error.
+ *
+ * Unlike 'yf_dict_search', this function tells apart keys not found from
+ * keys stored with a 'NULL' value, and is suitable for lookups that are
+ * expected to miss.
+ *
+ * @param dict: The dictionary.
+ * @param key: The key.
+ * @param val: The destination for the stored value. Can be 'NULL'.
+ * @return: If 'dict' contains 'key', returns a non-zero value. Otherwise,
+ *  zero is returned.
+ */
+int yf_dict_find(yf_dict_t *dict, const void *key, void **val);
+
 /**
  * Checks whether or not a dictionary contains a given key.
  *
@@ -145,9 +196,20 @@ void yf_dict_each(yf_dict_t *dict,
  */
 size_t yf_dict_getlen(yf_dict_t *dict);
 
+/**
+ * Removes all key/value pairs from a dictionary, keeping its capacity.
+ *
+ * Non-nil iterators that refer to 'dict' become invalid.
+ *
+ * @param dict: The dictionary.
+ */
+void yf_dict_reset(yf_dict_t *dict);
+
 /**
  * Removes all key/value pairs from a dictionary.
  *
+ * The dictionary shrinks to its reserved capacity.
+ *
  * Non-nil iterators that refer to 'dict' become invalid.
  *
  * @param dict: The dictionary.
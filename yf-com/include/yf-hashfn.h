@@ -9,6 +9,7 @@
 #define YF_YF_HASHFN_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include "yf-defs.h"
 
@@ -33,6 +34,8 @@ size_t yf_hash(const void *ptr);
 /**
  * Computes the hash value of a string.
  *
+ * This function uses 'yf_hash64()' with a seed of zero.
+ *
  * @param str: The null-terminated byte string.
  * @return: The hash value.
  */
@@ -41,6 +44,9 @@ size_t yf_hashstr(const void *str);
 /**
  * Computes the hash value of a varying number of byte arrays.
  *
+ * Each buffer is hashed with 'yf_hash64()', seeded by the hash value of the
+ * previous buffer.
+ *
  * @param buf: The first buffer.
  * @param len: The length of the first buffer.
  * @param ...: Variable number of buffer/length pairs. A 'NULL' buffer signals
@@ -49,6 +55,23 @@ size_t yf_hashstr(const void *str);
  */
 size_t yf_hashv(const void *buf, size_t len, ...);
 
+/**
+ * Computes the 64-bit hash value of a byte array.
+ *
+ * Input is processed one or more words at a time, so this function is much
+ * faster than byte-wise hashing for all but the shortest arrays. The values
+ * produced do not depend on the alignment of 'buf', but long arrays may hash
+ * differently in builds targeting other instruction sets, so hash values
+ * should not be persisted. This function is not suitable for cryptographic
+ * purposes.
+ *
+ * @param buf: The buffer. Can be 'NULL' if 'len' is zero.
+ * @param len: The length of the buffer.
+ * @param seed: The seed value.
+ * @return: The hash value.
+ */
+uint64_t yf_hash64(const void *buf, size_t len, uint64_t seed);
+
 YF_DECLS_END
 
 #endif /* YF_YF_HASHFN_H */
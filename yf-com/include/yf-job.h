@@ -0,0 +1,114 @@
+/*
+ * YF
+ * yf-job.h
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#ifndef YF_YF_JOB_H
+#define YF_YF_JOB_H
+
+#include <stddef.h>
+
+#include "yf-defs.h"
+
+YF_DECLS_BEGIN
+
+/**
+ * Opaque type defining a unit of work.
+ */
+typedef struct yf_job yf_job_t;
+
+/**
+ * Type defining the function executed by a job.
+ *
+ * @param job: The job being executed, which can be used as the parent of
+ *  new jobs.
+ * @param arg: The generic argument given on job creation.
+ */
+typedef void (*yf_jobfn_t)(yf_job_t *job, void *arg);
+
+/**
+ * Initializes the job system.
+ *
+ * Each worker thread has its own queue of jobs and steals from the others
+ * when its queue is empty. The calling thread also has a queue, and executes
+ * jobs whenever it waits for one to complete.
+ *
+ * Jobs can be created before initialization, or from threads other than
+ * the workers and the one that called this function, in which case they
+ * execute immediately on the calling thread.
+ *
+ * @param thrd_n: The number of worker threads to create. If zero, jobs will
+ *  only execute on the calling thread, while it waits.
+ * @return: On success, returns zero. Otherwise, a non-zero value is returned
+ *  and the global error is set to indicate the cause.
+ */
+int yf_job_init(unsigned thrd_n);
+
+/**
+ * Gets the number of worker threads of the job system.
+ *
+ * @return: The number of worker threads, not including the thread that
+ *  initialized the job system.
+ */
+unsigned yf_job_getthrdn(void);
+
+/**
+ * Creates a job and schedules it for execution.
+ *
+ * The job must be waited for with 'yf_job_wait()'.
+ *
+ * @param fn: The function to execute.
+ * @param arg: The generic argument to pass to 'fn'.
+ * @return: The new job.
+ */
+yf_job_t *yf_job_run(yf_jobfn_t fn, void *arg);
+
+/**
+ * Creates a child job and schedules it for execution.
+ *
+ * A job only completes after its function returns and all of its children
+ * complete. Child jobs are not waited for individually.
+ *
+ * @param parent: The parent job. It must not have completed yet.
+ * @param fn: The function to execute.
+ * @param arg: The generic argument to pass to 'fn'.
+ */
+void yf_job_fork(yf_job_t *parent, yf_jobfn_t fn, void *arg);
+
+/**
+ * Waits for a job to complete.
+ *
+ * The calling thread executes other jobs while waiting. After this function
+ * returns, 'job' is no longer valid.
+ *
+ * @param job: The job created by 'yf_job_run()'.
+ */
+void yf_job_wait(yf_job_t *job);
+
+/**
+ * Executes a function over a range of indices in parallel.
+ *
+ * The range is split recursively into jobs of at most 'grain' indices, and
+ * the calling thread takes part in their execution.
+ *
+ * @param n: The number of indices, starting from zero.
+ * @param grain: The maximum number of indices handled by a single call of
+ *  'fn'. If zero, a size is chosen based on the number of threads.
+ * @param fn: The function to execute, given a half-open interval of indices.
+ * @param arg: The generic argument to pass to 'fn'.
+ */
+void yf_job_parfor(size_t n, size_t grain,
+                   void (*fn)(size_t beg, size_t end, void *arg), void *arg);
+
+/**
+ * Deinitializes the job system.
+ *
+ * All jobs must have completed.
+ */
+void yf_job_deinit(void);
+
+YF_DECLS_END
+
+#endif /* YF_YF_JOB_H */
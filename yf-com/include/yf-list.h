@@ -22,12 +22,40 @@ typedef struct yf_list yf_list_t;
 /**
  * Initializes a new linked list.
  *
+ * Entries are allocated in blocks and recycled on removal. Memory is only
+ * released when the list is deinitialized.
+ *
  * @param cmp: The comparison function to use. Can be 'NULL'.
  * @return: On success, returns a new list. Otherwise, 'NULL' is returned and
  *  the global error is set to indicate the cause.
  */
 yf_list_t *yf_list_init(yf_cmpfn_t cmp);
 
+/**
+ * Storage modes.
+ *
+ * 'YF_LIST_LINKED' is the default mode, in which insertion and removal take
+ * constant time anywhere in the list.
+ * 'YF_LIST_ARRAY' stores values contiguously, which makes iteration faster.
+ * Insertion and removal take constant time at the beginning of the list
+ * and linear time elsewhere.
+ */
+#define YF_LIST_LINKED 0
+#define YF_LIST_ARRAY  1
+
+/**
+ * Sets the storage mode of a linked list.
+ *
+ * Values stored in the list are kept, in the same order.
+ * Non-nil iterators that refer to 'list' become invalid.
+ *
+ * @param list: The list.
+ * @param mode: The 'YF_LIST' value indicating the storage mode to use.
+ * @return: On success, returns zero. Otherwise, a non-zero value is returned
+ *  and the global error is set to indicate the cause.
+ */
+int yf_list_setmode(yf_list_t *list, int mode);
+
 /**
  * Inserts a given value in a linked list.
  *
@@ -142,6 +170,8 @@ size_t yf_list_getlen(yf_list_t *list);
 /**
  * Removes all elements from a linked list.
  *
+ * Storage is kept for reuse.
+ *
  * Non-nil iterators that refer to 'list' become invalid.
  *
  * @param list: The list.
@@ -0,0 +1,120 @@
+/*
+ * YF
+ * yf-mem.h
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#ifndef YF_YF_MEM_H
+#define YF_YF_MEM_H
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "yf-defs.h"
+
+YF_DECLS_BEGIN
+
+/**
+ * Tagged allocation.
+ *
+ * Allocations made through these macros are accounted per tag when
+ * 'YF_MEMTRACK' is defined. Otherwise, they expand to the standard library
+ * functions and the tag is ignored.
+ *
+ * Memory obtained from 'YF_MALLOC', 'YF_CALLOC' or 'YF_REALLOC' must only
+ * be released by 'YF_REALLOC' or 'YF_FREE', and vice versa.
+ *
+ * Tags must be string literals.
+ */
+#ifdef YF_MEMTRACK
+# define YF_MALLOC(tag, size) yf_mem_malloc("" tag, size)
+# define YF_CALLOC(tag, n, size) yf_mem_calloc("" tag, n, size)
+# define YF_REALLOC(tag, ptr, size) yf_mem_realloc("" tag, ptr, size)
+# define YF_FREE(ptr) yf_mem_free(ptr)
+#else
+# define YF_MALLOC(tag, size) malloc(size)
+# define YF_CALLOC(tag, n, size) calloc(n, size)
+# define YF_REALLOC(tag, ptr, size) realloc(ptr, size)
+# define YF_FREE(ptr) free(ptr)
+#endif
+
+/**
+ * Type defining allocation statistics of a tag.
+ */
+typedef struct yf_memstats {
+    const char *tag;
+    size_t live;
+    size_t peak;
+    size_t alloc_n;
+    size_t free_n;
+} yf_memstats_t;
+
+/**
+ * Allocates tracked memory.
+ *
+ * This function is called by 'YF_MALLOC', and should not be called
+ * directly.
+ *
+ * @param tag: The tag to account the allocation to.
+ * @param size: The number of bytes to allocate.
+ * @return: The allocated memory, or 'NULL' on failure.
+ */
+void *yf_mem_malloc(const char *tag, size_t size);
+
+/**
+ * Allocates zeroed tracked memory.
+ *
+ * This function is called by 'YF_CALLOC', and should not be called
+ * directly.
+ *
+ * @param tag: The tag to account the allocation to.
+ * @param n: The number of elements.
+ * @param size: The size of each element.
+ * @return: The allocated memory, or 'NULL' on failure.
+ */
+void *yf_mem_calloc(const char *tag, size_t n, size_t size);
+
+/**
+ * Reallocates tracked memory.
+ *
+ * This function is called by 'YF_REALLOC', and should not be called
+ * directly.
+ *
+ * @param tag: The tag to account the allocation to, if 'ptr' is 'NULL'.
+ *  Otherwise, the memory keeps the tag it was allocated with.
+ * @param ptr: The memory to reallocate. Can be 'NULL'.
+ * @param size: The new size, in bytes.
+ * @return: The reallocated memory, or 'NULL' on failure.
+ */
+void *yf_mem_realloc(const char *tag, void *ptr, size_t size);
+
+/**
+ * Deallocates tracked memory.
+ *
+ * This function is called by 'YF_FREE', and should not be called
+ * directly.
+ *
+ * @param ptr: The memory to deallocate. Can be 'NULL'.
+ */
+void yf_mem_free(void *ptr);
+
+/**
+ * Gets allocation statistics.
+ *
+ * @param stats: The destination for the statistics of each tag. Can be
+ *  'NULL' if 'n' is zero.
+ * @param n: The number of elements in 'stats'.
+ * @return: The number of tags that have been used. If this value exceeds
+ *  'n', only the first 'n' tags are written.
+ */
+size_t yf_mem_getstats(yf_memstats_t *stats, size_t n);
+
+/**
+ * Prints allocation statistics.
+ */
+void yf_mem_print(void);
+
+YF_DECLS_END
+
+#endif /* YF_YF_MEM_H */
@@ -0,0 +1,81 @@
+/*
+ * YF
+ * yf-prof.h
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#ifndef YF_YF_PROF_H
+#define YF_YF_PROF_H
+
+#include "yf-defs.h"
+
+YF_DECLS_BEGIN
+
+/* Profiling zones are compiled in only when 'YF_PROFILE' is defined.
+   Each thread that records zones buffers up to about 25 MB of events,
+   dropping further ones, and buffers are freed when the process exits. */
+
+/**
+ * Begins a profiling zone on the calling thread.
+ *
+ * Zones can be nested, and every zone must be ended on the thread that
+ * began it.
+ *
+ * @param name: The name of the zone, which must be a string literal.
+ */
+#ifdef YF_PROFILE
+# define YF_PROF_BEGIN(name) yf_prof_begin("" name)
+#else
+# define YF_PROF_BEGIN(name) ((void)0)
+#endif
+
+/**
+ * Ends the innermost profiling zone of the calling thread.
+ */
+#ifdef YF_PROFILE
+# define YF_PROF_END() yf_prof_end()
+#else
+# define YF_PROF_END() ((void)0)
+#endif
+
+/**
+ * Begins a profiling zone.
+ *
+ * This function is called by 'YF_PROF_BEGIN', and should not be called
+ * directly.
+ *
+ * @param name: The name of the zone.
+ */
+void yf_prof_begin(const char *name);
+
+/**
+ * Ends a profiling zone.
+ *
+ * This function is called by 'YF_PROF_END', and should not be called
+ * directly.
+ */
+void yf_prof_end(void);
+
+/**
+ * Exports recorded profiling zones as a Chrome trace.
+ *
+ * The output is a JSON file that can be loaded in 'chrome://tracing' and
+ * compatible viewers. Zones that have not ended are not exported.
+ *
+ * @param pathname: The pathname of the file to write.
+ * @return: On success, returns zero. Otherwise, a non-zero value is returned
+ *  and the global error is set to indicate the cause.
+ */
+int yf_prof_export(const char *pathname);
+
+/**
+ * Discards all recorded profiling zones.
+ *
+ * No thread can be inside a zone when this function is called.
+ */
+void yf_prof_reset(void);
+
+YF_DECLS_END
+
+#endif /* YF_YF_PROF_H */
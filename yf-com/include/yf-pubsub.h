@@ -14,6 +14,9 @@ YF_DECLS_BEGIN
 
 /**
  * Publish-Subscribe values.
+ *
+ * All functions can be called from any thread. Publishing does not block,
+ * while changes to publishers and subscriptions are serialized.
  */
 #define YF_PUBSUB_NONE   0
 #define YF_PUBSUB_DEINIT 0x01
@@ -45,6 +48,10 @@ unsigned yf_checkpub(const void *pub);
  *
  * The caller must ensure that 'pubsub' is valid for 'pub'.
  *
+ * Subscribers are called with the subscriptions that were in effect when
+ * publishing began. Subscription changes made concurrently or from within
+ * a callback only apply to subsequent calls.
+ *
  * @param pub: The publisher.
  * @param pubsub: The 'YF_PUBSUB' value indicating what to publish.
  */
@@ -67,6 +74,31 @@ void yf_publish(const void *pub, int pubsub);
 int yf_subscribe(const void *pub, const void *sub, unsigned pubsub_mask,
                  void (*callb)(void *pub, int pubsub, void *arg), void *arg);
 
+/**
+ * Defers publishing until the next flush.
+ *
+ * Publications deferred for the same publisher are merged, so that each
+ * subscriber receives at most one call per 'YF_PUBSUB' value when
+ * 'yf_flushpub()' is called. Unsetting the publisher discards its
+ * deferred publications.
+ *
+ * @param pub: The publisher.
+ * @param pubsub: The 'YF_PUBSUB' mask indicating what to publish. Must not
+ *  contain 'YF_PUBSUB_DEINIT'.
+ * @return: On success, returns zero. Otherwise, a non-zero value is returned
+ *  and the global error is set to indicate the cause.
+ */
+int yf_deferpub(const void *pub, int pubsub);
+
+/**
+ * Publishes all deferred publications.
+ *
+ * Publications are delivered in the order that their publishers were first
+ * deferred. Publications deferred from within callbacks are kept for the
+ * next flush.
+ */
+void yf_flushpub(void);
+
 YF_DECLS_END
 
 #endif /* YF_YF_PUBSUB_H */
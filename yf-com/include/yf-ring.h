@@ -0,0 +1,129 @@
+/*
+ * YF
+ * yf-ring.h
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#ifndef YF_YF_RING_H
+#define YF_YF_RING_H
+
+#include <stddef.h>
+
+#include "yf-defs.h"
+
+YF_DECLS_BEGIN
+
+/**
+ * Opaque type defining a single-producer/single-consumer ring.
+ *
+ * One thread can push while another thread pops, without locking.
+ */
+typedef struct yf_spsc yf_spsc_t;
+
+/**
+ * Opaque type defining a multi-producer/multi-consumer ring.
+ *
+ * Any number of threads can push and pop concurrently, without locking.
+ */
+typedef struct yf_mpmc yf_mpmc_t;
+
+/**
+ * Initializes a new single-producer/single-consumer ring.
+ *
+ * Storage is allocated once and elements are copied in and out of it.
+ *
+ * @param elem_sz: The size of each element. Must be greater than zero.
+ * @param cap: The minimum number of elements that the ring can hold. It is
+ *  rounded up to a power of two.
+ * @return: On success, returns a new ring. Otherwise, 'NULL' is returned
+ *  and the global error is set to indicate the cause.
+ */
+yf_spsc_t *yf_spsc_init(size_t elem_sz, size_t cap);
+
+/**
+ * Pushes an element onto a single-producer/single-consumer ring.
+ *
+ * @param ring: The ring.
+ * @param elem: The element to copy into the ring.
+ * @return: If the ring is full, returns a non-zero value. Otherwise, zero
+ *  is returned.
+ */
+int yf_spsc_push(yf_spsc_t *ring, const void *elem);
+
+/**
+ * Pops an element from a single-producer/single-consumer ring.
+ *
+ * @param ring: The ring.
+ * @param dst: The destination for the removed element.
+ * @return: If the ring is empty, returns a non-zero value. Otherwise, zero
+ *  is returned.
+ */
+int yf_spsc_pop(yf_spsc_t *ring, void *dst);
+
+/**
+ * Gets the capacity of a single-producer/single-consumer ring.
+ *
+ * @param ring: The ring.
+ * @return: The maximum number of elements that the ring can hold.
+ */
+size_t yf_spsc_getcap(yf_spsc_t *ring);
+
+/**
+ * Deinitializes a single-producer/single-consumer ring.
+ *
+ * @param ring: The ring to deinitialize. Can be 'NULL'.
+ */
+void yf_spsc_deinit(yf_spsc_t *ring);
+
+/**
+ * Initializes a new multi-producer/multi-consumer ring.
+ *
+ * Storage is allocated once and elements are copied in and out of it.
+ *
+ * @param elem_sz: The size of each element. Must be greater than zero.
+ * @param cap: The minimum number of elements that the ring can hold. It is
+ *  rounded up to a power of two.
+ * @return: On success, returns a new ring. Otherwise, 'NULL' is returned
+ *  and the global error is set to indicate the cause.
+ */
+yf_mpmc_t *yf_mpmc_init(size_t elem_sz, size_t cap);
+
+/**
+ * Pushes an element onto a multi-producer/multi-consumer ring.
+ *
+ * @param ring: The ring.
+ * @param elem: The element to copy into the ring.
+ * @return: If the ring is full, returns a non-zero value. Otherwise, zero
+ *  is returned.
+ */
+int yf_mpmc_push(yf_mpmc_t *ring, const void *elem);
+
+/**
+ * Pops an element from a multi-producer/multi-consumer ring.
+ *
+ * @param ring: The ring.
+ * @param dst: The destination for the removed element.
+ * @return: If the ring is empty, returns a non-zero value. Otherwise, zero
+ *  is returned.
+ */
+int yf_mpmc_pop(yf_mpmc_t *ring, void *dst);
+
+/**
+ * Gets the capacity of a multi-producer/multi-consumer ring.
+ *
+ * @param ring: The ring.
+ * @return: The maximum number of elements that the ring can hold.
+ */
+size_t yf_mpmc_getcap(yf_mpmc_t *ring);
+
+/**
+ * Deinitializes a multi-producer/multi-consumer ring.
+ *
+ * @param ring: The ring to deinitialize. Can be 'NULL'.
+ */
+void yf_mpmc_deinit(yf_mpmc_t *ring);
+
+YF_DECLS_END
+
+#endif /* YF_YF_RING_H */
@@ -0,0 +1,144 @@
+/*
+ * YF
+ * yf-vec.h
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#ifndef YF_YF_VEC_H
+#define YF_YF_VEC_H
+
+#include <stddef.h>
+
+#include "yf-defs.h"
+#include "yf-cmpfn.h"
+
+YF_DECLS_BEGIN
+
+/**
+ * Opaque type defining a growable array.
+ */
+typedef struct yf_vec yf_vec_t;
+
+/**
+ * Initializes a new growable array.
+ *
+ * Elements are stored contiguously and copied in and out of the array.
+ *
+ * @param elem_sz: The size of each element. Must be greater than zero.
+ * @return: On success, returns a new array. Otherwise, 'NULL' is returned and
+ *  the global error is set to indicate the cause.
+ */
+yf_vec_t *yf_vec_init(size_t elem_sz);
+
+/**
+ * Gets a typed pointer to the element at a given index of a growable array.
+ *
+ * @param vec: The array.
+ * @param type: The element type.
+ * @param i: The index.
+ * @return: A pointer to the element, as a 'type *'.
+ */
+#define YF_VEC_AT(vec, type, i) ((type *)yf_vec_get(vec, i))
+
+/**
+ * Ensures that a growable array can store a given number of elements
+ * without reallocating.
+ *
+ * @param vec: The array.
+ * @param n: The number of elements.
+ * @return: On success, returns zero. Otherwise, a non-zero value is returned
+ *  and the global error is set to indicate the cause.
+ */
+int yf_vec_reserve(yf_vec_t *vec, size_t n);
+
+/**
+ * Appends an element to a growable array.
+ *
+ * Pointers to elements of 'vec' become invalid.
+ *
+ * @param vec: The array.
+ * @param elem: The element to copy into the array.
+ * @return: On success, returns zero. Otherwise, a non-zero value is returned
+ *  and the global error is set to indicate the cause.
+ */
+int yf_vec_push(yf_vec_t *vec, const void *elem);
+
+/**
+ * Removes the last element of a growable array.
+ *
+ * @param vec: The array.
+ * @param dst: The destination for the removed element. Can be 'NULL'.
+ * @return: If 'vec' is empty, returns a non-zero value and sets the global
+ *  error to 'YF_ERR_NOTFND'. Otherwise, zero is returned.
+ */
+int yf_vec_pop(yf_vec_t *vec, void *dst);
+
+/**
+ * Removes an element from a growable array by replacing it with the last
+ * element.
+ *
+ * This does not preserve the order of elements, but takes constant time.
+ *
+ * @param vec: The array.
+ * @param i: The index of the element to remove. Must be less than the
+ *  length of the array.
+ * @param dst: The destination for the removed element. Can be 'NULL'.
+ */
+void yf_vec_swaprm(yf_vec_t *vec, size_t i, void *dst);
+
+/**
+ * Gets the element at a given index of a growable array.
+ *
+ * @param vec: The array.
+ * @param i: The index. Must be less than the length of the array.
+ * @return: A pointer to the element, which is valid until the array is
+ *  modified.
+ */
+void *yf_vec_get(yf_vec_t *vec, size_t i);
+
+/**
+ * Gets the underlying storage of a growable array.
+ *
+ * @param vec: The array.
+ * @param n: The destination for the number of elements. Can be 'NULL'.
+ * @return: A pointer to the first element, which is valid until the array
+ *  is modified. If the array has no storage, returns 'NULL'.
+ */
+void *yf_vec_getdata(yf_vec_t *vec, size_t *n);
+
+/**
+ * Gets the number of elements stored in a growable array.
+ *
+ * @param vec: The array.
+ * @return: The length of the array.
+ */
+size_t yf_vec_getlen(yf_vec_t *vec);
+
+/**
+ * Sorts the elements of a growable array.
+ *
+ * @param vec: The array.
+ * @param cmp: The comparison function, which is given pointers to elements.
+ */
+void yf_vec_sort(yf_vec_t *vec, yf_cmpfn_t cmp);
+
+/**
+ * Removes all elements from a growable array.
+ *
+ * Storage is kept for reuse.
+ *
+ * @param vec: The array.
+ */
+void yf_vec_clear(yf_vec_t *vec);
+
+/**
+ * Deinitializes a growable array.
+ *
+ * @param vec: The array to deinitialize. Can be 'NULL'.
+ */
+void yf_vec_deinit(yf_vec_t *vec);
+
+YF_DECLS_END
+
+#endif /* YF_YF_VEC_H */
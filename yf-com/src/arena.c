@@ -0,0 +1,269 @@
+/*
+ * YF
+ * arena.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#ifndef __STDC_NO_THREADS__
+# include <threads.h>
+#else
+# error "C11 threads required"
+#endif
+
+#include "yf-arena.h"
+#include "yf-mem.h"
+#include "yf-error.h"
+
+/* Alignment of every allocation. */
+#define YF_ARENAALIGN _Alignof(max_align_t)
+
+/* Default size of the first block and size limit for growth. */
+#define YF_ARENAMIN  4096
+#define YF_ARENAMAX  (1 << 20)
+
+/* Size of the first block of thread arenas. */
+#define YF_ARENATHRD 65536
+
+/* Block of memory.
+   Positions are counted from the start of the first block, so that a mark
+   identifies both a block and an offset within it. */
+typedef struct block block_t;
+struct block {
+    block_t *next;
+    size_t base;
+    size_t cap;
+    max_align_t data[];
+};
+
+struct yf_arena {
+    block_t *first;
+    block_t *cur;
+    size_t off;
+    size_t blk_sz;
+    unsigned char *last;
+};
+
+/* Rounds a size up to the allocation alignment. */
+static int align_size(size_t size, size_t *dst)
+{
+    if (size > SIZE_MAX - YF_ARENAALIGN) {
+        yf_seterr(YF_ERR_OFLOW, __func__);
+        return -1;
+    }
+
+    *dst = size == 0 ? YF_ARENAALIGN :
+           (size + YF_ARENAALIGN - 1) & ~(YF_ARENAALIGN - 1);
+    return 0;
+}
+
+/* Moves to the block following the current one, ensuring that it can
+   store a given number of bytes. */
+static int next_block(yf_arena_t *arena, size_t size)
+{
+    block_t *prev = arena->cur;
+    block_t *blk = prev != NULL ? prev->next : arena->first;
+
+    if (blk == NULL || blk->cap < size) {
+        /* blocks that are too small are kept for later */
+        const size_t cap = size > arena->blk_sz ? size : arena->blk_sz;
+        if (cap > SIZE_MAX - sizeof(block_t)) {
+            yf_seterr(YF_ERR_OFLOW, __func__);
+            return -1;
+        }
+
+        block_t *new_blk = YF_MALLOC("arena", sizeof(block_t) + cap);
+        if (new_blk == NULL) {
+            yf_seterr(YF_ERR_NOMEM, __func__);
+            return -1;
+        }
+
+        new_blk->next = blk;
+        new_blk->cap = cap;
+        if (prev != NULL)
+            prev->next = new_blk;
+        else
+            arena->first = new_blk;
+
+        if (arena->blk_sz < YF_ARENAMAX)
+            arena->blk_sz <<= 1;
+
+        new_blk->base = prev != NULL ? prev->base + prev->cap : 0;
+        for (block_t *b = new_blk; b->next != NULL; b = b->next)
+            b->next->base = b->base + b->cap;
+
+        blk = new_blk;
+    }
+
+    arena->cur = blk;
+    arena->off = 0;
+    return 0;
+}
+
+yf_arena_t *yf_arena_init(size_t size)
+{
+    yf_arena_t *arena = YF_CALLOC("arena", 1, sizeof(yf_arena_t));
+    if (arena == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        return NULL;
+    }
+
+    if (size == 0 || align_size(size, &arena->blk_sz) != 0)
+        arena->blk_sz = YF_ARENAMIN;
+
+    return arena;
+}
+
+void *yf_arena_alloc(yf_arena_t *arena, size_t size)
+{
+    assert(arena != NULL);
+
+    if (align_size(size, &size) != 0)
+        return NULL;
+
+    if (arena->cur == NULL || arena->cur->cap - arena->off < size) {
+        if (next_block(arena, size) != 0)
+            return NULL;
+    }
+
+    unsigned char *p = (unsigned char *)arena->cur->data + arena->off;
+    arena->off += size;
+    arena->last = p;
+    return p;
+}
+
+void *yf_arena_calloc(yf_arena_t *arena, size_t n, size_t size)
+{
+    assert(arena != NULL);
+
+    if (size != 0 && n > SIZE_MAX / size) {
+        yf_seterr(YF_ERR_OFLOW, __func__);
+        return NULL;
+    }
+
+    void *p = yf_arena_alloc(arena, n * size);
+    if (p != NULL)
+        memset(p, 0, n * size);
+    return p;
+}
+
+void *yf_arena_realloc(yf_arena_t *arena, void *ptr, size_t old_size,
+                       size_t new_size)
+{
+    assert(arena != NULL);
+
+    if (ptr == NULL)
+        return yf_arena_alloc(arena, new_size);
+
+    if (new_size <= old_size)
+        return ptr;
+
+    if (ptr == arena->last) {
+        /* the most recent allocation can grow into the rest of its block */
+        size_t size;
+        if (align_size(new_size, &size) != 0)
+            return NULL;
+
+        const size_t beg = arena->last - (unsigned char *)arena->cur->data;
+        if (arena->cur->cap - beg >= size) {
+            arena->off = beg + size;
+            return ptr;
+        }
+    }
+
+    void *p = yf_arena_alloc(arena, new_size);
+    if (p != NULL)
+        memcpy(p, ptr, old_size);
+    return p;
+}
+
+size_t yf_arena_getmark(yf_arena_t *arena)
+{
+    assert(arena != NULL);
+    return arena->cur != NULL ? arena->cur->base + arena->off : 0;
+}
+
+void yf_arena_reset(yf_arena_t *arena, size_t mark)
+{
+    assert(arena != NULL);
+    assert(mark <= yf_arena_getmark(arena));
+
+    arena->last = NULL;
+
+    if (mark == 0) {
+        arena->cur = NULL;
+        arena->off = 0;
+        return;
+    }
+
+    block_t *blk = arena->first;
+    while (mark > blk->base + blk->cap)
+        blk = blk->next;
+
+    arena->cur = blk;
+    arena->off = mark - blk->base;
+}
+
+void yf_arena_deinit(yf_arena_t *arena)
+{
+    if (arena == NULL)
+        return;
+
+    while (arena->first != NULL) {
+        block_t *next = arena->first->next;
+        YF_FREE(arena->first);
+        arena->first = next;
+    }
+
+    YF_FREE(arena);
+}
+
+/* Key used to deinitialize thread arenas on thread exit. */
+static tss_t key_;
+static once_flag once_ = ONCE_FLAG_INIT;
+static int key_ok_ = 0;
+
+/* The arena of the calling thread. */
+static _Thread_local yf_arena_t *thrd_ = NULL;
+
+/* Destructor of thread arenas. */
+static void deinit_thrd(void *arena)
+{
+    yf_arena_deinit(arena);
+}
+
+/* Creates the key for thread arenas. */
+static void init_key(void)
+{
+    key_ok_ = tss_create(&key_, deinit_thrd) == thrd_success;
+}
+
+yf_arena_t *yf_arena_getthrd(void)
+{
+    if (thrd_ != NULL)
+        return thrd_;
+
+    call_once(&once_, init_key);
+    if (!key_ok_) {
+        yf_seterr(YF_ERR_OTHER, __func__);
+        return NULL;
+    }
+
+    yf_arena_t *arena = yf_arena_init(YF_ARENATHRD);
+    if (arena == NULL)
+        return NULL;
+
+    if (tss_set(key_, arena) != thrd_success) {
+        yf_arena_deinit(arena);
+        yf_seterr(YF_ERR_OTHER, __func__);
+        return NULL;
+    }
+
+    thrd_ = arena;
+    return arena;
+}
@@ -0,0 +1,350 @@
+/*
+ * YF
+ * cdict.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#ifndef __STDC_NO_ATOMICS__
+# include <stdatomic.h>
+#else
+# error "C11 atomics required"
+#endif
+
+#ifndef __STDC_NO_THREADS__
+# include <threads.h>
+#else
+# error "C11 threads required"
+#endif
+
+#include "yf-cdict.h"
+#include "yf-dict.h"
+#include "yf-mem.h"
+#include "yf-error.h"
+
+/* Each shard is a regular dictionary guarded by a reader/writer lock.
+   The lock is a single atomic word, holding the number of readers, a bit
+   for the writer and a bit indicating that some thread sleeps on the
+   shard's condition variable. Uncontended locking is a single CAS, and
+   contended threads block instead of spinning, since 'findins' may hold a
+   shard for as long as it takes to create a value.
+
+   Readers do not acquire a shard that has sleepers, so that a steady
+   stream of lookups cannot starve a waiting writer. */
+
+/* Number of shards. */
+#define YF_SHARDBITS 4
+#define YF_SHARDN    (1 << YF_SHARDBITS)
+
+/* Size of a cache line.
+   Each shard is kept in its own line. */
+#define YF_LINESZ 64
+
+/* Lock state bits. */
+#define YF_LOCK_WRITER  0x80000000U
+#define YF_LOCK_WAITING 0x40000000U
+#define YF_LOCK_READERS 0x3fffffffU
+
+/* Shard of a concurrent dictionary. */
+typedef struct {
+    _Alignas(YF_LINESZ) atomic_uint lock;
+    mtx_t mtx;
+    cnd_t cnd;
+    yf_dict_t *dict;
+} shard_t;
+
+struct yf_cdict {
+    shard_t shards[YF_SHARDN];
+    yf_hashfn_t hash;
+};
+
+/* Wakes every thread sleeping on a shard. */
+static void wake_shard(shard_t *shard)
+{
+    mtx_lock(&shard->mtx);
+    atomic_fetch_and_explicit(&shard->lock, ~YF_LOCK_WAITING,
+                              memory_order_relaxed);
+    cnd_broadcast(&shard->cnd);
+    mtx_unlock(&shard->mtx);
+}
+
+/* Sleeps on a shard until it is unlocked.
+   The waiting bit is set with the mutex held, so the unlocking thread
+   either clears the lock before it is set, which is noticed here, or
+   sees it and wakes this thread. */
+static void wait_shard(shard_t *shard)
+{
+    mtx_lock(&shard->mtx);
+    const unsigned s = atomic_fetch_or_explicit(&shard->lock, YF_LOCK_WAITING,
+                                                memory_order_relaxed);
+    if (s & (YF_LOCK_WRITER | YF_LOCK_READERS)) {
+        cnd_wait(&shard->cnd, &shard->mtx);
+    } else {
+        /* released meanwhile - a stale waiting bit would block readers */
+        atomic_fetch_and_explicit(&shard->lock, ~YF_LOCK_WAITING,
+                                  memory_order_relaxed);
+        cnd_broadcast(&shard->cnd);
+    }
+    mtx_unlock(&shard->mtx);
+}
+
+/* Locks a shard for reading. */
+static void lock_rd(shard_t *shard)
+{
+    unsigned s = atomic_load_explicit(&shard->lock, memory_order_relaxed);
+    for (;;) {
+        if (s & (YF_LOCK_WRITER | YF_LOCK_WAITING)) {
+            wait_shard(shard);
+            s = atomic_load_explicit(&shard->lock, memory_order_relaxed);
+        } else {
+            if (atomic_compare_exchange_weak_explicit(&shard->lock, &s, s + 1,
+                                                      memory_order_acquire,
+                                                      memory_order_relaxed))
+                return;
+        }
+    }
+}
+
+/* Unlocks a shard locked for reading. */
+static void unlock_rd(shard_t *shard)
+{
+    const unsigned s = atomic_fetch_sub_explicit(&shard->lock, 1,
+                                                 memory_order_release);
+    assert(s & YF_LOCK_READERS);
+    if ((s & YF_LOCK_READERS) == 1 && (s & YF_LOCK_WAITING))
+        wake_shard(shard);
+}
+
+/* Locks a shard for writing. */
+static void lock_wr(shard_t *shard)
+{
+    unsigned s = atomic_load_explicit(&shard->lock, memory_order_relaxed);
+    for (;;) {
+        if (s & (YF_LOCK_WRITER | YF_LOCK_READERS)) {
+            wait_shard(shard);
+            s = atomic_load_explicit(&shard->lock, memory_order_relaxed);
+        } else {
+            if (atomic_compare_exchange_weak_explicit(&shard->lock, &s,
+                                                      s | YF_LOCK_WRITER,
+                                                      memory_order_acquire,
+                                                      memory_order_relaxed))
+                return;
+        }
+    }
+}
+
+/* Unlocks a shard locked for writing. */
+static void unlock_wr(shard_t *shard)
+{
+    const unsigned s = atomic_fetch_and_explicit(&shard->lock,
+                                                 ~YF_LOCK_WRITER,
+                                                 memory_order_release);
+    assert(s & YF_LOCK_WRITER);
+    if (s & YF_LOCK_WAITING)
+        wake_shard(shard);
+}
+
+/* Gets the shard of a given key.
+   The hash is mixed so that the shard does not depend on the same bits
+   that the shard's dictionary uses. */
+static shard_t *get_shard(yf_cdict_t *cdict, const void *key)
+{
+    const uint64_t x = (uint64_t)cdict->hash(key) * 0x9e3779b97f4a7c15ULL;
+    return cdict->shards + (x >> (64 - YF_SHARDBITS));
+}
+
+yf_cdict_t *yf_cdict_init(yf_hashfn_t hash, yf_cmpfn_t cmp)
+{
+    yf_cdict_t *cdict = YF_MALLOC("cdict", sizeof *cdict);
+    if (cdict == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        return NULL;
+    }
+    cdict->hash = hash != NULL ? hash : yf_hash;
+
+    for (size_t i = 0; i < YF_SHARDN; i++) {
+        shard_t *shard = cdict->shards+i;
+        atomic_init(&shard->lock, 0);
+
+        if ((shard->dict = yf_dict_init(hash, cmp)) == NULL) {
+            /* error set by 'yf_dict_init' */
+        } else if (mtx_init(&shard->mtx, mtx_plain) != thrd_success) {
+            yf_dict_deinit(shard->dict);
+            shard->dict = NULL;
+            yf_seterr(YF_ERR_OTHER, __func__);
+        } else if (cnd_init(&shard->cnd) != thrd_success) {
+            mtx_destroy(&shard->mtx);
+            yf_dict_deinit(shard->dict);
+            shard->dict = NULL;
+            yf_seterr(YF_ERR_OTHER, __func__);
+        }
+
+        if (shard->dict == NULL) {
+            while (i-- > 0) {
+                cnd_destroy(&cdict->shards[i].cnd);
+                mtx_destroy(&cdict->shards[i].mtx);
+                yf_dict_deinit(cdict->shards[i].dict);
+            }
+            YF_FREE(cdict);
+            return NULL;
+        }
+    }
+
+    return cdict;
+}
+
+int yf_cdict_insert(yf_cdict_t *cdict, const void *key, const void *val)
+{
+    assert(cdict != NULL);
+
+    shard_t *shard = get_shard(cdict, key);
+    lock_wr(shard);
+    const int r = yf_dict_insert(shard->dict, key, val);
+    unlock_wr(shard);
+
+    return r;
+}
+
+void *yf_cdict_findins(yf_cdict_t *cdict, const void *key,
+                       void *(*make)(const void *key, const void **new_key,
+                                     void *arg),
+                       void *arg)
+{
+    assert(cdict != NULL);
+    assert(make != NULL);
+
+    shard_t *shard = get_shard(cdict, key);
+    void *val;
+
+    lock_rd(shard);
+    const int found = yf_dict_find(shard->dict, key, &val);
+    unlock_rd(shard);
+    if (found)
+        return val;
+
+    /* another thread may insert the key before the write lock is taken */
+    lock_wr(shard);
+    if (!yf_dict_find(shard->dict, key, &val)) {
+        const void *new_key = key;
+        if ((val = make(key, &new_key, arg)) != NULL &&
+            yf_dict_insert(shard->dict, new_key, val) != 0)
+            val = NULL;
+    }
+    unlock_wr(shard);
+
+    return val;
+}
+
+void *yf_cdict_remove(yf_cdict_t *cdict, const void *key)
+{
+    assert(cdict != NULL);
+
+    shard_t *shard = get_shard(cdict, key);
+    lock_wr(shard);
+    void *val = yf_dict_remove(shard->dict, key);
+    unlock_wr(shard);
+
+    return val;
+}
+
+void *yf_cdict_search(yf_cdict_t *cdict, const void *key)
+{
+    assert(cdict != NULL);
+
+    shard_t *shard = get_shard(cdict, key);
+    lock_rd(shard);
+    void *val = yf_dict_search(shard->dict, key);
+    unlock_rd(shard);
+
+    return val;
+}
+
+int yf_cdict_contains(yf_cdict_t *cdict, const void *key)
+{
+    assert(cdict != NULL);
+
+    shard_t *shard = get_shard(cdict, key);
+    lock_rd(shard);
+    const int r = yf_dict_contains(shard->dict, key);
+    unlock_rd(shard);
+
+    return r;
+}
+
+/* Argument of 'each_shard'. */
+typedef struct {
+    int (*callb)(void *key, void *val, void *arg);
+    void *arg;
+    int stop;
+} each_t;
+
+/* Forwards a pair of a shard to the caller's callback. */
+static int each_shard(void *key, void *val, void *arg)
+{
+    each_t *each = arg;
+    return each->stop = each->callb(key, val, each->arg) != 0;
+}
+
+void yf_cdict_each(yf_cdict_t *cdict,
+                   int (*callb)(void *key, void *val, void *arg), void *arg)
+{
+    assert(cdict != NULL);
+    assert(callb != NULL);
+
+    each_t each = {callb, arg, 0};
+
+    for (size_t i = 0; i < YF_SHARDN && !each.stop; i++) {
+        shard_t *shard = cdict->shards+i;
+        lock_rd(shard);
+        yf_dict_each(shard->dict, each_shard, &each);
+        unlock_rd(shard);
+    }
+}
+
+size_t yf_cdict_getlen(yf_cdict_t *cdict)
+{
+    assert(cdict != NULL);
+
+    size_t len = 0;
+
+    for (size_t i = 0; i < YF_SHARDN; i++) {
+        shard_t *shard = cdict->shards+i;
+        lock_rd(shard);
+        len += yf_dict_getlen(shard->dict);
+        unlock_rd(shard);
+    }
+
+    return len;
+}
+
+void yf_cdict_clear(yf_cdict_t *cdict)
+{
+    assert(cdict != NULL);
+
+    for (size_t i = 0; i < YF_SHARDN; i++) {
+        shard_t *shard = cdict->shards+i;
+        lock_wr(shard);
+        yf_dict_clear(shard->dict);
+        unlock_wr(shard);
+    }
+}
+
+void yf_cdict_deinit(yf_cdict_t *cdict)
+{
+    if (cdict == NULL)
+        return;
+
+    for (size_t i = 0; i < YF_SHARDN; i++) {
+        shard_t *shard = cdict->shards+i;
+        assert(atomic_load(&shard->lock) == 0);
+        cnd_destroy(&shard->cnd);
+        mtx_destroy(&shard->mtx);
+        yf_dict_deinit(shard->dict);
+    }
+
+    YF_FREE(cdict);
+}
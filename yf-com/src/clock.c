@@ -5,13 +5,129 @@
  * Copyright © 2020 Gustavo C. Viegas.
  */
 
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <float.h>
-#include <math.h>
 #include <errno.h>
 #include <assert.h>
 
+#ifndef __STDC_NO_THREADS__
+# include <threads.h>
+#else
+# error "C11 threads required"
+#endif
+
 #include "yf-clock.h"
+#include "yf-error.h"
+
+/* The time-stamp counter is used on x86, unless 'YF_NO_TSC' is defined. */
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && \
+    !defined(YF_NO_TSC)
+# define YF_TSC
+# include <cpuid.h>
+# include <x86intrin.h>
+# define YF_PAUSE() _mm_pause()
+#else
+# define YF_PAUSE() ((void)0)
+#endif
+
+/* Interval used to calibrate the time-stamp counter, in nanoseconds. */
+#define YF_TSCCALIB 10000000
+
+/* Limits of the interval spent spinning by 'yf_waituntil()', and the
+   margin added to the observed oversleep, in nanoseconds. */
+#define YF_SPINMIN    50000
+#define YF_SPINMAX    4000000
+#define YF_SPINMARGIN 50000
+
+/* Sub-buckets of each power of two in frame time histograms.
+   Frame times are stored in microseconds, with '1 << YF_HISTBITS'
+   sub-buckets per power of two, which bounds the relative error. */
+#define YF_HISTBITS 5
+#define YF_HISTSUB  (1 << YF_HISTBITS)
+#define YF_HISTN    ((64 - YF_HISTBITS + 1) * YF_HISTSUB)
+
+struct yf_frmhist {
+    uint64_t *frms;
+    unsigned window;
+    unsigned n;
+    unsigned next;
+    unsigned cnts[YF_HISTN];
+};
+
+/* Gets the time from the system's monotonic clock, in nanoseconds. */
+static uint64_t get_sysns(void)
+{
+#if defined(_POSIX_C_SOURCE) && (_POSIX_C_SOURCE >= 199309L)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+#else
+    /* TODO: Other platforms. */
+# error "Invalid platform"
+#endif
+}
+
+/* Sleeps for a given number of nanoseconds. */
+static void sleep_ns(uint64_t ns)
+{
+#if defined(_POSIX_C_SOURCE) && (_POSIX_C_SOURCE >= 199309L)
+    struct timespec ts, ts_rem;
+    ts.tv_sec = ns / 1000000000;
+    ts.tv_nsec = ns % 1000000000;
+    int r;
+
+    while ((r = clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, &ts_rem)) != 0) {
+        assert(r == EINTR);
+        ts = ts_rem;
+    }
+#else
+    /* TODO: Other platforms. */
+# error "Invalid platform"
+#endif
+}
+
+#ifdef YF_TSC
+/* Calibration of the time-stamp counter.
+   Nanoseconds per tick are stored as a 32.32 fixed-point value. */
+static once_flag once_ = ONCE_FLAG_INIT;
+static int tsc_ok_ = 0;
+static uint64_t tsc_base_ = 0;
+static uint64_t ns_base_ = 0;
+static uint64_t tsc_mult_ = 0;
+
+/* Calibrates the time-stamp counter, if it is invariant. */
+static void init_tsc(void)
+{
+    unsigned a, b, c, d;
+    if (__get_cpuid(0x80000000, &a, &b, &c, &d) == 0 || a < 0x80000007)
+        return;
+    if (__get_cpuid(0x80000007, &a, &b, &c, &d) == 0 || !(d & (1 << 8)))
+        return;
+
+    const uint64_t ns0 = get_sysns();
+    const uint64_t tsc0 = __rdtsc();
+    uint64_t ns1, tsc1;
+    do {
+        ns1 = get_sysns();
+        tsc1 = __rdtsc();
+    } while (ns1 - ns0 < YF_TSCCALIB);
+
+    if (tsc1 <= tsc0)
+        return;
+    const uint64_t mult = ((ns1 - ns0) << 32) / (tsc1 - tsc0);
+
+    /* counters slower than 1 GHz would overflow the conversion */
+    if (mult == 0 || mult > UINT32_MAX)
+        return;
+
+    tsc_base_ = tsc1;
+    ns_base_ = ns1;
+    tsc_mult_ = mult;
+    tsc_ok_ = 1;
+}
+#endif /* YF_TSC */
 
 double yf_gettime(void)
 {
@@ -36,18 +152,165 @@ void yf_sleep(double seconds)
 {
     assert(seconds >= 0.0);
 
-#if defined(_POSIX_C_SOURCE) && (_POSIX_C_SOURCE >= 199309L)
-    struct timespec ts, ts_rem;
-    ts.tv_sec = seconds;
-    ts.tv_nsec = (seconds - floor(seconds)) * 1.0e9;
-    int r;
+    sleep_ns(seconds * 1.0e9);
+}
 
-    while ((r = clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, &ts_rem)) != 0) {
-        assert(r == EINTR);
-        ts = ts_rem;
+uint64_t yf_getns(void)
+{
+#ifdef YF_TSC
+    call_once(&once_, init_tsc);
+    if (tsc_ok_) {
+        const uint64_t d = __rdtsc() - tsc_base_;
+        return ns_base_ + (d >> 32) * tsc_mult_ +
+               ((d & UINT32_MAX) * tsc_mult_ >> 32);
     }
-#else
-    /* TODO: Other platforms. */
-# error "Invalid platform"
 #endif
+
+    return get_sysns();
+}
+
+void yf_waituntil(uint64_t deadline)
+{
+    /* expected oversleep of the calling thread */
+    static _Thread_local uint64_t spin = YF_SPINMAX;
+
+    uint64_t now = yf_getns();
+    if (now >= deadline)
+        return;
+
+    if (deadline - now > spin) {
+        const uint64_t wake = deadline - spin;
+        sleep_ns(wake - now);
+        now = yf_getns();
+
+        /* grow quickly when oversleeping, shrink slowly otherwise */
+        const uint64_t over = (now > wake ? now - wake : 0) + YF_SPINMARGIN;
+        if (over > spin)
+            spin = over < YF_SPINMAX ? over : YF_SPINMAX;
+        else
+            spin -= (spin - over) >> 4;
+        if (spin < YF_SPINMIN)
+            spin = YF_SPINMIN;
+    }
+
+    while (now < deadline) {
+        YF_PAUSE();
+        now = yf_getns();
+    }
+}
+
+/* Gets the histogram bucket of a frame time in microseconds. */
+static unsigned get_bucket(uint64_t us)
+{
+    if (us < YF_HISTSUB)
+        return us;
+
+    unsigned msb = 63;
+    while (!(us >> msb))
+        msb--;
+    const unsigned shf = msb - YF_HISTBITS;
+    return (shf + 1) * YF_HISTSUB + (us >> shf) - YF_HISTSUB;
+}
+
+/* Gets the frame time in nanoseconds represented by a histogram bucket. */
+static uint64_t get_value(unsigned bucket)
+{
+    if (bucket < YF_HISTSUB)
+        return (uint64_t)bucket * 1000 + 500;
+
+    const unsigned shf = bucket / YF_HISTSUB - 1;
+    const uint64_t us = (uint64_t)(bucket % YF_HISTSUB + YF_HISTSUB) << shf;
+    return (us + ((uint64_t)1 << shf >> 1)) * 1000;
+}
+
+yf_frmhist_t *yf_frmhist_init(unsigned window)
+{
+    if (window == 0) {
+        yf_seterr(YF_ERR_INVARG, __func__);
+        return NULL;
+    }
+
+    yf_frmhist_t *hist = calloc(1, sizeof(yf_frmhist_t));
+    if (hist == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        return NULL;
+    }
+    if ((hist->frms = malloc(window * sizeof *hist->frms)) == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        free(hist);
+        return NULL;
+    }
+
+    hist->window = window;
+    return hist;
+}
+
+void yf_frmhist_add(yf_frmhist_t *hist, uint64_t ns)
+{
+    assert(hist != NULL);
+
+    if (hist->n == hist->window)
+        hist->cnts[get_bucket(hist->frms[hist->next] / 1000)]--;
+    else
+        hist->n++;
+
+    hist->frms[hist->next] = ns;
+    hist->cnts[get_bucket(ns / 1000)]++;
+    hist->next = (hist->next + 1) % hist->window;
+}
+
+void yf_frmhist_getstats(yf_frmhist_t *hist, yf_frmstats_t *stats)
+{
+    assert(hist != NULL);
+    assert(stats != NULL);
+
+    memset(stats, 0, sizeof *stats);
+    if (hist->n == 0)
+        return;
+
+    for (unsigned i = 0; i < hist->n; i++) {
+        if (hist->frms[i] > stats->max)
+            stats->max = hist->frms[i];
+    }
+
+    /* ranks are one-based: ceil(n * p) */
+    const unsigned rank50 = (hist->n + 1) / 2;
+    const unsigned rank99 = (hist->n * 99 + 99) / 100;
+    unsigned cnt = 0;
+
+    for (unsigned i = 0; i < YF_HISTN; i++) {
+        if (hist->cnts[i] == 0)
+            continue;
+        const unsigned prev = cnt;
+        cnt += hist->cnts[i];
+        if (prev < rank50 && cnt >= rank50)
+            stats->p50 = get_value(i);
+        if (cnt >= rank99) {
+            stats->p99 = get_value(i);
+            break;
+        }
+    }
+
+    if (stats->p50 > stats->max)
+        stats->p50 = stats->max;
+    if (stats->p99 > stats->max)
+        stats->p99 = stats->max;
+    stats->n = hist->n;
+}
+
+void yf_frmhist_clear(yf_frmhist_t *hist)
+{
+    assert(hist != NULL);
+
+    memset(hist->cnts, 0, sizeof hist->cnts);
+    hist->n = 0;
+    hist->next = 0;
+}
+
+void yf_frmhist_deinit(yf_frmhist_t *hist)
+{
+    if (hist != NULL) {
+        free(hist->frms);
+        free(hist);
+    }
 }
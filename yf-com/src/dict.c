@@ -11,6 +11,10 @@
 #include <time.h>
 #include <assert.h>
 
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
+
 #ifdef YF_DEVEL
 # include <stdio.h>
 #endif
@@ -20,22 +24,50 @@
 #endif
 
 #include "yf-dict.h"
+#include "yf-mem.h"
 #include "yf-error.h"
 
+/* The dictionary is an open-addressing hash table. Slots are split in
+   groups of 'YF_GROUPN', and each slot has a control byte that is either
+   empty, deleted or holds the 7 upper bits of the hash value. Lookups
+   compare the control bytes of a whole group at once, and only call the
+   comparison function on slots whose bits match. Groups are probed
+   quadratically, and a probe sequence ends at the first group that has an
+   empty slot.
+
+   When rehashing incrementally, a resize allocates the new table and keeps
+   the old one around. Pairs are then moved to the new table a few at a
+   time, on every insertion and removal, and lookups check both tables
+   until the old one is empty. */
+
 #if SIZE_MAX < 4294967295UL
 # error "Unsupported system"
 #elif SIZE_MAX < 18446744073709551615ULL
-# define YF_WMINBITS 4
-# define YF_WMAXBITS 29
+# define YF_WMAXBITS 21
 # define YF_WBITS    32
 #else
-# define YF_WMINBITS 4
-# define YF_WMAXBITS 48
+# define YF_WMAXBITS 40
 # define YF_WBITS    64
 #endif
 
-#define YF_MINLOADF 0.25f
-#define YF_MAXLOADF 0.75f
+#define YF_GROUPN 16
+
+/* Tables grow when used slots (including deleted ones) would exceed 7/8 of
+   the capacity, and shrink when less than 1/8 of the slots have been in use
+   for a while. */
+#define YF_MAXLOAD(cap) ((cap) - ((cap) >> 3))
+#define YF_MINLOAD(cap) ((cap) >> 3)
+
+/* Number of removals at low load that cause a table to shrink, as a
+   fraction of its capacity. */
+#define YF_SHRINKN(cap) ((cap) >> 2)
+
+/* Number of old pairs to migrate on every operation. */
+#define YF_MIGRATEN 64
+
+/* Control bytes. */
+#define YF_CTRL_EMPTY   ((signed char)-128)
+#define YF_CTRL_DELETED ((signed char)-2)
 
 /* Key/value pair. */
 typedef struct {
@@ -43,26 +75,42 @@ typedef struct {
     const void *val;
 } pair_t;
 
-/* List of key/value pairs. */
+/* Table of slots. */
 typedef struct {
     pair_t *pairs;
-    size_t max_n;
-    size_t cur_n;
-} bucket_t;
+    signed char *ctrl;
+    size_t w;
+} table_t;
 
 struct yf_dict {
     yf_hashfn_t hash;
     yf_cmpfn_t cmp;
-    bucket_t *buckets;
-    size_t w;
+    table_t tab;
     size_t count;
+    size_t growth;
+    size_t min_w;
+    size_t low_n;
+    int rehash;
+    struct {
+        table_t tab;
+        size_t i;
+        size_t n;
+    } old;
     unsigned long long lcg_state;
     size_t a;
     size_t b;
 };
 
 /* Hasher. */
-#define YF_HASH(res, a, x, b, w) (res = ((a)*(x)+(b)) >> (YF_WBITS-(w)))
+#define YF_HASH(res, a, x, b) (res = (a)*(x)+(b))
+
+/* Gets the group where probing starts and the control byte of a hash. */
+#define YF_H1(h, w) \
+    ((w) == 0 ? 0 : ((h) >> (YF_WBITS-7-(w))) & ((1ULL<<(w))-1))
+#define YF_H2(h) ((signed char)((h) >> (YF_WBITS-7)))
+
+/* Gets the number of slots of a given 'w'. */
+#define YF_CAP(w) ((size_t)YF_GROUPN << (w))
 
 /* LCG. */
 #define YF_LCG(state, xn) do { \
@@ -101,136 +149,286 @@ static void make_factors(unsigned long long *state, size_t *a, size_t *b)
 #endif
 }
 
-/* Rehashes a dictionary. */
-static int rehash(yf_dict_t *dict)
+/* Matches the control bytes of a group against a given value.
+   Bit 'i' of the result is set if the byte at 'i' matches. */
+static inline unsigned match_byte(const signed char *group, signed char c)
 {
-    assert(dict != NULL);
+#ifdef __SSE2__
+    const __m128i g = _mm_loadu_si128((const __m128i *)group);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(c)));
+#else
+    unsigned mask = 0;
+    for (unsigned i = 0; i < YF_GROUPN; i++)
+        mask |= (unsigned)(group[i] == c) << i;
+    return mask;
+#endif
+}
 
-    const float fac = (float)dict->count / (1ULL<<dict->w);
-    size_t new_w;
+/* Matches the empty and deleted control bytes of a group. */
+static inline unsigned match_free(const signed char *group)
+{
+#ifdef __SSE2__
+    /* only these have the sign bit set */
+    return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+#else
+    unsigned mask = 0;
+    for (unsigned i = 0; i < YF_GROUPN; i++)
+        mask |= (unsigned)(group[i] < 0) << i;
+    return mask;
+#endif
+}
 
-    if (fac < YF_MINLOADF) {
-        if (dict->w == YF_WMINBITS)
-            return 0;
+/* Gets the index of the lowest bit set in a match. */
+#define YF_MATCHI(mask) ((unsigned)__builtin_ctz(mask))
 
-        new_w = dict->w - 1;
+/* Allocates the slots of a table. */
+static int alloc_table(table_t *tab, size_t w)
+{
+    assert(tab != NULL);
+    assert(w <= YF_WMAXBITS);
 
-    } else if (fac > YF_MAXLOADF) {
-        if (dict->w == YF_WMAXBITS)
-            return 0;
+    const size_t cap = YF_CAP(w);
 
-        new_w = dict->w + 1;
-        void *tmp = realloc(dict->buckets, sizeof(bucket_t) * (1ULL<<new_w));
-        if (tmp == NULL) {
-            yf_seterr(YF_ERR_NOMEM, __func__);
-            return -1;
+    tab->pairs = YF_MALLOC("dict", cap * (sizeof *tab->pairs + 1));
+    if (tab->pairs == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        return -1;
+    }
+    tab->ctrl = (signed char *)(tab->pairs + cap);
+    tab->w = w;
+    memset(tab->ctrl, YF_CTRL_EMPTY, cap);
+
+    return 0;
+}
+
+/* Finds the slot of a table that holds a given key.
+   Returns the slot index, or 'SIZE_MAX' if not found. */
+static size_t find(const yf_dict_t *dict, const table_t *tab,
+                   const void *key, size_t h)
+{
+    assert(dict != NULL);
+    assert(tab != NULL);
+
+    const size_t mask = (1ULL << tab->w) - 1;
+    const signed char h2 = YF_H2(h);
+    size_t g = YF_H1(h, tab->w);
+
+    for (size_t i = 1; ; i++) {
+        const signed char *group = tab->ctrl + g * YF_GROUPN;
+
+        for (unsigned m = match_byte(group, h2); m != 0; m &= m-1) {
+            const size_t k = g * YF_GROUPN + YF_MATCHI(m);
+            if (dict->cmp(tab->pairs[k].key, key) == 0)
+                return k;
         }
 
-        dict->buckets = tmp;
-        memset(&dict->buckets[1ULL<<dict->w], 0,
-               sizeof(bucket_t) * (1ULL<<dict->w));
+        if (match_byte(group, YF_CTRL_EMPTY) != 0 || i > mask)
+            return SIZE_MAX;
 
-    } else {
-        return 0;
+        g = (g + i) & mask;
     }
+}
 
-    const size_t ctrl_w = new_w > dict->w ? new_w : dict->w;
-    size_t *ctrl = calloc(1ULL << ctrl_w, sizeof(size_t));
-    if (ctrl == NULL) {
-        yf_seterr(YF_ERR_NOMEM, __func__);
-        return -1;
+/* Finds the first free slot of a table in the probe sequence of a given
+   hash. A free slot always exists, since tables are never full. */
+static size_t find_free(const table_t *tab, size_t h)
+{
+    assert(tab != NULL);
+
+    const size_t mask = (1ULL << tab->w) - 1;
+    size_t g = YF_H1(h, tab->w);
+
+    for (size_t i = 1; ; i++) {
+        const unsigned m = match_free(tab->ctrl + g * YF_GROUPN);
+        if (m != 0)
+            return g * YF_GROUPN + YF_MATCHI(m);
+
+        assert(i <= mask);
+        g = (g + i) & mask;
     }
+}
 
-    int r = 0;
+/* Locates the slot that holds a given key, in either table.
+   Returns the slot index and sets 'tab', or 'SIZE_MAX' if not found. */
+static size_t locate(yf_dict_t *dict, const void *key, table_t **tab)
+{
+    assert(dict != NULL);
+    assert(tab != NULL);
 
-cancel:
+    size_t h, x = dict->hash(key);
+    YF_HASH(h, dict->a, x, dict->b);
 
-    for (size_t i = 0; i < 1ULL<<dict->w; i++) {
-        if (ctrl[i] >= dict->buckets[i].cur_n)
-            continue;
+    size_t k = find(dict, &dict->tab, key, h);
+    if (k != SIZE_MAX) {
+        *tab = &dict->tab;
+        return k;
+    }
 
-        size_t j = dict->buckets[i].cur_n;
-
-        while (ctrl[i] < j) {
-            pair_t *pair = dict->buckets[i].pairs+j-1;
-
-            size_t k, x = dict->hash(pair->key);
-            YF_HASH(k, dict->a, x, dict->b, new_w);
-
-            bucket_t *bucket = dict->buckets+k;
-
-            if (ctrl[k] == bucket->max_n) {
-                const size_t new_n = ctrl[k] == 0 ? 1 : ctrl[k] << 1;
-                void *tmp = realloc(bucket->pairs, sizeof(pair_t) * new_n);
-
-                if (tmp == NULL) {
-                    /* XXX: Dictionary is in an invalid state, this rehash
-                       operation needs to be cancelled. */
-                    yf_seterr(YF_ERR_NOMEM, __func__);
-                    r = -1;
-
-                    if (new_w < dict->w) {
-                        new_w = dict->w;
-                    } else {
-                        const size_t tmp = new_w;
-                        new_w = dict->w;
-                        dict->w = tmp;
-                    }
-
-                    memset(ctrl, 0, sizeof *ctrl * (1ULL<<ctrl_w));
-
-                    /* rolling back to previous state does not require new
-                       allocations, thus it is guaranteed to succeed */
-                    goto cancel;
-                }
-
-                bucket->max_n = new_n;
-                bucket->cur_n++;
-                bucket->pairs = tmp;
-                bucket->pairs[ctrl[k]] = *pair;
-                ctrl[k]++;
-                j--;
-
-            } else if (ctrl[k] == bucket->cur_n) {
-                bucket->cur_n++;
-                bucket->pairs[ctrl[k]] = *pair;
-                ctrl[k]++;
-                j--;
-
-            } else if (k != i || ctrl[k] != j-1) {
-                const pair_t tmp = bucket->pairs[ctrl[k]];
-                bucket->pairs[ctrl[k]] = *pair;
-                *pair = tmp;
-                ctrl[k]++;
-
-            } else {
-                ctrl[k]++;
-                break;
-            }
+    if (dict->old.tab.pairs != NULL &&
+        (k = find(dict, &dict->old.tab, key, h)) != SIZE_MAX) {
+        *tab = &dict->old.tab;
+        return k;
+    }
+
+    return SIZE_MAX;
+}
+
+/* Moves a given number of old pairs to the current table. */
+static void migrate(yf_dict_t *dict, size_t n)
+{
+    assert(dict != NULL);
+
+    table_t *old = &dict->old.tab;
+    if (old->pairs == NULL)
+        return;
+
+    const size_t cap = YF_CAP(old->w);
+
+    while (dict->old.i < cap && dict->old.n > 0 && n > 0) {
+        const size_t i = dict->old.i;
+
+        /* free groups are skipped at once */
+        if ((i & (YF_GROUPN-1)) == 0 &&
+            match_free(old->ctrl+i) == (1U << YF_GROUPN) - 1) {
+            dict->old.i += YF_GROUPN;
+            continue;
         }
 
-        dict->buckets[i].cur_n = ctrl[i];
+        dict->old.i++;
+        if (old->ctrl[i] < 0)
+            continue;
+
+        size_t h, x = dict->hash(old->pairs[i].key);
+        YF_HASH(h, dict->a, x, dict->b);
+
+        /* space for old pairs is accounted for in 'growth' */
+        const size_t k = find_free(&dict->tab, h);
+        dict->tab.ctrl[k] = YF_H2(h);
+        dict->tab.pairs[k] = old->pairs[i];
+        old->ctrl[i] = YF_CTRL_DELETED;
+        dict->old.n--;
+        n--;
     }
 
-    free(ctrl);
+    if (dict->old.i == cap || dict->old.n == 0) {
+        YF_FREE(old->pairs);
+        old->pairs = NULL;
+    }
+}
 
-    if (new_w < dict->w) {
-        for (size_t i = 1ULL<<new_w; i < 1ULL<<dict->w; i++)
-            free(dict->buckets[i].pairs);
+/* Resizes a dictionary to a given 'w', discarding deleted slots.
+   If the dictionary rehashes incrementally, only the new table is set up
+   here and pairs are moved later. */
+static int resize(yf_dict_t *dict, size_t new_w, int incr)
+{
+    assert(dict != NULL);
+    assert(dict->old.tab.pairs == NULL);
+    assert(YF_MAXLOAD(YF_CAP(new_w)) > dict->count);
 
-        void *tmp = realloc(dict->buckets, sizeof(bucket_t) * (1ULL<<new_w));
-        if (tmp != NULL)
-            dict->buckets = tmp;
+    table_t tab;
+    if (alloc_table(&tab, new_w) != 0)
+        return -1;
+
+    dict->old.tab = dict->tab;
+    dict->old.i = 0;
+    dict->old.n = dict->count;
+    dict->tab = tab;
+    dict->growth = YF_MAXLOAD(YF_CAP(new_w)) - dict->count;
+    dict->low_n = 0;
+
+    migrate(dict, incr ? YF_MIGRATEN : SIZE_MAX);
+    if (!incr)
+        assert(dict->old.tab.pairs == NULL);
+
+    return 0;
+}
+
+/* Makes room for one more pair in a dictionary. */
+static int grow(yf_dict_t *dict)
+{
+    assert(dict != NULL);
+    assert(dict->growth == 0);
+
+    /* XXX: Should not happen, since migration is much faster than the
+       rate at which tables fill up. */
+    migrate(dict, SIZE_MAX);
+
+    /* if deleted slots account for much of the load, rehashing at the same
+       size is enough */
+    size_t new_w = dict->tab.w;
+    if (dict->count >= YF_MAXLOAD(YF_CAP(dict->tab.w)) >> 1) {
+        if (dict->tab.w == YF_WMAXBITS) {
+            yf_seterr(YF_ERR_LIMIT, __func__);
+            return -1;
+        }
+        new_w++;
     }
 
-    dict->w = new_w;
+    return resize(dict, new_w, dict->rehash == YF_DICT_REHASH_INCR);
+}
 
-    return r;
+/* Shrinks a dictionary if its load has been low for long enough. */
+static void shrink(yf_dict_t *dict)
+{
+    assert(dict != NULL);
+
+    const size_t cap = YF_CAP(dict->tab.w);
+
+    if (dict->tab.w <= dict->min_w || dict->count >= YF_MINLOAD(cap) ||
+        ++dict->low_n < YF_SHRINKN(cap) || dict->old.tab.pairs != NULL)
+        return;
+
+    /* the new load will be between 1/4 and 1/2 */
+    size_t new_w = dict->tab.w - 1;
+    while (new_w > dict->min_w && dict->count < YF_CAP(new_w) >> 2)
+        new_w--;
+
+    /* failing to shrink is not an error */
+    resize(dict, new_w, dict->rehash == YF_DICT_REHASH_INCR);
+}
+
+/* Erases the pair stored in a given slot of a table. */
+static void erase(yf_dict_t *dict, table_t *tab, size_t k)
+{
+    assert(dict != NULL);
+    assert(tab != NULL);
+    assert(tab->ctrl[k] >= 0);
+
+    if (tab == &dict->old.tab) {
+        /* one less pair to migrate */
+        tab->ctrl[k] = YF_CTRL_DELETED;
+        dict->old.n--;
+        dict->growth++;
+        dict->count--;
+        return;
+    }
+
+    /* probe sequences stop at groups that have empty slots, so the slot
+       can be emptied if its group already has one */
+    const signed char *group = tab->ctrl + (k & ~(size_t)(YF_GROUPN-1));
+    if (match_byte(group, YF_CTRL_EMPTY) != 0) {
+        tab->ctrl[k] = YF_CTRL_EMPTY;
+        dict->growth++;
+    } else {
+        tab->ctrl[k] = YF_CTRL_DELETED;
+    }
+
+    dict->count--;
+}
+
+/* Drops the old table of a dictionary, if any. */
+static void drop_old(yf_dict_t *dict)
+{
+    assert(dict != NULL);
+
+    YF_FREE(dict->old.tab.pairs);
+    dict->old.tab.pairs = NULL;
+    dict->old.n = 0;
 }
 
 yf_dict_t *yf_dict_init(yf_hashfn_t hash, yf_cmpfn_t cmp)
 {
-    yf_dict_t *dict = malloc(sizeof(yf_dict_t));
+    yf_dict_t *dict = YF_CALLOC("dict", 1, sizeof(yf_dict_t));
     if (dict == NULL) {
         yf_seterr(YF_ERR_NOMEM, __func__);
         return NULL;
@@ -238,13 +436,13 @@ yf_dict_t *yf_dict_init(yf_hashfn_t hash, yf_cmpfn_t cmp)
 
     dict->hash = hash != NULL ? hash : yf_hash;
     dict->cmp = cmp != NULL ? cmp : yf_cmp;
-    dict->w = YF_WMINBITS;
     dict->count = 0;
+    dict->growth = YF_MAXLOAD(YF_CAP(0));
+    dict->min_w = 0;
+    dict->rehash = YF_DICT_REHASH_ALL;
 
-    dict->buckets = calloc(1 << dict->w, sizeof *dict->buckets);
-    if (dict->buckets == NULL) {
-        yf_seterr(YF_ERR_NOMEM, __func__);
-        free(dict);
+    if (alloc_table(&dict->tab, 0) != 0) {
+        YF_FREE(dict);
         return NULL;
     }
 
@@ -254,72 +452,96 @@ yf_dict_t *yf_dict_init(yf_hashfn_t hash, yf_cmpfn_t cmp)
     return dict;
 }
 
-int yf_dict_insert(yf_dict_t *dict, const void *key, const void *val)
+void yf_dict_setrehash(yf_dict_t *dict, int rehash)
 {
     assert(dict != NULL);
+    assert(rehash == YF_DICT_REHASH_ALL || rehash == YF_DICT_REHASH_INCR);
 
-    size_t k, x = dict->hash(key);
-    YF_HASH(k, dict->a, x, dict->b, dict->w);
+    if (rehash == YF_DICT_REHASH_ALL)
+        migrate(dict, SIZE_MAX);
 
-    bucket_t *bucket = dict->buckets+k;
+    dict->rehash = rehash;
+}
 
-    if (bucket->cur_n == bucket->max_n) {
-        const size_t new_n = bucket->max_n == 0 ? 1 : bucket->max_n << 1;
-        void *tmp = realloc(bucket->pairs, sizeof(pair_t) * new_n);
-        if (tmp == NULL) {
-            yf_seterr(YF_ERR_NOMEM, __func__);
+int yf_dict_reserve(yf_dict_t *dict, size_t n)
+{
+    assert(dict != NULL);
+
+    size_t w = 0;
+    while (YF_MAXLOAD(YF_CAP(w)) < n) {
+        if (w == YF_WMAXBITS) {
+            yf_seterr(YF_ERR_LIMIT, __func__);
             return -1;
         }
-
-        bucket->pairs = tmp;
-        bucket->max_n = new_n;
+        w++;
     }
 
-    for (size_t i = 0; i < bucket->cur_n; i++) {
-        if (dict->cmp(bucket->pairs[i].key, key) == 0) {
-            yf_seterr(YF_ERR_EXIST, __func__);
+    if (w > dict->tab.w) {
+        migrate(dict, SIZE_MAX);
+        if (resize(dict, w, 0) != 0)
             return -1;
-        }
     }
 
-    bucket->pairs[bucket->cur_n++] = (pair_t){key, val};
-    dict->count++;
-
-    rehash(dict);
+    dict->min_w = w;
 
     return 0;
 }
 
-void *yf_dict_remove(yf_dict_t *dict, const void *key)
+int yf_dict_insert(yf_dict_t *dict, const void *key, const void *val)
 {
     assert(dict != NULL);
 
-    size_t k, x = dict->hash(key);
-    YF_HASH(k, dict->a, x, dict->b, dict->w);
+    migrate(dict, YF_MIGRATEN);
 
-    bucket_t *bucket = dict->buckets+k;
-    size_t i = 0;
+    size_t h, x = dict->hash(key);
+    YF_HASH(h, dict->a, x, dict->b);
 
-    for (; i < bucket->cur_n; i++) {
-        if (dict->cmp(bucket->pairs[i].key, key) == 0)
-            break;
+    if (find(dict, &dict->tab, key, h) != SIZE_MAX ||
+        (dict->old.tab.pairs != NULL &&
+         find(dict, &dict->old.tab, key, h) != SIZE_MAX)) {
+
+        yf_seterr(YF_ERR_EXIST, __func__);
+        return -1;
     }
 
-    if (i == bucket->cur_n) {
-        yf_seterr(YF_ERR_NOTFND, __func__);
-        return NULL;
+    size_t k = find_free(&dict->tab, h);
+
+    /* reusing a deleted slot does not increase the load */
+    if (dict->tab.ctrl[k] == YF_CTRL_EMPTY) {
+        if (dict->growth == 0) {
+            if (grow(dict) != 0)
+                return -1;
+            k = find_free(&dict->tab, h);
+        }
+        dict->growth--;
     }
 
-    const void *val = bucket->pairs[i].val;
+    dict->tab.ctrl[k] = YF_H2(h);
+    dict->tab.pairs[k] = (pair_t){key, val};
+    dict->count++;
 
-    if (i+1 < bucket->cur_n)
-        memmove(bucket->pairs+i, bucket->pairs+i+1,
-                sizeof(pair_t) * (bucket->cur_n - i - 1));
+    if (dict->count >= YF_MINLOAD(YF_CAP(dict->tab.w)))
+        dict->low_n = 0;
 
-    bucket->cur_n--;
-    dict->count--;
+    return 0;
+}
 
-    rehash(dict);
+void *yf_dict_remove(yf_dict_t *dict, const void *key)
+{
+    assert(dict != NULL);
+
+    migrate(dict, YF_MIGRATEN);
+
+    table_t *tab;
+    const size_t k = locate(dict, key, &tab);
+    if (k == SIZE_MAX) {
+        yf_seterr(YF_ERR_NOTFND, __func__);
+        return NULL;
+    }
+
+    const void *val = tab->pairs[k].val;
+    erase(dict, tab, k);
+    shrink(dict);
 
     return (void *)val;
 }
@@ -329,33 +551,19 @@ void *yf_dict_delete(yf_dict_t *dict, void **key)
     assert(dict != NULL);
     assert(key != NULL);
 
-    size_t k, x = dict->hash(*key);
-    YF_HASH(k, dict->a, x, dict->b, dict->w);
-
-    bucket_t *bucket = dict->buckets+k;
-    size_t i = 0;
+    migrate(dict, YF_MIGRATEN);
 
-    for (; i < bucket->cur_n; i++) {
-        if (dict->cmp(bucket->pairs[i].key, *key) == 0)
-            break;
-    }
-
-    if (i == bucket->cur_n) {
+    table_t *tab;
+    const size_t k = locate(dict, *key, &tab);
+    if (k == SIZE_MAX) {
         yf_seterr(YF_ERR_NOTFND, __func__);
         return NULL;
     }
 
-    *key = (void *)bucket->pairs[i].key;
-    const void *val = bucket->pairs[i].val;
-
-    if (i+1 < bucket->cur_n)
-        memmove(bucket->pairs+i, bucket->pairs+i+1,
-                sizeof(pair_t) * (bucket->cur_n - i - 1));
-
-    bucket->cur_n--;
-    dict->count--;
-
-    rehash(dict);
+    *key = (void *)tab->pairs[k].key;
+    const void *val = tab->pairs[k].val;
+    erase(dict, tab, k);
+    shrink(dict);
 
     return (void *)val;
 }
@@ -364,43 +572,31 @@ void *yf_dict_replace(yf_dict_t *dict, const void *key, const void *val)
 {
     assert(dict != NULL);
 
-    size_t k, x = dict->hash(key);
-    YF_HASH(k, dict->a, x, dict->b, dict->w);
-
-    bucket_t *bucket = dict->buckets+k;
-
-    for (size_t i = 0; i < bucket->cur_n; i++) {
-        if (dict->cmp(bucket->pairs[i].key, key) != 0)
-            continue;
-
-        const void *old_val = bucket->pairs[i].val;
-        bucket->pairs[i].val = val;
-
-        return (void *)old_val;
+    table_t *tab;
+    const size_t k = locate(dict, key, &tab);
+    if (k == SIZE_MAX) {
+        yf_seterr(YF_ERR_NOTFND, __func__);
+        return NULL;
     }
 
-    yf_seterr(YF_ERR_NOTFND, __func__);
+    const void *old_val = tab->pairs[k].val;
+    tab->pairs[k].val = val;
 
-    return NULL;
+    return (void *)old_val;
 }
 
 void *yf_dict_search(yf_dict_t *dict, const void *key)
 {
     assert(dict != NULL);
 
-    size_t k, x = dict->hash(key);
-    YF_HASH(k, dict->a, x, dict->b, dict->w);
-
-    for (size_t i = 0; i < dict->buckets[k].cur_n; i++) {
-        const pair_t *pair = &dict->buckets[k].pairs[i];
-
-        if (dict->cmp(pair->key, key) == 0)
-            return (void *)pair->val;
+    table_t *tab;
+    const size_t k = locate(dict, key, &tab);
+    if (k == SIZE_MAX) {
+        yf_seterr(YF_ERR_NOTFND, __func__);
+        return NULL;
     }
 
-    yf_seterr(YF_ERR_NOTFND, __func__);
-
-    return NULL;
+    return (void *)tab->pairs[k].val;
 }
 
 void *yf_dict_lookup(yf_dict_t *dict, void **key)
@@ -408,97 +604,75 @@ void *yf_dict_lookup(yf_dict_t *dict, void **key)
     assert(dict != NULL);
     assert(key != NULL);
 
-    size_t k, x = dict->hash(*key);
-    YF_HASH(k, dict->a, x, dict->b, dict->w);
-
-    for (size_t i = 0; i < dict->buckets[k].cur_n; i++) {
-        const pair_t *pair = &dict->buckets[k].pairs[i];
-
-        if (dict->cmp(pair->key, *key) == 0) {
-            *key = (void *)pair->key;
-            return (void *)pair->val;
-        }
+    table_t *tab;
+    const size_t k = locate(dict, *key, &tab);
+    if (k == SIZE_MAX) {
+        yf_seterr(YF_ERR_NOTFND, __func__);
+        return NULL;
     }
 
-    yf_seterr(YF_ERR_NOTFND, __func__);
-
-    return NULL;
+    *key = (void *)tab->pairs[k].key;
+    return (void *)tab->pairs[k].val;
 }
 
-int yf_dict_contains(yf_dict_t *dict, const void *key)
+int yf_dict_find(yf_dict_t *dict, const void *key, void **val)
 {
     assert(dict != NULL);
 
-    size_t k, x = dict->hash(key);
-    YF_HASH(k, dict->a, x, dict->b, dict->w);
-
-    if (dict->buckets[k].cur_n == 0)
+    table_t *tab;
+    const size_t k = locate(dict, key, &tab);
+    if (k == SIZE_MAX)
         return 0;
 
-    for (size_t i = 0; i < dict->buckets[k].cur_n; i++) {
-        if (dict->cmp(dict->buckets[k].pairs[i].key, key) == 0)
-            return 1;
-    }
+    if (val != NULL)
+        *val = (void *)tab->pairs[k].val;
+    return 1;
+}
 
-    return 0;
+int yf_dict_contains(yf_dict_t *dict, const void *key)
+{
+    assert(dict != NULL);
+
+    table_t *tab;
+    return locate(dict, key, &tab) != SIZE_MAX;
 }
 
 void *yf_dict_next(yf_dict_t *dict, yf_iter_t *it, void **key)
 {
     assert(dict != NULL);
 
-    pair_t *pair = NULL;
+    /* the current table is iterated first, then the old one */
+    size_t i = 0;
+    size_t t = 0;
 
-    if (it == NULL) {
-        for (size_t i = 0; i < 1ULL<<dict->w; i++) {
-            if (dict->buckets[i].cur_n == 0)
-                continue;
+    if (it != NULL && !YF_IT_ISNIL(*it)) {
+        i = it->data[0] + 1;
+        t = it->data[1];
+    }
 
-            pair = dict->buckets[i].pairs;
-            break;
-        }
+    for (; t < 2; t++, i = 0) {
+        const table_t *tab = t == 0 ? &dict->tab : &dict->old.tab;
+        if (tab->pairs == NULL)
+            continue;
 
-    } else if (YF_IT_ISNIL(*it)) {
-        for (size_t i = 0; i < 1ULL<<dict->w; i++) {
-            if (dict->buckets[i].cur_n == 0)
+        const size_t cap = YF_CAP(tab->w);
+        for (; i < cap; i++) {
+            if (tab->ctrl[i] < 0)
                 continue;
 
-            it->data[0] = i;
-            it->data[1] = 0;
-            pair = dict->buckets[i].pairs;
-            break;
-        }
-
-    } else {
-        const size_t bucket_i = it->data[0];
-        const size_t pair_i = it->data[1];
-
-        if (dict->buckets[bucket_i].cur_n > pair_i+1) {
-            it->data[1]++;
-            pair = &dict->buckets[bucket_i].pairs[pair_i+1];
-
-        } else {
-            *it = YF_NILIT;
-
-            for (size_t i = bucket_i+1; i < 1ULL<<dict->w; i++) {
-                if (dict->buckets[i].cur_n == 0)
-                    continue;
-
+            if (it != NULL) {
                 it->data[0] = i;
-                it->data[1] = 0;
-                pair = dict->buckets[i].pairs;
-                break;
+                it->data[1] = t;
             }
-        }
-    }
+            if (key != NULL)
+                *key = (void *)tab->pairs[i].key;
 
-    if (pair != NULL) {
-        if (key != NULL)
-            *key = (void *)pair->key;
-
-        return (void *)pair->val;
+            return (void *)tab->pairs[i].val;
+        }
     }
 
+    if (it != NULL)
+        *it = YF_NILIT;
     if (key != NULL)
         *key = NULL;
 
@@ -511,11 +685,19 @@ void yf_dict_each(yf_dict_t *dict,
     assert(dict != NULL);
     assert(callb != NULL);
 
-    for (size_t i = 0; i < 1ULL<<dict->w; i++) {
-        bucket_t *bucket = dict->buckets+i;
+    const table_t *tabs[] = {&dict->tab, &dict->old.tab};
+
+    for (size_t t = 0; t < 2; t++) {
+        if (tabs[t]->pairs == NULL)
+            continue;
+
+        const size_t cap = YF_CAP(tabs[t]->w);
+
+        for (size_t i = 0; i < cap; i++) {
+            if (tabs[t]->ctrl[i] < 0)
+                continue;
 
-        for (size_t j = 0; j < bucket->cur_n; j++) {
-            pair_t *pair = bucket->pairs+j;
+            pair_t *pair = tabs[t]->pairs+i;
 
             if (callb((void *)pair->key, (void *)pair->val, arg) != 0)
                 return;
@@ -529,36 +711,29 @@ size_t yf_dict_getlen(yf_dict_t *dict)
     return dict->count;
 }
 
-void yf_dict_clear(yf_dict_t *dict)
+void yf_dict_reset(yf_dict_t *dict)
 {
     assert(dict != NULL);
 
-    if (dict->count == 0)
-        return;
-
-    for (size_t i = 1ULL<<YF_WMINBITS; i < 1ULL<<dict->w; i++) {
-        if (dict->buckets[i].max_n != 0) {
-            free(dict->buckets[i].pairs);
-            dict->count -= dict->buckets[i].cur_n;
-        }
-    }
+    drop_old(dict);
 
-    bucket_t *bucket = dict->buckets;
+    if (dict->count == 0 && dict->growth == YF_MAXLOAD(YF_CAP(dict->tab.w)))
+        return;
 
-    while (dict->count > 0) {
-        if (bucket->cur_n != 0) {
-            dict->count -= bucket->cur_n;
-            bucket->cur_n = 0;
-        }
+    memset(dict->tab.ctrl, YF_CTRL_EMPTY, YF_CAP(dict->tab.w));
+    dict->count = 0;
+    dict->growth = YF_MAXLOAD(YF_CAP(dict->tab.w));
+    dict->low_n = 0;
+}
 
-        bucket++;
-    }
+void yf_dict_clear(yf_dict_t *dict)
+{
+    assert(dict != NULL);
 
-    dict->w = YF_WMINBITS;
-    void *tmp = realloc(dict->buckets, sizeof(bucket_t) * (1ULL<<dict->w));
+    yf_dict_reset(dict);
 
-    if (tmp != NULL)
-        dict->buckets = tmp;
+    if (dict->tab.w > dict->min_w)
+        resize(dict, dict->min_w, 0);
 }
 
 void yf_dict_deinit(yf_dict_t *dict)
@@ -566,11 +741,9 @@ void yf_dict_deinit(yf_dict_t *dict)
     if (dict == NULL)
         return;
 
-    for (size_t i = 0; i < 1ULL<<dict->w; i++)
-        free(dict->buckets[i].pairs);
-
-    free(dict->buckets);
-    free(dict);
+    YF_FREE(dict->tab.pairs);
+    YF_FREE(dict->old.tab.pairs);
+    YF_FREE(dict);
 }
 
 /*
@@ -581,15 +754,30 @@ void yf_dict_deinit(yf_dict_t *dict)
 
 void yf_print_dict(yf_dict_t *dict)
 {
-    printf("\ndict:\n w: %zu\n count: %zu\n lcg_state: %llu\n a: %zu\n b: %zu",
-           dict->w, dict->count, dict->lcg_state, dict->a, dict->b);
+    printf("\ndict:\n w: %zu\n count: %zu\n growth: %zu\n min_w: %zu\n"
+           " low_n: %zu\n rehash: %d\n old:\n  w: %zu\n  i: %zu\n  n: %zu\n"
+           " lcg_state: %llu\n a: %zu\n b: %zu", dict->tab.w, dict->count,
+           dict->growth, dict->min_w, dict->low_n, dict->rehash,
+           dict->old.tab.pairs != NULL ? dict->old.tab.w : 0, dict->old.i,
+           dict->old.n, dict->lcg_state, dict->a, dict->b);
+
+    const table_t *tabs[] = {&dict->tab, &dict->old.tab};
+
+    for (size_t t = 0; t < 2; t++) {
+        if (tabs[t]->pairs == NULL)
+            continue;
 
-    for (size_t i = 0; i < 1ULL<<dict->w; i++) {
-        printf("\n buckets[%zu]:\n  max_n: %zu\n  cur_n: %zu", i,
-               dict->buckets[i].max_n, dict->buckets[i].cur_n);
-        for (size_t j = 0; j < dict->buckets[i].cur_n; j++)
-            printf("\n  pairs[%zu]: %p/%p", j, dict->buckets[i].pairs[j].key,
-                   dict->buckets[i].pairs[j].val);
+        for (size_t i = 0; i < YF_CAP(tabs[t]->w); i++) {
+            const signed char c = tabs[t]->ctrl[i];
+            if (c == YF_CTRL_EMPTY)
+                continue;
+            if (c == YF_CTRL_DELETED)
+                printf("\n %s[%zu]: (deleted)", t ? "old" : "pairs", i);
+            else
+                printf("\n %s[%zu]: %p/%p (%02x)", t ? "old" : "pairs", i,
+                       tabs[t]->pairs[i].key, tabs[t]->pairs[i].val,
+                       (unsigned char)c);
+        }
     }
 
     puts("");
@@ -7,18 +7,235 @@
 
 #include <stdint.h>
 #include <stdarg.h>
+#include <string.h>
 #include <assert.h>
 
+#ifdef __AVX2__
+# include <immintrin.h>
+#endif
+
 #include "yf-hashfn.h"
 
+/* 'yf_hash64()' follows the design of wyhash: words are read 8 bytes at a
+   time and combined using the 128-bit product of two 64-bit values, with
+   three independent lanes of 48 bytes per step for longer inputs.
+   When AVX2 is available, long inputs are instead split in 64-byte stripes
+   that are accumulated in eight 64-bit lanes, in the manner of XXH3.
+   An SSE2 version of the accumulator was slower than the scalar loop. */
+
+/* Secret values. */
+static const uint64_t secret_[16] = {
+    0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL,
+    0x4d5a2da51de1aa47ULL, 0xbe4ba423396cfeb8ULL, 0x1cad21f72c81017cULL,
+    0xdb979083e96dd4deULL, 0x1f67b3b7a4a44072ULL, 0x78e5c0cc4ee679cbULL,
+    0x2172ffcc7dd05a82ULL, 0x8e2443f7744608b8ULL, 0x4c263a81e69035e0ULL,
+    0xcb00c391bb52283cULL, 0xa32e531b8b65d088ULL, 0x4ef90da297486471ULL,
+    0xd8acdea946ef1938ULL
+};
+
+/* Reads a little-endian word. */
+static inline uint64_t read64(const unsigned char *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof v);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+/* Reads a little-endian half word. */
+static inline uint64_t read32(const unsigned char *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof v);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+}
+
+/* Reads from one to three bytes. */
+static inline uint64_t read3(const unsigned char *p, size_t n)
+{
+    return ((uint64_t)p[0] << 16) | ((uint64_t)p[n>>1] << 8) | p[n-1];
+}
+
+/* Computes the 128-bit product of two words, in place. */
+static inline void mum(uint64_t *a, uint64_t *b)
+{
+#ifdef __SIZEOF_INT128__
+    __extension__ typedef unsigned __int128 u128_t;
+    const u128_t r = (u128_t)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#else
+    const uint64_t ha = *a >> 32, hb = *b >> 32;
+    const uint64_t la = (uint32_t)*a, lb = (uint32_t)*b;
+    const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    const uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    const uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+/* Mixes two words. */
+static inline uint64_t mix(uint64_t a, uint64_t b)
+{
+    mum(&a, &b);
+    return a ^ b;
+}
+
+#ifdef __AVX2__
+
+/* Inputs at least this long use the stripe accumulator. */
+# define YF_HLONG 512
+
+/* Number of stripes between accumulator scrambles. */
+# define YF_HSTRIPEN 8
+
+/* Prime used to scramble the accumulator. */
+# define YF_HPRIME32 0x9e3779b1U
+
+/* Accumulates whole stripes. */
+static void accumulate(uint64_t *acc, const unsigned char *p, size_t n,
+                       size_t stripe_i)
+{
+    __m256i a0 = _mm256_loadu_si256((const __m256i *)acc);
+    __m256i a1 = _mm256_loadu_si256((const __m256i *)(acc+4));
+
+    for (size_t i = 0; i < n; i++, p += 64, stripe_i++) {
+        const uint64_t *s = secret_ + stripe_i % YF_HSTRIPEN;
+        const __m256i d0 = _mm256_loadu_si256((const __m256i *)p);
+        const __m256i d1 = _mm256_loadu_si256((const __m256i *)(p+32));
+        const __m256i k0 = _mm256_loadu_si256((const __m256i *)s);
+        const __m256i k1 = _mm256_loadu_si256((const __m256i *)(s+4));
+        const __m256i x0 = _mm256_xor_si256(d0, k0);
+        const __m256i x1 = _mm256_xor_si256(d1, k1);
+        const __m256i p0 =
+            _mm256_mul_epu32(x0, _mm256_shuffle_epi32(x0, 0x31));
+        const __m256i p1 =
+            _mm256_mul_epu32(x1, _mm256_shuffle_epi32(x1, 0x31));
+        a0 = _mm256_add_epi64(a0, _mm256_shuffle_epi32(d0, 0x4e));
+        a1 = _mm256_add_epi64(a1, _mm256_shuffle_epi32(d1, 0x4e));
+        a0 = _mm256_add_epi64(a0, p0);
+        a1 = _mm256_add_epi64(a1, p1);
+    }
+
+    _mm256_storeu_si256((__m256i *)acc, a0);
+    _mm256_storeu_si256((__m256i *)(acc+4), a1);
+}
+
+/* Scrambles the accumulator. */
+static void scramble(uint64_t *acc)
+{
+    for (size_t j = 0; j < 8; j++) {
+        uint64_t a = acc[j];
+        a ^= a >> 47;
+        a ^= secret_[8+j];
+        acc[j] = a * YF_HPRIME32;
+    }
+}
+
+/* Computes the hash value of a long input. */
+static uint64_t hash_long(const unsigned char *p, size_t len, uint64_t seed)
+{
+    assert(len >= YF_HLONG);
+
+    uint64_t acc[8];
+    for (size_t j = 0; j < 8; j++)
+        acc[j] = secret_[j] ^ seed;
+
+    const size_t stripe_n = len / 64;
+    size_t i = 0;
+
+    for (; i + YF_HSTRIPEN <= stripe_n; i += YF_HSTRIPEN) {
+        accumulate(acc, p + i * 64, YF_HSTRIPEN, 0);
+        scramble(acc);
+    }
+    accumulate(acc, p + i * 64, stripe_n - i, 0);
+
+    /* the last stripe overlaps the previous one unless 'len' is a multiple
+       of the stripe size */
+    accumulate(acc, p + len - 64, 1, 1);
+
+    uint64_t h = len * 0x9e3779b97f4a7c15ULL;
+    for (size_t j = 0; j < 8; j += 2)
+        h += mix(acc[j] ^ secret_[8+j], acc[j+1] ^ secret_[9+j]);
+
+    return mix(h ^ secret_[0], h ^ seed ^ secret_[1]);
+}
+
+#endif /* __AVX2__ */
+
+uint64_t yf_hash64(const void *buf, size_t len, uint64_t seed)
+{
+    assert(buf != NULL || len == 0);
+
+    const unsigned char *p = buf;
+
+#ifdef __AVX2__
+    if (len >= YF_HLONG)
+        return hash_long(p, len, seed);
+#endif
+
+    seed ^= mix(seed ^ secret_[0], secret_[1]);
+    uint64_t a, b;
+
+    if (len <= 16) {
+        if (len >= 4) {
+            const size_t off = (len >> 3) << 2;
+            a = (read32(p) << 32) | read32(p+off);
+            b = (read32(p+len-4) << 32) | read32(p+len-4-off);
+        } else if (len > 0) {
+            a = read3(p, len);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+
+    } else {
+        size_t i = len;
+
+        if (i > 48) {
+            uint64_t seed1 = seed, seed2 = seed;
+            do {
+                seed = mix(read64(p) ^ secret_[1], read64(p+8) ^ seed);
+                seed1 = mix(read64(p+16) ^ secret_[2], read64(p+24) ^ seed1);
+                seed2 = mix(read64(p+32) ^ secret_[3], read64(p+40) ^ seed2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= seed1 ^ seed2;
+        }
+
+        while (i > 16) {
+            seed = mix(read64(p) ^ secret_[1], read64(p+8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+
+        a = read64(p+i-16);
+        b = read64(p+i-8);
+    }
+
+    a ^= secret_[1];
+    b ^= seed;
+    mum(&a, &b);
+
+    return mix(a ^ secret_[0] ^ len, b ^ secret_[1]);
+}
+
+/* Folds a 64-bit hash value into a 'size_t'. */
 #if SIZE_MAX < 4294967295UL
 # error "Unsupported system"
 #elif SIZE_MAX < 18446744073709551615ULL
-# define YF_HPRIME 16777619UL
-# define YF_HSEED  2166136261UL
+# define YF_HFOLD(h) ((size_t)((h) ^ ((h) >> 32)))
 #else
-# define YF_HPRIME 1099511628211ULL
-# define YF_HSEED  14695981039346656037ULL
+# define YF_HFOLD(h) ((size_t)(h))
 #endif
 
 size_t yf_hash(const void *ptr)
@@ -30,13 +247,8 @@ size_t yf_hashstr(const void *str)
 {
     assert(str != NULL);
 
-    const char *s = str;
-    size_t hash = YF_HSEED;
-
-    while (*s != '\0')
-        hash = hash * YF_HPRIME ^ *s++;
-
-    return hash;
+    const uint64_t h = yf_hash64(str, strlen(str), 0);
+    return YF_HFOLD(h);
 }
 
 size_t yf_hashv(const void *buf, size_t len, ...)
@@ -44,15 +256,14 @@ size_t yf_hashv(const void *buf, size_t len, ...)
     assert(buf != NULL);
 
     va_list ap;
-    const char *b = buf;
+    const void *b = buf;
     size_t n = len;
-    size_t hash = YF_HSEED;
+    uint64_t hash = 0;
 
     va_start(ap, len);
 
     while (1) {
-        while (n--)
-            hash = hash * YF_HPRIME ^ *b++;
+        hash = yf_hash64(b, n, hash);
 
         b = va_arg(ap, void *);
 
@@ -64,5 +275,5 @@ size_t yf_hashv(const void *buf, size_t len, ...)
 
     va_end(ap);
 
-    return hash;
+    return YF_HFOLD(hash);
 }
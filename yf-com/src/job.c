@@ -0,0 +1,533 @@
+/*
+ * YF
+ * job.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+
+#ifndef __STDC_NO_THREADS__
+# include <threads.h>
+#else
+# error "C11 threads required"
+#endif
+
+#ifndef __STDC_NO_ATOMICS__
+# include <stdatomic.h>
+#else
+# error "C11 atomics required"
+#endif
+
+#include "yf-job.h"
+#include "yf-error.h"
+
+/* Number of jobs that can be pending at once.
+   Jobs are taken from a fixed pool, and when it is exhausted new jobs
+   execute immediately on the calling thread instead. */
+#define YF_JOBN 1024
+
+/* Capacity of each thread's queue (power of two). */
+#define YF_DEQCAP 1024
+
+/* Maximum number of worker threads. */
+#define YF_THRDMAX 255
+
+/* Number of failed attempts to find work before a worker yields, and
+   before it sleeps. */
+#define YF_SPINN  64
+#define YF_YIELDN 128
+
+/* Timeout of a worker's sleep, in nanoseconds. */
+#define YF_SLEEPNS 2000000
+
+struct yf_job {
+    _Alignas(64) yf_jobfn_t fn;
+    void *arg;
+    yf_job_t *parent;
+    /* one for the job itself and one for each child that is pending */
+    atomic_uint unfinished;
+    /* index of the next free job plus one */
+    atomic_uint next;
+    int pooled;
+    /* range of 'yf_job_parfor()' */
+    size_t beg;
+    size_t end;
+};
+
+/* Double-ended queue of jobs.
+   The owner pushes and takes jobs at the bottom, while other threads
+   steal from the top (Chase-Lev). */
+typedef struct {
+    _Alignas(64) atomic_int_least64_t top;
+    _Alignas(64) atomic_int_least64_t bottom;
+    _Atomic(yf_job_t *) jobs[YF_DEQCAP];
+} deque_t;
+
+/* Job pool and the head of its free stack.
+   The head holds a tag in the upper half to prevent ABA. */
+static yf_job_t pool_[YF_JOBN];
+static atomic_uint_least64_t free_ = 0;
+static once_flag once_ = ONCE_FLAG_INIT;
+
+/* Job returned when the pool is exhausted, which is always completed. */
+static yf_job_t done_ = {0};
+
+/* Queues of the initializing thread (first) and workers. */
+static deque_t *deques_ = NULL;
+static thrd_t *thrds_ = NULL;
+static unsigned thrd_n_ = 0;
+
+/* Worker synchronization. */
+static atomic_int stop_ = 0;
+static atomic_long queued_ = 0;
+static atomic_int sleep_n_ = 0;
+static mtx_t mtx_;
+static cnd_t cnd_;
+
+/* The queue of the calling thread and its victim selection state. */
+static _Thread_local deque_t *deq_ = NULL;
+static _Thread_local unsigned seed_ = 0;
+
+/* Links all jobs of the pool into the free stack. */
+static void init_pool(void)
+{
+    for (unsigned i = 0; i < YF_JOBN; i++)
+        atomic_init(&pool_[i].next, i + 1 < YF_JOBN ? i + 2 : 0);
+    atomic_store(&free_, 1);
+}
+
+/* Obtains a job from the pool. */
+static yf_job_t *obtain_job(void)
+{
+    call_once(&once_, init_pool);
+
+    uint_least64_t head = atomic_load_explicit(&free_, memory_order_acquire);
+    uint_least64_t new_head;
+    unsigned i;
+    do {
+        i = head & 0xffffffff;
+        if (i == 0)
+            return NULL;
+        const unsigned next = atomic_load_explicit(&pool_[i-1].next,
+                                                   memory_order_relaxed);
+        new_head = (((head >> 32) + 1) << 32) | next;
+    } while (!atomic_compare_exchange_weak_explicit(&free_, &head, new_head,
+                                                    memory_order_acq_rel,
+                                                    memory_order_acquire));
+
+    return pool_+i-1;
+}
+
+/* Yields a job back to the pool. */
+static void yield_job(yf_job_t *job)
+{
+    assert(job->pooled);
+
+    const unsigned i = job - pool_ + 1;
+    uint_least64_t head = atomic_load_explicit(&free_, memory_order_relaxed);
+    uint_least64_t new_head;
+    do {
+        atomic_store_explicit(&job->next, head & 0xffffffff,
+                              memory_order_relaxed);
+        new_head = (((head >> 32) + 1) << 32) | i;
+    } while (!atomic_compare_exchange_weak_explicit(&free_, &head, new_head,
+                                                    memory_order_release,
+                                                    memory_order_relaxed));
+}
+
+/* Pushes a job onto the bottom of the calling thread's queue. */
+static int push(deque_t *deq, yf_job_t *job)
+{
+    const int_least64_t b = atomic_load_explicit(&deq->bottom,
+                                                 memory_order_relaxed);
+    const int_least64_t t = atomic_load_explicit(&deq->top,
+                                                 memory_order_acquire);
+    if (b - t >= YF_DEQCAP)
+        return -1;
+
+    atomic_store_explicit(&deq->jobs[b & (YF_DEQCAP-1)], job,
+                          memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deq->bottom, b + 1, memory_order_relaxed);
+    return 0;
+}
+
+/* Takes a job from the bottom of the calling thread's queue. */
+static yf_job_t *take(deque_t *deq)
+{
+    const int_least64_t b = atomic_load_explicit(&deq->bottom,
+                                                 memory_order_relaxed) - 1;
+    atomic_store_explicit(&deq->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int_least64_t t = atomic_load_explicit(&deq->top, memory_order_relaxed);
+
+    if (t > b) {
+        atomic_store_explicit(&deq->bottom, b + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    yf_job_t *job = atomic_load_explicit(&deq->jobs[b & (YF_DEQCAP-1)],
+                                         memory_order_relaxed);
+    if (t == b) {
+        /* last job, which a thief may be taking as well */
+        if (!atomic_compare_exchange_strong_explicit(&deq->top, &t, t + 1,
+                                                     memory_order_seq_cst,
+                                                     memory_order_relaxed))
+            job = NULL;
+        atomic_store_explicit(&deq->bottom, b + 1, memory_order_relaxed);
+    }
+
+    return job;
+}
+
+/* Steals a job from the top of another thread's queue. */
+static yf_job_t *steal(deque_t *deq)
+{
+    int_least64_t t = atomic_load_explicit(&deq->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    const int_least64_t b = atomic_load_explicit(&deq->bottom,
+                                                 memory_order_acquire);
+    if (t >= b)
+        return NULL;
+
+    yf_job_t *job = atomic_load_explicit(&deq->jobs[t & (YF_DEQCAP-1)],
+                                         memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deq->top, &t, t + 1,
+                                                 memory_order_seq_cst,
+                                                 memory_order_relaxed))
+        return NULL;
+
+    return job;
+}
+
+/* Marks a job as finished, propagating completion to its ancestors. */
+static void finish(yf_job_t *job)
+{
+    while (job != NULL) {
+        /* the job can be released by another thread once it completes */
+        yf_job_t *parent = job->parent;
+        const int yield = job->pooled && parent != NULL;
+
+        if (atomic_fetch_sub_explicit(&job->unfinished, 1,
+                                      memory_order_acq_rel) != 1)
+            break;
+
+        if (yield)
+            yield_job(job);
+        job = parent;
+    }
+}
+
+/* Executes a job obtained from a queue. */
+static void execute(yf_job_t *job)
+{
+    job->fn(job, job->arg);
+    finish(job);
+}
+
+/* Executes one pending job, if any. */
+static int help(void)
+{
+    yf_job_t *job = NULL;
+
+    if (deq_ != NULL)
+        job = take(deq_);
+
+    if (job == NULL && deques_ != NULL) {
+        const unsigned n = thrd_n_ + 1;
+        seed_ = seed_ * 1103515245 + 12345;
+        const unsigned beg = (seed_ >> 16) % n;
+
+        for (unsigned i = 0; i < n && job == NULL; i++) {
+            deque_t *victim = deques_+(beg+i)%n;
+            if (victim != deq_)
+                job = steal(victim);
+        }
+    }
+
+    if (job == NULL)
+        return 0;
+
+    atomic_fetch_sub_explicit(&queued_, 1, memory_order_relaxed);
+    execute(job);
+    return 1;
+}
+
+/* Waits until a job has no pending work other than the given count. */
+static void wait_until(yf_job_t *job, unsigned unfinished)
+{
+    while (atomic_load_explicit(&job->unfinished,
+                                memory_order_acquire) > unfinished) {
+        if (!help())
+            thrd_yield();
+    }
+}
+
+/* Executes a job on the calling thread, waiting for its children. */
+static void execute_now(yf_job_t *job)
+{
+    job->fn(job, job->arg);
+    wait_until(job, 1);
+    finish(job);
+}
+
+/* Schedules a job for execution. */
+static void submit(yf_job_t *job)
+{
+    if (deq_ == NULL || push(deq_, job) != 0) {
+        execute_now(job);
+        return;
+    }
+
+    atomic_fetch_add(&queued_, 1);
+    if (atomic_load(&sleep_n_) != 0) {
+        mtx_lock(&mtx_);
+        cnd_signal(&cnd_);
+        mtx_unlock(&mtx_);
+    }
+}
+
+/* Creates a child job and schedules it for execution. */
+static void spawn(yf_job_t *parent, yf_jobfn_t fn, void *arg,
+                  size_t beg, size_t end)
+{
+    atomic_fetch_add_explicit(&parent->unfinished, 1, memory_order_relaxed);
+
+    yf_job_t *job = obtain_job();
+    if (job == NULL) {
+        yf_job_t tmp = {.fn = fn, .arg = arg, .parent = parent,
+                        .beg = beg, .end = end};
+        atomic_init(&tmp.unfinished, 1);
+        execute_now(&tmp);
+        return;
+    }
+
+    job->fn = fn;
+    job->arg = arg;
+    job->parent = parent;
+    job->pooled = 1;
+    job->beg = beg;
+    job->end = end;
+    atomic_store_explicit(&job->unfinished, 1, memory_order_relaxed);
+
+    submit(job);
+}
+
+/* Puts a worker to sleep until new jobs are queued. */
+static void sleep_worker(void)
+{
+    mtx_lock(&mtx_);
+    atomic_fetch_add(&sleep_n_, 1);
+
+    if (atomic_load(&queued_) <= 0 && !atomic_load(&stop_)) {
+        struct timespec ts;
+        timespec_get(&ts, TIME_UTC);
+        ts.tv_nsec += YF_SLEEPNS;
+        if (ts.tv_nsec >= 1000000000) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+        }
+        cnd_timedwait(&cnd_, &mtx_, &ts);
+    }
+
+    atomic_fetch_sub(&sleep_n_, 1);
+    mtx_unlock(&mtx_);
+}
+
+/* Worker thread's main function. */
+static int work(void *arg)
+{
+    deq_ = arg;
+    seed_ = (unsigned)((deque_t *)arg - deques_);
+
+    unsigned idle = 0;
+    while (!atomic_load_explicit(&stop_, memory_order_acquire)) {
+        if (help()) {
+            idle = 0;
+        } else if (++idle >= YF_YIELDN) {
+            sleep_worker();
+            idle = 0;
+        } else if (idle >= YF_SPINN) {
+            thrd_yield();
+        }
+    }
+
+    deq_ = NULL;
+    return 0;
+}
+
+int yf_job_init(unsigned thrd_n)
+{
+    if (deques_ != NULL) {
+        yf_seterr(YF_ERR_INUSE, __func__);
+        return -1;
+    }
+
+    if (thrd_n > YF_THRDMAX) {
+        yf_seterr(YF_ERR_LIMIT, __func__);
+        return -1;
+    }
+
+    deque_t *deques = aligned_alloc(_Alignof(deque_t),
+                                    (thrd_n + 1) * sizeof *deques);
+    thrd_t *thrds = malloc((thrd_n + 1) * sizeof *thrds);
+    if (deques == NULL || thrds == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        free(deques);
+        free(thrds);
+        return -1;
+    }
+    memset(deques, 0, (thrd_n + 1) * sizeof *deques);
+
+    if (mtx_init(&mtx_, mtx_plain) != thrd_success) {
+        yf_seterr(YF_ERR_OTHER, __func__);
+        free(deques);
+        free(thrds);
+        return -1;
+    }
+    if (cnd_init(&cnd_) != thrd_success) {
+        yf_seterr(YF_ERR_OTHER, __func__);
+        mtx_destroy(&mtx_);
+        free(deques);
+        free(thrds);
+        return -1;
+    }
+
+    deques_ = deques;
+    thrds_ = thrds;
+    thrd_n_ = 0;
+    atomic_store(&stop_, 0);
+    atomic_store(&queued_, 0);
+
+    for (unsigned i = 0; i < thrd_n; i++) {
+        if (thrd_create(thrds+i, work, deques+i+1) != thrd_success) {
+            yf_seterr(YF_ERR_OTHER, __func__);
+            yf_job_deinit();
+            return -1;
+        }
+        thrd_n_++;
+    }
+
+    deq_ = deques;
+    return 0;
+}
+
+unsigned yf_job_getthrdn(void)
+{
+    return thrd_n_;
+}
+
+yf_job_t *yf_job_run(yf_jobfn_t fn, void *arg)
+{
+    assert(fn != NULL);
+
+    yf_job_t *job = obtain_job();
+    if (job == NULL) {
+        yf_job_t tmp = {.fn = fn, .arg = arg};
+        atomic_init(&tmp.unfinished, 1);
+        execute_now(&tmp);
+        return &done_;
+    }
+
+    job->fn = fn;
+    job->arg = arg;
+    job->parent = NULL;
+    job->pooled = 1;
+    job->beg = 0;
+    job->end = 0;
+    atomic_store_explicit(&job->unfinished, 1, memory_order_relaxed);
+
+    submit(job);
+    return job;
+}
+
+void yf_job_fork(yf_job_t *parent, yf_jobfn_t fn, void *arg)
+{
+    assert(parent != NULL);
+    assert(fn != NULL);
+
+    spawn(parent, fn, arg, 0, 0);
+}
+
+void yf_job_wait(yf_job_t *job)
+{
+    assert(job != NULL);
+
+    if (job == &done_)
+        return;
+
+    wait_until(job, 0);
+    yield_job(job);
+}
+
+/* Range execution of 'yf_job_parfor()'. */
+typedef struct {
+    void (*fn)(size_t beg, size_t end, void *arg);
+    void *arg;
+    size_t grain;
+} parfor_t;
+
+/* Splits a range in halves until it fits in the grain size. */
+static void split(yf_job_t *job, void *arg)
+{
+    const parfor_t *pf = arg;
+    const size_t beg = job->beg;
+    size_t end = job->end;
+
+    while (end - beg > pf->grain) {
+        const size_t mid = beg + (end - beg) / 2;
+        spawn(job, split, arg, mid, end);
+        end = mid;
+    }
+
+    pf->fn(beg, end, pf->arg);
+}
+
+void yf_job_parfor(size_t n, size_t grain,
+                   void (*fn)(size_t beg, size_t end, void *arg), void *arg)
+{
+    assert(fn != NULL);
+
+    if (n == 0)
+        return;
+
+    if (grain == 0) {
+        /* a few ranges per thread, so that stealing can balance the load */
+        grain = n / ((thrd_n_ + 1) * 8);
+        if (grain == 0)
+            grain = 1;
+    }
+
+    parfor_t pf = {fn, arg, grain};
+    yf_job_t root = {.fn = split, .arg = &pf, .beg = 0, .end = n};
+    atomic_init(&root.unfinished, 1);
+    execute_now(&root);
+}
+
+void yf_job_deinit(void)
+{
+    if (deques_ == NULL)
+        return;
+
+    atomic_store(&stop_, 1);
+    mtx_lock(&mtx_);
+    cnd_broadcast(&cnd_);
+    mtx_unlock(&mtx_);
+
+    for (unsigned i = 0; i < thrd_n_; i++)
+        thrd_join(thrds_[i], NULL);
+
+    cnd_destroy(&cnd_);
+    mtx_destroy(&mtx_);
+    free(deques_);
+    free(thrds_);
+    deques_ = NULL;
+    thrds_ = NULL;
+    thrd_n_ = 0;
+    deq_ = NULL;
+}
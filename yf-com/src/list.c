@@ -6,6 +6,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 #include "yf-list.h"
@@ -19,37 +20,190 @@ struct entry {
     const void *val;
 };
 
+/* Block of entries.
+   Entries are allocated in slabs and recycled through a free list, so that
+   insertion and removal do not call 'malloc()'/'free()'. */
+typedef struct slab slab_t;
+struct slab {
+    slab_t *next;
+    entry_t entries[];
+};
+
+/* Number of entries in the first and largest slabs. */
+#define YF_SLABMIN 16
+#define YF_SLABMAX 1024
+
 struct yf_list {
     yf_cmpfn_t cmp;
-    entry_t *first;
+    int mode;
     size_t n;
+
+    /* linked storage */
+    entry_t *first;
+    entry_t *free;
+    slab_t *slabs;
+    size_t slab_n;
+
+    /* array storage, from last to first value */
+    const void **vals;
+    size_t cap;
 };
 
+/* Obtains an unused entry. */
+static entry_t *obtain_entry(yf_list_t *list)
+{
+    if (list->free == NULL) {
+        const size_t n = list->slab_n;
+        slab_t *slab = malloc(sizeof *slab + n * sizeof(entry_t));
+        if (slab == NULL) {
+            yf_seterr(YF_ERR_NOMEM, __func__);
+            return NULL;
+        }
+
+        slab->next = list->slabs;
+        list->slabs = slab;
+        if (n < YF_SLABMAX)
+            list->slab_n = n << 1;
+
+        for (size_t i = 0; i < n; i++) {
+            slab->entries[i].next = list->free;
+            list->free = slab->entries+i;
+        }
+    }
+
+    entry_t *e = list->free;
+    list->free = e->next;
+    return e;
+}
+
+/* Yields an entry back to the free list. */
+static void yield_entry(yf_list_t *list, entry_t *e)
+{
+    e->next = list->free;
+    list->free = e;
+}
+
+/* Frees all slabs of a list. */
+static void free_slabs(yf_list_t *list)
+{
+    while (list->slabs != NULL) {
+        slab_t *next = list->slabs->next;
+        free(list->slabs);
+        list->slabs = next;
+    }
+
+    list->first = NULL;
+    list->free = NULL;
+    list->slab_n = YF_SLABMIN;
+}
+
+/* Ensures that the array can store one more value. */
+static int grow_array(yf_list_t *list)
+{
+    if (list->n < list->cap)
+        return 0;
+
+    const size_t cap = list->cap < YF_SLABMIN ? YF_SLABMIN : list->cap << 1;
+    const void **vals = realloc(list->vals, cap * sizeof *vals);
+    if (vals == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        return -1;
+    }
+
+    list->vals = vals;
+    list->cap = cap;
+    return 0;
+}
+
+/* Removes the array value at a given index. */
+static void remove_array(yf_list_t *list, size_t i)
+{
+    assert(i < list->n);
+
+    memmove(list->vals+i, list->vals+i+1, (list->n-i-1) * sizeof *list->vals);
+    list->n--;
+}
+
 yf_list_t *yf_list_init(yf_cmpfn_t cmp)
 {
-    yf_list_t *list = malloc(sizeof(yf_list_t));
+    yf_list_t *list = calloc(1, sizeof(yf_list_t));
     if (list == NULL) {
         yf_seterr(YF_ERR_NOMEM, __func__);
         return NULL;
     }
 
     list->cmp = cmp != NULL ? cmp : yf_cmp;
-    list->first = NULL;
-    list->n = 0;
+    list->mode = YF_LIST_LINKED;
+    list->slab_n = YF_SLABMIN;
 
     return list;
 }
 
+int yf_list_setmode(yf_list_t *list, int mode)
+{
+    assert(list != NULL);
+    assert(mode == YF_LIST_LINKED || mode == YF_LIST_ARRAY);
+
+    if (mode == list->mode)
+        return 0;
+
+    if (mode == YF_LIST_ARRAY) {
+        if (list->n > 0) {
+            const void **vals = malloc(list->n * sizeof *vals);
+            if (vals == NULL) {
+                yf_seterr(YF_ERR_NOMEM, __func__);
+                return -1;
+            }
+
+            size_t i = list->n;
+            for (const entry_t *e = list->first; e != NULL; e = e->next)
+                vals[--i] = e->val;
+
+            list->vals = vals;
+            list->cap = list->n;
+        }
+
+        free_slabs(list);
+
+    } else {
+        const size_t n = list->n;
+        list->n = 0;
+        list->mode = YF_LIST_LINKED;
+
+        for (size_t i = 0; i < n; i++) {
+            if (yf_list_insert(list, list->vals[i]) != 0) {
+                free_slabs(list);
+                list->n = n;
+                list->mode = YF_LIST_ARRAY;
+                return -1;
+            }
+        }
+
+        free(list->vals);
+        list->vals = NULL;
+        list->cap = 0;
+    }
+
+    list->mode = mode;
+    return 0;
+}
+
 int yf_list_insert(yf_list_t *list, const void *val)
 {
     assert(list != NULL);
 
-    entry_t *e = malloc(sizeof(entry_t));
-    if (e == NULL) {
-        yf_seterr(YF_ERR_NOMEM, __func__);
-        return -1;
+    if (list->mode == YF_LIST_ARRAY) {
+        if (grow_array(list) != 0)
+            return -1;
+
+        list->vals[list->n++] = val;
+        return 0;
     }
 
+    entry_t *e = obtain_entry(list);
+    if (e == NULL)
+        return -1;
+
     e->val = val;
     e->prev = NULL;
     e->next = list->first;
@@ -75,23 +229,38 @@ int yf_list_insertat(yf_list_t *list, yf_iter_t *it, const void *val)
         if (yf_list_insert(list, val) != 0)
             return -1;
 
-        it->data[0] = (size_t)list->first;
+        if (list->mode == YF_LIST_ARRAY)
+            it->data[0] = list->n - 1;
+        else
+            it->data[0] = (size_t)list->first;
+        it->data[1] = ~it->data[0];
+
+    } else if (list->mode == YF_LIST_ARRAY) {
+        if (grow_array(list) != 0)
+            return -1;
+
+        /* the next value precedes the current one in the array */
+        const size_t i = it->data[0];
+        memmove(list->vals+i+1, list->vals+i, (list->n-i) * sizeof *list->vals);
+        list->vals[i] = val;
+        list->n++;
         it->data[1] = ~it->data[0];
 
     } else {
-        entry_t *e = malloc(sizeof(entry_t));
-        if (e == NULL) {
-            yf_seterr(YF_ERR_NOMEM, __func__);
+        entry_t *e = obtain_entry(list);
+        if (e == NULL)
             return -1;
-        }
 
         entry_t *cur = (entry_t *)it->data[0];
         e->prev = cur;
         e->next = cur->next;
         e->val = val;
+        if (cur->next != NULL)
+            cur->next->prev = e;
         cur->next = e;
         list->n++;
         it->data[0] = (size_t)e;
+        it->data[1] = ~it->data[0];
     }
 
     return 0;
@@ -101,6 +270,18 @@ int yf_list_remove(yf_list_t *list, const void *val)
 {
     assert(list != NULL);
 
+    if (list->mode == YF_LIST_ARRAY) {
+        for (size_t i = list->n; i > 0; i--) {
+            if (list->cmp(val, list->vals[i-1]) == 0) {
+                remove_array(list, i-1);
+                return 0;
+            }
+        }
+
+        yf_seterr(YF_ERR_NOTFND, __func__);
+        return -1;
+    }
+
     entry_t *e = list->first;
 
     while (e != NULL) {
@@ -113,7 +294,7 @@ int yf_list_remove(yf_list_t *list, const void *val)
             if (e->next != NULL)
                 e->next->prev = e->prev;
 
-            free(e);
+            yield_entry(list, e);
             list->n--;
 
             return 0;
@@ -131,13 +312,35 @@ void *yf_list_removeat(yf_list_t *list, yf_iter_t *it)
 {
     assert(list != NULL);
 
-    if (list->first == NULL) {
+    if (list->n == 0) {
         if (it != NULL)
             *it = YF_NILIT;
 
         return NULL;
     }
 
+    if (list->mode == YF_LIST_ARRAY) {
+        size_t i;
+        if (it == NULL || YF_IT_ISNIL(*it))
+            i = list->n - 1;
+        else
+            i = it->data[0];
+
+        void *r = (void *)list->vals[i];
+        remove_array(list, i);
+
+        if (it != NULL) {
+            if (i > 0) {
+                it->data[0] = i - 1;
+                it->data[1] = ~it->data[0];
+            } else {
+                *it = YF_NILIT;
+            }
+        }
+
+        return r;
+    }
+
     entry_t *e = NULL;
 
     if (it == NULL || YF_IT_ISNIL(*it))
@@ -153,15 +356,17 @@ void *yf_list_removeat(yf_list_t *list, yf_iter_t *it)
     if (e->next != NULL) {
         e->next->prev = e->prev;
 
-        if (it != NULL)
+        if (it != NULL) {
             it->data[0] = (size_t)e->next;
+            it->data[1] = ~it->data[0];
+        }
 
     } else if (it != NULL) {
         *it = YF_NILIT;
     }
 
     void *r = (void *)e->val;
-    free(e);
+    yield_entry(list, e);
     list->n--;
 
     return r;
@@ -171,6 +376,15 @@ int yf_list_contains(yf_list_t *list, const void *val)
 {
     assert(list != NULL);
 
+    if (list->mode == YF_LIST_ARRAY) {
+        for (size_t i = list->n; i > 0; i--) {
+            if (list->cmp(list->vals[i-1], val) == 0)
+                return 1;
+        }
+
+        return 0;
+    }
+
     entry_t *e = list->first;
 
     while (e != NULL) {
@@ -187,6 +401,31 @@ void *yf_list_next(yf_list_t *list, yf_iter_t *it)
 {
     assert(list != NULL);
 
+    if (list->mode == YF_LIST_ARRAY) {
+        if (list->n == 0) {
+            if (it != NULL)
+                *it = YF_NILIT;
+            return NULL;
+        }
+
+        if (it == NULL)
+            return (void *)list->vals[list->n-1];
+
+        size_t i;
+        if (YF_IT_ISNIL(*it)) {
+            i = list->n - 1;
+        } else if (it->data[0] > 0) {
+            i = it->data[0] - 1;
+        } else {
+            *it = YF_NILIT;
+            return NULL;
+        }
+
+        it->data[0] = i;
+        it->data[1] = ~i;
+        return (void *)list->vals[i];
+    }
+
     void *r = NULL;
 
     if (it == NULL) {
@@ -196,7 +435,7 @@ void *yf_list_next(yf_list_t *list, yf_iter_t *it)
     } else if (YF_IT_ISNIL(*it)) {
         if (list->first != NULL) {
             it->data[0] = (size_t)list->first;
-            it->data[1] = ~it->data[1];
+            it->data[1] = ~it->data[0];
             r = (void *)list->first->val;
         }
 
@@ -205,6 +444,7 @@ void *yf_list_next(yf_list_t *list, yf_iter_t *it)
 
         if (e->next != NULL) {
             it->data[0] = (size_t)e->next;
+            it->data[1] = ~it->data[0];
             r = (void *)e->next->val;
         } else {
             *it = YF_NILIT;
@@ -220,6 +460,15 @@ void yf_list_each(yf_list_t *list,
     assert(list != NULL);
     assert(callb != NULL);
 
+    if (list->mode == YF_LIST_ARRAY) {
+        for (size_t i = list->n; i > 0; i--) {
+            if (callb((void *)list->vals[i-1], arg) != 0)
+                break;
+        }
+
+        return;
+    }
+
     entry_t *e = list->first;
 
     while (e != NULL) {
@@ -243,37 +492,26 @@ void yf_list_clear(yf_list_t *list)
     if (list->n == 0)
         return;
 
-    entry_t *e = list->first;
-
-    while (1) {
-        if (e->next == NULL) {
-            free(e);
-            break;
-        }
+    if (list->mode == YF_LIST_LINKED) {
+        /* entries are kept for reuse */
+        entry_t *e = list->first;
+        while (e->next != NULL)
+            e = e->next;
 
-        e = e->next;
-        free(e->prev);
+        e->next = list->free;
+        list->free = list->first;
+        list->first = NULL;
     }
 
-    list->first = NULL;
     list->n = 0;
 }
 
 void yf_list_deinit(yf_list_t *list)
 {
-    if (list != NULL && list->n > 0) {
-        entry_t *e = list->first;
-
-        while (1) {
-            if (e->next == NULL) {
-                free(e);
-                break;
-            }
-
-            e = e->next;
-            free(e->prev);
-        }
-    }
+    if (list == NULL)
+        return;
 
+    free_slabs(list);
+    free(list->vals);
     free(list);
 }
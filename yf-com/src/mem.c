@@ -0,0 +1,192 @@
+/*
+ * YF
+ * mem.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#ifndef __STDC_NO_THREADS__
+# include <threads.h>
+#else
+# error "C11 threads required"
+#endif
+
+#include "yf-mem.h"
+
+/* Maximum number of tags.
+   Allocations using further tags are accounted to the last one. */
+#define YF_MEMTAGN 64
+
+/* Tag used when no more tags can be added. */
+#define YF_MEMOTHER "(other)"
+
+/* Header preceding every tracked allocation. */
+typedef union {
+    struct {
+        size_t size;
+        unsigned tag;
+    } h;
+    max_align_t align;
+} hdr_t;
+
+/* Statistics of each tag. */
+static yf_memstats_t tags_[YF_MEMTAGN];
+static unsigned tag_n_ = 0;
+
+/* Lock protecting the statistics. */
+static mtx_t mtx_;
+static once_flag once_ = ONCE_FLAG_INIT;
+
+/* Initializes the lock. */
+static void init_mtx(void)
+{
+    if (mtx_init(&mtx_, mtx_plain) != thrd_success)
+        abort();
+}
+
+/* Gets the index of a tag, adding it if needed.
+   Must be called with the lock held. */
+static unsigned get_tag(const char *tag)
+{
+    assert(tag != NULL);
+
+    for (unsigned i = 0; i < tag_n_; i++) {
+        /* equal literals need not share storage across files */
+        if (tags_[i].tag == tag || strcmp(tags_[i].tag, tag) == 0)
+            return i;
+    }
+
+    if (tag_n_ == YF_MEMTAGN - 1) {
+        tags_[tag_n_++].tag = YF_MEMOTHER;
+        return tag_n_ - 1;
+    }
+    if (tag_n_ == YF_MEMTAGN)
+        return YF_MEMTAGN - 1;
+
+    tags_[tag_n_].tag = tag;
+    return tag_n_++;
+}
+
+/* Accounts an allocation. Must be called with the lock held. */
+static void add_bytes(unsigned tag, size_t size)
+{
+    yf_memstats_t *st = tags_+tag;
+    st->live += size;
+    if (st->live > st->peak)
+        st->peak = st->live;
+    st->alloc_n++;
+}
+
+/* Accounts a deallocation. Must be called with the lock held. */
+static void sub_bytes(unsigned tag, size_t size)
+{
+    yf_memstats_t *st = tags_+tag;
+    assert(st->live >= size);
+    st->live -= size;
+    st->free_n++;
+}
+
+void *yf_mem_malloc(const char *tag, size_t size)
+{
+    if (size > SIZE_MAX - sizeof(hdr_t))
+        return NULL;
+
+    hdr_t *hdr = malloc(sizeof(hdr_t) + size);
+    if (hdr == NULL)
+        return NULL;
+
+    call_once(&once_, init_mtx);
+    mtx_lock(&mtx_);
+    hdr->h.size = size;
+    hdr->h.tag = get_tag(tag);
+    add_bytes(hdr->h.tag, size);
+    mtx_unlock(&mtx_);
+
+    return hdr+1;
+}
+
+void *yf_mem_calloc(const char *tag, size_t n, size_t size)
+{
+    if (size != 0 && n > (SIZE_MAX - sizeof(hdr_t)) / size)
+        return NULL;
+
+    void *ptr = yf_mem_malloc(tag, n * size);
+    if (ptr != NULL)
+        memset(ptr, 0, n * size);
+    return ptr;
+}
+
+void *yf_mem_realloc(const char *tag, void *ptr, size_t size)
+{
+    if (ptr == NULL)
+        return yf_mem_malloc(tag, size);
+
+    if (size > SIZE_MAX - sizeof(hdr_t))
+        return NULL;
+
+    hdr_t *hdr = (hdr_t *)ptr - 1;
+    const size_t old_size = hdr->h.size;
+
+    hdr = realloc(hdr, sizeof(hdr_t) + size);
+    if (hdr == NULL)
+        return NULL;
+
+    mtx_lock(&mtx_);
+    yf_memstats_t *st = tags_+hdr->h.tag;
+    st->live = st->live - old_size + size;
+    if (st->live > st->peak)
+        st->peak = st->live;
+    hdr->h.size = size;
+    mtx_unlock(&mtx_);
+
+    return hdr+1;
+}
+
+void yf_mem_free(void *ptr)
+{
+    if (ptr == NULL)
+        return;
+
+    hdr_t *hdr = (hdr_t *)ptr - 1;
+
+    mtx_lock(&mtx_);
+    sub_bytes(hdr->h.tag, hdr->h.size);
+    mtx_unlock(&mtx_);
+
+    free(hdr);
+}
+
+size_t yf_mem_getstats(yf_memstats_t *stats, size_t n)
+{
+    assert(stats != NULL || n == 0);
+
+    call_once(&once_, init_mtx);
+    mtx_lock(&mtx_);
+    const size_t tag_n = tag_n_;
+    if (n > 0)
+        memcpy(stats, tags_, (n < tag_n ? n : tag_n) * sizeof *stats);
+    mtx_unlock(&mtx_);
+
+    return tag_n;
+}
+
+void yf_mem_print(void)
+{
+    yf_memstats_t stats[YF_MEMTAGN];
+    const size_t n = yf_mem_getstats(stats, YF_MEMTAGN);
+
+    printf("\n[YF] MEMORY:\n");
+    printf(" %-16s %12s %12s %10s %10s\n", "tag", "live", "peak", "allocs",
+           "frees");
+    for (size_t i = 0; i < n; i++)
+        printf(" %-16s %12zu %12zu %10zu %10zu\n", stats[i].tag,
+               stats[i].live, stats[i].peak, stats[i].alloc_n,
+               stats[i].free_n);
+    printf("\n");
+}
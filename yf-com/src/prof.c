@@ -0,0 +1,290 @@
+/*
+ * YF
+ * prof.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#ifndef __STDC_NO_ATOMICS__
+# include <stdatomic.h>
+#else
+# error "C11 atomics required"
+#endif
+
+#ifndef __STDC_NO_THREADS__
+# include <threads.h>
+#else
+# error "C11 threads required"
+#endif
+
+#include "yf-prof.h"
+#include "yf-clock.h"
+#include "yf-error.h"
+
+/* Maximum nesting depth of zones.
+   Deeper zones are not recorded. */
+#define YF_PROFDEPTH 64
+
+/* Number of events in each chunk. */
+#define YF_PROFCHUNK 4096
+
+/* Maximum number of chunks of a thread.
+   Events are dropped once the limit is reached. */
+#define YF_PROFCHUNKN 256
+
+/* Zone that has ended. */
+typedef struct {
+    const char *name;
+    uint64_t beg;
+    uint64_t end;
+} event_t;
+
+/* Chunk of events.
+   Only the owner thread writes events, and the count is published after
+   each write, so that exporting need not stop recording threads. */
+typedef struct chunk chunk_t;
+struct chunk {
+    _Atomic(chunk_t *) next;
+    atomic_size_t n;
+    event_t evts[YF_PROFCHUNK];
+};
+
+/* Events of a thread.
+   Buffers are kept until the process exits, so that zones recorded by
+   threads that have exited can still be exported. */
+typedef struct buf buf_t;
+struct buf {
+    buf_t *next;
+    unsigned tid;
+    struct {
+        const char *name;
+        uint64_t beg;
+    } stack[YF_PROFDEPTH];
+    unsigned depth;
+    chunk_t *first;
+    chunk_t *cur;
+    unsigned chunk_n;
+};
+
+/* List of thread buffers. */
+static _Atomic(buf_t *) bufs_ = NULL;
+
+/* Identifier given to the next thread buffer. */
+static atomic_uint tid_ = 1;
+
+/* The buffer of the calling thread. */
+static _Thread_local buf_t *thrd_ = NULL;
+
+/* Registration of 'deinit_bufs' to run on exit. */
+static once_flag once_ = ONCE_FLAG_INIT;
+
+/* Whether buffers have been freed on exit.
+   Zones recorded afterwards, from other exit handlers, are ignored. */
+static atomic_bool exited_ = 0;
+
+/* Frees all thread buffers.
+   Threads must not be recording zones when the process exits. */
+static void deinit_bufs(void)
+{
+    atomic_store(&exited_, 1);
+    thrd_ = NULL;
+
+    buf_t *buf = atomic_exchange(&bufs_, NULL);
+    while (buf != NULL) {
+        chunk_t *chunk = buf->first;
+        while (chunk != NULL) {
+            chunk_t *next = atomic_load_explicit(&chunk->next,
+                                                 memory_order_relaxed);
+            free(chunk);
+            chunk = next;
+        }
+        buf_t *next = buf->next;
+        free(buf);
+        buf = next;
+    }
+}
+
+/* Registers 'deinit_bufs' to run on exit. */
+static void init_exit(void)
+{
+    atexit(deinit_bufs);
+}
+
+/* Creates and registers the buffer of the calling thread. */
+static buf_t *init_thrd(void)
+{
+    call_once(&once_, init_exit);
+    if (atomic_load(&exited_))
+        return NULL;
+
+    buf_t *buf = calloc(1, sizeof *buf);
+    chunk_t *chunk = malloc(sizeof *chunk);
+    if (buf == NULL || chunk == NULL) {
+        free(buf);
+        free(chunk);
+        return NULL;
+    }
+
+    atomic_init(&chunk->next, NULL);
+    atomic_init(&chunk->n, 0);
+    buf->tid = atomic_fetch_add_explicit(&tid_, 1, memory_order_relaxed);
+    buf->first = buf->cur = chunk;
+    buf->chunk_n = 1;
+
+    buf_t *head = atomic_load_explicit(&bufs_, memory_order_relaxed);
+    do
+        buf->next = head;
+    while (!atomic_compare_exchange_weak_explicit(&bufs_, &head, buf,
+                                                  memory_order_release,
+                                                  memory_order_relaxed));
+
+    thrd_ = buf;
+    return buf;
+}
+
+/* Appends an event to the buffer of the calling thread. */
+static void push_event(buf_t *buf, const event_t *evt)
+{
+    chunk_t *chunk = buf->cur;
+    size_t n = atomic_load_explicit(&chunk->n, memory_order_relaxed);
+
+    if (n == YF_PROFCHUNK) {
+        chunk_t *next = atomic_load_explicit(&chunk->next,
+                                             memory_order_relaxed);
+        if (next == NULL) {
+            if (buf->chunk_n == YF_PROFCHUNKN ||
+                (next = malloc(sizeof *next)) == NULL)
+                return;
+            atomic_init(&next->next, NULL);
+            atomic_init(&next->n, 0);
+            atomic_store_explicit(&chunk->next, next, memory_order_release);
+            buf->chunk_n++;
+        }
+        buf->cur = chunk = next;
+        n = 0;
+    }
+
+    chunk->evts[n] = *evt;
+    atomic_store_explicit(&chunk->n, n + 1, memory_order_release);
+}
+
+void yf_prof_begin(const char *name)
+{
+    assert(name != NULL);
+
+    buf_t *buf = thrd_;
+    if (buf == NULL && (buf = init_thrd()) == NULL)
+        return;
+
+    if (buf->depth < YF_PROFDEPTH) {
+        buf->stack[buf->depth].name = name;
+        buf->stack[buf->depth].beg = yf_getns();
+    }
+    buf->depth++;
+}
+
+void yf_prof_end(void)
+{
+    const uint64_t end = yf_getns();
+
+    buf_t *buf = thrd_;
+    if (buf == NULL)
+        return;
+
+    assert(buf->depth > 0);
+    if (buf->depth-- > YF_PROFDEPTH)
+        return;
+
+    const event_t evt = {
+        buf->stack[buf->depth].name,
+        buf->stack[buf->depth].beg,
+        end
+    };
+    push_event(buf, &evt);
+}
+
+/* Writes a string as a JSON string. */
+static void write_str(FILE *file, const char *str)
+{
+    fputc('"', file);
+    for (; *str != '\0'; str++) {
+        const unsigned char c = *str;
+        if (c == '"' || c == '\\')
+            fprintf(file, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(file, "\\u%04x", c);
+        else
+            fputc(c, file);
+    }
+    fputc('"', file);
+}
+
+int yf_prof_export(const char *pathname)
+{
+    assert(pathname != NULL);
+
+    FILE *file = fopen(pathname, "w");
+    if (file == NULL) {
+        yf_seterr(YF_ERR_NOFILE, __func__);
+        return -1;
+    }
+
+    fputs("{\"traceEvents\":[", file);
+    int first = 1;
+
+    buf_t *buf = atomic_load_explicit(&bufs_, memory_order_acquire);
+    for (; buf != NULL; buf = buf->next) {
+        fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\","
+                "\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}",
+                first ? "" : ",", buf->tid, buf->tid);
+        first = 0;
+
+        chunk_t *chunk = buf->first;
+        while (chunk != NULL) {
+            const size_t n = atomic_load_explicit(&chunk->n,
+                                                  memory_order_acquire);
+            for (size_t i = 0; i < n; i++) {
+                const event_t *evt = chunk->evts+i;
+                fputs(",\n{\"name\":", file);
+                write_str(file, evt->name);
+                fprintf(file, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                        "\"pid\":1,\"tid\":%u}",
+                        (double)evt->beg * 1.0e-3,
+                        (double)(evt->end - evt->beg) * 1.0e-3, buf->tid);
+            }
+            chunk = atomic_load_explicit(&chunk->next, memory_order_acquire);
+        }
+    }
+
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", file);
+
+    if (ferror(file) != 0) {
+        fclose(file);
+        yf_seterr(YF_ERR_OTHER, __func__);
+        return -1;
+    }
+    if (fclose(file) != 0) {
+        yf_seterr(YF_ERR_OTHER, __func__);
+        return -1;
+    }
+
+    return 0;
+}
+
+void yf_prof_reset(void)
+{
+    buf_t *buf = atomic_load_explicit(&bufs_, memory_order_acquire);
+    for (; buf != NULL; buf = buf->next) {
+        chunk_t *chunk = buf->first;
+        while (chunk != NULL) {
+            atomic_store_explicit(&chunk->n, 0, memory_order_relaxed);
+            chunk = atomic_load_explicit(&chunk->next, memory_order_relaxed);
+        }
+        buf->cur = buf->first;
+    }
+}
@@ -5,111 +5,398 @@
  * Copyright © 2021 Gustavo C. Viegas.
  */
 
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
+#ifndef __STDC_NO_THREADS__
+# include <threads.h>
+#else
+# error "C11 threads required"
+#endif
+
+#ifndef __STDC_NO_ATOMICS__
+# include <stdatomic.h>
+#else
+# error "C11 atomics required"
+#endif
+
 #include "yf-pubsub.h"
 #include "yf-dict.h"
 #include "yf-error.h"
 
-/* TODO: Thread-safe. */
-
-/* Publisher variables. */
-typedef struct {
-    unsigned pubsub_mask;
-    yf_dict_t *subs;
-} pub_t;
+/* Publishing does not lock. Each publisher has an immutable snapshot of its
+   subscribers, which is found through a publisher index that readers probe
+   using atomic loads. Changes are made under a lock by creating a new
+   snapshot and swapping it into the index. Replaced snapshots and indices
+   are retired and only freed once no reader can be using them, which is
+   tracked by two reader counters - one for each parity of the current
+   epoch. */
 
 /* Subscriber variables. */
 typedef struct {
+    const void *sub;
     unsigned pubsub_mask;
     void (*callb)(void *, int, void *);
     void *arg;
 } sub_t;
 
-/* Dictionary containing all publishers. */
-static yf_dict_t *pubs_ = NULL;
+/* Snapshot of a publisher's subscribers. */
+typedef struct snap {
+    struct snap *next;
+    unsigned pubsub_mask;
+    size_t n;
+    sub_t subs[];
+} snap_t;
+
+/* Publisher index entry. */
+typedef struct {
+    _Atomic(const void *) pub;
+    _Atomic(snap_t *) snap;
+} slot_t;
+
+/* Publisher index.
+   Keys are never removed. Entries of publishers that were unset have a
+   'NULL' snapshot instead, and are dropped when the index is rebuilt. */
+typedef struct index {
+    struct index *next;
+    size_t w;
+    size_t used_n;
+    size_t pub_n;
+    slot_t slots[];
+} index_t;
+
+/* Minimum width of the index. */
+#define YF_PUBMINW 6
+
+/* Current publisher index. */
+static _Atomic(index_t *) index_ = NULL;
+
+/* Current epoch. */
+static atomic_uint epoch_ = 0;
+
+/* Number of readers in epochs of each parity. */
+static atomic_size_t readers_[2];
+
+/* Snapshots and indices retired in epochs of each parity. */
+static struct {
+    snap_t *snaps;
+    index_t *idxs;
+} retired_[2];
+
+/* Deferred publication. */
+typedef struct {
+    const void *pub;
+    unsigned pubsub_mask;
+} defer_t;
+
+/* Deferred publications, in the order that publishers were first added.
+   'pos' maps publishers to their position in 'defers' plus one. The spare
+   array is kept from the previous flush to avoid reallocations. */
+static struct {
+    defer_t *defers;
+    size_t n;
+    size_t cap;
+    yf_dict_t *pos;
+    defer_t *spare;
+    size_t spare_cap;
+} queue_ = {0};
+
+/* Lock for changes. */
+static mtx_t mtx_;
+static once_flag once_ = ONCE_FLAG_INIT;
+static int mtx_ok_ = 0;
+
+/* Initializes the lock. */
+static void init_mtx(void)
+{
+    mtx_ok_ = mtx_init(&mtx_, mtx_plain) == thrd_success;
+}
+
+/* Acquires the lock for changes. */
+static int lock(void)
+{
+    call_once(&once_, init_mtx);
+
+    if (!mtx_ok_ || mtx_lock(&mtx_) != thrd_success) {
+        yf_seterr(YF_ERR_OTHER, __func__);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Releases the lock for changes. */
+static void unlock(void)
+{
+    mtx_unlock(&mtx_);
+}
+
+/* Enters a read-side section. */
+static unsigned enter(void)
+{
+    while (1) {
+        const unsigned e = atomic_load(&epoch_);
+        atomic_fetch_add(&readers_[e & 1], 1);
+
+        /* an epoch change may have raced with the increment */
+        if (atomic_load(&epoch_) == e)
+            return e;
+
+        atomic_fetch_sub(&readers_[e & 1], 1);
+    }
+}
+
+/* Leaves a read-side section. */
+static void leave(unsigned epoch)
+{
+    atomic_fetch_sub(&readers_[epoch & 1], 1);
+}
 
-#if 0
-/* On exit deinitialization. */
-static void deinit(void)
+/* Frees retired data that readers can no longer reach.
+   Must be called with the lock held. */
+static void reclaim(void)
 {
-    if (pubs_ == NULL)
+    const unsigned e = atomic_load(&epoch_);
+
+    /* readers of the previous epoch use the same counter as the next one,
+       so once it drops to zero the data they could see can be freed */
+    if (atomic_load(&readers_[(e + 1) & 1]) != 0)
         return;
 
-    yf_iter_t it = YF_NILIT;
-    pub_t *pub;
-    while ((pub = yf_dict_next(pubs_, &it, NULL)) != NULL) {
-        yf_iter_t it2 = YF_NILIT;
-        sub_t *sub;
-        while ((sub = yf_dict_next(pub->subs, &it2, NULL)) != NULL)
-            free(sub);
-        yf_dict_deinit(pub->subs);
-        free(pub);
+    snap_t *snap = retired_[(e + 1) & 1].snaps;
+    while (snap != NULL) {
+        snap_t *next = snap->next;
+        free(snap);
+        snap = next;
+    }
+
+    index_t *idx = retired_[(e + 1) & 1].idxs;
+    while (idx != NULL) {
+        index_t *next = idx->next;
+        free(idx);
+        idx = next;
     }
 
-    yf_dict_deinit(pubs_);
+    retired_[(e + 1) & 1].snaps = NULL;
+    retired_[(e + 1) & 1].idxs = NULL;
+    atomic_store(&epoch_, e + 1);
 }
-#endif
 
-int yf_setpub(const void *pub, unsigned pubsub_mask)
+/* Retires a snapshot. Must be called with the lock held. */
+static void retire_snap(snap_t *snap)
 {
-    if (pub == NULL) {
-        yf_seterr(YF_ERR_INVARG, __func__);
-        return -1;
+    if (snap == NULL)
+        return;
+
+    const unsigned e = atomic_load(&epoch_);
+    snap->next = retired_[e & 1].snaps;
+    retired_[e & 1].snaps = snap;
+}
+
+/* Retires an index. Must be called with the lock held. */
+static void retire_idx(index_t *idx)
+{
+    if (idx == NULL)
+        return;
+
+    const unsigned e = atomic_load(&epoch_);
+    idx->next = retired_[e & 1].idxs;
+    retired_[e & 1].idxs = idx;
+}
+
+/* Finds the index entry of a given publisher, or else the empty entry
+   where it would be inserted. */
+static slot_t *probe(index_t *idx, const void *pub)
+{
+    const size_t mask = ((size_t)1 << idx->w) - 1;
+    size_t i = ((uint64_t)(uintptr_t)pub * 0x9e3779b97f4a7c15ULL) >>
+               (64 - idx->w);
+
+    while (1) {
+        const void *key = atomic_load(&idx->slots[i].pub);
+        if (key == pub || key == NULL)
+            return idx->slots+i;
+        i = (i + 1) & mask;
     }
+}
 
-    if (pubs_ == NULL) {
-        if ((pubs_ = yf_dict_init(NULL, NULL)) == NULL)
-            return -1;
+/* Gets the current snapshot of a given publisher.
+   Readers must call this from within a read-side section. */
+static snap_t *get_snap(const void *pub)
+{
+    index_t *idx = atomic_load(&index_);
+    if (idx == NULL)
+        return NULL;
+
+    /* an empty slot may be claimed by another publisher before its
+       snapshot is read, so the key is checked again afterwards */
+    slot_t *slot = probe(idx, pub);
+    snap_t *snap = atomic_load(&slot->snap);
+    return atomic_load(&slot->pub) == pub ? snap : NULL;
+}
 
-        /* XXX: Certain code calls pubsub functions on exit handler. */
-#if 0
-        atexit(deinit);
-#endif
+/* Creates a new index containing the publishers of another one. */
+static index_t *rebuild_idx(index_t *idx, size_t pub_n)
+{
+    size_t w = YF_PUBMINW;
+    while ((((size_t)3 << w) >> 3) < pub_n)
+        w++;
+
+    const size_t n = (size_t)1 << w;
+    index_t *new_idx = malloc(sizeof *new_idx + n * sizeof(slot_t));
+    if (new_idx == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        return NULL;
+    }
+    new_idx->next = NULL;
+    new_idx->w = w;
+    new_idx->used_n = 0;
+    new_idx->pub_n = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        atomic_init(&new_idx->slots[i].pub, NULL);
+        atomic_init(&new_idx->slots[i].snap, NULL);
     }
 
-    pub_t *val = yf_dict_search(pubs_, pub);
+    if (idx == NULL)
+        return new_idx;
 
-    /* removal */
-    if (pubsub_mask == YF_PUBSUB_NONE) {
-        if (val != NULL) {
-            yf_dict_remove(pubs_, pub);
+    for (size_t i = 0; i < ((size_t)1 << idx->w); i++) {
+        snap_t *snap = atomic_load(&idx->slots[i].snap);
+        if (snap == NULL)
+            continue;
 
-            yf_iter_t it = YF_NILIT;
-            sub_t *sub;
-            while ((sub = yf_dict_next(val->subs, &it, NULL)) != NULL)
-                free(sub);
+        const void *pub = atomic_load(&idx->slots[i].pub);
+        slot_t *slot = probe(new_idx, pub);
+        atomic_init(&slot->snap, snap);
+        atomic_init(&slot->pub, pub);
+        new_idx->used_n++;
+        new_idx->pub_n++;
+    }
 
-            yf_dict_deinit(val->subs);
-            free(val);
-        }
+    return new_idx;
+}
+
+/* Replaces the snapshot of a given publisher.
+   A 'NULL' snapshot unsets the publisher. Must be called with the lock
+   held. */
+static int set_snap(const void *pub, snap_t *snap)
+{
+    index_t *idx = atomic_load(&index_);
 
+    if (idx == NULL) {
+        if (snap == NULL)
+            return 0;
+        if ((idx = rebuild_idx(NULL, 1)) == NULL)
+            return -1;
+        atomic_store(&index_, idx);
+    }
+
+    slot_t *slot = probe(idx, pub);
+
+    if (atomic_load(&slot->pub) == pub) {
+        snap_t *prev = atomic_exchange(&slot->snap, snap);
+        idx->pub_n += (prev == NULL) - (snap == NULL);
+        retire_snap(prev);
+        reclaim();
         return 0;
     }
 
-    /* insertion/update */
-    if (val == NULL) {
-        if ((val = malloc(sizeof *val)) == NULL) {
-            yf_seterr(YF_ERR_NOMEM, __func__);
-            return -1;
-        }
+    if (snap == NULL)
+        return 0;
 
-        val->subs = yf_dict_init(NULL, NULL);
-        if (val->subs == NULL) {
-            free(val);
+    /* the index is rebuilt when used entries exceed 3/4 of its size */
+    if (idx->used_n + 1 > ((size_t)3 << idx->w) >> 2) {
+        index_t *new_idx = rebuild_idx(idx, idx->pub_n + 1);
+        if (new_idx == NULL)
             return -1;
-        }
 
-        if (yf_dict_insert(pubs_, pub, val) != 0) {
-            yf_dict_deinit(val->subs);
-            free(val);
-            return -1;
-        }
+        atomic_store(&index_, new_idx);
+        retire_idx(idx);
+        idx = new_idx;
+        slot = probe(idx, pub);
+    }
+
+    /* the snapshot must be visible before the key is */
+    atomic_store(&slot->snap, snap);
+    atomic_store(&slot->pub, pub);
+    idx->used_n++;
+    idx->pub_n++;
+    reclaim();
+
+    return 0;
+}
+
+/* Creates a copy of a snapshot with room for one more subscriber. */
+static snap_t *copy_snap(const snap_t *snap, unsigned pubsub_mask)
+{
+    const size_t n = snap != NULL ? snap->n : 0;
+
+    snap_t *new_snap = malloc(sizeof *new_snap + (n + 1) * sizeof(sub_t));
+    if (new_snap == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        return NULL;
+    }
+    new_snap->next = NULL;
+    new_snap->pubsub_mask = pubsub_mask;
+    new_snap->n = n;
+
+    if (n > 0)
+        memcpy(new_snap->subs, snap->subs, n * sizeof(sub_t));
+
+    return new_snap;
+}
+
+/* Discards the deferred publications of a given publisher.
+   Must be called with the lock held. */
+static void discard_defers(const void *pub)
+{
+    if (queue_.pos == NULL)
+        return;
+
+    void *pos;
+    if (yf_dict_find(queue_.pos, pub, &pos)) {
+        queue_.defers[(size_t)pos-1].pub = NULL;
+        yf_dict_remove(queue_.pos, pub);
+    }
+}
+
+int yf_setpub(const void *pub, unsigned pubsub_mask)
+{
+    if (pub == NULL) {
+        yf_seterr(YF_ERR_INVARG, __func__);
+        return -1;
+    }
+
+    if (lock() != 0)
+        return -1;
+
+    snap_t *snap = get_snap(pub);
+
+    /* removal */
+    if (pubsub_mask == YF_PUBSUB_NONE) {
+        set_snap(pub, NULL);
+        discard_defers(pub);
+        unlock();
+        return 0;
     }
 
-    val->pubsub_mask = pubsub_mask;
+    /* insertion/update */
+    if (snap != NULL && snap->pubsub_mask == pubsub_mask) {
+        unlock();
+        return 0;
+    }
 
+    snap_t *new_snap = copy_snap(snap, pubsub_mask);
+    if (new_snap == NULL || set_snap(pub, new_snap) != 0) {
+        free(new_snap);
+        unlock();
+        return -1;
+    }
+
+    unlock();
     return 0;
 }
 
@@ -117,30 +404,30 @@ unsigned yf_checkpub(const void *pub)
 {
     assert(pub != NULL);
 
-    if (pubs_ == NULL)
-        return YF_PUBSUB_NONE;
-
-    pub_t *val = yf_dict_search(pubs_, pub);
+    const unsigned e = enter();
+    const snap_t *snap = get_snap(pub);
+    const unsigned mask = snap != NULL ? snap->pubsub_mask : YF_PUBSUB_NONE;
+    leave(e);
 
-    return val != NULL ? val->pubsub_mask : YF_PUBSUB_NONE;
+    return mask;
 }
 
 void yf_publish(const void *pub, int pubsub)
 {
     assert(pub != NULL);
-    assert(pubs_ != NULL);
 
-    pub_t *val = yf_dict_search(pubs_, pub);
+    const unsigned e = enter();
+    const snap_t *snap = get_snap(pub);
 
-    if (val == NULL)
-        return;
-
-    yf_iter_t it = YF_NILIT;
-    sub_t *sub;
-    while ((sub = yf_dict_next(val->subs, &it, NULL)) != NULL) {
-        if (sub->pubsub_mask & pubsub)
-            sub->callb((void *)pub, pubsub, sub->arg);
+    if (snap != NULL) {
+        for (size_t i = 0; i < snap->n; i++) {
+            const sub_t *sub = snap->subs+i;
+            if (sub->pubsub_mask & pubsub)
+                sub->callb((void *)pub, pubsub, sub->arg);
+        }
     }
+
+    leave(e);
 }
 
 int yf_subscribe(const void *pub, const void *sub, unsigned pubsub_mask,
@@ -149,45 +436,159 @@ int yf_subscribe(const void *pub, const void *sub, unsigned pubsub_mask,
     assert(pub != NULL);
     assert(pubsub_mask == YF_PUBSUB_NONE || callb != NULL);
 
-    if (sub == NULL || pubs_ == NULL) {
+    if (sub == NULL) {
         yf_seterr(YF_ERR_INVARG, __func__);
         return -1;
     }
 
-    pub_t *pv = yf_dict_search(pubs_, pub);
+    if (lock() != 0)
+        return -1;
+
+    snap_t *snap = get_snap(pub);
 
-    if (pv == NULL)
+    if (snap == NULL) {
+        yf_seterr(YF_ERR_NOTFND, __func__);
+        unlock();
         return -1;
+    }
 
-    sub_t *sv = yf_dict_search(pv->subs, sub);
+    size_t sub_i = 0;
+    while (sub_i < snap->n && snap->subs[sub_i].sub != sub)
+        sub_i++;
 
     /* removal */
     if (pubsub_mask == YF_PUBSUB_NONE) {
-        if (sv != NULL) {
-            yf_dict_remove(pv->subs, sub);
-            free(sv);
+        if (sub_i == snap->n) {
+            unlock();
+            return 0;
         }
 
+        snap_t *new_snap = copy_snap(snap, snap->pubsub_mask);
+        if (new_snap == NULL) {
+            unlock();
+            return -1;
+        }
+        new_snap->subs[sub_i] = new_snap->subs[--new_snap->n];
+
+        /* the publisher exists, so this cannot fail */
+        set_snap(pub, new_snap);
+        unlock();
         return 0;
     }
 
     /* insertion/update */
-    if (sv == NULL) {
-        if ((sv = malloc(sizeof *sv)) == NULL) {
-            yf_seterr(YF_ERR_NOMEM, __func__);
-            return -1;
-        }
+    snap_t *new_snap = copy_snap(snap, snap->pubsub_mask);
+    if (new_snap == NULL) {
+        unlock();
+        return -1;
+    }
+    if (sub_i == new_snap->n)
+        new_snap->n++;
+
+    /* XXX: May want to compare pub/sub masks. */
+    new_snap->subs[sub_i] = (sub_t){
+        .sub = sub,
+        .pubsub_mask = pubsub_mask,
+        .callb = callb,
+        .arg = arg
+    };
+
+    set_snap(pub, new_snap);
+    unlock();
+    return 0;
+}
+
+int yf_deferpub(const void *pub, int pubsub)
+{
+    assert(pub != NULL);
+
+    if (pubsub == YF_PUBSUB_NONE || (pubsub & YF_PUBSUB_DEINIT)) {
+        yf_seterr(YF_ERR_INVARG, __func__);
+        return -1;
+    }
+
+    if (lock() != 0)
+        return -1;
+
+    if (queue_.pos == NULL && (queue_.pos = yf_dict_init(NULL, NULL)) == NULL) {
+        unlock();
+        return -1;
+    }
 
-        if (yf_dict_insert(pv->subs, sub, sv) != 0) {
-            free(sv);
+    /* repeated publications are merged into the pending one */
+    void *pos;
+    if (yf_dict_find(queue_.pos, pub, &pos)) {
+        queue_.defers[(size_t)pos-1].pubsub_mask |= pubsub;
+        unlock();
+        return 0;
+    }
+
+    if (queue_.n == queue_.cap) {
+        const size_t new_cap = queue_.cap < 32 ? 32 : queue_.cap << 1;
+        defer_t *defers = realloc(queue_.defers, new_cap * sizeof *defers);
+        if (defers == NULL) {
+            yf_seterr(YF_ERR_NOMEM, __func__);
+            unlock();
             return -1;
         }
+        queue_.defers = defers;
+        queue_.cap = new_cap;
     }
 
-    /* XXX: May want to compare pub/sub masks. */
-    sv->pubsub_mask = pubsub_mask;
-    sv->callb = callb;
-    sv->arg = arg;
+    if (yf_dict_insert(queue_.pos, pub, (void *)(queue_.n + 1)) != 0) {
+        unlock();
+        return -1;
+    }
+    queue_.defers[queue_.n++] = (defer_t){pub, pubsub};
 
+    unlock();
     return 0;
 }
+
+void yf_flushpub(void)
+{
+    if (lock() != 0)
+        return;
+
+    if (queue_.n == 0) {
+        unlock();
+        return;
+    }
+
+    /* publications deferred from within callbacks go to the next flush */
+    defer_t *defers = queue_.defers;
+    const size_t n = queue_.n;
+    const size_t cap = queue_.cap;
+
+    queue_.defers = queue_.spare;
+    queue_.cap = queue_.spare_cap;
+    queue_.n = 0;
+    queue_.spare = NULL;
+    queue_.spare_cap = 0;
+    yf_dict_reset(queue_.pos);
+
+    unlock();
+
+    for (size_t i = 0; i < n; i++) {
+        if (defers[i].pub == NULL)
+            continue;
+
+        /* one call per value, as in 'yf_publish()' */
+        for (unsigned m = defers[i].pubsub_mask; m != 0; m &= m - 1)
+            yf_publish(defers[i].pub, m & -m);
+    }
+
+    if (lock() != 0) {
+        free(defers);
+        return;
+    }
+
+    if (queue_.spare == NULL) {
+        queue_.spare = defers;
+        queue_.spare_cap = cap;
+    } else {
+        free(defers);
+    }
+
+    unlock();
+}
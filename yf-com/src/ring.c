@@ -0,0 +1,306 @@
+/*
+ * YF
+ * ring.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#ifndef __STDC_NO_ATOMICS__
+# include <stdatomic.h>
+#else
+# error "C11 atomics required"
+#endif
+
+#include "yf-ring.h"
+#include "yf-error.h"
+
+/* Size of a cache line.
+   Indices written by different threads are kept in separate lines. */
+#define YF_LINESZ 64
+
+struct yf_spsc {
+    /* producer's index and its copy of the consumer's */
+    _Alignas(YF_LINESZ) atomic_size_t tail;
+    size_t head_cache;
+
+    /* consumer's index and its copy of the producer's */
+    _Alignas(YF_LINESZ) atomic_size_t head;
+    size_t tail_cache;
+
+    _Alignas(YF_LINESZ) size_t mask;
+    size_t elem_sz;
+    unsigned char *data;
+};
+
+struct yf_mpmc {
+    _Alignas(YF_LINESZ) atomic_size_t tail;
+    _Alignas(YF_LINESZ) atomic_size_t head;
+
+    _Alignas(YF_LINESZ) size_t mask;
+    size_t elem_sz;
+    size_t cell_sz;
+    unsigned char *cells;
+};
+
+/* Cell of a multi-producer/multi-consumer ring.
+   The sequence number tells whether the cell is ready to be written or
+   read for a given position (Vyukov's bounded queue). */
+typedef struct {
+    atomic_size_t seq;
+    max_align_t data[];
+} cell_t;
+
+/* Rounds a capacity up to a power of two. */
+static int round_cap(size_t cap, size_t *dst)
+{
+    if (cap > (SIZE_MAX >> 1) + 1) {
+        yf_seterr(YF_ERR_OFLOW, __func__);
+        return -1;
+    }
+
+    size_t pow2 = 1;
+    while (pow2 < cap)
+        pow2 <<= 1;
+
+    *dst = pow2;
+    return 0;
+}
+
+/* Allocates zeroed memory aligned to the cache line size. */
+static void *alloc_aligned(size_t size)
+{
+    size = (size + YF_LINESZ - 1) & ~(size_t)(YF_LINESZ - 1);
+
+    void *p = aligned_alloc(YF_LINESZ, size);
+    if (p == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        return NULL;
+    }
+
+    memset(p, 0, size);
+    return p;
+}
+
+yf_spsc_t *yf_spsc_init(size_t elem_sz, size_t cap)
+{
+    if (elem_sz == 0 || cap == 0) {
+        yf_seterr(YF_ERR_INVARG, __func__);
+        return NULL;
+    }
+
+    if (round_cap(cap, &cap) != 0)
+        return NULL;
+
+    if (cap > SIZE_MAX / elem_sz - YF_LINESZ) {
+        yf_seterr(YF_ERR_OFLOW, __func__);
+        return NULL;
+    }
+
+    yf_spsc_t *ring = alloc_aligned(sizeof(yf_spsc_t));
+    if (ring == NULL)
+        return NULL;
+
+    if ((ring->data = alloc_aligned(cap * elem_sz)) == NULL) {
+        free(ring);
+        return NULL;
+    }
+
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->head, 0);
+    ring->mask = cap - 1;
+    ring->elem_sz = elem_sz;
+
+    return ring;
+}
+
+int yf_spsc_push(yf_spsc_t *ring, const void *elem)
+{
+    assert(ring != NULL);
+    assert(elem != NULL);
+
+    const size_t tail = atomic_load_explicit(&ring->tail,
+                                             memory_order_relaxed);
+
+    if (tail - ring->head_cache > ring->mask) {
+        ring->head_cache = atomic_load_explicit(&ring->head,
+                                                memory_order_acquire);
+        if (tail - ring->head_cache > ring->mask)
+            return -1;
+    }
+
+    memcpy(ring->data + (tail & ring->mask) * ring->elem_sz, elem,
+           ring->elem_sz);
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+
+    return 0;
+}
+
+int yf_spsc_pop(yf_spsc_t *ring, void *dst)
+{
+    assert(ring != NULL);
+    assert(dst != NULL);
+
+    const size_t head = atomic_load_explicit(&ring->head,
+                                             memory_order_relaxed);
+
+    if (head == ring->tail_cache) {
+        ring->tail_cache = atomic_load_explicit(&ring->tail,
+                                                memory_order_acquire);
+        if (head == ring->tail_cache)
+            return -1;
+    }
+
+    memcpy(dst, ring->data + (head & ring->mask) * ring->elem_sz,
+           ring->elem_sz);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    return 0;
+}
+
+size_t yf_spsc_getcap(yf_spsc_t *ring)
+{
+    assert(ring != NULL);
+    return ring->mask + 1;
+}
+
+void yf_spsc_deinit(yf_spsc_t *ring)
+{
+    if (ring == NULL)
+        return;
+
+    free(ring->data);
+    free(ring);
+}
+
+yf_mpmc_t *yf_mpmc_init(size_t elem_sz, size_t cap)
+{
+    if (elem_sz == 0 || cap == 0) {
+        yf_seterr(YF_ERR_INVARG, __func__);
+        return NULL;
+    }
+
+    /* a single cell cannot tell a full ring from an empty one */
+    if (round_cap(cap < 2 ? 2 : cap, &cap) != 0)
+        return NULL;
+
+    const size_t align = _Alignof(cell_t);
+    if (elem_sz > SIZE_MAX - sizeof(cell_t) - align) {
+        yf_seterr(YF_ERR_OFLOW, __func__);
+        return NULL;
+    }
+    const size_t cell_sz = (sizeof(cell_t) + elem_sz + align - 1) &
+                           ~(align - 1);
+    if (cap > SIZE_MAX / cell_sz - YF_LINESZ) {
+        yf_seterr(YF_ERR_OFLOW, __func__);
+        return NULL;
+    }
+
+    yf_mpmc_t *ring = alloc_aligned(sizeof(yf_mpmc_t));
+    if (ring == NULL)
+        return NULL;
+
+    if ((ring->cells = alloc_aligned(cap * cell_sz)) == NULL) {
+        free(ring);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < cap; i++)
+        atomic_init(&((cell_t *)(ring->cells + i * cell_sz))->seq, i);
+
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->head, 0);
+    ring->mask = cap - 1;
+    ring->elem_sz = elem_sz;
+    ring->cell_sz = cell_sz;
+
+    return ring;
+}
+
+int yf_mpmc_push(yf_mpmc_t *ring, const void *elem)
+{
+    assert(ring != NULL);
+    assert(elem != NULL);
+
+    size_t pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    cell_t *cell;
+
+    while (1) {
+        cell = (cell_t *)(ring->cells + (pos & ring->mask) * ring->cell_sz);
+        const size_t seq = atomic_load_explicit(&cell->seq,
+                                                memory_order_acquire);
+        const intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->tail, &pos,
+                                                      pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+                break;
+        } else if (dif < 0) {
+            /* the cell still holds the element of the previous lap */
+            return -1;
+        } else {
+            pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        }
+    }
+
+    memcpy(cell->data, elem, ring->elem_sz);
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+
+    return 0;
+}
+
+int yf_mpmc_pop(yf_mpmc_t *ring, void *dst)
+{
+    assert(ring != NULL);
+    assert(dst != NULL);
+
+    size_t pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    cell_t *cell;
+
+    while (1) {
+        cell = (cell_t *)(ring->cells + (pos & ring->mask) * ring->cell_sz);
+        const size_t seq = atomic_load_explicit(&cell->seq,
+                                                memory_order_acquire);
+        const intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->head, &pos,
+                                                      pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+                break;
+        } else if (dif < 0) {
+            /* the cell has not been written for this lap */
+            return -1;
+        } else {
+            pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        }
+    }
+
+    memcpy(dst, cell->data, ring->elem_sz);
+    atomic_store_explicit(&cell->seq, pos + ring->mask + 1,
+                          memory_order_release);
+
+    return 0;
+}
+
+size_t yf_mpmc_getcap(yf_mpmc_t *ring)
+{
+    assert(ring != NULL);
+    return ring->mask + 1;
+}
+
+void yf_mpmc_deinit(yf_mpmc_t *ring)
+{
+    if (ring == NULL)
+        return;
+
+    free(ring->cells);
+    free(ring);
+}
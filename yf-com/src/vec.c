@@ -0,0 +1,170 @@
+/*
+ * YF
+ * vec.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "yf-vec.h"
+#include "yf-error.h"
+
+/* Initial capacity. */
+#define YF_VECMIN 8
+
+struct yf_vec {
+    size_t elem_sz;
+    size_t n;
+    size_t cap;
+    unsigned char *data;
+};
+
+/* Resizes the storage of an array. */
+static int resize(yf_vec_t *vec, size_t new_cap)
+{
+    assert(new_cap >= vec->n);
+
+    if (new_cap > SIZE_MAX / vec->elem_sz) {
+        yf_seterr(YF_ERR_OFLOW, __func__);
+        return -1;
+    }
+
+    unsigned char *data = realloc(vec->data, new_cap * vec->elem_sz);
+    if (data == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        return -1;
+    }
+
+    vec->data = data;
+    vec->cap = new_cap;
+    return 0;
+}
+
+yf_vec_t *yf_vec_init(size_t elem_sz)
+{
+    if (elem_sz == 0) {
+        yf_seterr(YF_ERR_INVARG, __func__);
+        return NULL;
+    }
+
+    yf_vec_t *vec = calloc(1, sizeof(yf_vec_t));
+    if (vec == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        return NULL;
+    }
+
+    vec->elem_sz = elem_sz;
+    return vec;
+}
+
+int yf_vec_reserve(yf_vec_t *vec, size_t n)
+{
+    assert(vec != NULL);
+
+    if (n <= vec->cap)
+        return 0;
+
+    return resize(vec, n);
+}
+
+int yf_vec_push(yf_vec_t *vec, const void *elem)
+{
+    assert(vec != NULL);
+    assert(elem != NULL);
+
+    if (vec->n == vec->cap) {
+        const size_t cap = vec->cap < YF_VECMIN ? YF_VECMIN : vec->cap << 1;
+        if (cap <= vec->cap) {
+            yf_seterr(YF_ERR_OFLOW, __func__);
+            return -1;
+        }
+        if (resize(vec, cap) != 0)
+            return -1;
+    }
+
+    memcpy(vec->data + vec->n * vec->elem_sz, elem, vec->elem_sz);
+    vec->n++;
+    return 0;
+}
+
+int yf_vec_pop(yf_vec_t *vec, void *dst)
+{
+    assert(vec != NULL);
+
+    if (vec->n == 0) {
+        yf_seterr(YF_ERR_NOTFND, __func__);
+        return -1;
+    }
+
+    vec->n--;
+    if (dst != NULL)
+        memcpy(dst, vec->data + vec->n * vec->elem_sz, vec->elem_sz);
+
+    return 0;
+}
+
+void yf_vec_swaprm(yf_vec_t *vec, size_t i, void *dst)
+{
+    assert(vec != NULL);
+    assert(i < vec->n);
+
+    unsigned char *elem = vec->data + i * vec->elem_sz;
+
+    if (dst != NULL)
+        memcpy(dst, elem, vec->elem_sz);
+
+    if (--vec->n != i)
+        memcpy(elem, vec->data + vec->n * vec->elem_sz, vec->elem_sz);
+}
+
+void *yf_vec_get(yf_vec_t *vec, size_t i)
+{
+    assert(vec != NULL);
+    assert(i < vec->n);
+
+    return vec->data + i * vec->elem_sz;
+}
+
+void *yf_vec_getdata(yf_vec_t *vec, size_t *n)
+{
+    assert(vec != NULL);
+
+    if (n != NULL)
+        *n = vec->n;
+
+    return vec->data;
+}
+
+size_t yf_vec_getlen(yf_vec_t *vec)
+{
+    assert(vec != NULL);
+    return vec->n;
+}
+
+void yf_vec_sort(yf_vec_t *vec, yf_cmpfn_t cmp)
+{
+    assert(vec != NULL);
+    assert(cmp != NULL);
+
+    if (vec->n > 1)
+        qsort(vec->data, vec->n, vec->elem_sz, cmp);
+}
+
+void yf_vec_clear(yf_vec_t *vec)
+{
+    assert(vec != NULL);
+    vec->n = 0;
+}
+
+void yf_vec_deinit(yf_vec_t *vec)
+{
+    if (vec == NULL)
+        return;
+
+    free(vec->data);
+    free(vec);
+}
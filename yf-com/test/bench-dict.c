@@ -0,0 +1,353 @@
+/*
+ * YF
+ * bench-dict.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "test.h"
+#include "yf-dict.h"
+
+/* Chained dictionary used as reference.
+   This follows the layout of the previous 'yf_dict' implementation: one
+   array of pairs per bucket, multiply-shift hashing, and resizing when the
+   load leaves the [0.25, 0.75] range. */
+
+typedef struct {
+    const void *key;
+    const void *val;
+} pair_t;
+
+typedef struct {
+    pair_t *pairs;
+    size_t max_n;
+    size_t cur_n;
+} bucket_t;
+
+typedef struct {
+    yf_hashfn_t hash;
+    yf_cmpfn_t cmp;
+    bucket_t *buckets;
+    size_t w;
+    size_t count;
+    size_t a;
+    size_t b;
+} chained_t;
+
+#define YF_CHASH(ch, key, w) \
+    (((ch)->a*(ch)->hash(key)+(ch)->b) >> (sizeof(size_t)*8-(w)))
+
+static int chained_rehash(chained_t *ch, size_t new_w)
+{
+    bucket_t *buckets = calloc(1ULL << new_w, sizeof *buckets);
+    if (buckets == NULL)
+        return -1;
+
+    for (size_t i = 0; i < 1ULL << ch->w; i++) {
+        for (size_t j = 0; j < ch->buckets[i].cur_n; j++) {
+            const pair_t *pair = ch->buckets[i].pairs+j;
+            bucket_t *bucket = buckets + YF_CHASH(ch, pair->key, new_w);
+
+            if (bucket->cur_n == bucket->max_n) {
+                bucket->max_n = bucket->max_n == 0 ? 1 : bucket->max_n << 1;
+                bucket->pairs = realloc(bucket->pairs,
+                                        bucket->max_n * sizeof *pair);
+                assert(bucket->pairs != NULL);
+            }
+            bucket->pairs[bucket->cur_n++] = *pair;
+        }
+        free(ch->buckets[i].pairs);
+    }
+
+    free(ch->buckets);
+    ch->buckets = buckets;
+    ch->w = new_w;
+    return 0;
+}
+
+static int chained_insert(chained_t *ch, const void *key, const void *val)
+{
+    bucket_t *bucket = ch->buckets + YF_CHASH(ch, key, ch->w);
+
+    for (size_t i = 0; i < bucket->cur_n; i++) {
+        if (ch->cmp(bucket->pairs[i].key, key) == 0)
+            return -1;
+    }
+
+    if (bucket->cur_n == bucket->max_n) {
+        bucket->max_n = bucket->max_n == 0 ? 1 : bucket->max_n << 1;
+        bucket->pairs = realloc(bucket->pairs,
+                                bucket->max_n * sizeof *bucket->pairs);
+        assert(bucket->pairs != NULL);
+    }
+    bucket->pairs[bucket->cur_n++] = (pair_t){key, val};
+
+    if (++ch->count > (3ULL << ch->w) >> 2)
+        return chained_rehash(ch, ch->w + 1);
+    return 0;
+}
+
+static void *chained_search(chained_t *ch, const void *key)
+{
+    const bucket_t *bucket = ch->buckets + YF_CHASH(ch, key, ch->w);
+
+    for (size_t i = 0; i < bucket->cur_n; i++) {
+        if (ch->cmp(bucket->pairs[i].key, key) == 0)
+            return (void *)bucket->pairs[i].val;
+    }
+    return NULL;
+}
+
+static void *chained_remove(chained_t *ch, const void *key)
+{
+    bucket_t *bucket = ch->buckets + YF_CHASH(ch, key, ch->w);
+
+    for (size_t i = 0; i < bucket->cur_n; i++) {
+        if (ch->cmp(bucket->pairs[i].key, key) != 0)
+            continue;
+
+        const void *val = bucket->pairs[i].val;
+        bucket->pairs[i] = bucket->pairs[--bucket->cur_n];
+
+        if (--ch->count < (1ULL << ch->w) >> 2 && ch->w > 4)
+            chained_rehash(ch, ch->w - 1);
+        return (void *)val;
+    }
+    return NULL;
+}
+
+/* Gets the key of a given index. Keys resemble heap pointers. */
+#define YF_BKEY(i) ((const void *)(((uintptr_t)(i)+1) << 4))
+
+/* Gets a key that is not in the dictionary. */
+#define YF_BMISS(i) ((const void *)((((uintptr_t)(i)+1) << 4) | 8))
+
+/* Gets the next index of a pseudo-random sequence.
+   Searches use this order so that consecutive lookups do not benefit from
+   the insertion order. */
+#define YF_BNEXT(state, n) \
+    ((state) = (state) * 6364136223846793005ULL + 1442695040888963407ULL, \
+     (size_t)(((state) >> 33) % (n)))
+
+/* Defines benchmarks of a given function for dictionaries of 1e3 to 1e7
+   entries. Each is named after the function, suffixed by the size. */
+#define YF_BSWEEP(fn) \
+    int yf_##fn##1e3(yf_bench_t *bench) { return fn(bench, 1000); } \
+    int yf_##fn##1e4(yf_bench_t *bench) { return fn(bench, 10000); } \
+    int yf_##fn##1e5(yf_bench_t *bench) { return fn(bench, 100000); } \
+    int yf_##fn##1e6(yf_bench_t *bench) { return fn(bench, 1000000); } \
+    int yf_##fn##1e7(yf_bench_t *bench) { return fn(bench, 10000000); }
+
+/* Initializes a chained dictionary. */
+static int chained_init(chained_t *ch)
+{
+    *ch = (chained_t){
+        .hash = yf_hash,
+        .cmp = yf_cmp,
+        .w = 4,
+        .a = (size_t)0x9e3779b97f4a7c15ULL,
+        .b = 0x632be5ab
+    };
+    ch->buckets = calloc(1ULL << ch->w, sizeof *ch->buckets);
+    return ch->buckets == NULL ? -1 : 0;
+}
+
+/* Deinitializes a chained dictionary. */
+static void chained_deinit(chained_t *ch)
+{
+    for (size_t i = 0; i < 1ULL << ch->w; i++)
+        free(ch->buckets[i].pairs);
+    free(ch->buckets);
+}
+
+/* Fills a chained dictionary with a given number of keys. */
+static int chained_fill(chained_t *ch, size_t n)
+{
+    if (chained_init(ch) != 0)
+        return -1;
+
+    for (size_t i = 0; i < n; i++) {
+        if (chained_insert(ch, YF_BKEY(i), (void *)i) != 0) {
+            chained_deinit(ch);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Benchmarks insertion in the chained dictionary used as reference. */
+int yf_bench_chainedinsert(yf_bench_t *bench)
+{
+    chained_t ch;
+    if (chained_fill(&ch, bench->n) != 0)
+        return -1;
+
+    chained_deinit(&ch);
+    return 0;
+}
+
+/* Benchmarks search of random keys in a chained dictionary of a given
+   size. */
+static int bench_chainedsearch(yf_bench_t *bench, size_t size)
+{
+    chained_t ch;
+    if (chained_fill(&ch, size) != 0)
+        return -1;
+    yf_bench_reset(bench);
+
+    uint64_t state = bench->n;
+    size_t sum = 0;
+    for (size_t i = 0; i < bench->n; i++)
+        sum += (size_t)chained_search(&ch, YF_BKEY(YF_BNEXT(state, size)));
+    yf_bench_stop(bench);
+
+    chained_deinit(&ch);
+    return sum == SIZE_MAX;
+}
+
+/* Benchmarks search of missing keys in a chained dictionary of a given
+   size. */
+static int bench_chainedmiss(yf_bench_t *bench, size_t size)
+{
+    chained_t ch;
+    if (chained_fill(&ch, size) != 0)
+        return -1;
+    yf_bench_reset(bench);
+
+    uint64_t state = bench->n;
+    size_t sum = 0;
+    for (size_t i = 0; i < bench->n; i++)
+        sum += (size_t)chained_search(&ch, YF_BMISS(YF_BNEXT(state, size)));
+    yf_bench_stop(bench);
+
+    chained_deinit(&ch);
+    return sum != 0;
+}
+
+YF_BSWEEP(bench_chainedsearch)
+YF_BSWEEP(bench_chainedmiss)
+
+/* Benchmarks removal from the chained dictionary, including shrinking. */
+int yf_bench_chainedremove(yf_bench_t *bench)
+{
+    chained_t ch;
+    if (chained_fill(&ch, bench->n) != 0)
+        return -1;
+    yf_bench_reset(bench);
+
+    size_t sum = 0;
+    for (size_t i = 0; i < bench->n; i++)
+        sum += (size_t)chained_remove(&ch, YF_BKEY(i));
+
+    chained_deinit(&ch);
+
+    /* values are the indices of the keys */
+    return sum != bench->n * (bench->n - 1) / 2;
+}
+
+/* Fills a dictionary with a given number of keys. */
+static yf_dict_t *dict_fill(size_t n)
+{
+    yf_dict_t *dict = yf_dict_init(NULL, NULL);
+    if (dict == NULL)
+        return NULL;
+
+    for (size_t i = 0; i < n; i++) {
+        if (yf_dict_insert(dict, YF_BKEY(i), (void *)i) != 0) {
+            yf_dict_deinit(dict);
+            return NULL;
+        }
+    }
+    return dict;
+}
+
+/* Benchmarks dictionary insertion, including growth. */
+int yf_bench_dictinsert(yf_bench_t *bench)
+{
+    yf_dict_t *dict = dict_fill(bench->n);
+    if (dict == NULL)
+        return -1;
+
+    yf_dict_deinit(dict);
+    return 0;
+}
+
+/* Benchmarks dictionary insertion, rehashing incrementally. */
+int yf_bench_dictinsincr(yf_bench_t *bench)
+{
+    yf_dict_t *dict = yf_dict_init(NULL, NULL);
+    if (dict == NULL)
+        return -1;
+    yf_dict_setrehash(dict, YF_DICT_REHASH_INCR);
+
+    for (size_t i = 0; i < bench->n; i++) {
+        if (yf_dict_insert(dict, YF_BKEY(i), (void *)i) != 0) {
+            yf_dict_deinit(dict);
+            return -1;
+        }
+    }
+
+    yf_dict_deinit(dict);
+    return 0;
+}
+
+/* Benchmarks search of random keys in a dictionary of a given size. */
+static int bench_dictsearch(yf_bench_t *bench, size_t size)
+{
+    yf_dict_t *dict = dict_fill(size);
+    if (dict == NULL)
+        return -1;
+    yf_bench_reset(bench);
+
+    uint64_t state = bench->n;
+    size_t sum = 0;
+    for (size_t i = 0; i < bench->n; i++)
+        sum += (size_t)yf_dict_search(dict, YF_BKEY(YF_BNEXT(state, size)));
+    yf_bench_stop(bench);
+
+    yf_dict_deinit(dict);
+    return sum == SIZE_MAX;
+}
+
+/* Benchmarks search of missing keys in a dictionary of a given size. */
+static int bench_dictmiss(yf_bench_t *bench, size_t size)
+{
+    yf_dict_t *dict = dict_fill(size);
+    if (dict == NULL)
+        return -1;
+    yf_bench_reset(bench);
+
+    uint64_t state = bench->n;
+    size_t sum = 0;
+    for (size_t i = 0; i < bench->n; i++)
+        sum += yf_dict_contains(dict, YF_BMISS(YF_BNEXT(state, size)));
+    yf_bench_stop(bench);
+
+    yf_dict_deinit(dict);
+    return sum != 0;
+}
+
+YF_BSWEEP(bench_dictsearch)
+YF_BSWEEP(bench_dictmiss)
+
+/* Benchmarks dictionary removal. */
+int yf_bench_dictremove(yf_bench_t *bench)
+{
+    yf_dict_t *dict = dict_fill(bench->n);
+    if (dict == NULL)
+        return -1;
+    yf_bench_reset(bench);
+
+    size_t sum = 0;
+    for (size_t i = 0; i < bench->n; i++)
+        sum += (size_t)yf_dict_remove(dict, YF_BKEY(i));
+
+    const int r = sum != bench->n * (bench->n - 1) / 2 ||
+                  yf_dict_getlen(dict) != 0;
+    yf_dict_deinit(dict);
+    return r;
+}
@@ -0,0 +1,105 @@
+/*
+ * YF
+ * bench-hashfn.c
+ *
+ * Copyright © 2020 Gustavo C. Viegas.
+ */
+
+#include <stdint.h>
+
+#include "test.h"
+#include "yf-hashfn.h"
+
+/* Byte-wise FNV used as reference.
+   This is the hashing function that 'yf_hashv()' used previously. */
+static uint64_t fnv(const void *buf, size_t len)
+{
+    const unsigned char *b = buf;
+    uint64_t hash = 14695981039346656037ULL;
+
+    while (len--)
+        hash = hash * 1099511628211ULL ^ *b++;
+
+    return hash;
+}
+
+/* Destination of hash values, so that computations are not elided. */
+static volatile uint64_t sink_;
+
+/* Input length of the long input benchmarks. */
+#define YF_BHLEN 1024
+
+/* Input length of the short input benchmarks, typical of keys. */
+#define YF_BHSHORT 16
+
+/* Input of the benchmarks.
+   The offset changes on every iteration, so that results cannot be
+   reused. */
+static unsigned char buf_[YF_BHLEN + 64];
+
+/* Fills the input of the benchmarks. */
+static void fill_buf(void)
+{
+    for (size_t i = 0; i < sizeof buf_; i++)
+        buf_[i] = i * 31;
+}
+
+/* Benchmarks byte-wise hashing of long inputs, used as reference. */
+int yf_bench_fnv(yf_bench_t *bench)
+{
+    fill_buf();
+    yf_bench_reset(bench);
+
+    uint64_t sum = 0;
+    for (size_t i = 0; i < bench->n; i++)
+        sum += fnv(buf_ + (i & 63), YF_BHLEN);
+    sink_ = sum;
+
+    bench->bytes = YF_BHLEN;
+    return 0;
+}
+
+/* Benchmarks 'yf_hash64()' on long inputs. */
+int yf_bench_hash64(yf_bench_t *bench)
+{
+    fill_buf();
+    yf_bench_reset(bench);
+
+    uint64_t sum = 0;
+    for (size_t i = 0; i < bench->n; i++)
+        sum += yf_hash64(buf_ + (i & 63), YF_BHLEN, 0);
+    sink_ = sum;
+
+    bench->bytes = YF_BHLEN;
+    return 0;
+}
+
+/* Benchmarks byte-wise hashing of short inputs. */
+int yf_bench_fnvshort(yf_bench_t *bench)
+{
+    fill_buf();
+    yf_bench_reset(bench);
+
+    uint64_t sum = 0;
+    for (size_t i = 0; i < bench->n; i++)
+        sum += fnv(buf_ + (i & 63), YF_BHSHORT);
+    sink_ = sum;
+
+    bench->bytes = YF_BHSHORT;
+    return 0;
+}
+
+/* Benchmarks 'yf_hash64()' on short inputs. */
+int yf_bench_hash64short(yf_bench_t *bench)
+{
+    fill_buf();
+    yf_bench_reset(bench);
+
+    uint64_t sum = 0;
+    for (size_t i = 0; i < bench->n; i++)
+        sum += yf_hash64(buf_ + (i & 63), YF_BHSHORT, 0);
+    sink_ = sum;
+
+    bench->bytes = YF_BHSHORT;
+    return 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * YF
+ * bench-job.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "yf-job.h"
+
+/* Number of transforms computed per frame. */
+#define YF_BXFORMN 65536
+
+/* Number of transforms computed by each job. */
+#define YF_BGRAIN 512
+
+/* Column-major 4x4 matrix. */
+typedef float mat4_t[16];
+
+/* Local and world transforms, as computed for scene nodes. */
+static mat4_t locals_[YF_BXFORMN];
+static mat4_t worlds_[YF_BXFORMN];
+
+/* Multiplies two matrices. */
+static void mul(mat4_t dst, const mat4_t a, const mat4_t b)
+{
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            float s = 0.0f;
+            for (int k = 0; k < 4; k++)
+                s += a[k*4+j] * b[i*4+k];
+            dst[i*4+j] = s;
+        }
+    }
+}
+
+/* Computes world transforms of a range of nodes.
+   Every node goes through a fixed hierarchy depth, so that the work per
+   index is uniform. */
+static void compute(size_t beg, size_t end, YF_UNUSED void *arg)
+{
+    for (size_t i = beg; i < end; i++) {
+        mat4_t m, tmp;
+        for (int k = 0; k < 16; k++)
+            m[k] = locals_[i][k];
+
+        for (int d = 0; d < 8; d++) {
+            mul(tmp, locals_[(i * 31 + d) % YF_BXFORMN], m);
+            for (int k = 0; k < 16; k++)
+                m[k] = tmp[k];
+        }
+
+        for (int k = 0; k < 16; k++)
+            worlds_[i][k] = m[k];
+    }
+}
+
+/* Sums the world transforms, to check that every run has the same result. */
+static double sum_worlds(void)
+{
+    double s = 0.0;
+    for (size_t i = 0; i < YF_BXFORMN; i++)
+        s += worlds_[i][0] + worlds_[i][5] + worlds_[i][10] + worlds_[i][15];
+    return s;
+}
+
+/* Initializes the local transforms and computes the expected sum of the
+   world transforms. */
+static double init_xforms(void)
+{
+    srand(2);
+    for (size_t i = 0; i < YF_BXFORMN; i++) {
+        for (int k = 0; k < 16; k++)
+            locals_[i][k] = (k % 5 == 0 ? 1.0f : 0.0f) +
+                            ((float)rand() / RAND_MAX - 0.5f) * 0.01f;
+    }
+
+    compute(0, YF_BXFORMN, NULL);
+    return sum_worlds();
+}
+
+/* Benchmarks frames of transforms computed serially, used as reference. */
+int yf_bench_parforserial(yf_bench_t *bench)
+{
+    const double s_ref = init_xforms();
+    yf_bench_reset(bench);
+
+    for (size_t f = 0; f < bench->n; f++)
+        compute(0, YF_BXFORMN, NULL);
+
+    return sum_worlds() != s_ref;
+}
+
+/* Benchmarks frames of transforms computed by jobs on a given number of
+   threads, including the calling one. */
+static int bench_parfor(yf_bench_t *bench, unsigned thrd_n)
+{
+    const double s_ref = init_xforms();
+
+    if (yf_job_init(thrd_n - 1) != 0)
+        return -1;
+
+    /* warm up the workers */
+    yf_job_parfor(YF_BXFORMN, YF_BGRAIN, compute, NULL);
+    yf_bench_reset(bench);
+
+    for (size_t f = 0; f < bench->n; f++)
+        yf_job_parfor(YF_BXFORMN, YF_BGRAIN, compute, NULL);
+
+    yf_job_deinit();
+    return sum_worlds() != s_ref;
+}
+
+/* Benchmarks transforms computed by jobs on one thread. */
+int yf_bench_parfor1(yf_bench_t *bench)
+{
+    return bench_parfor(bench, 1);
+}
+
+/* Benchmarks transforms computed by jobs on two threads. */
+int yf_bench_parfor2(yf_bench_t *bench)
+{
+    return bench_parfor(bench, 2);
+}
+
+/* Benchmarks transforms computed by jobs on four threads. */
+int yf_bench_parfor4(yf_bench_t *bench)
+{
+    return bench_parfor(bench, 4);
+}
+
+/* Benchmarks transforms computed by jobs on a thread per CPU. */
+int yf_bench_parforall(yf_bench_t *bench)
+{
+    const long cpu_n = sysconf(_SC_NPROCESSORS_ONLN);
+    return bench_parfor(bench, cpu_n < 1 ? 1 : cpu_n);
+}
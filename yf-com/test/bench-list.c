@@ -0,0 +1,162 @@
+/*
+ * YF
+ * bench-list.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "test.h"
+#include "yf-list.h"
+
+/* Linked list used as reference.
+   This follows the previous 'yf_list' implementation, which allocated
+   every entry separately. */
+
+typedef struct mentry mentry_t;
+struct mentry {
+    mentry_t *prev;
+    mentry_t *next;
+    const void *val;
+};
+
+typedef struct {
+    mentry_t *first;
+    size_t n;
+} mlist_t;
+
+static void mlist_insert(mlist_t *ls, const void *val)
+{
+    mentry_t *e = malloc(sizeof *e);
+    assert(e != NULL);
+
+    e->val = val;
+    e->prev = NULL;
+    e->next = ls->first;
+    if (ls->first != NULL)
+        ls->first->prev = e;
+    ls->first = e;
+    ls->n++;
+}
+
+/* Not inlined, so that iteration costs the same call as 'yf_list_next()'. */
+__attribute__((noinline))
+static const void *mlist_next(mlist_t *ls, yf_iter_t *it)
+{
+    if (YF_IT_ISNIL(*it)) {
+        if (ls->first == NULL)
+            return NULL;
+        it->data[0] = (size_t)ls->first;
+        it->data[1] = ~it->data[0];
+        return ls->first->val;
+    }
+
+    const mentry_t *e = (const mentry_t *)it->data[0];
+    if (e->next == NULL) {
+        *it = YF_NILIT;
+        return NULL;
+    }
+    it->data[0] = (size_t)e->next;
+    it->data[1] = ~it->data[0];
+    return e->next->val;
+}
+
+static void mlist_clear(mlist_t *ls)
+{
+    mentry_t *e = ls->first;
+    while (e != NULL) {
+        mentry_t *next = e->next;
+        free(e);
+        e = next;
+    }
+
+    ls->first = NULL;
+    ls->n = 0;
+}
+
+/* Number of values inserted per frame. */
+#define YF_BLISTN 1024
+
+/* Gets the value inserted at a given index. */
+#define YF_BVAL(i) ((const void *)(((uintptr_t)(i)+1) << 4))
+
+/* Sum of the values inserted per frame. */
+#define YF_BSUM ((size_t)YF_BLISTN * (YF_BLISTN + 1) / 2 << 4)
+
+/* Destination of iteration results, so that iterations are not elided. */
+static volatile size_t sink_;
+
+/* Benchmarks frames of values inserted, iterated and cleared, as scene
+   objects are, using per-entry allocation. */
+int yf_bench_listmalloc(yf_bench_t *bench)
+{
+    mlist_t ml = {0};
+    size_t sum = 0;
+
+    for (size_t f = 0; f < bench->n; f++) {
+        for (size_t i = 0; i < YF_BLISTN; i++)
+            mlist_insert(&ml, YF_BVAL(i));
+
+        yf_iter_t it = YF_NILIT;
+        while (1) {
+            const void *val = mlist_next(&ml, &it);
+            if (YF_IT_ISNIL(it))
+                break;
+            sum += (size_t)val;
+        }
+
+        mlist_clear(&ml);
+    }
+
+    sink_ = sum;
+    return sum != YF_BSUM * bench->n;
+}
+
+/* Benchmarks frames of values using a given list storage mode. */
+static int bench_mode(yf_bench_t *bench, int mode)
+{
+    yf_list_t *ls = yf_list_init(NULL);
+    if (ls == NULL)
+        return -1;
+    if (yf_list_setmode(ls, mode) != 0) {
+        yf_list_deinit(ls);
+        return -1;
+    }
+    yf_bench_reset(bench);
+
+    size_t sum = 0;
+
+    for (size_t f = 0; f < bench->n; f++) {
+        for (size_t i = 0; i < YF_BLISTN; i++)
+            yf_list_insert(ls, YF_BVAL(i));
+
+        yf_iter_t it = YF_NILIT;
+        while (1) {
+            const void *val = yf_list_next(ls, &it);
+            if (YF_IT_ISNIL(it))
+                break;
+            sum += (size_t)val;
+        }
+
+        yf_list_clear(ls);
+    }
+
+    yf_list_deinit(ls);
+    sink_ = sum;
+    return sum != YF_BSUM * bench->n;
+}
+
+/* Benchmarks frames of values using linked storage. */
+int yf_bench_listlinked(yf_bench_t *bench)
+{
+    return bench_mode(bench, YF_LIST_LINKED);
+}
+
+/* Benchmarks frames of values using array storage. */
+int yf_bench_listarray(yf_bench_t *bench)
+{
+    return bench_mode(bench, YF_LIST_ARRAY);
+}
@@ -0,0 +1,225 @@
+/*
+ * YF
+ * bench-ring.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifndef __STDC_NO_THREADS__
+# include <threads.h>
+#else
+# error "C11 threads required"
+#endif
+
+#ifndef __STDC_NO_ATOMICS__
+# include <stdatomic.h>
+#else
+# error "C11 atomics required"
+#endif
+
+#include "test.h"
+#include "yf-ring.h"
+
+/* Ring protected by a mutex, used as reference. */
+typedef struct {
+    mtx_t mtx;
+    uint64_t *vals;
+    size_t mask;
+    size_t head;
+    size_t tail;
+} mring_t;
+
+static int mring_push(void *arg, const void *val)
+{
+    mring_t *ring = arg;
+    int r = -1;
+    mtx_lock(&ring->mtx);
+    if (ring->tail - ring->head <= ring->mask) {
+        ring->vals[ring->tail++ & ring->mask] = *(const uint64_t *)val;
+        r = 0;
+    }
+    mtx_unlock(&ring->mtx);
+    return r;
+}
+
+static int mring_pop(void *arg, void *dst)
+{
+    mring_t *ring = arg;
+    int r = -1;
+    mtx_lock(&ring->mtx);
+    if (ring->head != ring->tail) {
+        *(uint64_t *)dst = ring->vals[ring->head++ & ring->mask];
+        r = 0;
+    }
+    mtx_unlock(&ring->mtx);
+    return r;
+}
+
+/* Capacity of the rings. */
+#define YF_BRCAP 1024
+
+/* Ring operations. */
+typedef struct {
+    int (*push)(void *ring, const void *val);
+    int (*pop)(void *ring, void *dst);
+    void *ring;
+    unsigned cons_n;
+    uint64_t val_n;
+} ops_t;
+
+/* Sum of values popped by consumers. */
+static atomic_uint_least64_t sum_ = 0;
+
+/* Adapters to the 'ops_t' interface. */
+static int spsc_push(void *ring, const void *val)
+{
+    return yf_spsc_push(ring, val);
+}
+
+static int spsc_pop(void *ring, void *dst)
+{
+    return yf_spsc_pop(ring, dst);
+}
+
+static int mpmc_push(void *ring, const void *val)
+{
+    return yf_mpmc_push(ring, val);
+}
+
+static int mpmc_pop(void *ring, void *dst)
+{
+    return yf_mpmc_pop(ring, dst);
+}
+
+/* Producer thread. */
+static int produce(void *arg)
+{
+    ops_t *ops = arg;
+
+    for (uint64_t i = 1; i <= ops->val_n; i++) {
+        while (ops->push(ops->ring, &i) != 0)
+            thrd_yield();
+    }
+
+    return 0;
+}
+
+/* Consumer thread. */
+static int consume(void *arg)
+{
+    ops_t *ops = arg;
+    uint64_t sum = 0;
+    uint64_t val;
+
+    while (1) {
+        if (ops->pop(ops->ring, &val) != 0) {
+            thrd_yield();
+            continue;
+        }
+        if (val == 0)
+            break;
+        sum += val;
+    }
+
+    atomic_fetch_add(&sum_, sum);
+    return 0;
+}
+
+/* Runs producers and consumers, each producer pushing a share of the
+   benchmark's values. */
+static int run(yf_bench_t *bench, ops_t *ops, unsigned prod_n)
+{
+    thrd_t thrds[8];
+    const unsigned n = prod_n + ops->cons_n;
+    ops->val_n = (bench->n + prod_n - 1) / prod_n;
+    atomic_store(&sum_, 0);
+    yf_bench_reset(bench);
+
+    for (unsigned i = 0; i < n; i++) {
+        if (thrd_create(thrds+i, i < prod_n ? produce : consume,
+                        ops) != thrd_success)
+            return -1;
+    }
+    for (unsigned i = 0; i < prod_n; i++)
+        thrd_join(thrds[i], NULL);
+
+    /* one terminator for each consumer, after every value */
+    const uint64_t end = 0;
+    for (unsigned i = 0; i < ops->cons_n; i++) {
+        while (ops->push(ops->ring, &end) != 0)
+            thrd_yield();
+    }
+    for (unsigned i = prod_n; i < n; i++)
+        thrd_join(thrds[i], NULL);
+
+    const uint64_t expct = ops->val_n * (ops->val_n + 1) / 2 * prod_n;
+    return atomic_load(&sum_) != expct;
+}
+
+/* Benchmarks a mutex-protected ring with a given number of producers and
+   consumers, used as reference. */
+static int bench_mutex(yf_bench_t *bench, unsigned thrd_n)
+{
+    mring_t mring = {0};
+    if (mtx_init(&mring.mtx, mtx_plain) != thrd_success)
+        return -1;
+    mring.vals = malloc(YF_BRCAP * sizeof *mring.vals);
+    mring.mask = YF_BRCAP - 1;
+
+    int r = -1;
+    if (mring.vals != NULL) {
+        ops_t ops = {mring_push, mring_pop, &mring, thrd_n, 0};
+        r = run(bench, &ops, thrd_n);
+    }
+
+    free(mring.vals);
+    mtx_destroy(&mring.mtx);
+    return r;
+}
+
+/* Benchmarks values passed through a mutex-protected ring, with one
+   producer and one consumer. */
+int yf_bench_ringmutex1(yf_bench_t *bench)
+{
+    return bench_mutex(bench, 1);
+}
+
+/* Benchmarks values passed through a mutex-protected ring, with four
+   producers and four consumers. */
+int yf_bench_ringmutex4(yf_bench_t *bench)
+{
+    return bench_mutex(bench, 4);
+}
+
+/* Benchmarks values passed through a single-producer, single-consumer
+   ring. */
+int yf_bench_ringspsc(yf_bench_t *bench)
+{
+    yf_spsc_t *spsc = yf_spsc_init(sizeof(uint64_t), YF_BRCAP);
+    if (spsc == NULL)
+        return -1;
+
+    ops_t ops = {spsc_push, spsc_pop, spsc, 1, 0};
+    const int r = run(bench, &ops, 1);
+
+    yf_spsc_deinit(spsc);
+    return r;
+}
+
+/* Benchmarks values passed through a multi-producer, multi-consumer ring,
+   with four producers and four consumers. */
+int yf_bench_ringmpmc4(yf_bench_t *bench)
+{
+    yf_mpmc_t *mpmc = yf_mpmc_init(sizeof(uint64_t), YF_BRCAP);
+    if (mpmc == NULL)
+        return -1;
+
+    ops_t ops = {mpmc_push, mpmc_pop, mpmc, 4, 0};
+    const int r = run(bench, &ops, 4);
+
+    yf_mpmc_deinit(mpmc);
+    return r;
+}
@@ -10,31 +10,191 @@
 int yf_test_error(void);
 int yf_test_clock(void);
 int yf_test_list(void);
+int yf_test_vec(void);
+int yf_test_arena(void);
 int yf_test_dict(void);
+int yf_test_hashfn(void);
 int yf_test_pubsub(void);
+int yf_test_job(void);
+int yf_test_ring(void);
+int yf_test_prof(void);
+int yf_test_mem(void);
+int yf_test_cdict(void);
+
+int yf_bench_listmalloc(yf_bench_t *bench);
+int yf_bench_listlinked(yf_bench_t *bench);
+int yf_bench_listarray(yf_bench_t *bench);
+int yf_bench_chainedinsert(yf_bench_t *bench);
+int yf_bench_chainedsearch1e3(yf_bench_t *bench);
+int yf_bench_chainedsearch1e4(yf_bench_t *bench);
+int yf_bench_chainedsearch1e5(yf_bench_t *bench);
+int yf_bench_chainedsearch1e6(yf_bench_t *bench);
+int yf_bench_chainedsearch1e7(yf_bench_t *bench);
+int yf_bench_chainedmiss1e3(yf_bench_t *bench);
+int yf_bench_chainedmiss1e4(yf_bench_t *bench);
+int yf_bench_chainedmiss1e5(yf_bench_t *bench);
+int yf_bench_chainedmiss1e6(yf_bench_t *bench);
+int yf_bench_chainedmiss1e7(yf_bench_t *bench);
+int yf_bench_chainedremove(yf_bench_t *bench);
+int yf_bench_dictinsert(yf_bench_t *bench);
+int yf_bench_dictinsincr(yf_bench_t *bench);
+int yf_bench_dictsearch1e3(yf_bench_t *bench);
+int yf_bench_dictsearch1e4(yf_bench_t *bench);
+int yf_bench_dictsearch1e5(yf_bench_t *bench);
+int yf_bench_dictsearch1e6(yf_bench_t *bench);
+int yf_bench_dictsearch1e7(yf_bench_t *bench);
+int yf_bench_dictmiss1e3(yf_bench_t *bench);
+int yf_bench_dictmiss1e4(yf_bench_t *bench);
+int yf_bench_dictmiss1e5(yf_bench_t *bench);
+int yf_bench_dictmiss1e6(yf_bench_t *bench);
+int yf_bench_dictmiss1e7(yf_bench_t *bench);
+int yf_bench_dictremove(yf_bench_t *bench);
+int yf_bench_fnv(yf_bench_t *bench);
+int yf_bench_hash64(yf_bench_t *bench);
+int yf_bench_fnvshort(yf_bench_t *bench);
+int yf_bench_hash64short(yf_bench_t *bench);
+int yf_bench_parforserial(yf_bench_t *bench);
+int yf_bench_parfor1(yf_bench_t *bench);
+int yf_bench_parfor2(yf_bench_t *bench);
+int yf_bench_parfor4(yf_bench_t *bench);
+int yf_bench_parforall(yf_bench_t *bench);
+int yf_bench_ringmutex1(yf_bench_t *bench);
+int yf_bench_ringspsc(yf_bench_t *bench);
+int yf_bench_ringmutex4(yf_bench_t *bench);
+int yf_bench_ringmpmc4(yf_bench_t *bench);
 
 static const char *ids_[] = {
     "error",
     "clock",
     "list",
+    "vec",
+    "arena",
     "dict",
-    "pubsub"
+    "hashfn",
+    "pubsub",
+    "job",
+    "ring",
+    "prof",
+    "mem",
+    "cdict"
 };
 
 static int (*fns_[])(void) = {
     yf_test_error,
     yf_test_clock,
     yf_test_list,
+    yf_test_vec,
+    yf_test_arena,
     yf_test_dict,
-    yf_test_pubsub
+    yf_test_hashfn,
+    yf_test_pubsub,
+    yf_test_job,
+    yf_test_ring,
+    yf_test_prof,
+    yf_test_mem,
+    yf_test_cdict
 };
 
 _Static_assert(sizeof ids_ / sizeof *ids_ == sizeof fns_ / sizeof *fns_,
                "!sizeof");
 
+static const char *bench_ids_[] = {
+    "list-malloc",
+    "list-linked",
+    "list-array",
+    "chained-insert",
+    "chained-search-1e3",
+    "chained-search-1e4",
+    "chained-search-1e5",
+    "chained-search-1e6",
+    "chained-search-1e7",
+    "chained-miss-1e3",
+    "chained-miss-1e4",
+    "chained-miss-1e5",
+    "chained-miss-1e6",
+    "chained-miss-1e7",
+    "chained-remove",
+    "dict-insert",
+    "dict-insert-incr",
+    "dict-search-1e3",
+    "dict-search-1e4",
+    "dict-search-1e5",
+    "dict-search-1e6",
+    "dict-search-1e7",
+    "dict-miss-1e3",
+    "dict-miss-1e4",
+    "dict-miss-1e5",
+    "dict-miss-1e6",
+    "dict-miss-1e7",
+    "dict-remove",
+    "fnv",
+    "hash64",
+    "fnv-short",
+    "hash64-short",
+    "parfor-serial",
+    "parfor-1",
+    "parfor-2",
+    "parfor-4",
+    "parfor-all",
+    "ring-mutex",
+    "ring-spsc",
+    "ring-mutex4",
+    "ring-mpmc4"
+};
+
+static int (*bench_fns_[])(yf_bench_t *) = {
+    yf_bench_listmalloc,
+    yf_bench_listlinked,
+    yf_bench_listarray,
+    yf_bench_chainedinsert,
+    yf_bench_chainedsearch1e3,
+    yf_bench_chainedsearch1e4,
+    yf_bench_chainedsearch1e5,
+    yf_bench_chainedsearch1e6,
+    yf_bench_chainedsearch1e7,
+    yf_bench_chainedmiss1e3,
+    yf_bench_chainedmiss1e4,
+    yf_bench_chainedmiss1e5,
+    yf_bench_chainedmiss1e6,
+    yf_bench_chainedmiss1e7,
+    yf_bench_chainedremove,
+    yf_bench_dictinsert,
+    yf_bench_dictinsincr,
+    yf_bench_dictsearch1e3,
+    yf_bench_dictsearch1e4,
+    yf_bench_dictsearch1e5,
+    yf_bench_dictsearch1e6,
+    yf_bench_dictsearch1e7,
+    yf_bench_dictmiss1e3,
+    yf_bench_dictmiss1e4,
+    yf_bench_dictmiss1e5,
+    yf_bench_dictmiss1e6,
+    yf_bench_dictmiss1e7,
+    yf_bench_dictremove,
+    yf_bench_fnv,
+    yf_bench_hash64,
+    yf_bench_fnvshort,
+    yf_bench_hash64short,
+    yf_bench_parforserial,
+    yf_bench_parfor1,
+    yf_bench_parfor2,
+    yf_bench_parfor4,
+    yf_bench_parforall,
+    yf_bench_ringmutex1,
+    yf_bench_ringspsc,
+    yf_bench_ringmutex4,
+    yf_bench_ringmpmc4
+};
+
+_Static_assert(sizeof bench_ids_ / sizeof *bench_ids_ ==
+               sizeof bench_fns_ / sizeof *bench_fns_, "!sizeof");
+
 const yf_test_t yf_g_test = {
     .name = "com",
     .ids = ids_,
     .fns = fns_,
-    .n = sizeof ids_ / sizeof *ids_
+    .n = sizeof ids_ / sizeof *ids_,
+    .bench_ids = bench_ids_,
+    .bench_fns = bench_fns_,
+    .bench_n = sizeof bench_ids_ / sizeof *bench_ids_
 };
@@ -0,0 +1,174 @@
+/*
+ * YF
+ * test-arena.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef __STDC_NO_THREADS__
+# include <threads.h>
+#else
+# error "C11 threads required"
+#endif
+
+#include "test.h"
+#include "yf-arena.h"
+#include "yf-error.h"
+
+/* Number of simulated frames. */
+#define YF_AFRAMES 8
+
+/* Checks that a pointer is suitably aligned for any type. */
+#define YF_AALIGNED(p) ((uintptr_t)(p) % _Alignof(max_align_t) == 0)
+
+/* Allocates memory as a frame would, returning the first allocation. */
+static void *frame(yf_arena_t *arena)
+{
+    unsigned char *first = NULL;
+
+    for (size_t i = 1; i <= 64; i++) {
+        unsigned char *p = yf_arena_alloc(arena, i * 37);
+        if (p == NULL || !YF_AALIGNED(p))
+            return NULL;
+        memset(p, (int)i, i * 37);
+        if (first == NULL)
+            first = p;
+    }
+
+    /* larger than any block obtained so far */
+    if (yf_arena_alloc(arena, 100000) == NULL)
+        return NULL;
+
+    return first;
+}
+
+/* Thread function that checks the thread arena. */
+static int thrd_fn(void *arg)
+{
+    yf_arena_t *arena = yf_arena_getthrd();
+    if (arena == NULL || arena == arg || arena != yf_arena_getthrd())
+        return -1;
+
+    const size_t mark = yf_arena_getmark(arena);
+    if (frame(arena) == NULL)
+        return -1;
+    yf_arena_reset(arena, mark);
+
+    return 0;
+}
+
+/* Tests arena. */
+int yf_test_arena(void)
+{
+    YF_TEST_PRINT("init", "0", "arena");
+    yf_arena_t *arena = yf_arena_init(0);
+    if (arena == NULL || yf_arena_getmark(arena) != 0)
+        return -1;
+
+    YF_TEST_PRINT("alloc", "arena, 1", "p1");
+    unsigned char *p1 = yf_arena_alloc(arena, 1);
+    if (p1 == NULL || !YF_AALIGNED(p1))
+        return -1;
+    *p1 = 0xff;
+
+    YF_TEST_PRINT("getmark", "arena", "mark");
+    const size_t mark = yf_arena_getmark(arena);
+    if (mark == 0)
+        return -1;
+
+    YF_TEST_PRINT("calloc", "arena, 10, sizeof(int)", "p2");
+    int *p2 = yf_arena_calloc(arena, 10, sizeof(int));
+    if (p2 == NULL || !YF_AALIGNED(p2) || (unsigned char *)p2 == p1)
+        return -1;
+    for (int i = 0; i < 10; i++) {
+        if (p2[i] != 0)
+            return -1;
+        p2[i] = i;
+    }
+
+    YF_TEST_PRINT("realloc", "arena, p2, 10*sizeof(int), 20*sizeof(int)",
+                  "p2");
+    if (yf_arena_realloc(arena, p2, 10 * sizeof(int),
+                         20 * sizeof(int)) != p2)
+        return -1;
+
+    YF_TEST_PRINT("alloc", "arena, 1", "p3");
+    unsigned char *p3 = yf_arena_alloc(arena, 1);
+    if (p3 == NULL || p3 < (unsigned char *)(p2+20))
+        return -1;
+
+    YF_TEST_PRINT("realloc", "arena, p2, 20*sizeof(int), 40*sizeof(int)",
+                  "p4");
+    int *p4 = yf_arena_realloc(arena, p2, 20 * sizeof(int),
+                               40 * sizeof(int));
+    if (p4 == NULL || p4 == p2)
+        return -1;
+    for (int i = 0; i < 10; i++) {
+        if (p4[i] != i)
+            return -1;
+    }
+
+    YF_TEST_PRINT("calloc", "arena, SIZE_MAX, 2", "NULL");
+    if (yf_arena_calloc(arena, SIZE_MAX, 2) != NULL ||
+        yf_geterr() != YF_ERR_OFLOW)
+        return -1;
+
+    YF_TEST_PRINT("reset", "arena, mark", "");
+    yf_arena_reset(arena, mark);
+    if (yf_arena_getmark(arena) != mark || *p1 != 0xff ||
+        yf_arena_alloc(arena, 1) != (void *)p2)
+        return -1;
+
+    YF_TEST_PRINT("reset", "arena, 0", "");
+    yf_arena_reset(arena, 0);
+    if (yf_arena_getmark(arena) != 0)
+        return -1;
+
+    YF_TEST_PRINT("alloc", "arena, <frames>", "");
+    void *first = NULL;
+    size_t end = 0;
+    for (int i = 0; i < YF_AFRAMES; i++) {
+        const size_t beg = yf_arena_getmark(arena);
+        void *p = frame(arena);
+        if (p == NULL)
+            return -1;
+
+        /* once grown, the arena is expected to reuse the same memory */
+        if (i == YF_AFRAMES / 2) {
+            first = p;
+            end = yf_arena_getmark(arena);
+        } else if (i > YF_AFRAMES / 2 &&
+                   (p != first || yf_arena_getmark(arena) != end)) {
+            return -1;
+        }
+
+        yf_arena_reset(arena, beg);
+    }
+
+    YF_TEST_PRINT("deinit", "arena", "");
+    yf_arena_deinit(arena);
+
+    YF_TEST_PRINT("getthrd", "", "thrd");
+    yf_arena_t *thrd = yf_arena_getthrd();
+    if (thrd == NULL || thrd != yf_arena_getthrd())
+        return -1;
+
+    YF_TEST_PRINT("getthrd", "<4 threads>", "");
+    thrd_t thrds[4];
+    for (int i = 0; i < 4; i++) {
+        if (thrd_create(thrds+i, thrd_fn, thrd) != thrd_success)
+            return -1;
+    }
+    int r = 0;
+    for (int i = 0; i < 4; i++) {
+        int res;
+        if (thrd_join(thrds[i], &res) != thrd_success || res != 0)
+            r = -1;
+    }
+
+    return r;
+}
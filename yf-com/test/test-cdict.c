@@ -0,0 +1,180 @@
+/*
+ * YF
+ * test-cdict.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef __STDC_NO_THREADS__
+# include <threads.h>
+#else
+# error "C11 threads required"
+#endif
+
+#ifndef __STDC_NO_ATOMICS__
+# include <stdatomic.h>
+#else
+# error "C11 atomics required"
+#endif
+
+#include "test.h"
+#include "yf-cdict.h"
+#include "yf-error.h"
+
+/* Number of threads in the stress test. */
+#define YF_CDTHRDN 8
+
+/* Number of keys in the stress test. */
+#define YF_CDKEYN 4096
+
+/* Values created by 'make' in the stress test. */
+static uintptr_t vals_[YF_CDKEYN];
+static atomic_uint make_n_;
+
+/* Shared dictionary of the stress test. */
+static yf_cdict_t *cdict_ = NULL;
+
+/* 'cdict_findins()' callback. */
+static void *make(const void *key, const void **new_key, void *arg)
+{
+    const uintptr_t k = (uintptr_t)key;
+
+    if (arg != NULL) {
+        yf_seterr(YF_ERR_OTHER, "make");
+        return NULL;
+    }
+
+    atomic_fetch_add(&make_n_, 1);
+    vals_[k-1] = k * 3;
+    *new_key = key;
+    return vals_+k-1;
+}
+
+/* Looks up all keys, creating the missing ones. */
+static int find_all(void *arg)
+{
+    const size_t off = (uintptr_t)arg;
+
+    for (size_t i = 0; i < YF_CDKEYN; i++) {
+        const uintptr_t k = (i + off) % YF_CDKEYN + 1;
+        const uintptr_t *val = yf_cdict_findins(cdict_, (void *)k, make,
+                                                NULL);
+        if (val == NULL || *val != k * 3)
+            return -1;
+        if (yf_cdict_search(cdict_, (void *)k) != val)
+            return -1;
+    }
+
+    return 0;
+}
+
+/* 'cdict_each()' callback. */
+static int cdict_cb(YF_UNUSED void *key, YF_UNUSED void *val, void *arg)
+{
+    return ++*(size_t *)arg == 2;
+}
+
+/* Tests concurrent dictionary. */
+int yf_test_cdict(void)
+{
+    YF_TEST_PRINT("init", "NULL, NULL", "cdict");
+    yf_cdict_t *cdict = yf_cdict_init(NULL, NULL);
+    if (cdict == NULL || yf_cdict_getlen(cdict) != 0)
+        return -1;
+
+    const void *key1 = (const void *)1UL;
+    const void *key2 = (const void *)2UL;
+    const void *key3 = (const void *)3UL;
+    const char *val;
+
+    YF_TEST_PRINT("insert", "cdict, key1, \"a\"", "");
+    if (yf_cdict_insert(cdict, key1, "a") != 0 ||
+        !yf_cdict_contains(cdict, key1) || yf_cdict_getlen(cdict) != 1)
+        return -1;
+
+    YF_TEST_PRINT("insert", "cdict, key1, \"b\"", "");
+    if (yf_cdict_insert(cdict, key1, "b") == 0 ||
+        yf_geterr() != YF_ERR_EXIST || yf_cdict_getlen(cdict) != 1)
+        return -1;
+
+    YF_TEST_PRINT("findins", "cdict, key1, make, NULL", "\"a\"");
+    val = yf_cdict_findins(cdict, key1, make, NULL);
+    if (val == NULL || strcmp(val, "a") != 0 ||
+        atomic_load(&make_n_) != 0)
+        return -1;
+
+    YF_TEST_PRINT("findins", "cdict, key2, make, NULL", "&vals_[1]");
+    val = yf_cdict_findins(cdict, key2, make, NULL);
+    if (val != (void *)(vals_+1) || vals_[1] != 6 ||
+        atomic_load(&make_n_) != 1 || yf_cdict_getlen(cdict) != 2)
+        return -1;
+
+    YF_TEST_PRINT("findins", "cdict, key3, make, (fail)", "NULL");
+    val = yf_cdict_findins(cdict, key3, make, (void *)1);
+    if (val != NULL || yf_geterr() != YF_ERR_OTHER ||
+        yf_cdict_contains(cdict, key3) || yf_cdict_getlen(cdict) != 2)
+        return -1;
+
+    YF_TEST_PRINT("search", "cdict, key3", "NULL");
+    if (yf_cdict_search(cdict, key3) != NULL ||
+        yf_geterr() != YF_ERR_NOTFND)
+        return -1;
+
+    YF_TEST_PRINT("each", "cdict, cdict_cb, &n", "");
+    size_t n = 0;
+    yf_cdict_each(cdict, cdict_cb, &n);
+    if (n != 2)
+        return -1;
+
+    YF_TEST_PRINT("remove", "cdict, key1", "\"a\"");
+    val = yf_cdict_remove(cdict, key1);
+    if (val == NULL || strcmp(val, "a") != 0 ||
+        yf_cdict_contains(cdict, key1) || yf_cdict_getlen(cdict) != 1)
+        return -1;
+
+    YF_TEST_PRINT("remove", "cdict, key1", "NULL");
+    if (yf_cdict_remove(cdict, key1) != NULL ||
+        yf_geterr() != YF_ERR_NOTFND)
+        return -1;
+
+    YF_TEST_PRINT("clear", "cdict", "");
+    yf_cdict_clear(cdict);
+    if (yf_cdict_getlen(cdict) != 0 || yf_cdict_contains(cdict, key2))
+        return -1;
+
+    YF_TEST_PRINT("deinit", "cdict", "");
+    yf_cdict_deinit(cdict);
+
+    YF_TEST_PRINT("findins", "(8 threads)", "");
+    if ((cdict_ = yf_cdict_init(NULL, NULL)) == NULL)
+        return -1;
+    atomic_store(&make_n_, 0);
+    memset(vals_, 0, sizeof vals_);
+
+    thrd_t thrds[YF_CDTHRDN];
+    for (size_t i = 0; i < YF_CDTHRDN; i++) {
+        const uintptr_t off = i * (YF_CDKEYN / YF_CDTHRDN);
+        if (thrd_create(thrds+i, find_all, (void *)off) != thrd_success)
+            return -1;
+    }
+    int failed = 0;
+    for (size_t i = 0; i < YF_CDTHRDN; i++) {
+        int res;
+        if (thrd_join(thrds[i], &res) != thrd_success || res != 0)
+            failed = 1;
+    }
+
+    /* each key must have been created exactly once */
+    if (failed || atomic_load(&make_n_) != YF_CDKEYN ||
+        yf_cdict_getlen(cdict_) != YF_CDKEYN)
+        return -1;
+
+    yf_cdict_deinit(cdict_);
+    cdict_ = NULL;
+
+    return 0;
+}
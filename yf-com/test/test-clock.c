@@ -6,9 +6,141 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
 
 #include "test.h"
 #include "yf-clock.h"
+#include "yf-error.h"
+
+/* Number of short waits whose median lateness is checked. */
+#define YF_CLKWAITN 31
+
+/* Maximum median lateness accepted from 'waituntil', in nanoseconds.
+   A single wait can be late by any amount if the thread is preempted,
+   so only the median of many waits is checked against this bound. */
+#define YF_CLKLATE 2000000
+
+/* Compares two 'uint64_t' values. */
+static int cmp_u64(const void *a, const void *b)
+{
+    const uint64_t x = *(const uint64_t *)a;
+    const uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* Tests nanosecond clock and waiting. */
+static int test_ns(void)
+{
+    char s[256] = {0};
+
+    const uint64_t t1 = yf_getns();
+    snprintf(s, sizeof s, "%" PRIu64, t1);
+    YF_TEST_PRINT("getns", "", s);
+
+    const uint64_t t2 = yf_getns();
+    snprintf(s, sizeof s, "%" PRIu64, t2);
+    YF_TEST_PRINT("getns", "", s);
+
+    if (t2 < t1)
+        return -1;
+
+    /* must agree with the system clock */
+    const double tm = yf_gettime();
+    yf_sleep(0.05);
+    const double dtm = yf_gettime() - tm;
+    const double dns = (double)(yf_getns() - t2) * 1.0e-9;
+    printf("\n- elapsed time: %.10fs (gettime), %.10fs (getns) -\n\n",
+           dtm, dns);
+    if (dns < 0.05 || dns > dtm + 0.005)
+        return -1;
+
+    const uint64_t ts[] = {16666667, 1000000, 5000000, 16666667, 33333333};
+    for (size_t i = 0; i < (sizeof ts / sizeof *ts); i++) {
+        snprintf(s, sizeof s, "<now + %" PRIu64 "ns>", ts[i]);
+        YF_TEST_PRINT("waituntil", s, "");
+        const uint64_t dl = yf_getns() + ts[i];
+        yf_waituntil(dl);
+        const uint64_t now = yf_getns();
+        if (now < dl)
+            return -1;
+        printf("\n- late by: %" PRIu64 "ns -\n\n", now - dl);
+    }
+
+    uint64_t lates[YF_CLKWAITN];
+    snprintf(s, sizeof s, "<now + 1000000ns> (x%d)", YF_CLKWAITN);
+    YF_TEST_PRINT("waituntil", s, "");
+    for (size_t i = 0; i < YF_CLKWAITN; i++) {
+        const uint64_t dl = yf_getns() + 1000000;
+        yf_waituntil(dl);
+        const uint64_t now = yf_getns();
+        if (now < dl)
+            return -1;
+        lates[i] = now - dl;
+    }
+    qsort(lates, YF_CLKWAITN, sizeof *lates, cmp_u64);
+    printf("\n- late by: %" PRIu64 "ns (median), %" PRIu64 "ns (max) -\n\n",
+           lates[YF_CLKWAITN/2], lates[YF_CLKWAITN-1]);
+    if (lates[YF_CLKWAITN/2] > YF_CLKLATE)
+        return -1;
+
+    return 0;
+}
+
+/* Tests frame time histogram. */
+static int test_frmhist(void)
+{
+    YF_TEST_PRINT("frmhist_init", "0", "NULL");
+    if (yf_frmhist_init(0) != NULL || yf_geterr() != YF_ERR_INVARG)
+        return -1;
+
+    YF_TEST_PRINT("frmhist_init", "100", "hist");
+    yf_frmhist_t *hist = yf_frmhist_init(100);
+    if (hist == NULL)
+        return -1;
+
+    yf_frmstats_t st;
+    YF_TEST_PRINT("frmhist_getstats", "hist, &st", "(empty)");
+    yf_frmhist_getstats(hist, &st);
+    if (st.n != 0 || st.p50 != 0 || st.p99 != 0 || st.max != 0)
+        return -1;
+
+    /* frame times from 1ms to 100ms, in shuffled order */
+    YF_TEST_PRINT("frmhist_add", "hist, <1ms..100ms>", "");
+    for (unsigned i = 0; i < 100; i++)
+        yf_frmhist_add(hist, (uint64_t)(i * 37 % 100 + 1) * 1000000);
+
+    YF_TEST_PRINT("frmhist_getstats", "hist, &st", "");
+    yf_frmhist_getstats(hist, &st);
+    printf("\n- n: %u, p50: %" PRIu64 ", p99: %" PRIu64 ", max: %" PRIu64
+           " -\n\n", st.n, st.p50, st.p99, st.max);
+    if (st.n != 100 || st.max != 100000000 ||
+        st.p50 < 48500000 || st.p50 > 51500000 ||
+        st.p99 < 96000000 || st.p99 > 100000000)
+        return -1;
+
+    /* older frame times leave the window */
+    YF_TEST_PRINT("frmhist_add", "hist, <100 x 2ms>", "");
+    for (unsigned i = 0; i < 100; i++)
+        yf_frmhist_add(hist, 2000000);
+
+    YF_TEST_PRINT("frmhist_getstats", "hist, &st", "");
+    yf_frmhist_getstats(hist, &st);
+    if (st.n != 100 || st.max != 2000000 || st.p50 < 1940000 ||
+        st.p50 > 2000000 || st.p99 < 1940000 || st.p99 > 2000000)
+        return -1;
+
+    YF_TEST_PRINT("frmhist_clear", "hist", "");
+    yf_frmhist_clear(hist);
+    yf_frmhist_getstats(hist, &st);
+    if (st.n != 0)
+        return -1;
+
+    YF_TEST_PRINT("frmhist_deinit", "hist", "");
+    yf_frmhist_deinit(hist);
+
+    return 0;
+}
 
 /* Tests clock. */
 int yf_test_clock(void)
@@ -35,5 +167,8 @@ int yf_test_clock(void)
         printf("\n- elapsed time: %.10fs -\n\n", yf_gettime() - t1);
     }
 
-    return 0;
+    if (test_ns() != 0)
+        return -1;
+
+    return test_frmhist();
 }
@@ -79,6 +79,17 @@ int yf_test_dict(void)
     if (yf_dict_getlen(dict) != 2 || !yf_dict_contains(dict, key3))
         return -1;
 
+    yf_seterr(YF_ERR_UNKNOWN, NULL);
+    void *found = "";
+    YF_TEST_PRINT("find", "dict, key1, &found", "");
+    if (yf_dict_find(dict, key1, &found) ||
+        yf_geterr() != YF_ERR_UNKNOWN)
+        return -1;
+
+    YF_TEST_PRINT("find", "dict, key3, &found", "");
+    if (!yf_dict_find(dict, key3, &found) || found != NULL)
+        return -1;
+
     YF_TEST_PRINT("replace", "dict, key2, \"xyz\"", "");
     val = yf_dict_replace(dict, key2, "xyz");
     if (val == NULL || strcmp(val, "b") != 0 || !yf_dict_contains(dict, key2))
@@ -279,5 +290,88 @@ int yf_test_dict(void)
     YF_TEST_PRINT("deinit", "dict", "");
     yf_dict_deinit(dict);
 
+    YF_TEST_PRINT("init", "NULL, NULL", "dict");
+    dict = yf_dict_init(NULL, NULL);
+
+    count = 1000;
+
+    YF_TEST_PRINT("reserve", "dict, 1000", "");
+    if (yf_dict_reserve(dict, count) != 0)
+        return -1;
+
+    for (size_t i = 1; i <= count; i++) {
+        if (yf_dict_insert(dict, (void *)i, (void *)i) != 0)
+            return -1;
+    }
+
+    YF_TEST_PRINT("reset", "dict", "");
+    yf_dict_reset(dict);
+    if (yf_dict_getlen(dict) != 0 || yf_dict_contains(dict, (void *)1) ||
+        yf_dict_next(dict, NULL, NULL) != NULL)
+        return -1;
+
+    YF_TEST_PRINT("setrehash", "dict, DICT_REHASH_INCR", "");
+    yf_dict_setrehash(dict, YF_DICT_REHASH_INCR);
+
+    YF_TEST_PRINT("reserve", "dict, 0", "");
+    if (yf_dict_reserve(dict, 0) != 0)
+        return -1;
+
+    /* large enough to resize a few times while pairs are migrated */
+    count = 20000;
+
+    for (size_t i = 1; i <= count; i++) {
+        if (yf_dict_insert(dict, (void *)i, (void *)(i*3)) != 0 ||
+            !yf_dict_contains(dict, (void *)(i>>1|1)))
+            return -1;
+    }
+    YF_TEST_PRINT("insert", "dict, 1..20000, ...", "");
+
+    size_t sum = 0;
+    it = YF_NILIT;
+    for (;;) {
+        size_t v = (size_t)yf_dict_next(dict, &it, &key);
+        if (YF_IT_ISNIL(it))
+            break;
+        if (v != (size_t)key*3)
+            return -1;
+        sum += (size_t)key;
+    }
+    YF_TEST_PRINT("next", "dict, &it, &key", "");
+    if (sum != count*(count+1)/2)
+        return -1;
+
+    for (size_t i = 1; i <= count; i += 2) {
+        if ((size_t)yf_dict_remove(dict, (void *)i) != i*3 ||
+            yf_dict_contains(dict, (void *)i) ||
+            !yf_dict_contains(dict, (void *)(i+1)))
+            return -1;
+    }
+    YF_TEST_PRINT("remove", "dict, 1..20000 (odd)", "");
+
+    for (size_t i = 2; i <= count; i += 2) {
+        if ((size_t)yf_dict_search(dict, (void *)i) != i*3)
+            return -1;
+    }
+    YF_TEST_PRINT("search", "dict, 1..20000 (even)", "");
+
+    if (yf_dict_getlen(dict) != count/2)
+        return -1;
+
+    YF_TEST_PRINT("setrehash", "dict, DICT_REHASH_ALL", "");
+    yf_dict_setrehash(dict, YF_DICT_REHASH_ALL);
+
+    for (size_t i = 2; i <= count; i += 2) {
+        if ((size_t)yf_dict_remove(dict, (void *)i) != i*3)
+            return -1;
+    }
+    YF_TEST_PRINT("remove", "dict, 1..20000 (even)", "");
+
+    if (yf_dict_getlen(dict) != 0 || yf_dict_next(dict, NULL, NULL) != NULL)
+        return -1;
+
+    YF_TEST_PRINT("deinit", "dict", "");
+    yf_dict_deinit(dict);
+
     return 0;
 }
@@ -0,0 +1,192 @@
+/*
+ * YF
+ * test-hashfn.c
+ *
+ * Copyright © 2020 Gustavo C. Viegas.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "test.h"
+#include "yf-hashfn.h"
+
+/* Largest input length tested. */
+#define YF_HMAXLEN 1100
+
+/* Gets the next value of a pseudo-random sequence. */
+#define YF_HNEXT(state) \
+    ((state) = (state) * 6364136223846793005ULL + 1442695040888963407ULL, \
+     (state) >> 32)
+
+/* Counts the bits that differ between two hash values. */
+static unsigned diff_bits(uint64_t a, uint64_t b)
+{
+    return __builtin_popcountll(a ^ b);
+}
+
+/* Compares two hash values. */
+static int cmp_hash(const void *a, const void *b)
+{
+    const uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/* Checks that every length produces consistent hash values. */
+static int test_lengths(void)
+{
+    unsigned char *buf = malloc(YF_HMAXLEN + 8);
+    assert(buf != NULL);
+
+    unsigned long long state = 1;
+    for (size_t i = 0; i < YF_HMAXLEN + 8; i++)
+        buf[i] = YF_HNEXT(state);
+
+    int r = 0;
+    for (size_t len = 0; len <= YF_HMAXLEN && r == 0; len++) {
+        const uint64_t h = yf_hash64(buf, len, 0);
+
+        /* alignment must not matter */
+        for (size_t off = 1; off < 8; off++) {
+            memmove(buf+off, buf+off-1, len);
+            if (yf_hash64(buf+off, len, 0) != h)
+                r = -1;
+        }
+        memmove(buf, buf+7, len);
+
+        if (yf_hash64(buf, len, 0) != h || yf_hash64(buf, len, 1) == h ||
+            (len > 0 && yf_hash64(buf, len-1, 0) == h))
+            r = -1;
+
+        /* every byte must contribute */
+        for (size_t i = 0; i < len; i++) {
+            buf[i] ^= 1;
+            if (yf_hash64(buf, len, 0) == h)
+                r = -1;
+            buf[i] ^= 1;
+        }
+    }
+
+    free(buf);
+    return r;
+}
+
+/* Checks that distinct keys produce distinct hash values. */
+static int test_collisions(size_t n)
+{
+    uint64_t *hs = malloc(n * 2 * sizeof *hs);
+    assert(hs != NULL);
+
+    /* small integers and names that only differ in a few digits */
+    for (size_t i = 0; i < n; i++) {
+        const uint64_t k = i;
+        hs[i] = yf_hash64(&k, sizeof k, 0);
+
+        char s[32];
+        const int len = snprintf(s, sizeof s, "texture_%zu.png", i);
+        hs[n+i] = yf_hash64(s, len, 0);
+    }
+
+    qsort(hs, n * 2, sizeof *hs, cmp_hash);
+
+    size_t coll_n = 0;
+    for (size_t i = 1; i < n * 2; i++)
+        coll_n += hs[i] == hs[i-1];
+
+    /* distribution of the low bits, which 'yf_dict' uses for grouping */
+    size_t *cnts = calloc(1 << 12, sizeof *cnts);
+    assert(cnts != NULL);
+    for (size_t i = 0; i < n; i++) {
+        const uint64_t k = i;
+        cnts[yf_hash64(&k, sizeof k, 0) & 0xfff]++;
+    }
+    double chi2 = 0.0;
+    const double expect = (double)n / (1 << 12);
+    for (size_t i = 0; i < 1 << 12; i++)
+        chi2 += (cnts[i] - expect) * (cnts[i] - expect) / expect;
+
+    free(cnts);
+    free(hs);
+
+    printf(" %zu keys, %zu collisions, chi2 %.1f (4095 dof)\n",
+           n * 2, coll_n, chi2);
+
+    /* five standard deviations from the expected value */
+    return coll_n == 0 && chi2 < 4095.0 + 5.0 * 90.5 ? 0 : -1;
+}
+
+/* Checks that flipping any input bit flips about half of the output bits. */
+static int test_avalanche(size_t len)
+{
+    const size_t sample_n = 64;
+    unsigned char *buf = malloc(len);
+    assert(buf != NULL);
+
+    unsigned long long state = len;
+    double min = 64.0, max = 0.0;
+
+    for (size_t bit = 0; bit < len * 8; bit++) {
+        unsigned sum = 0;
+        for (size_t i = 0; i < sample_n; i++) {
+            for (size_t j = 0; j < len; j++)
+                buf[j] = YF_HNEXT(state);
+
+            const uint64_t h = yf_hash64(buf, len, 0);
+            buf[bit>>3] ^= 1 << (bit & 7);
+            sum += diff_bits(h, yf_hash64(buf, len, 0));
+        }
+
+        const double mean = (double)sum / sample_n;
+        if (mean < min)
+            min = mean;
+        if (mean > max)
+            max = mean;
+    }
+
+    free(buf);
+
+    printf(" %4zu bytes, flipped bits in [%.2f, %.2f]\n", len, min, max);
+
+    /* the mean of 64 samples has a standard deviation of 0.5 */
+    return min > 28.0 && max < 36.0 ? 0 : -1;
+}
+
+/* Tests hashing functions. */
+int yf_test_hashfn(void)
+{
+    YF_TEST_PRINT("hash64", "buf, [0, 1100], seed", "");
+    if (test_lengths() != 0)
+        return -1;
+
+    if (yf_hash64(NULL, 0, 0) == yf_hash64(NULL, 0, 1))
+        return -1;
+
+    YF_TEST_PRINT("hash64", "keys, 8|14-21, 0", "");
+    if (test_collisions(1 << 20) != 0)
+        return -1;
+
+    const size_t lens[] = {3, 8, 12, 16, 24, 48, 100, 512, 600};
+    for (size_t i = 0; i < sizeof lens / sizeof *lens; i++) {
+        char s[64] = {0};
+        snprintf(s, sizeof s, "rand, %zu, 0", lens[i]);
+        YF_TEST_PRINT("hash64", s, "");
+
+        if (test_avalanche(lens[i]) != 0)
+            return -1;
+    }
+
+    YF_TEST_PRINT("hashstr", "\"texture_0.png\"", "");
+    if (yf_hashstr("texture_0.png") != yf_hashstr("texture_0.png") ||
+        yf_hashstr("texture_0.png") == yf_hashstr("texture_1.png") ||
+        yf_hashstr("") == yf_hashstr("a"))
+        return -1;
+
+    YF_TEST_PRINT("hashv", "\"ab\", 2, \"c\", 1, NULL", "");
+    if (yf_hashv("ab", 2, "c", 1, NULL) == yf_hashv("a", 1, "bc", 2, NULL) ||
+        yf_hashv("ab", 2, "c", 1, NULL) != yf_hashv("ab", 2, "c", 1, NULL))
+        return -1;
+
+    return 0;
+}
@@ -0,0 +1,169 @@
+/*
+ * YF
+ * test-job.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifndef __STDC_NO_THREADS__
+# include <threads.h>
+#else
+# error "C11 threads required"
+#endif
+
+#ifndef __STDC_NO_ATOMICS__
+# include <stdatomic.h>
+#else
+# error "C11 atomics required"
+#endif
+
+#include "test.h"
+#include "yf-job.h"
+#include "yf-error.h"
+
+/* Number of indices for 'yf_job_parfor()' calls. */
+#define YF_JN 100000
+
+/* Depth of the job trees. */
+#define YF_JDEPTH 12
+
+/* Visit counts of each index. */
+static atomic_uchar visits_[YF_JN];
+
+/* Number of jobs executed. */
+static atomic_uint count_ = 0;
+
+/* Range function that visits indices. */
+static void visit(size_t beg, size_t end, void *arg)
+{
+    if (end - beg > *(size_t *)arg)
+        abort();
+
+    for (size_t i = beg; i < end; i++)
+        atomic_fetch_add_explicit(visits_+i, 1, memory_order_relaxed);
+}
+
+/* Checks that every index was visited once and clears the counts. */
+static int check_visits(size_t n)
+{
+    int r = 0;
+    for (size_t i = 0; i < YF_JN; i++) {
+        if (atomic_load(visits_+i) != (i < n))
+            r = -1;
+        atomic_store(visits_+i, 0);
+    }
+    return r;
+}
+
+/* Job function that forks two children until a given depth. */
+static void tree(yf_job_t *job, void *arg)
+{
+    const size_t depth = (size_t)arg;
+
+    atomic_fetch_add_explicit(&count_, 1, memory_order_relaxed);
+    if (depth > 0) {
+        yf_job_fork(job, tree, (void *)(depth - 1));
+        yf_job_fork(job, tree, (void *)(depth - 1));
+    }
+}
+
+/* Job function that waits for nested work. */
+static void nested(YF_UNUSED yf_job_t *job, void *arg)
+{
+    size_t grain = 10;
+    yf_job_parfor(YF_JN, grain, visit, &grain);
+
+    yf_job_wait(yf_job_run(tree, arg));
+}
+
+/* Runs the job tree and parallel-for tests. */
+static int test_jobs(void)
+{
+    const unsigned tree_n = (2u << YF_JDEPTH) - 1;
+
+    char s[64] = {0};
+    snprintf(s, sizeof s, "tree, <depth %d>", YF_JDEPTH);
+    YF_TEST_PRINT("run", s, "job");
+    atomic_store(&count_, 0);
+    yf_job_t *job = yf_job_run(tree, (void *)(size_t)YF_JDEPTH);
+
+    YF_TEST_PRINT("wait", "job", "");
+    yf_job_wait(job);
+    if (atomic_load(&count_) != tree_n)
+        return -1;
+
+    size_t grains[] = {1, 7, 1000, YF_JN};
+    for (size_t i = 0; i < sizeof grains / sizeof *grains; i++) {
+        snprintf(s, sizeof s, "%d, %zu, visit", YF_JN - (int)i, grains[i]);
+        YF_TEST_PRINT("parfor", s, "");
+        yf_job_parfor(YF_JN - i, grains[i], visit, grains+i);
+        if (check_visits(YF_JN - i) != 0)
+            return -1;
+    }
+
+    size_t max = SIZE_MAX;
+    YF_TEST_PRINT("parfor", "YF_JN, 0, visit", "");
+    yf_job_parfor(YF_JN, 0, visit, &max);
+    if (check_visits(YF_JN) != 0)
+        return -1;
+
+    YF_TEST_PRINT("run", "nested, <depth 4>", "job");
+    atomic_store(&count_, 0);
+    yf_job_wait(yf_job_run(nested, (void *)(size_t)4));
+    if (check_visits(YF_JN) != 0 || atomic_load(&count_) != 31)
+        return -1;
+
+    return 0;
+}
+
+/* Thread function that creates jobs from outside the job system. */
+static int thrd_fn(YF_UNUSED void *arg)
+{
+    yf_job_wait(yf_job_run(tree, (void *)(size_t)4));
+    return 0;
+}
+
+/* Tests job system. */
+int yf_test_job(void)
+{
+    YF_TEST_PRINT("<no init>", "", "");
+    if (test_jobs() != 0)
+        return -1;
+
+    const unsigned thrd_ns[] = {0, 3};
+    for (size_t i = 0; i < sizeof thrd_ns / sizeof *thrd_ns; i++) {
+        char s[16] = {0};
+        snprintf(s, sizeof s, "%u", thrd_ns[i]);
+        YF_TEST_PRINT("init", s, "");
+        if (yf_job_init(thrd_ns[i]) != 0 ||
+            yf_job_getthrdn() != thrd_ns[i])
+            return -1;
+
+        YF_TEST_PRINT("init", s, "(error)");
+        if (yf_job_init(thrd_ns[i]) == 0 || yf_geterr() != YF_ERR_INUSE)
+            return -1;
+
+        if (test_jobs() != 0)
+            return -1;
+
+        YF_TEST_PRINT("run", "<from another thread>", "");
+        atomic_store(&count_, 0);
+        thrd_t thrd;
+        int res;
+        if (thrd_create(&thrd, thrd_fn, NULL) != thrd_success ||
+            thrd_join(thrd, &res) != thrd_success || res != 0 ||
+            atomic_load(&count_) != 31)
+            return -1;
+
+        YF_TEST_PRINT("deinit", "", "");
+        yf_job_deinit();
+        if (yf_job_getthrdn() != 0)
+            return -1;
+    }
+
+    return 0;
+}
@@ -17,8 +17,8 @@ static int list_cb(void *val, void *arg)
     return 0;
 }
 
-/* Tests list. */
-int yf_test_list(void)
+/* Tests list using a given storage mode. */
+static int test_mode(int mode)
 {
     const int a = 'a';
     const int b = 'b';
@@ -29,6 +29,11 @@ int yf_test_list(void)
     yf_list_t *ls = yf_list_init(NULL);
     if (yf_list_getlen(ls) != 0)
         return -1;
+
+    YF_TEST_PRINT("setmode", mode == YF_LIST_ARRAY ? "ls, LIST_ARRAY" :
+                  "ls, LIST_LINKED", "");
+    if (yf_list_setmode(ls, mode) != 0)
+        return -1;
     if (yf_list_contains(ls, NULL))
         return -1;
 
@@ -286,3 +291,105 @@ int yf_test_list(void)
 
     return 0;
 }
+
+/* Checks that two lists contain the same values in the same order. */
+static int compare(yf_list_t *ls1, yf_list_t *ls2)
+{
+    if (yf_list_getlen(ls1) != yf_list_getlen(ls2))
+        return -1;
+
+    yf_iter_t it1 = YF_NILIT, it2 = YF_NILIT;
+    do {
+        if (yf_list_next(ls1, &it1) != yf_list_next(ls2, &it2) ||
+            YF_IT_ISNIL(it1) != YF_IT_ISNIL(it2))
+            return -1;
+    } while (!YF_IT_ISNIL(it1));
+
+    return 0;
+}
+
+/* Applies the same random operations to lists of different modes. */
+static int test_random(void)
+{
+    yf_list_t *lnk = yf_list_init(NULL);
+    yf_list_t *arr = yf_list_init(NULL);
+    if (lnk == NULL || arr == NULL || yf_list_setmode(arr, YF_LIST_ARRAY) != 0)
+        return -1;
+
+    unsigned long long state = 1;
+    for (size_t i = 0; i < 20000; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        const size_t r = state >> 33;
+        const void *val = (const void *)(r % 64 + 1);
+
+        /* iterators are advanced to the same position */
+        yf_iter_t it1 = YF_NILIT, it2 = YF_NILIT;
+        for (size_t j = (r >> 8) % 8; j > 0; j--) {
+            yf_list_next(lnk, &it1);
+            yf_list_next(arr, &it2);
+        }
+
+        switch (r % 7) {
+        case 0:
+        case 1:
+            yf_list_insert(lnk, val);
+            yf_list_insert(arr, val);
+            break;
+        case 2:
+            yf_list_insertat(lnk, &it1, val);
+            yf_list_insertat(arr, &it2, val);
+            if (yf_list_next(lnk, &it1) != yf_list_next(arr, &it2))
+                return -1;
+            break;
+        case 3:
+            if ((yf_list_remove(lnk, val) == 0) !=
+                (yf_list_remove(arr, val) == 0))
+                return -1;
+            break;
+        case 4:
+            if (yf_list_removeat(lnk, &it1) != yf_list_removeat(arr, &it2) ||
+                yf_list_next(lnk, &it1) != yf_list_next(arr, &it2))
+                return -1;
+            break;
+        case 5:
+            if (yf_list_contains(lnk, val) != yf_list_contains(arr, val))
+                return -1;
+            if (r % 97 == 0) {
+                yf_list_clear(lnk);
+                yf_list_clear(arr);
+            }
+            break;
+        case 6:
+            /* conversions keep the order */
+            if (r % 13 == 0) {
+                if (yf_list_setmode(lnk, YF_LIST_ARRAY) != 0 ||
+                    yf_list_setmode(arr, YF_LIST_LINKED) != 0)
+                    return -1;
+
+                yf_list_t *tmp = lnk;
+                lnk = arr;
+                arr = tmp;
+            }
+            break;
+        }
+
+        if (compare(lnk, arr) != 0)
+            return -1;
+    }
+
+    printf(" %zu values after 20000 operations\n", yf_list_getlen(lnk));
+
+    yf_list_deinit(lnk);
+    yf_list_deinit(arr);
+    return 0;
+}
+
+/* Tests list. */
+int yf_test_list(void)
+{
+    if (test_mode(YF_LIST_LINKED) != 0 || test_mode(YF_LIST_ARRAY) != 0)
+        return -1;
+
+    YF_TEST_PRINT("<random>", "LIST_LINKED, LIST_ARRAY", "");
+    return test_random();
+}
@@ -0,0 +1,108 @@
+/*
+ * YF
+ * test-mem.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "yf-mem.h"
+
+/* Gets the statistics of a tag. */
+static int get_stats(const char *tag, yf_memstats_t *dst)
+{
+    yf_memstats_t stats[64];
+    const size_t n = yf_mem_getstats(stats, 64);
+
+    for (size_t i = 0; i < n && i < 64; i++) {
+        if (strcmp(stats[i].tag, tag) == 0) {
+            *dst = stats[i];
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* Checks the statistics of a tag. */
+#define YF_MEMCHECK(tag, live_, peak_, alloc_n_, free_n_) \
+    do { \
+        yf_memstats_t st; \
+        if (get_stats(tag, &st) != 0 || st.live != (live_) || \
+            st.peak != (peak_) || st.alloc_n != (alloc_n_) || \
+            st.free_n != (free_n_)) \
+            return -1; \
+    } while (0)
+
+/* Tests allocation tracking. */
+int yf_test_mem(void)
+{
+    YF_TEST_PRINT("mem_malloc", "\"test-a\", 100", "a");
+    char *a = yf_mem_malloc("test-a", 100);
+    if (a == NULL)
+        return -1;
+    memset(a, 'a', 100);
+    YF_MEMCHECK("test-a", 100, 100, 1, 0);
+
+    YF_TEST_PRINT("mem_calloc", "\"test-b\", 10, 8", "b");
+    unsigned char *b = yf_mem_calloc("test-b", 10, 8);
+    if (b == NULL)
+        return -1;
+    for (size_t i = 0; i < 80; i++) {
+        if (b[i] != 0)
+            return -1;
+    }
+    YF_MEMCHECK("test-b", 80, 80, 1, 0);
+
+    YF_TEST_PRINT("mem_calloc", "\"test-b\", SIZE_MAX, 2", "NULL");
+    if (yf_mem_calloc("test-b", (size_t)-1, 2) != NULL)
+        return -1;
+    YF_MEMCHECK("test-b", 80, 80, 1, 0);
+
+    YF_TEST_PRINT("mem_realloc", "\"test-b\", a, 1000", "a");
+    a = yf_mem_realloc("test-b", a, 1000);
+    if (a == NULL || a[0] != 'a' || a[99] != 'a')
+        return -1;
+    /* the original tag is kept */
+    YF_MEMCHECK("test-a", 1000, 1000, 1, 0);
+    YF_MEMCHECK("test-b", 80, 80, 1, 0);
+
+    YF_TEST_PRINT("mem_realloc", "\"test-a\", a, 10", "a");
+    a = yf_mem_realloc("test-a", a, 10);
+    if (a == NULL || a[9] != 'a')
+        return -1;
+    YF_MEMCHECK("test-a", 10, 1000, 1, 0);
+
+    YF_TEST_PRINT("mem_realloc", "\"test-a\", NULL, 30", "c");
+    void *c = yf_mem_realloc("test-a", NULL, 30);
+    if (c == NULL)
+        return -1;
+    YF_MEMCHECK("test-a", 40, 1000, 2, 0);
+
+    YF_TEST_PRINT("mem_free", "a", "");
+    yf_mem_free(a);
+    YF_MEMCHECK("test-a", 30, 1000, 2, 1);
+
+    YF_TEST_PRINT("mem_free", "NULL", "");
+    yf_mem_free(NULL);
+    YF_MEMCHECK("test-a", 30, 1000, 2, 1);
+
+    YF_TEST_PRINT("mem_print", "", "");
+    yf_mem_print();
+
+    YF_TEST_PRINT("mem_free", "b", "");
+    yf_mem_free(b);
+    YF_MEMCHECK("test-b", 0, 80, 1, 1);
+
+    YF_TEST_PRINT("mem_free", "c", "");
+    yf_mem_free(c);
+    YF_MEMCHECK("test-a", 0, 1000, 2, 2);
+
+    YF_TEST_PRINT("mem_getstats", "NULL, 0", "");
+    if (yf_mem_getstats(NULL, 0) < 2)
+        return -1;
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+/*
+ * YF
+ * test-prof.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef __STDC_NO_THREADS__
+# include <threads.h>
+#else
+# error "C11 threads required"
+#endif
+
+#include "test.h"
+#include "yf-prof.h"
+#include "yf-error.h"
+
+/* Pathname of the exported trace. */
+#define YF_PPATH "yf-test-prof.json"
+
+/* Number of zones recorded by the secondary thread. */
+#define YF_PTHRDN 10000
+
+/* Thread function that records many zones. */
+static int thrd_fn(YF_UNUSED void *arg)
+{
+    for (int i = 0; i < YF_PTHRDN; i++) {
+        yf_prof_begin("thrd\"zone\"");
+        yf_prof_end();
+    }
+
+    return 0;
+}
+
+/* Reads the exported trace. */
+static char *read_trace(void)
+{
+    FILE *file = fopen(YF_PPATH, "r");
+    if (file == NULL)
+        return NULL;
+
+    fseek(file, 0, SEEK_END);
+    const long len = ftell(file);
+    rewind(file);
+
+    char *s = malloc(len + 1);
+    if (s == NULL || fread(s, 1, len, file) != (size_t)len) {
+        free(s);
+        fclose(file);
+        return NULL;
+    }
+
+    s[len] = '\0';
+    fclose(file);
+    return s;
+}
+
+/* Counts the occurrences of a substring. */
+static unsigned count_str(const char *s, const char *sub)
+{
+    unsigned n = 0;
+    while ((s = strstr(s, sub)) != NULL) {
+        n++;
+        s++;
+    }
+    return n;
+}
+
+/* Tests profiling zones. */
+int yf_test_prof(void)
+{
+    YF_TEST_PRINT("prof_export", "\"\"", "-1");
+    if (yf_prof_export("") == 0 || yf_geterr() != YF_ERR_NOFILE)
+        return -1;
+
+    YF_TEST_PRINT("prof_begin", "\"outer\"", "");
+    yf_prof_begin("outer");
+
+    thrd_t thrd;
+    if (thrd_create(&thrd, thrd_fn, NULL) != thrd_success)
+        return -1;
+
+    YF_TEST_PRINT("prof_begin", "\"inner\"", "");
+    yf_prof_begin("inner");
+    YF_TEST_PRINT("prof_end", "", "");
+    yf_prof_end();
+
+    int res;
+    if (thrd_join(thrd, &res) != thrd_success || res != 0)
+        return -1;
+
+    YF_TEST_PRINT("prof_end", "", "");
+    yf_prof_end();
+
+    YF_TEST_PRINT("prof_export", YF_PPATH, "0");
+    if (yf_prof_export(YF_PPATH) != 0)
+        return -1;
+
+    char *s = read_trace();
+    if (s == NULL)
+        return -1;
+
+    int r = 0;
+    if (strncmp(s, "{\"traceEvents\":[", 16) != 0 ||
+        count_str(s, "\"ph\":\"X\"") != YF_PTHRDN + 2 ||
+        count_str(s, "\"name\":\"outer\"") != 1 ||
+        count_str(s, "\"name\":\"inner\"") != 1 ||
+        count_str(s, "\"name\":\"thrd\\\"zone\\\"\"") != YF_PTHRDN)
+        r = -1;
+    free(s);
+    if (r != 0) {
+        remove(YF_PPATH);
+        return -1;
+    }
+
+    YF_TEST_PRINT("prof_reset", "", "");
+    yf_prof_reset();
+
+    YF_TEST_PRINT("prof_export", YF_PPATH, "0");
+    if (yf_prof_export(YF_PPATH) != 0 || (s = read_trace()) == NULL) {
+        remove(YF_PPATH);
+        return -1;
+    }
+    if (count_str(s, "\"ph\":\"X\"") != 0)
+        r = -1;
+    free(s);
+
+    remove(YF_PPATH);
+    return r;
+}
@@ -6,6 +6,8 @@
  */
 
 #include <stdio.h>
+#include <threads.h>
+#include <stdatomic.h>
 
 #include "test.h"
 #include "yf-pubsub.h"
@@ -28,6 +30,125 @@ static void pubsub_cb2(void *pub, int pubsub, void *arg)
            pub, ps->id, ps->val, pubsub, (size_t)arg);
 }
 
+/* Variables & functions used by 'test_threads'. */
+#define YF_PUBTHRN 4
+#define YF_PUBN    20000
+#define YF_PUBCHGN 2000
+
+static char pub_[1];
+static char pubs_[YF_PUBCHGN];
+static atomic_size_t count_;
+static atomic_size_t extra_count_;
+
+static void count_cb(YF_UNUSED void *pub, YF_UNUSED int pubsub, void *arg)
+{
+    atomic_fetch_add((atomic_size_t *)arg, 1);
+}
+
+static int publish_thr(YF_UNUSED void *arg)
+{
+    for (size_t i = 0; i < YF_PUBN; i++) {
+        yf_publish(pub_, YF_PUBSUB_CHANGE);
+        if (yf_checkpub(pub_) != YF_PUBSUB_CHANGE)
+            return -1;
+    }
+    return 0;
+}
+
+/* Tests publishing from multiple threads while subscriptions change. */
+static int test_threads(void)
+{
+    if (yf_setpub(pub_, YF_PUBSUB_CHANGE) != 0 ||
+        yf_subscribe(pub_, pub_, YF_PUBSUB_CHANGE, count_cb, &count_) != 0)
+        return -1;
+
+    thrd_t thrs[YF_PUBTHRN];
+    for (size_t i = 0; i < YF_PUBTHRN; i++) {
+        if (thrd_create(thrs+i, publish_thr, NULL) != thrd_success)
+            return -1;
+    }
+
+    /* changes cause snapshots to be replaced and the index to be rebuilt */
+    int r = 0;
+    for (size_t i = 0; i < YF_PUBCHGN && r == 0; i++) {
+        if (yf_setpub(pubs_+i, YF_PUBSUB_DEINIT) != 0 ||
+            yf_subscribe(pub_, pubs_+i, YF_PUBSUB_CHANGE, count_cb,
+                         &extra_count_) != 0)
+            r = -1;
+        if (i % 2 == 0 &&
+            (yf_setpub(pubs_+i, YF_PUBSUB_NONE) != 0 ||
+             yf_subscribe(pub_, pubs_+i, YF_PUBSUB_NONE, NULL, NULL) != 0))
+            r = -1;
+    }
+
+    for (size_t i = 0; i < YF_PUBTHRN; i++) {
+        int res;
+        thrd_join(thrs[i], &res);
+        if (res != 0)
+            r = -1;
+    }
+
+    for (size_t i = 1; i < YF_PUBCHGN; i += 2) {
+        if (yf_checkpub(pubs_+i) != YF_PUBSUB_DEINIT)
+            r = -1;
+        yf_subscribe(pub_, pubs_+i, YF_PUBSUB_NONE, NULL, NULL);
+        yf_setpub(pubs_+i, YF_PUBSUB_NONE);
+    }
+    yf_setpub(pub_, YF_PUBSUB_NONE);
+
+    const size_t n = atomic_load(&count_);
+    printf("\n %d threads, %zu callbacks (%d expected), %zu extra\n",
+           YF_PUBTHRN, n, YF_PUBTHRN * YF_PUBN, atomic_load(&extra_count_));
+
+    return r == 0 && n == YF_PUBTHRN * YF_PUBN ? 0 : -1;
+}
+
+/* Tests deferred publishing. */
+static int test_defer(void)
+{
+    const char p1[1] = {0}, p2[1] = {0}, p3[1] = {0};
+    atomic_size_t n1 = 0, n2 = 0, n3 = 0;
+
+    if (yf_setpub(p1, YF_PUBSUB_DEINIT|YF_PUBSUB_CHANGE) != 0 ||
+        yf_setpub(p2, YF_PUBSUB_DEINIT|YF_PUBSUB_CHANGE) != 0 ||
+        yf_setpub(p3, YF_PUBSUB_CHANGE) != 0 ||
+        yf_subscribe(p1, p2, YF_PUBSUB_CHANGE, count_cb, &n1) != 0 ||
+        yf_subscribe(p2, p1, YF_PUBSUB_CHANGE, count_cb, &n2) != 0 ||
+        yf_subscribe(p3, p1, YF_PUBSUB_CHANGE, count_cb, &n3) != 0)
+        return -1;
+
+    if (yf_deferpub(p1, YF_PUBSUB_DEINIT) == 0)
+        return -1;
+
+    for (size_t i = 0; i < 100; i++) {
+        if (yf_deferpub(p1, YF_PUBSUB_CHANGE) != 0 ||
+            yf_deferpub(p2, YF_PUBSUB_CHANGE) != 0 ||
+            yf_deferpub(p3, YF_PUBSUB_CHANGE) != 0)
+            return -1;
+    }
+
+    /* discards deferred publications */
+    yf_setpub(p3, YF_PUBSUB_NONE);
+
+    if (atomic_load(&n1) != 0 || atomic_load(&n2) != 0)
+        return -1;
+
+    yf_flushpub();
+    printf("\n 100 deferred, %zu/%zu/%zu delivered\n",
+           atomic_load(&n1), atomic_load(&n2), atomic_load(&n3));
+    if (atomic_load(&n1) != 1 || atomic_load(&n2) != 1 ||
+        atomic_load(&n3) != 0)
+        return -1;
+
+    yf_flushpub();
+    if (atomic_load(&n1) != 1 || atomic_load(&n2) != 1)
+        return -1;
+
+    yf_setpub(p1, YF_PUBSUB_NONE);
+    yf_setpub(p2, YF_PUBSUB_NONE);
+    return 0;
+}
+
 /* Tests publish-subscribe. */
 int yf_test_pubsub(void)
 {
@@ -201,5 +322,13 @@ int yf_test_pubsub(void)
         yf_checkpub(&a1) != YF_PUBSUB_NONE)
         return -1;
 
+    YF_TEST_PRINT("deferpub", "<pubs>, PUBSUB_CHANGE", "");
+    if (test_defer() != 0)
+        return -1;
+
+    YF_TEST_PRINT("publish", "<threads>", "");
+    if (test_threads() != 0)
+        return -1;
+
     return 0;
 }
@@ -0,0 +1,245 @@
+/*
+ * YF
+ * test-ring.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifndef __STDC_NO_THREADS__
+# include <threads.h>
+#else
+# error "C11 threads required"
+#endif
+
+#ifndef __STDC_NO_ATOMICS__
+# include <stdatomic.h>
+#else
+# error "C11 atomics required"
+#endif
+
+#include "test.h"
+#include "yf-ring.h"
+#include "yf-error.h"
+
+/* Number of elements pushed by each producer in stress tests. */
+#define YF_RN 200000
+
+/* Number of producers and consumers in the multi-producer test. */
+#define YF_RPRODN 4
+#define YF_RCONSN 4
+
+/* Element type, larger than a word so that torn copies are noticed. */
+typedef struct {
+    uint32_t prod;
+    uint32_t seq;
+    uint64_t check;
+} elem_t;
+
+/* Computes the check value of an element. */
+#define YF_RCHECK(prod, seq) (((uint64_t)(prod) << 40) ^ ((seq) * 2654435761u))
+
+/* Tests single-threaded behavior of a ring type. */
+#define YF_RBASIC(type, name) \
+    do { \
+        YF_TEST_PRINT(#type "_init", "0, 8", "NULL"); \
+        if (yf_##type##_init(0, 8) != NULL || yf_geterr() != YF_ERR_INVARG) \
+            return -1; \
+        \
+        YF_TEST_PRINT(#type "_init", "sizeof(elem_t), 5", #name); \
+        yf_##type##_t *name = yf_##type##_init(sizeof(elem_t), 5); \
+        if (name == NULL || yf_##type##_getcap(name) != 8) \
+            return -1; \
+        \
+        elem_t e; \
+        YF_TEST_PRINT(#type "_pop", #name ", &e", "(empty)"); \
+        if (yf_##type##_pop(name, &e) == 0) \
+            return -1; \
+        \
+        YF_TEST_PRINT(#type "_push", #name ", <20 elems, 3 at a time>", ""); \
+        uint32_t in = 0, out = 0; \
+        while (in < 20) { \
+            for (int i = 0; i < 3; i++, in++) { \
+                e = (elem_t){0, in, YF_RCHECK(0, in)}; \
+                if (yf_##type##_push(name, &e) != 0) \
+                    return -1; \
+            } \
+            while (out < in - 1) { \
+                if (yf_##type##_pop(name, &e) != 0 || e.seq != out || \
+                    e.check != YF_RCHECK(0, out)) \
+                    return -1; \
+                out++; \
+            } \
+        } \
+        \
+        YF_TEST_PRINT(#type "_push", #name ", <until full>", ""); \
+        while (1) { \
+            e = (elem_t){0, in, YF_RCHECK(0, in)}; \
+            if (yf_##type##_push(name, &e) != 0) \
+                break; \
+            in++; \
+        } \
+        if (in - out != 8) \
+            return -1; \
+        \
+        YF_TEST_PRINT(#type "_pop", #name ", <until empty>", ""); \
+        while (yf_##type##_pop(name, &e) == 0) { \
+            if (e.seq != out || e.check != YF_RCHECK(0, out)) \
+                return -1; \
+            out++; \
+        } \
+        if (out != in) \
+            return -1; \
+        \
+        YF_TEST_PRINT(#type "_deinit", #name, ""); \
+        yf_##type##_deinit(name); \
+    } while (0)
+
+/* Single-producer ring and its producer's result. */
+static yf_spsc_t *spsc_ = NULL;
+
+/* Multi-producer ring and the number of elements popped. */
+static yf_mpmc_t *mpmc_ = NULL;
+static atomic_uint popped_ = 0;
+
+/* Pushes a sequence of elements onto the single-producer ring. */
+static int produce_spsc(YF_UNUSED void *arg)
+{
+    for (uint32_t i = 0; i < YF_RN; i++) {
+        const elem_t e = {0, i, YF_RCHECK(0, i)};
+        while (yf_spsc_push(spsc_, &e) != 0)
+            thrd_yield();
+    }
+
+    return 0;
+}
+
+/* Pushes a sequence of elements onto the multi-producer ring. */
+static int produce_mpmc(void *arg)
+{
+    const uint32_t prod = (uint32_t)(uintptr_t)arg;
+
+    for (uint32_t i = 0; i < YF_RN; i++) {
+        const elem_t e = {prod, i, YF_RCHECK(prod, i)};
+        while (yf_mpmc_push(mpmc_, &e) != 0)
+            thrd_yield();
+    }
+
+    return 0;
+}
+
+/* Pops elements from the multi-producer ring until all were popped.
+   Elements from the same producer must be seen in order. */
+static int consume_mpmc(void *arg)
+{
+    unsigned *counts = arg;
+    int64_t last[YF_RPRODN];
+    for (int i = 0; i < YF_RPRODN; i++)
+        last[i] = -1;
+
+    while (atomic_load(&popped_) < YF_RN * YF_RPRODN) {
+        elem_t e;
+        if (yf_mpmc_pop(mpmc_, &e) != 0) {
+            thrd_yield();
+            continue;
+        }
+
+        if (e.prod >= YF_RPRODN || e.check != YF_RCHECK(e.prod, e.seq) ||
+            (int64_t)e.seq <= last[e.prod])
+            return -1;
+
+        last[e.prod] = e.seq;
+        counts[e.prod]++;
+        atomic_fetch_add(&popped_, 1);
+    }
+
+    return 0;
+}
+
+/* Tests rings with concurrent producers and consumers. */
+static int test_stress(void)
+{
+    char s[64] = {0};
+
+    snprintf(s, sizeof s, "<1 producer, 1 consumer, %d elems>", YF_RN);
+    YF_TEST_PRINT("spsc", s, "");
+
+    if ((spsc_ = yf_spsc_init(sizeof(elem_t), 64)) == NULL)
+        return -1;
+
+    thrd_t prod;
+    if (thrd_create(&prod, produce_spsc, NULL) != thrd_success)
+        return -1;
+
+    int r = 0;
+    for (uint32_t i = 0; i < YF_RN; i++) {
+        elem_t e;
+        while (yf_spsc_pop(spsc_, &e) != 0)
+            thrd_yield();
+        if (e.seq != i || e.check != YF_RCHECK(0, i))
+            r = -1;
+    }
+
+    int res;
+    if (thrd_join(prod, &res) != thrd_success || res != 0)
+        r = -1;
+    yf_spsc_deinit(spsc_);
+    if (r != 0)
+        return -1;
+
+    snprintf(s, sizeof s, "<%d producers, %d consumers, %d elems each>",
+             YF_RPRODN, YF_RCONSN, YF_RN);
+    YF_TEST_PRINT("mpmc", s, "");
+
+    if ((mpmc_ = yf_mpmc_init(sizeof(elem_t), 256)) == NULL)
+        return -1;
+    atomic_store(&popped_, 0);
+
+    unsigned counts[YF_RCONSN][YF_RPRODN] = {0};
+    thrd_t prods[YF_RPRODN], conss[YF_RCONSN];
+    for (int i = 0; i < YF_RCONSN; i++) {
+        if (thrd_create(conss+i, consume_mpmc, counts[i]) != thrd_success)
+            return -1;
+    }
+    for (int i = 0; i < YF_RPRODN; i++) {
+        if (thrd_create(prods+i, produce_mpmc,
+                        (void *)(uintptr_t)i) != thrd_success)
+            return -1;
+    }
+
+    for (int i = 0; i < YF_RPRODN; i++) {
+        if (thrd_join(prods[i], &res) != thrd_success || res != 0)
+            r = -1;
+    }
+    for (int i = 0; i < YF_RCONSN; i++) {
+        if (thrd_join(conss[i], &res) != thrd_success || res != 0)
+            r = -1;
+    }
+
+    for (int i = 0; i < YF_RPRODN; i++) {
+        unsigned n = 0;
+        for (int j = 0; j < YF_RCONSN; j++)
+            n += counts[j][i];
+        if (n != YF_RN)
+            r = -1;
+    }
+
+    elem_t e;
+    if (yf_mpmc_pop(mpmc_, &e) == 0)
+        r = -1;
+
+    yf_mpmc_deinit(mpmc_);
+    return r;
+}
+
+/* Tests rings. */
+int yf_test_ring(void)
+{
+    YF_RBASIC(spsc, ring);
+    YF_RBASIC(mpmc, ring);
+
+    return test_stress();
+}
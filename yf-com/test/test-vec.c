@@ -0,0 +1,116 @@
+/*
+ * YF
+ * test-vec.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include <stdio.h>
+
+#include "test.h"
+#include "yf-vec.h"
+#include "yf-error.h"
+
+/* Element type used by 'test_vec'. */
+typedef struct {
+    int key;
+    double val;
+} elem_t;
+
+/* Compares two 'elem_t' by key. */
+static int cmp_elem(const void *a, const void *b)
+{
+    return ((const elem_t *)a)->key - ((const elem_t *)b)->key;
+}
+
+/* Prints the keys of all elements. */
+static void print_vec(yf_vec_t *vec)
+{
+    size_t n;
+    const elem_t *elems = yf_vec_getdata(vec, &n);
+    for (size_t i = 0; i < n; i++)
+        printf(" %d", elems[i].key);
+    puts("");
+}
+
+/* Tests growable array. */
+int yf_test_vec(void)
+{
+    YF_TEST_PRINT("init", "0", "NULL");
+    if (yf_vec_init(0) != NULL || yf_geterr() != YF_ERR_INVARG)
+        return -1;
+
+    YF_TEST_PRINT("init", "sizeof(elem_t)", "vec");
+    yf_vec_t *vec = yf_vec_init(sizeof(elem_t));
+    if (vec == NULL || yf_vec_getlen(vec) != 0 ||
+        yf_vec_getdata(vec, NULL) != NULL)
+        return -1;
+
+    YF_TEST_PRINT("pop", "vec, NULL", "");
+    if (yf_vec_pop(vec, NULL) == 0 || yf_geterr() != YF_ERR_NOTFND)
+        return -1;
+
+    YF_TEST_PRINT("push", "vec, <100 elems>", "");
+    for (int i = 0; i < 100; i++) {
+        const elem_t e = {(i * 37) % 100, i * 0.5};
+        if (yf_vec_push(vec, &e) != 0)
+            return -1;
+    }
+    if (yf_vec_getlen(vec) != 100 || YF_VEC_AT(vec, elem_t, 1)->key != 37 ||
+        YF_VEC_AT(vec, elem_t, 99)->val != 49.5)
+        return -1;
+
+    YF_TEST_PRINT("sort", "vec, cmp_elem", "");
+    yf_vec_sort(vec, cmp_elem);
+    for (int i = 0; i < 100; i++) {
+        if (YF_VEC_AT(vec, elem_t, i)->key != i)
+            return -1;
+    }
+
+    elem_t e;
+
+    YF_TEST_PRINT("pop", "vec, &e", "");
+    if (yf_vec_pop(vec, &e) != 0 || e.key != 99 || yf_vec_getlen(vec) != 99)
+        return -1;
+
+    YF_TEST_PRINT("swaprm", "vec, 10, &e", "");
+    yf_vec_swaprm(vec, 10, &e);
+    if (e.key != 10 || YF_VEC_AT(vec, elem_t, 10)->key != 98 ||
+        yf_vec_getlen(vec) != 98)
+        return -1;
+
+    YF_TEST_PRINT("swaprm", "vec, <last>, NULL", "");
+    yf_vec_swaprm(vec, yf_vec_getlen(vec) - 1, NULL);
+    if (yf_vec_getlen(vec) != 97 || YF_VEC_AT(vec, elem_t, 96)->key != 96)
+        return -1;
+
+    while (yf_vec_getlen(vec) > 8)
+        yf_vec_pop(vec, NULL);
+    print_vec(vec);
+
+    YF_TEST_PRINT("clear", "vec", "");
+    const void *data = yf_vec_getdata(vec, NULL);
+    yf_vec_clear(vec);
+    if (yf_vec_getlen(vec) != 0)
+        return -1;
+
+    YF_TEST_PRINT("reserve", "vec, 100", "");
+    if (yf_vec_reserve(vec, 100) != 0 || yf_vec_getdata(vec, NULL) != data)
+        return -1;
+
+    YF_TEST_PRINT("reserve", "vec, 1000", "");
+    if (yf_vec_reserve(vec, 1000) != 0)
+        return -1;
+    data = yf_vec_getdata(vec, NULL);
+    for (int i = 0; i < 1000; i++) {
+        const elem_t e = {i, 0.0};
+        yf_vec_push(vec, &e);
+    }
+    if (yf_vec_getdata(vec, NULL) != data || yf_vec_getlen(vec) != 1000)
+        return -1;
+
+    YF_TEST_PRINT("deinit", "vec", "");
+    yf_vec_deinit(vec);
+
+    return 0;
+}
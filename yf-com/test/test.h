@@ -0,0 +1 @@
+../../test/test.h
\ No newline at end of file
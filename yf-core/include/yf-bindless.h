@@ -0,0 +1,94 @@
+/*
+ * YF
+ * yf-bindless.h
+ *
+ * Copyright © 2020 Gustavo C. Viegas.
+ */
+
+#ifndef YF_YF_BINDLESS_H
+#define YF_YF_BINDLESS_H
+
+#include "yf/com/yf-defs.h"
+
+#include "yf-context.h"
+#include "yf-dtable.h"
+
+YF_DECLS_BEGIN
+
+/**
+ * Bindings of the bindless table.
+ *
+ * 'YF_BINDLESS_IMAGES' is an array of 'YF_DTYPE_ISAMPLER' elements and
+ * 'YF_BINDLESS_BUFFERS' is an array of 'YF_DTYPE_MUTABLE' elements.
+ */
+#define YF_BINDLESS_IMAGES  0
+#define YF_BINDLESS_BUFFERS 1
+
+/**
+ * Gets the bindless table of a context.
+ *
+ * The bindless table is a descriptor table with a single allocation, whose
+ * elements are partially bound and can be updated after the table is set
+ * in a command buffer. Images and buffers are added to it with
+ * 'yf_image_getindex()' and 'yf_buffer_getindex()', and shaders select them
+ * using the indices returned by these functions.
+ *
+ * The table is managed by the context and must not be deinitialized nor
+ * reallocated. When used in a command buffer, allocation zero must be set.
+ *
+ * Requires the descriptor indexing features of the device.
+ *
+ * @param ctx: The context.
+ * @return: On success, returns the bindless table. Otherwise, 'NULL' is
+ *  returned and the global error is set to indicate the cause.
+ */
+yf_dtable_t *yf_getbindless(yf_context_t *ctx);
+
+/**
+ * Adds an image to the bindless table.
+ *
+ * The index remains valid until released with 'yf_image_ungetindex()'.
+ *
+ * @param img: The image.
+ * @param layer: The image layer to use.
+ * @param splr: The sampler to combine with the image. Can be 'NULL'.
+ * @param index: The destination for the element index.
+ * @return: On success, returns zero. Otherwise, a non-zero value is returned
+ *  and the global error is set to indicate the cause.
+ */
+int yf_image_getindex(yf_image_t *img, unsigned layer,
+                      const yf_sampler_t *splr, unsigned *index);
+
+/**
+ * Releases an image index obtained from the bindless table.
+ *
+ * @param img: The image.
+ * @param index: The index to release.
+ */
+void yf_image_ungetindex(yf_image_t *img, unsigned index);
+
+/**
+ * Adds a buffer to the bindless table.
+ *
+ * The whole buffer, up to the maximum range of mutable descriptors, is made
+ * available. The index remains valid until released with
+ * 'yf_buffer_ungetindex()'.
+ *
+ * @param buf: The buffer.
+ * @param index: The destination for the element index.
+ * @return: On success, returns zero. Otherwise, a non-zero value is returned
+ *  and the global error is set to indicate the cause.
+ */
+int yf_buffer_getindex(yf_buffer_t *buf, unsigned *index);
+
+/**
+ * Releases a buffer index obtained from the bindless table.
+ *
+ * @param buf: The buffer.
+ * @param index: The index to release.
+ */
+void yf_buffer_ungetindex(yf_buffer_t *buf, unsigned index);
+
+YF_DECLS_END
+
+#endif /* YF_YF_BINDLESS_H */
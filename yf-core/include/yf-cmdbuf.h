@@ -8,6 +8,8 @@
 #ifndef YF_YF_CMDBUF_H
 #define YF_YF_CMDBUF_H
 
+#include <stdint.h>
+
 #include "yf/com/yf-defs.h"
 
 #include "yf-gstate.h"
@@ -38,6 +40,9 @@ typedef struct yf_cmdbuf yf_cmdbuf_t;
  * The returned command buffer must only receive encodings valid for its
  * type, otherwise 'yf_cmdbuf_end()' will fail.
  *
+ * Command buffers are not thread-safe. Calls that get, end, execute or
+ * reset command buffers of a given context must not happen concurrently.
+ *
  * @param ctx: The context.
  * @param cmdbuf: The 'YF_CMDBUF' value indicating the command buffer type.
  * @return: On success, returns a command buffer ready for encoding. Otherwise,
@@ -61,6 +66,7 @@ int yf_cmdbuf_end(yf_cmdbuf_t *cmdb);
  * Executes pending command buffers.
  *
  * Resources are once again available for use after this function completes.
+ * 'yf_cmdbuf_submit()' can be used instead to execute without waiting.
  *
  * @param ctx: The context that owns the command buffers to execute.
  * @return: On success, returns zero. Otherwise, a non-zero value is returned
@@ -77,6 +83,61 @@ int yf_cmdbuf_exec(yf_context_t *ctx);
  */
 void yf_cmdbuf_reset(yf_context_t *ctx);
 
+/**
+ * Gets the serial of pending command buffers.
+ *
+ * Each execution of command buffers is identified by a serial number, which
+ * increases monotonically. The value returned by this function identifies
+ * the next execution - that is, the one that will include every command
+ * buffer ended from now on. Executions that have nothing to submit do not
+ * consume a serial.
+ *
+ * @param ctx: The context.
+ * @return: The serial of the next execution.
+ */
+uint64_t yf_cmdbuf_getserial(yf_context_t *ctx);
+
+/**
+ * Checks whether a given execution of command buffers has completed.
+ *
+ * This function never blocks. Resources used by command buffers of a given
+ * serial can be released once this function returns a non-zero value for it.
+ *
+ * @param ctx: The context.
+ * @param serial: The serial to check, as returned by 'yf_cmdbuf_getserial'.
+ * @return: If the execution has completed, returns a non-zero value.
+ *  Otherwise, zero is returned.
+ */
+int yf_cmdbuf_completed(yf_context_t *ctx, uint64_t serial);
+
+/**
+ * Executes pending command buffers without waiting for them to complete.
+ *
+ * Unlike 'yf_cmdbuf_exec()', this function returns as soon as the command
+ * buffers are submitted. Resources used by them must not be modified by the
+ * host until the execution completes, which can be checked with
+ * 'yf_cmdbuf_completed()' or awaited with 'yf_cmdbuf_wait()'.
+ *
+ * @param ctx: The context that owns the command buffers to execute.
+ * @return: On success, returns zero. Otherwise, a non-zero value is returned
+ *  and the global error is set to indicate the cause.
+ */
+int yf_cmdbuf_submit(yf_context_t *ctx);
+
+/**
+ * Waits for a given execution of command buffers to complete.
+ *
+ * Serials of executions that have not happened yet refer to the last
+ * execution, so waiting for the serial returned by 'yf_cmdbuf_getserial()'
+ * waits for every command buffer executed so far.
+ *
+ * @param ctx: The context.
+ * @param serial: The serial to wait for.
+ * @return: On success, returns zero. Otherwise, a non-zero value is returned
+ *  and the global error is set to indicate the cause.
+ */
+int yf_cmdbuf_wait(yf_context_t *ctx, uint64_t serial);
+
 /*
  * State
  */
@@ -301,6 +362,61 @@ void yf_cmdbuf_copyimg(yf_cmdbuf_t *cmdb, yf_image_t *dst, yf_off3_t dst_off,
                        yf_image_t *src, yf_off3_t src_off, unsigned src_layer,
                        unsigned src_level, yf_dim3_t dim, unsigned layer_n);
 
+/**
+ * Type defining a region to copy between buffers.
+ */
+typedef struct yf_bufcpy {
+    size_t dst_off;
+    size_t src_off;
+    size_t size;
+} yf_bufcpy_t;
+
+/**
+ * Copies multiple regions between buffers.
+ *
+ * CMDBUF_XFER
+ *
+ * Regions must not overlap.
+ *
+ * @param cmdb: The command buffer.
+ * @param dst: The destination buffer.
+ * @param src: The source buffer.
+ * @param regions: The regions to copy.
+ * @param region_n: The number of regions.
+ */
+void yf_cmdbuf_copybufs(yf_cmdbuf_t *cmdb, yf_buffer_t *dst, yf_buffer_t *src,
+                        const yf_bufcpy_t *regions, unsigned region_n);
+
+/**
+ * Type defining a region to copy between images.
+ */
+typedef struct yf_imgcpy {
+    yf_off3_t dst_off;
+    unsigned dst_layer;
+    unsigned dst_level;
+    yf_off3_t src_off;
+    unsigned src_layer;
+    unsigned src_level;
+    yf_dim3_t dim;
+    unsigned layer_n;
+} yf_imgcpy_t;
+
+/**
+ * Copies multiple regions between images.
+ *
+ * CMDBUF_XFER
+ *
+ * Regions must not overlap.
+ *
+ * @param cmdb: The command buffer.
+ * @param dst: The destination image.
+ * @param src: The source image.
+ * @param regions: The regions to copy.
+ * @param region_n: The number of regions.
+ */
+void yf_cmdbuf_copyimgs(yf_cmdbuf_t *cmdb, yf_image_t *dst, yf_image_t *src,
+                        const yf_imgcpy_t *regions, unsigned region_n);
+
 /*
  * Synchronization
  */
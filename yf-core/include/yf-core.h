@@ -11,15 +11,19 @@
 /**
  * Core interface.
  */
+#include "yf-bindless.h"
 #include "yf-buffer.h"
 #include "yf-cmdbuf.h"
 #include "yf-context.h"
 #include "yf-cstate.h"
+#include "yf-debug.h"
 #include "yf-dtable.h"
 #include "yf-gstate.h"
 #include "yf-image.h"
 #include "yf-limits.h"
+#include "yf-memory.h"
 #include "yf-pass.h"
+#include "yf-readback.h"
 #include "yf-sampler.h"
 #include "yf-stage.h"
 #include "yf-vinput.h"
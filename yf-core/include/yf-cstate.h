@@ -32,6 +32,11 @@ typedef struct yf_cconf {
 /**
  * Initializes a new compute state.
  *
+ * States are cached by configuration. If a state created from an identical
+ * configuration exists, it is returned instead of a new one, and its
+ * reference count is incremented. The objects referenced by the
+ * configuration must not be deinitialized while the state is in use.
+ *
  * @param ctx: The context.
  * @param conf: The configuration to use.
  * @return: On success, returns a new state. Otherwise, 'NULL' is returned
@@ -59,6 +64,9 @@ yf_dtable_t *yf_cstate_getdtb(yf_cstate_t *cst, unsigned index);
 /**
  * Deinitializes a compute state.
  *
+ * Shared states are only destroyed when every initialization that
+ * returned them is matched by a call to this function.
+ *
  * @param cst: The state to deinitialize. Can be 'NULL'.
  */
 void yf_cstate_deinit(yf_cstate_t *cst);
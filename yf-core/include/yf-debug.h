@@ -0,0 +1,118 @@
+/*
+ * YF
+ * yf-debug.h
+ *
+ * Copyright © 2020 Gustavo C. Viegas.
+ */
+
+#ifndef YF_YF_DEBUG_H
+#define YF_YF_DEBUG_H
+
+#include "yf/com/yf-defs.h"
+
+#include "yf-buffer.h"
+#include "yf-image.h"
+#include "yf-gstate.h"
+#include "yf-cstate.h"
+#include "yf-dtable.h"
+#include "yf-cmdbuf.h"
+
+YF_DECLS_BEGIN
+
+/**
+ * Debug names and labels.
+ *
+ * These are forwarded to external tools through the 'VK_EXT_debug_utils'
+ * extension. Support is compiled in devel builds (unless 'YF_NO_DBGUTILS'
+ * is defined) or when 'YF_DBGUTILS' is defined, and the definitions must
+ * match the ones used to build the library. Otherwise, the functions are
+ * replaced by macros that expand to nothing. If the extension is not
+ * available, the functions do nothing.
+ */
+#if defined(YF_DEVEL) && !defined(YF_NO_DBGUTILS) && !defined(YF_DBGUTILS)
+# define YF_DBGUTILS
+#endif
+
+/**
+ * Maximum length of a command buffer label, including the terminator.
+ * Longer labels are truncated.
+ */
+#define YF_LABELMAX 48
+
+#ifdef YF_DBGUTILS
+
+/**
+ * Names a buffer.
+ *
+ * @param buf: The buffer.
+ * @param name: The name.
+ */
+void yf_buffer_setname(yf_buffer_t *buf, const char *name);
+
+/**
+ * Names an image.
+ *
+ * @param img: The image.
+ * @param name: The name.
+ */
+void yf_image_setname(yf_image_t *img, const char *name);
+
+/**
+ * Names a graphics state.
+ *
+ * @param gst: The state.
+ * @param name: The name.
+ */
+void yf_gstate_setname(yf_gstate_t *gst, const char *name);
+
+/**
+ * Names a compute state.
+ *
+ * @param cst: The state.
+ * @param name: The name.
+ */
+void yf_cstate_setname(yf_cstate_t *cst, const char *name);
+
+/**
+ * Names a descriptor table.
+ *
+ * Only the allocations that exist when this function is called are named.
+ *
+ * @param dtb: The dtable.
+ * @param name: The name.
+ */
+void yf_dtable_setname(yf_dtable_t *dtb, const char *name);
+
+/**
+ * Begins a labeled region of commands.
+ *
+ * Regions can be nested. Regions not ended when the command buffer is
+ * ended are ended implicitly.
+ *
+ * @param cmdb: The command buffer.
+ * @param label: The label.
+ */
+void yf_cmdbuf_beginlabel(yf_cmdbuf_t *cmdb, const char *label);
+
+/**
+ * Ends the last labeled region of commands.
+ *
+ * @param cmdb: The command buffer.
+ */
+void yf_cmdbuf_endlabel(yf_cmdbuf_t *cmdb);
+
+#else
+
+# define yf_buffer_setname(buf, name)       ((void)(buf), (void)(name))
+# define yf_image_setname(img, name)        ((void)(img), (void)(name))
+# define yf_gstate_setname(gst, name)       ((void)(gst), (void)(name))
+# define yf_cstate_setname(cst, name)       ((void)(cst), (void)(name))
+# define yf_dtable_setname(dtb, name)       ((void)(dtb), (void)(name))
+# define yf_cmdbuf_beginlabel(cmdb, label)  ((void)(cmdb), (void)(label))
+# define yf_cmdbuf_endlabel(cmdb)           ((void)(cmdb))
+
+#endif /* YF_DBGUTILS */
+
+YF_DECLS_END
+
+#endif /* YF_YF_DEBUG_H */
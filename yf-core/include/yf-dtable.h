@@ -68,9 +68,11 @@ yf_dtable_t *yf_dtable_init(yf_context_t *ctx, const yf_dentry_t *entries,
  * necessary for operations requiring different values, as the memory contents
  * are applied at execution time, rather than encoding time.
  *
- * Multiple calls to this function replaces, rather than increases, the number
- * of available allocations. Any previous contents written to a given
- * allocation should be considered invalid.
+ * Multiple calls to this function change the number of available
+ * allocations. Increasing this number preserves the contents of existing
+ * allocations, as new resources are chained to the previous ones. When the
+ * number decreases, the allocations removed are kept for reuse, and their
+ * contents should be considered invalid.
  *
  * @param dtb: The dtable.
  * @param n: The number of copies to allocate.
@@ -82,6 +84,8 @@ int yf_dtable_alloc(yf_dtable_t *dtb, unsigned n);
 /**
  * Deallocates resources of a given descriptor table.
  *
+ * This releases every allocation, including the ones kept for reuse.
+ *
  * @param dtb: The dtable.
  */
 void yf_dtable_dealloc(yf_dtable_t *dtb);
@@ -73,6 +73,11 @@ typedef struct yf_gconf {
 /**
  * Initializes a new graphics state.
  *
+ * States are cached by configuration. If a state created from an identical
+ * configuration exists, it is returned instead of a new one, and its
+ * reference count is incremented. The objects referenced by the
+ * configuration must not be deinitialized while the state is in use.
+ *
  * @param ctx: The context.
  * @param conf: The configuration to use.
  * @return: On success, returns a new state. Otherwise, 'NULL' is returned
@@ -110,6 +115,9 @@ yf_dtable_t *yf_gstate_getdtb(yf_gstate_t *gst, unsigned index);
 /**
  * Deinitializes a graphics state.
  *
+ * Shared states are only destroyed when every initialization that
+ * returned them is matched by a call to this function.
+ *
  * @param gst: The state to deinitialize. Can be 'NULL'.
  */
 void yf_gstate_deinit(yf_gstate_t *gst);
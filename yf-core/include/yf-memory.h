@@ -0,0 +1,85 @@
+/*
+ * YF
+ * yf-memory.h
+ *
+ * Copyright © 2020 Gustavo C. Viegas.
+ */
+
+#ifndef YF_YF_MEMORY_H
+#define YF_YF_MEMORY_H
+
+#include <stddef.h>
+
+#include "yf/com/yf-defs.h"
+
+#include "yf-context.h"
+
+YF_DECLS_BEGIN
+
+/**
+ * Maximum number of memory heaps.
+ */
+#define YF_HEAPMAX 16
+
+/**
+ * Type defining the memory budget of a heap.
+ *
+ * 'usage' is the amount of memory currently in use, and 'budget' is the
+ * amount that can be used before allocations start to fail or performance
+ * degrades.
+ */
+typedef struct yf_budget {
+    size_t size;
+    size_t usage;
+    size_t budget;
+    int local;
+} yf_budget_t;
+
+/**
+ * Gets the memory budget of each heap.
+ *
+ * If the device supports the 'VK_EXT_memory_budget' extension, the values
+ * are provided by the implementation. Otherwise, usage only accounts for
+ * allocations made by this context and the budget is the heap size.
+ *
+ * @param ctx: The context.
+ * @param budgets: The destination array for the budgets. Must have space for
+ *  at least 'YF_HEAPMAX' elements.
+ * @return: The number of heaps.
+ */
+unsigned yf_getbudget(yf_context_t *ctx, yf_budget_t *budgets);
+
+/**
+ * Memory pressure levels.
+ */
+#define YF_PRESSURE_HIGH     1
+#define YF_PRESSURE_CRITICAL 2
+
+/**
+ * Sets the function to call when memory is under pressure.
+ *
+ * The callback is invoked from within the allocation that caused the
+ * pressure. A level of 'YF_PRESSURE_HIGH' indicates that the allocation will
+ * make usage of the heap exceed the threshold of its budget. A level of
+ * 'YF_PRESSURE_CRITICAL' indicates that the allocation failed, in which case
+ * it will be attempted once more after the callback returns.
+ *
+ * Objects deinitialized from within the callback release their memory once
+ * pending work completes. The callback must not allocate device memory.
+ *
+ * @param ctx: The context.
+ * @param threshold: The fraction of the budget above which pressure is
+ *  signaled, in the range [0, 1].
+ * @param callb: The function to call on memory pressure. Can be 'NULL'.
+ * @param arg: The generic argument to pass on 'callb' calls. Can be 'NULL'.
+ * @return: On success, returns zero. Otherwise, a non-zero value is returned
+ *  and the global error is set to indicate the cause.
+ */
+int yf_setpressure(yf_context_t *ctx, float threshold,
+                   void (*callb)(int level, unsigned heap, size_t size,
+                                 void *arg),
+                   void *arg);
+
+YF_DECLS_END
+
+#endif /* YF_YF_MEMORY_H */
@@ -0,0 +1,114 @@
+/*
+ * YF
+ * yf-readback.h
+ *
+ * Copyright © 2020 Gustavo C. Viegas.
+ */
+
+#ifndef YF_YF_READBACK_H
+#define YF_YF_READBACK_H
+
+#include <stddef.h>
+
+#include "yf/com/yf-defs.h"
+#include "yf/com/yf-types.h"
+
+#include "yf-buffer.h"
+#include "yf-image.h"
+
+YF_DECLS_BEGIN
+
+/**
+ * Opaque type defining a request to read device data back to the host.
+ *
+ * Readbacks are recorded as part of the pending command buffers and complete
+ * when their execution finishes, which is noticed by 'yf_readback_poll()',
+ * 'yf_cmdbuf_wait()' and later executions. The data read is stored in host
+ * memory owned by the context.
+ */
+typedef struct yf_readback yf_readback_t;
+
+/**
+ * Readback states.
+ */
+#define YF_READBACK_FAILED  -1
+#define YF_READBACK_PENDING  0
+#define YF_READBACK_DONE     1
+
+/**
+ * Requests the contents of a buffer.
+ *
+ * The read happens after all previously ended command buffers.
+ *
+ * @param buf: The buffer to read from.
+ * @param offset: The offset from the beginning of the buffer.
+ * @param size: The number of bytes to read.
+ * @param callb: The function to call when the readback completes. Can be
+ *  'NULL'.
+ * @param arg: The generic argument to pass on 'callb' calls. Can be 'NULL'.
+ * @return: On success, returns a new readback. Otherwise, 'NULL' is returned
+ *  and the global error is set to indicate the cause.
+ */
+yf_readback_t *yf_buffer_read(yf_buffer_t *buf, size_t offset, size_t size,
+                              void (*callb)(yf_readback_t *rb, int state,
+                                            void *arg),
+                              void *arg);
+
+/**
+ * Requests the contents of an image.
+ *
+ * The read happens after all previously ended command buffers. Data is
+ * tightly packed, in the image's pixel format.
+ *
+ * @param img: The image to read from.
+ * @param off: The offset from the beginning of the image, in pixels.
+ * @param dim: The read dimensions, in pixels.
+ * @param layer: The source layer.
+ * @param level: The source level.
+ * @param callb: The function to call when the readback completes. Can be
+ *  'NULL'.
+ * @param arg: The generic argument to pass on 'callb' calls. Can be 'NULL'.
+ * @return: On success, returns a new readback. Otherwise, 'NULL' is returned
+ *  and the global error is set to indicate the cause.
+ */
+yf_readback_t *yf_image_read(yf_image_t *img, yf_off3_t off, yf_dim3_t dim,
+                             unsigned layer, unsigned level,
+                             void (*callb)(yf_readback_t *rb, int state,
+                                           void *arg),
+                             void *arg);
+
+/**
+ * Polls the state of a readback.
+ *
+ * This function never blocks.
+ *
+ * @param rb: The readback.
+ * @return: The 'YF_READBACK' value indicating the current state.
+ */
+int yf_readback_poll(yf_readback_t *rb);
+
+/**
+ * Gets the data of a completed readback.
+ *
+ * The data is valid until the readback is deinitialized.
+ *
+ * @param rb: The readback.
+ * @param size: The destination for the data size, in bytes. Can be 'NULL'.
+ * @return: If the readback is not done, returns 'NULL'. Otherwise, the data
+ *  read is returned.
+ */
+const void *yf_readback_getdata(yf_readback_t *rb, size_t *size);
+
+/**
+ * Deinitializes a readback.
+ *
+ * Pending readbacks can be deinitialized, in which case their callbacks will
+ * not be called.
+ *
+ * @param rb: The readback to deinitialize. Can be 'NULL'.
+ */
+void yf_readback_deinit(yf_readback_t *rb);
+
+YF_DECLS_END
+
+#endif /* YF_YF_READBACK_H */
@@ -0,0 +1,251 @@
+/*
+ * YF
+ * bindless.c
+ *
+ * Copyright © 2020 Gustavo C. Viegas.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "yf/com/yf-util.h"
+#include "yf/com/yf-error.h"
+
+#include "yf-bindless.h"
+#include "yf-limits.h"
+#include "context.h"
+#include "dtable.h"
+#include "buffer.h"
+#include "image.h"
+
+/* TODO: Should be defined elsewhere. */
+#define YF_BDLSIMG 4096
+#define YF_BDLSBUF 1024
+
+/* Element indices of a binding. */
+typedef struct {
+    /* released indices, reused before new ones */
+    unsigned *free;
+    unsigned free_n;
+    unsigned next;
+    unsigned max;
+} slots_t;
+
+/* Bindless table stored in a context. */
+typedef struct {
+    yf_dtable_t *dtb;
+    slots_t imgs;
+    slots_t bufs;
+} priv_t;
+
+/* Destroys the 'priv_t' data stored in a given context. */
+static void destroy_priv(yf_context_t *ctx)
+{
+    assert(ctx != NULL);
+
+    priv_t *priv = ctx->bdls.priv;
+    if (priv == NULL)
+        return;
+
+    yf_dtable_deinit(priv->dtb);
+    free(priv->imgs.free);
+    free(priv->bufs.free);
+    free(priv);
+    ctx->bdls.priv = NULL;
+}
+
+/* Gets the bindless table data of a given context, creating it if needed. */
+static priv_t *get_priv(yf_context_t *ctx)
+{
+    assert(ctx != NULL);
+
+    if (ctx->bdls.priv != NULL)
+        return ctx->bdls.priv;
+
+    if (ctx->features_v12.descriptorIndexing != VK_TRUE) {
+        yf_seterr(YF_ERR_UNSUP, __func__);
+        return NULL;
+    }
+
+    VkPhysicalDeviceVulkan12Properties prop_v12 = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES,
+        .pNext = NULL
+    };
+    VkPhysicalDeviceProperties2 prop2 = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+        .pNext = &prop_v12
+    };
+    vkGetPhysicalDeviceProperties2(ctx->phy_dev, &prop2);
+
+    /* combined image samplers count as both sampled images and samplers */
+    unsigned img_n = YF_BDLSIMG;
+    img_n = YF_MIN(img_n,
+                   prop_v12.maxPerStageDescriptorUpdateAfterBindSampledImages);
+    img_n = YF_MIN(img_n,
+                   prop_v12.maxPerStageDescriptorUpdateAfterBindSamplers);
+    img_n = YF_MIN(img_n,
+                   prop_v12.maxDescriptorSetUpdateAfterBindSampledImages);
+    img_n = YF_MIN(img_n, prop_v12.maxDescriptorSetUpdateAfterBindSamplers);
+
+    unsigned buf_n = YF_BDLSBUF;
+    buf_n = YF_MIN(buf_n,
+                   prop_v12.maxPerStageDescriptorUpdateAfterBindStorageBuffers);
+    buf_n = YF_MIN(buf_n,
+                   prop_v12.maxDescriptorSetUpdateAfterBindStorageBuffers);
+
+    const unsigned res_max = prop_v12.maxPerStageUpdateAfterBindResources;
+    if (img_n + buf_n > res_max) {
+        buf_n = YF_MIN(buf_n, res_max >> 2);
+        img_n = YF_MIN(img_n, res_max - buf_n);
+    }
+
+    if (img_n == 0 || buf_n == 0) {
+        yf_seterr(YF_ERR_LIMIT, __func__);
+        return NULL;
+    }
+
+    priv_t *priv = calloc(1, sizeof(priv_t));
+    if (priv == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        return NULL;
+    }
+    priv->imgs.free = malloc(img_n * sizeof *priv->imgs.free);
+    priv->bufs.free = malloc(buf_n * sizeof *priv->bufs.free);
+    if (priv->imgs.free == NULL || priv->bufs.free == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        free(priv->imgs.free);
+        free(priv->bufs.free);
+        free(priv);
+        return NULL;
+    }
+    priv->imgs.max = img_n;
+    priv->bufs.max = buf_n;
+
+    const yf_dentry_t entries[] = {
+        {YF_BINDLESS_IMAGES, YF_DTYPE_ISAMPLER, img_n, NULL},
+        {YF_BINDLESS_BUFFERS, YF_DTYPE_MUTABLE, buf_n, NULL}
+    };
+
+    priv->dtb = yf_dtable_initbdls(ctx, entries,
+                                   sizeof entries / sizeof *entries);
+    if (priv->dtb == NULL || yf_dtable_alloc(priv->dtb, 1) != 0) {
+        yf_dtable_deinit(priv->dtb);
+        free(priv->imgs.free);
+        free(priv->bufs.free);
+        free(priv);
+        return NULL;
+    }
+
+    ctx->bdls.priv = priv;
+    ctx->bdls.deinit_callb = destroy_priv;
+    return priv;
+}
+
+/* Obtains an unused element index. */
+static int obtain_slot(slots_t *slots, unsigned *index)
+{
+    assert(slots != NULL);
+    assert(index != NULL);
+
+    if (slots->free_n > 0) {
+        *index = slots->free[--slots->free_n];
+        return 0;
+    }
+
+    if (slots->next == slots->max) {
+        yf_seterr(YF_ERR_LIMIT, __func__);
+        return -1;
+    }
+
+    *index = slots->next++;
+    return 0;
+}
+
+/* Yields an element index. */
+static void yield_slot(slots_t *slots, unsigned index)
+{
+    assert(slots != NULL);
+    assert(index < slots->next);
+    assert(slots->free_n < slots->next);
+
+    slots->free[slots->free_n++] = index;
+}
+
+yf_dtable_t *yf_getbindless(yf_context_t *ctx)
+{
+    assert(ctx != NULL);
+
+    priv_t *priv = get_priv(ctx);
+    return priv != NULL ? priv->dtb : NULL;
+}
+
+int yf_image_getindex(yf_image_t *img, unsigned layer,
+                      const yf_sampler_t *splr, unsigned *index)
+{
+    assert(img != NULL);
+    assert(index != NULL);
+
+    if (layer >= img->layers) {
+        yf_seterr(YF_ERR_INVARG, __func__);
+        return -1;
+    }
+
+    priv_t *priv = get_priv(img->ctx);
+    if (priv == NULL || obtain_slot(&priv->imgs, index) != 0)
+        return -1;
+
+    const yf_slice_t elements = {*index, 1};
+
+    if (yf_dtable_copyimg(priv->dtb, 0, YF_BINDLESS_IMAGES, elements, &img,
+                          &layer, splr) != 0) {
+        yield_slot(&priv->imgs, *index);
+        return -1;
+    }
+
+    return 0;
+}
+
+void yf_image_ungetindex(yf_image_t *img, unsigned index)
+{
+    assert(img != NULL);
+
+    priv_t *priv = img->ctx->bdls.priv;
+    assert(priv != NULL);
+
+    yf_dtable_resetimg(priv->dtb, 0, YF_BINDLESS_IMAGES, index);
+    yield_slot(&priv->imgs, index);
+}
+
+int yf_buffer_getindex(yf_buffer_t *buf, unsigned *index)
+{
+    assert(buf != NULL);
+    assert(index != NULL);
+
+    priv_t *priv = get_priv(buf->ctx);
+    if (priv == NULL || obtain_slot(&priv->bufs, index) != 0)
+        return -1;
+
+    const yf_limits_t *lim = yf_getlimits(buf->ctx);
+    const yf_slice_t elements = {*index, 1};
+    const size_t offset = 0;
+    const size_t size = YF_MIN(buf->size, lim->dtable.cpy_mut_sz_max);
+
+    if (yf_dtable_copybuf(priv->dtb, 0, YF_BINDLESS_BUFFERS, elements, &buf,
+                          &offset, &size) != 0) {
+        yield_slot(&priv->bufs, *index);
+        return -1;
+    }
+
+    return 0;
+}
+
+void yf_buffer_ungetindex(yf_buffer_t *buf, unsigned index)
+{
+    assert(buf != NULL);
+
+    priv_t *priv = buf->ctx->bdls.priv;
+    assert(priv != NULL);
+
+    /* partially bound, so stale descriptors are fine as long as unused */
+    yield_slot(&priv->bufs, index);
+}
@@ -16,6 +16,7 @@
 #include "buffer.h"
 #include "context.h"
 #include "memory.h"
+#include "retire.h"
 #include "yf-limits.h"
 
 yf_buffer_t *yf_buffer_init(yf_context_t *ctx, size_t size)
@@ -106,7 +107,7 @@ void yf_buffer_deinit(yf_buffer_t *buf)
     yf_publish(buf, YF_PUBSUB_DEINIT);
     yf_setpub(buf, YF_PUBSUB_NONE);
 
+    yf_retire_buffer(buf->ctx, buf->buffer);
     yf_buffer_free(buf);
-    vkDestroyBuffer(buf->ctx->device, buf->buffer, NULL);
     free(buf);
 }
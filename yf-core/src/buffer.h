@@ -15,6 +15,8 @@ struct yf_buffer {
     yf_context_t *ctx;
     VkBuffer buffer;
     VkDeviceMemory memory;
+    unsigned mem_heap;
+    size_t mem_size;
     size_t size;
     void *data;
 };
@@ -116,6 +116,11 @@ typedef struct yf_cmd_cpyimg {
     unsigned layer_n;
 } yf_cmd_cpyimg_t;
 
+/* The parameters of a 'begin label' command. */
+typedef struct yf_cmd_label {
+    char name[YF_LABELMAX];
+} yf_cmd_label_t;
+
 /* Command types. */
 #define YF_CMD_GST     0
 #define YF_CMD_CST     1
@@ -134,6 +139,8 @@ typedef struct yf_cmd_cpyimg {
 #define YF_CMD_CPYBUF  14
 #define YF_CMD_CPYIMG  15
 #define YF_CMD_SYNC    16
+#define YF_CMD_BLABEL  17
+#define YF_CMD_ELABEL  18
 
 /* Command of a given type. */
 typedef struct yf_cmd {
@@ -155,6 +162,7 @@ typedef struct yf_cmd {
         yf_cmd_disp_t disp;
         yf_cmd_cpybuf_t cpybuf;
         yf_cmd_cpyimg_t cpyimg;
+        yf_cmd_label_t label;
     };
 } yf_cmd_t;
 
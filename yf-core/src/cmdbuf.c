@@ -6,11 +6,13 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 #include <assert.h>
 
 #include "yf/com/yf-util.h"
 #include "yf/com/yf-error.h"
+#include "yf/com/yf-prof.h"
 
 #include "cmdbuf.h"
 #include "context.h"
@@ -31,13 +33,15 @@ static int grow_cmds(yf_cmdbuf_t *cmdb)
     unsigned cap = cmdb->cmd_cap << 1;
     cap = YF_MAX(cap, cmdb->cmd_cap + 1);
 
-    void *tmp = realloc(cmdb->cmds, cap * sizeof *cmdb->cmds);
+    const size_t sz = cmdb->cmd_cap * sizeof *cmdb->cmds;
+    void *tmp = yf_arena_realloc(cmdb->arena, cmdb->cmds, sz,
+                                 cap * sizeof *cmdb->cmds);
     if (tmp == NULL) {
         cap = cmdb->cmd_cap + 1;
-        if ((tmp = realloc(cmdb->cmds, cap * sizeof *cmdb->cmds)) == NULL) {
-            yf_seterr(YF_ERR_NOMEM, __func__);
+        tmp = yf_arena_realloc(cmdb->arena, cmdb->cmds, sz,
+                               cap * sizeof *cmdb->cmds);
+        if (tmp == NULL)
             return -1;
-        }
     }
     cmdb->cmds = tmp;
     cmdb->cmd_cap = cap;
@@ -45,21 +49,61 @@ static int grow_cmds(yf_cmdbuf_t *cmdb)
     return 0;
 }
 
+/* Destroys the command buffers kept in a given context. */
+static void destroy_cmdbs(yf_context_t *ctx)
+{
+    assert(ctx != NULL);
+
+    yf_cmdbuf_t *cmdb = ctx->cmdb.priv;
+    while (cmdb != NULL) {
+        yf_cmdbuf_t *next = cmdb->next;
+        yf_arena_deinit(cmdb->arena);
+        free(cmdb);
+        cmdb = next;
+    }
+
+    ctx->cmdb.priv = NULL;
+}
+
+/* Keeps a command buffer in its context for reuse.
+   The list of recycled command buffers is not locked, since command
+   buffers of a context are used from a single thread. */
+static void yield_cmdb(yf_cmdbuf_t *cmdb)
+{
+    assert(cmdb != NULL);
+
+    yf_arena_reset(cmdb->arena, 0);
+    cmdb->cmds = NULL;
+    cmdb->next = cmdb->ctx->cmdb.priv;
+    cmdb->ctx->cmdb.priv = cmdb;
+}
+
 yf_cmdbuf_t *yf_cmdbuf_get(yf_context_t *ctx, int cmdbuf)
 {
     assert(ctx != NULL);
 
-    yf_cmdbuf_t *cmdb = calloc(1, sizeof(yf_cmdbuf_t));
-    if (cmdb == NULL) {
-        yf_seterr(YF_ERR_NOMEM, __func__);
-        return NULL;
+    yf_cmdbuf_t *cmdb = ctx->cmdb.priv;
+    if (cmdb != NULL) {
+        ctx->cmdb.priv = cmdb->next;
+    } else {
+        cmdb = calloc(1, sizeof(yf_cmdbuf_t));
+        if (cmdb == NULL) {
+            yf_seterr(YF_ERR_NOMEM, __func__);
+            return NULL;
+        }
+        cmdb->arena = yf_arena_init(YF_CMDCAP * sizeof(yf_cmd_t) * 2);
+        if (cmdb->arena == NULL) {
+            free(cmdb);
+            return NULL;
+        }
+        ctx->cmdb.deinit_callb = destroy_cmdbs;
     }
     cmdb->ctx = ctx;
     cmdb->cmdbuf = cmdbuf;
-    cmdb->cmds = calloc(YF_CMDCAP, sizeof(yf_cmd_t));
+    cmdb->next = NULL;
+    cmdb->cmds = yf_arena_alloc(cmdb->arena, YF_CMDCAP * sizeof(yf_cmd_t));
     if (cmdb->cmds == NULL) {
-        yf_seterr(YF_ERR_NOMEM, __func__);
-        free(cmdb);
+        yield_cmdb(cmdb);
         return NULL;
     }
     cmdb->cmd_n = 0;
@@ -74,18 +118,39 @@ int yf_cmdbuf_end(yf_cmdbuf_t *cmdb)
     assert(cmdb != NULL);
 
     int r = -1;
-    if (!cmdb->invalid)
+    if (!cmdb->invalid) {
+        YF_PROF_BEGIN("cmdbuf_decode");
         r = yf_cmdbuf_decode(cmdb);
+        YF_PROF_END();
+    }
 
-    free(cmdb->cmds);
-    free(cmdb);
+    yield_cmdb(cmdb);
     return r;
 }
 
 int yf_cmdbuf_exec(yf_context_t *ctx)
 {
     assert(ctx != NULL);
-    return yf_cmdexec_exec(ctx);
+
+    YF_PROF_BEGIN("cmdbuf_exec");
+    const uint64_t serial = yf_cmdexec_getserial(ctx);
+    int r = yf_cmdexec_exec(ctx);
+    if (r == 0)
+        r = yf_cmdexec_wait(ctx, serial);
+    YF_PROF_END();
+
+    return r;
+}
+
+int yf_cmdbuf_submit(yf_context_t *ctx)
+{
+    assert(ctx != NULL);
+
+    YF_PROF_BEGIN("cmdbuf_submit");
+    const int r = yf_cmdexec_exec(ctx);
+    YF_PROF_END();
+
+    return r;
 }
 
 void yf_cmdbuf_reset(yf_context_t *ctx)
@@ -94,6 +159,29 @@ void yf_cmdbuf_reset(yf_context_t *ctx)
     yf_cmdexec_reset(ctx);
 }
 
+uint64_t yf_cmdbuf_getserial(yf_context_t *ctx)
+{
+    assert(ctx != NULL);
+    return yf_cmdexec_getserial(ctx);
+}
+
+int yf_cmdbuf_completed(yf_context_t *ctx, uint64_t serial)
+{
+    assert(ctx != NULL);
+    return yf_cmdexec_completed(ctx, serial);
+}
+
+int yf_cmdbuf_wait(yf_context_t *ctx, uint64_t serial)
+{
+    assert(ctx != NULL);
+
+    YF_PROF_BEGIN("cmdbuf_wait");
+    const int r = yf_cmdexec_wait(ctx, serial);
+    YF_PROF_END();
+
+    return r;
+}
+
 void yf_cmdbuf_setgstate(yf_cmdbuf_t *cmdb, yf_gstate_t *gst)
 {
     assert(cmdb != NULL);
@@ -525,6 +613,36 @@ void yf_cmdbuf_copyimg(yf_cmdbuf_t *cmdb, yf_image_t *dst, yf_off3_t dst_off,
     }
 }
 
+void yf_cmdbuf_copybufs(yf_cmdbuf_t *cmdb, yf_buffer_t *dst, yf_buffer_t *src,
+                        const yf_bufcpy_t *regions, unsigned region_n)
+{
+    assert(cmdb != NULL);
+    assert(dst != NULL);
+    assert(src != NULL);
+    assert(regions != NULL || region_n == 0);
+
+    /* consecutive copies are coalesced when decoded */
+    for (unsigned i = 0; i < region_n && !cmdb->invalid; i++)
+        yf_cmdbuf_copybuf(cmdb, dst, regions[i].dst_off, src,
+                          regions[i].src_off, regions[i].size);
+}
+
+void yf_cmdbuf_copyimgs(yf_cmdbuf_t *cmdb, yf_image_t *dst, yf_image_t *src,
+                        const yf_imgcpy_t *regions, unsigned region_n)
+{
+    assert(cmdb != NULL);
+    assert(dst != NULL);
+    assert(src != NULL);
+    assert(regions != NULL || region_n == 0);
+
+    /* consecutive copies are coalesced when decoded */
+    for (unsigned i = 0; i < region_n && !cmdb->invalid; i++)
+        yf_cmdbuf_copyimg(cmdb, dst, regions[i].dst_off, regions[i].dst_layer,
+                          regions[i].dst_level, src, regions[i].src_off,
+                          regions[i].src_layer, regions[i].src_level,
+                          regions[i].dim, regions[i].layer_n);
+}
+
 void yf_cmdbuf_sync(yf_cmdbuf_t *cmdb)
 {
     assert(cmdb != NULL);
@@ -539,3 +657,40 @@ void yf_cmdbuf_sync(yf_cmdbuf_t *cmdb)
     }
     cmdb->cmds[i].cmd = YF_CMD_SYNC;
 }
+
+#ifdef YF_DBGUTILS
+
+void yf_cmdbuf_beginlabel(yf_cmdbuf_t *cmdb, const char *label)
+{
+    assert(cmdb != NULL);
+    assert(label != NULL);
+
+    if (cmdb->invalid || !cmdb->ctx->dbg_utils)
+        return;
+
+    unsigned i = cmdb->cmd_n++;
+    if (i == cmdb->cmd_cap && grow_cmds(cmdb) != 0) {
+        cmdb->invalid = 1;
+        return;
+    }
+    cmdb->cmds[i].cmd = YF_CMD_BLABEL;
+    strncpy(cmdb->cmds[i].label.name, label, YF_LABELMAX - 1);
+    cmdb->cmds[i].label.name[YF_LABELMAX - 1] = '\0';
+}
+
+void yf_cmdbuf_endlabel(yf_cmdbuf_t *cmdb)
+{
+    assert(cmdb != NULL);
+
+    if (cmdb->invalid || !cmdb->ctx->dbg_utils)
+        return;
+
+    unsigned i = cmdb->cmd_n++;
+    if (i == cmdb->cmd_cap && grow_cmds(cmdb) != 0) {
+        cmdb->invalid = 1;
+        return;
+    }
+    cmdb->cmds[i].cmd = YF_CMD_ELABEL;
+}
+
+#endif /* YF_DBGUTILS */
@@ -8,7 +8,10 @@
 #ifndef YF_CMDBUF_H
 #define YF_CMDBUF_H
 
+#include "yf/com/yf-arena.h"
+
 #include "yf-cmdbuf.h"
+#include "yf-debug.h"
 #include "cmd.h"
 
 struct yf_cmdbuf {
@@ -18,6 +21,11 @@ struct yf_cmdbuf {
     unsigned cmd_n;
     unsigned cmd_cap;
     int invalid;
+
+    /* storage for commands and decoding, released when the command buffer
+       ends - command buffers are then kept in the context for reuse */
+    yf_arena_t *arena;
+    yf_cmdbuf_t *next;
 };
 
 /* Decodes a command buffer and enqueues the resulting object for execution.
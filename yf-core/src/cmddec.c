@@ -26,13 +26,21 @@
 #include "image.h"
 #include "pass.h"
 #include "dtable.h"
+#include "debug.h"
 #include "vk.h"
 #include "yf-limits.h"
 
+/* List of targets used by render passes. */
+typedef struct tgtl {
+    const yf_target_t *tgt;
+    struct tgtl *next;
+} tgtl_t;
+
 /* Graphics decoding state. */
 typedef struct {
     yf_context_t *ctx;
     const yf_cmdres_t *cmdr;
+    yf_arena_t *arena;
 #define YF_GDEC_GST   0x01
 #define YF_GDEC_TGT   0x02
 #define YF_GDEC_VPORT 0x04
@@ -46,6 +54,7 @@ typedef struct {
     yf_pass_t *pass;
     yf_target_t *tgt;
     yf_gstate_t *gst;
+    tgtl_t *tgts;
     struct {
         int pending;
         unsigned *allocs;
@@ -67,6 +76,10 @@ typedef struct {
         int pending;
         unsigned val;
     } clrsten;
+#ifdef YF_DBGUTILS
+    unsigned lbl_n;
+    unsigned pass_lbl;
+#endif
 } gdec_t;
 
 /* Compute decoding state. */
@@ -83,12 +96,18 @@ typedef struct {
         int *used;
         unsigned n;
     } dtb;
+#ifdef YF_DBGUTILS
+    unsigned lbl_n;
+#endif
 } cdec_t;
 
 /* Transfer decoding state. */
 typedef struct {
     yf_context_t *ctx;
     const yf_cmdres_t *cmdr;
+#ifdef YF_DBGUTILS
+    unsigned lbl_n;
+#endif
 } xdec_t;
 
 /* The current decoding states for graph/comp/xfer. */
@@ -96,6 +115,53 @@ static _Thread_local gdec_t *gdec_ = NULL;
 static _Thread_local cdec_t *cdec_ = NULL;
 static _Thread_local xdec_t *xdec_ = NULL;
 
+/* Ends the current render pass. */
+static void end_pass(void)
+{
+    assert(gdec_->pass != NULL);
+
+    vkCmdEndRenderPass(gdec_->cmdr->pool_res);
+    gdec_->pass = NULL;
+
+#ifdef YF_DBGUTILS
+    yf_dbg_endlabel(gdec_->ctx, gdec_->cmdr->pool_res);
+#endif
+}
+
+#ifdef YF_DBGUTILS
+/* Decodes a 'begin label' command. */
+static void decode_blabel(const yf_cmd_t *cmd, yf_context_t *ctx,
+                          VkCommandBuffer cmdbuf, unsigned *lbl_n)
+{
+    yf_dbg_beginlabel(ctx, cmdbuf, cmd->label.name);
+    (*lbl_n)++;
+}
+
+/* Decodes an 'end label' command. */
+static void decode_elabel(yf_context_t *ctx, VkCommandBuffer cmdbuf,
+                          unsigned *lbl_n)
+{
+    /* unbalanced ends are ignored */
+    if (*lbl_n == 0)
+        return;
+
+    /* a render pass that began within this label has its own label
+       closed and reopened, so that regions nest properly */
+    const int split = gdec_ != NULL && gdec_->pass != NULL &&
+                      gdec_->pass_lbl >= *lbl_n;
+    if (split)
+        yf_dbg_endlabel(ctx, cmdbuf);
+
+    yf_dbg_endlabel(ctx, cmdbuf);
+    (*lbl_n)--;
+
+    if (split) {
+        yf_dbg_beginlabel(ctx, cmdbuf, "render pass");
+        gdec_->pass_lbl = *lbl_n;
+    }
+}
+#endif /* YF_DBGUTILS */
+
 /* Decodes a 'set gstate' command. */
 static int decode_gst(const yf_cmd_t *cmd)
 {
@@ -104,10 +170,8 @@ static int decode_gst(const yf_cmd_t *cmd)
         gdec_->gst = cmd->gst.gst;
 
         /* TODO: Check if passes are compatible instead. */
-        if (gdec_->pass != NULL && gdec_->pass != gdec_->gst->pass) {
-            vkCmdEndRenderPass(gdec_->cmdr->pool_res);
-            gdec_->pass = NULL;
-        }
+        if (gdec_->pass != NULL && gdec_->pass != gdec_->gst->pass)
+            end_pass();
 
         vkCmdBindPipeline(gdec_->cmdr->pool_res,
                           VK_PIPELINE_BIND_POINT_GRAPHICS,
@@ -137,10 +201,8 @@ static int decode_tgt(const yf_cmd_t *cmd)
         gdec_->gdec |= YF_GDEC_TGT;
         gdec_->tgt = cmd->tgt.tgt;
 
-        if (gdec_->pass != NULL) {
-            vkCmdEndRenderPass(gdec_->cmdr->pool_res);
-            gdec_->pass = NULL;
-        }
+        if (gdec_->pass != NULL)
+            end_pass();
     }
     return 0;
 }
@@ -305,6 +367,26 @@ static int decode_clrsten(const yf_cmd_t *cmd)
     return 0;
 }
 
+/* Sets the layouts of the images of render pass targets.
+   Render passes begin with undefined layouts and leave attachments in
+   their final layouts, which later commands must start from. */
+static int set_pass_layouts(const tgtl_t *tgts)
+{
+    for (; tgts != NULL; tgts = tgts->next) {
+        const yf_target_t *tgt = tgts->tgt;
+        const unsigned depth_i = tgt->iview_n - tgt->pass->depth_n;
+
+        for (unsigned i = 0; i < tgt->iview_n; i++) {
+            const VkImageLayout layout =
+                i < depth_i ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL :
+                              VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            if (yf_image_setlayout(tgt->imgs[i], layout) != 0)
+                return -1;
+        }
+    }
+    return 0;
+}
+
 /* Decodes a 'draw' or 'drawi' command. */
 static int decode_draw(const yf_cmd_t *cmd)
 {
@@ -320,7 +402,7 @@ static int decode_draw(const yf_cmd_t *cmd)
     /* render pass */
     if (gdec_->pass != gdec_->gst->pass) {
         if (gdec_->pass != NULL)
-            vkCmdEndRenderPass(gdec_->cmdr->pool_res);
+            end_pass();
         gdec_->pass = gdec_->gst->pass;
 
         VkRenderPassBeginInfo info = {
@@ -336,8 +418,23 @@ static int decode_draw(const yf_cmd_t *cmd)
             .pClearValues = NULL
         };
 
+#ifdef YF_DBGUTILS
+        yf_dbg_beginlabel(gdec_->ctx, gdec_->cmdr->pool_res, "render pass");
+        gdec_->pass_lbl = gdec_->lbl_n;
+#endif
+
         vkCmdBeginRenderPass(gdec_->cmdr->pool_res, &info,
                              VK_SUBPASS_CONTENTS_INLINE);
+
+        /* layouts are set once the commands are enqueued */
+        if (gdec_->tgts == NULL || gdec_->tgts->tgt != gdec_->tgt) {
+            tgtl_t *tgts = yf_arena_alloc(gdec_->arena, sizeof *tgts);
+            if (tgts == NULL)
+                return -1;
+            tgts->tgt = gdec_->tgt;
+            tgts->next = gdec_->tgts;
+            gdec_->tgts = tgts;
+        }
     }
 
     /* dtables */
@@ -376,11 +473,10 @@ static int decode_draw(const yf_cmd_t *cmd)
         unsigned clr_i = 0;
 
         if (gdec_->clrcol.pending) {
-            clr_atts = malloc(sizeof *clr_atts * (gdec_->clrcol.n+1));
-            if (clr_atts == NULL) {
-                yf_seterr(YF_ERR_NOMEM, __func__);
+            clr_atts = yf_arena_alloc(gdec_->arena,
+                                      sizeof *clr_atts * (gdec_->clrcol.n+1));
+            if (clr_atts == NULL)
                 return -1;
-            }
 
             for (unsigned i = 0; ; i++) {
                 if (gdec_->clrcol.used[i]) {
@@ -402,11 +498,9 @@ static int decode_draw(const yf_cmd_t *cmd)
             gdec_->clrcol.pending = 0;
 
         } else {
-            clr_atts = malloc(sizeof *clr_atts);
-            if (clr_atts == NULL) {
-                yf_seterr(YF_ERR_NOMEM, __func__);
+            clr_atts = yf_arena_alloc(gdec_->arena, sizeof *clr_atts);
+            if (clr_atts == NULL)
                 return -1;
-            }
         }
 
         clr_atts[clr_i].aspectMask = 0;
@@ -428,7 +522,6 @@ static int decode_draw(const yf_cmd_t *cmd)
                               clr_i + (clr_atts[clr_i].aspectMask != 0),
                               clr_atts, 1, &clr_rect);
 
-        free(clr_atts);
         gdec_->clr_pending = 0;
     }
 
@@ -515,95 +608,198 @@ static int decode_disp(const yf_cmd_t *cmd)
     return r;
 }
 
-/* Decodes a 'copy buffer' command. */
-static int decode_cpybuf(const yf_cmd_t *cmd)
+/* Maximum number of regions to copy in a single call. */
+#define YF_CPYMAX 64
+
+/* Checks whether two ranges overlap. */
+static int overlap(long long off1, long long sz1, long long off2,
+                   long long sz2)
 {
-    assert(cmd->cpybuf.dst->size >= cmd->cpybuf.dst_off + cmd->cpybuf.size);
-    assert(cmd->cpybuf.src->size >= cmd->cpybuf.src_off + cmd->cpybuf.size);
-    assert(cmd->cpybuf.size > 0);
-
-    VkBufferCopy region = {
-        .srcOffset = cmd->cpybuf.src_off,
-        .dstOffset = cmd->cpybuf.dst_off,
-        .size = cmd->cpybuf.size
-    };
+    return off1 < off2 + sz2 && off2 < off1 + sz1;
+}
+
+/* Gets how many consecutive 'copy buffer' commands can be decoded in a
+   single call, starting at a given one.
+   Regions of a single call are not ordered, so copies are coalesced only
+   between distinct buffers and while their destinations do not
+   overlap. */
+static unsigned coalesce_cpybuf(const yf_cmd_t *cmds, unsigned n)
+{
+    const yf_cmd_cpybuf_t *first = &cmds->cpybuf;
+    if (first->dst == first->src)
+        return 1;
+
+    unsigned i = 1;
+    for (; i < n && i < YF_CPYMAX; i++) {
+        const yf_cmd_cpybuf_t *cpy = &cmds[i].cpybuf;
+        if (cmds[i].cmd != YF_CMD_CPYBUF || cpy->dst != first->dst ||
+            cpy->src != first->src)
+            break;
+
+        for (unsigned j = 0; j < i; j++) {
+            const yf_cmd_cpybuf_t *prev = &cmds[j].cpybuf;
+            if (overlap(cpy->dst_off, cpy->size, prev->dst_off, prev->size))
+                return i;
+        }
+    }
+    return i;
+}
+
+/* Gets how many consecutive 'copy image' commands can be decoded in a
+   single call, starting at a given one. */
+static unsigned coalesce_cpyimg(const yf_cmd_t *cmds, unsigned n)
+{
+    const yf_cmd_cpyimg_t *first = &cmds->cpyimg;
+    if (first->dst == first->src)
+        return 1;
+
+    unsigned i = 1;
+    for (; i < n && i < YF_CPYMAX; i++) {
+        const yf_cmd_cpyimg_t *cpy = &cmds[i].cpyimg;
+        if (cmds[i].cmd != YF_CMD_CPYIMG || cpy->dst != first->dst ||
+            cpy->src != first->src)
+            break;
+
+        for (unsigned j = 0; j < i; j++) {
+            const yf_cmd_cpyimg_t *prev = &cmds[j].cpyimg;
+            if (cpy->dst_level == prev->dst_level &&
+                overlap(cpy->dst_layer, cpy->layer_n,
+                        prev->dst_layer, prev->layer_n) &&
+                overlap(cpy->dst_off.x, cpy->dim.width,
+                        prev->dst_off.x, prev->dim.width) &&
+                overlap(cpy->dst_off.y, cpy->dim.height,
+                        prev->dst_off.y, prev->dim.height) &&
+                overlap(cpy->dst_off.z, cpy->dim.depth,
+                        prev->dst_off.z, prev->dim.depth))
+                return i;
+        }
+    }
+    return i;
+}
+
+/* Decodes a sequence of 'copy buffer' commands.
+   All commands must have the same source and destination. */
+static int decode_cpybuf(const yf_cmd_t *cmds, unsigned n)
+{
+    assert(n > 0);
+
+    VkBufferCopy regions[YF_CPYMAX];
+    unsigned region_n = 0;
+
+    for (unsigned i = 0; i < n; i++) {
+        const yf_cmd_t *cmd = cmds+i;
+
+        assert(cmd->cpybuf.dst == cmds->cpybuf.dst);
+        assert(cmd->cpybuf.src == cmds->cpybuf.src);
+        assert(cmd->cpybuf.dst->size >=
+               cmd->cpybuf.dst_off + cmd->cpybuf.size);
+        assert(cmd->cpybuf.src->size >=
+               cmd->cpybuf.src_off + cmd->cpybuf.size);
+
+        if (cmd->cpybuf.size == 0)
+            continue;
 
-    vkCmdCopyBuffer(xdec_->cmdr->pool_res, cmd->cpybuf.src->buffer,
-                    cmd->cpybuf.dst->buffer, 1, &region);
+        regions[region_n].srcOffset = cmd->cpybuf.src_off;
+        regions[region_n].dstOffset = cmd->cpybuf.dst_off;
+        regions[region_n].size = cmd->cpybuf.size;
+
+        if (++region_n == YF_CPYMAX || i == n-1) {
+            vkCmdCopyBuffer(xdec_->cmdr->pool_res, cmds->cpybuf.src->buffer,
+                            cmds->cpybuf.dst->buffer, region_n, regions);
+            region_n = 0;
+        }
+    }
+
+    if (region_n > 0)
+        vkCmdCopyBuffer(xdec_->cmdr->pool_res, cmds->cpybuf.src->buffer,
+                        cmds->cpybuf.dst->buffer, region_n, regions);
 
     return 0;
 }
 
-/* Decodes a 'copy image' command. */
-static int decode_cpyimg(const yf_cmd_t *cmd)
+/* Decodes a sequence of 'copy image' commands.
+   All commands must have the same source and destination. */
+static int decode_cpyimg(const yf_cmd_t *cmds, unsigned n)
 {
-    assert(cmd->cpyimg.dst->dim.width >=
-           cmd->cpyimg.dst_off.x + cmd->cpyimg.dim.width);
-    assert(cmd->cpyimg.dst->dim.height >=
-           cmd->cpyimg.dst_off.y + cmd->cpyimg.dim.height);
-    assert(cmd->cpyimg.dst->dim.depth >=
-           cmd->cpyimg.dst_off.z + cmd->cpyimg.dim.depth);
-    assert(cmd->cpyimg.dst->layers >=
-           cmd->cpyimg.dst_layer + cmd->cpyimg.layer_n);
-    assert(cmd->cpyimg.dst->levels > cmd->cpyimg.dst_level);
-
-    assert(cmd->cpyimg.src->dim.width >=
-           cmd->cpyimg.src_off.x + cmd->cpyimg.dim.width);
-    assert(cmd->cpyimg.src->dim.height >=
-           cmd->cpyimg.src_off.y + cmd->cpyimg.dim.height);
-    assert(cmd->cpyimg.src->dim.depth >=
-           cmd->cpyimg.src_off.z + cmd->cpyimg.dim.depth);
-    assert(cmd->cpyimg.src->layers >=
-           cmd->cpyimg.src_layer + cmd->cpyimg.layer_n);
-    assert(cmd->cpyimg.src->levels > cmd->cpyimg.src_level);
-
-    assert(cmd->cpyimg.dim.width > 0);
-    assert(cmd->cpyimg.dim.height > 0);
-    assert(cmd->cpyimg.dim.depth > 0);
-    assert(cmd->cpyimg.layer_n > 0);
+    assert(n > 0);
+
+    yf_image_t *dst = cmds->cpyimg.dst;
+    yf_image_t *src = cmds->cpyimg.src;
 
     /* FIXME: These layout changes happen in the priority command buffer. */
-    if (cmd->cpyimg.dst->next_layout != VK_IMAGE_LAYOUT_GENERAL &&
-        yf_image_chglayout(cmd->cpyimg.dst, VK_IMAGE_LAYOUT_GENERAL) != 0)
+    if (dst->next_layout != VK_IMAGE_LAYOUT_GENERAL &&
+        yf_image_chglayout(dst, VK_IMAGE_LAYOUT_GENERAL) != 0)
         return -1;
-    if (cmd->cpyimg.src->next_layout != VK_IMAGE_LAYOUT_GENERAL &&
-        yf_image_chglayout(cmd->cpyimg.src, VK_IMAGE_LAYOUT_GENERAL) != 0)
+    if (src->next_layout != VK_IMAGE_LAYOUT_GENERAL &&
+        yf_image_chglayout(src, VK_IMAGE_LAYOUT_GENERAL) != 0)
         return -1;
 
-    VkImageCopy region = {
-        .srcSubresource = {
-            .aspectMask = cmd->cpyimg.src->aspect,
-            .mipLevel = cmd->cpyimg.src_level,
-            .baseArrayLayer = cmd->cpyimg.src_layer,
-            .layerCount = cmd->cpyimg.layer_n
-        },
-        .srcOffset = {
-            .x = cmd->cpyimg.src_off.x,
-            .y = cmd->cpyimg.src_off.y,
-            .z = cmd->cpyimg.src_off.z
-        },
-        .dstSubresource = {
-            .aspectMask = cmd->cpyimg.dst->aspect,
-            .mipLevel = cmd->cpyimg.dst_level,
-            .baseArrayLayer = cmd->cpyimg.dst_layer,
-            .layerCount = cmd->cpyimg.layer_n
-        },
-        .dstOffset = {
-            .x = cmd->cpyimg.dst_off.x,
-            .y = cmd->cpyimg.dst_off.y,
-            .z = cmd->cpyimg.dst_off.z
-        },
-        .extent = {
-            .width = cmd->cpyimg.dim.width,
-            .height = cmd->cpyimg.dim.height,
-            .depth = cmd->cpyimg.dim.depth
-        }
-    };
+    VkImageCopy regions[YF_CPYMAX];
+    unsigned region_n = 0;
+
+    for (unsigned i = 0; i < n; i++) {
+        const yf_cmd_t *cmd = cmds+i;
+
+        assert(cmd->cpyimg.dst == dst);
+        assert(cmd->cpyimg.src == src);
+
+        assert(dst->dim.width >= cmd->cpyimg.dst_off.x + cmd->cpyimg.dim.width);
+        assert(dst->dim.height >=
+               cmd->cpyimg.dst_off.y + cmd->cpyimg.dim.height);
+        assert(dst->dim.depth >= cmd->cpyimg.dst_off.z + cmd->cpyimg.dim.depth);
+        assert(dst->layers >= cmd->cpyimg.dst_layer + cmd->cpyimg.layer_n);
+        assert(dst->levels > cmd->cpyimg.dst_level);
+
+        assert(src->dim.width >= cmd->cpyimg.src_off.x + cmd->cpyimg.dim.width);
+        assert(src->dim.height >=
+               cmd->cpyimg.src_off.y + cmd->cpyimg.dim.height);
+        assert(src->dim.depth >= cmd->cpyimg.src_off.z + cmd->cpyimg.dim.depth);
+        assert(src->layers >= cmd->cpyimg.src_layer + cmd->cpyimg.layer_n);
+        assert(src->levels > cmd->cpyimg.src_level);
+
+        assert(cmd->cpyimg.dim.width > 0);
+        assert(cmd->cpyimg.dim.height > 0);
+        assert(cmd->cpyimg.dim.depth > 0);
+        assert(cmd->cpyimg.layer_n > 0);
+
+        regions[region_n] = (VkImageCopy){
+            .srcSubresource = {
+                .aspectMask = src->aspect,
+                .mipLevel = cmd->cpyimg.src_level,
+                .baseArrayLayer = cmd->cpyimg.src_layer,
+                .layerCount = cmd->cpyimg.layer_n
+            },
+            .srcOffset = {
+                .x = cmd->cpyimg.src_off.x,
+                .y = cmd->cpyimg.src_off.y,
+                .z = cmd->cpyimg.src_off.z
+            },
+            .dstSubresource = {
+                .aspectMask = dst->aspect,
+                .mipLevel = cmd->cpyimg.dst_level,
+                .baseArrayLayer = cmd->cpyimg.dst_layer,
+                .layerCount = cmd->cpyimg.layer_n
+            },
+            .dstOffset = {
+                .x = cmd->cpyimg.dst_off.x,
+                .y = cmd->cpyimg.dst_off.y,
+                .z = cmd->cpyimg.dst_off.z
+            },
+            .extent = {
+                .width = cmd->cpyimg.dim.width,
+                .height = cmd->cpyimg.dim.height,
+                .depth = cmd->cpyimg.dim.depth
+            }
+        };
 
-    vkCmdCopyImage(xdec_->cmdr->pool_res,
-                   cmd->cpyimg.src->image, VK_IMAGE_LAYOUT_GENERAL,
-                   cmd->cpyimg.dst->image, VK_IMAGE_LAYOUT_GENERAL,
-                   1, &region);
+        if (++region_n == YF_CPYMAX || i == n-1) {
+            vkCmdCopyImage(xdec_->cmdr->pool_res,
+                           src->image, VK_IMAGE_LAYOUT_GENERAL,
+                           dst->image, VK_IMAGE_LAYOUT_GENERAL,
+                           region_n, regions);
+            region_n = 0;
+        }
+    }
 
     return 0;
 }
@@ -616,10 +812,8 @@ static int decode_sync(int cmdbuf)
     const yf_cmdres_t *cmdr;
     switch (cmdbuf) {
     case YF_CMDBUF_GRAPH:
-        if (gdec_->pass != NULL) {
-            vkCmdEndRenderPass(gdec_->cmdr->pool_res);
-            gdec_->pass = NULL;
-        }
+        if (gdec_->pass != NULL)
+            end_pass();
         cmdr = gdec_->cmdr;
         break;
     case YF_CMDBUF_COMP:
@@ -649,35 +843,34 @@ static int decode_sync(int cmdbuf)
 }
 
 /* Decodes a graphics command buffer. */
-static int decode_graph(yf_cmdbuf_t *cmdb, const yf_cmdres_t *cmdr)
+static int decode_graph(yf_cmdbuf_t *cmdb, const yf_cmdres_t *cmdr,
+                        const tgtl_t **tgts)
 {
-    gdec_ = calloc(1, sizeof *gdec_);
-    if (gdec_ == NULL) {
-        yf_seterr(YF_ERR_NOMEM, __func__);
+    /* decoding state is released along with the command buffer */
+    yf_arena_t *arena = cmdb->arena;
+    gdec_t *gdec = yf_arena_calloc(arena, 1, sizeof *gdec);
+    if (gdec == NULL)
         return -1;
-    }
-    gdec_->ctx = cmdb->ctx;
-    gdec_->cmdr = cmdr;
+    gdec->ctx = cmdb->ctx;
+    gdec->cmdr = cmdr;
+    gdec->arena = arena;
 
     const unsigned dtb_max = yf_getlimits(cmdb->ctx)->state.dtable_max;
-    gdec_->dtb.allocs = calloc(dtb_max, sizeof *gdec_->dtb.allocs);
-    gdec_->dtb.used = calloc(dtb_max, sizeof *gdec_->dtb.used);
+    gdec->dtb.allocs = yf_arena_calloc(arena, dtb_max,
+                                       sizeof *gdec->dtb.allocs);
+    gdec->dtb.used = yf_arena_calloc(arena, dtb_max, sizeof *gdec->dtb.used);
 
     const unsigned col_max = yf_getlimits(cmdb->ctx)->pass.color_max;
-    gdec_->clrcol.vals = calloc(col_max, sizeof *gdec_->clrcol.vals);
-    gdec_->clrcol.used = calloc(col_max, sizeof *gdec_->clrcol.used);
-
-    if (gdec_->dtb.allocs == NULL || gdec_->dtb.used == NULL ||
-        gdec_->clrcol.vals == NULL || gdec_->clrcol.used == NULL) {
-        yf_seterr(YF_ERR_NOMEM, __func__);
-        free(gdec_->dtb.allocs);
-        free(gdec_->dtb.used);
-        free(gdec_->clrcol.vals);
-        free(gdec_->clrcol.used);
-        free(gdec_);
-        gdec_ = NULL;
+    gdec->clrcol.vals = yf_arena_calloc(arena, col_max,
+                                        sizeof *gdec->clrcol.vals);
+    gdec->clrcol.used = yf_arena_calloc(arena, col_max,
+                                        sizeof *gdec->clrcol.used);
+
+    if (gdec->dtb.allocs == NULL || gdec->dtb.used == NULL ||
+        gdec->clrcol.vals == NULL || gdec->clrcol.used == NULL)
         return -1;
-    }
+
+    gdec_ = gdec;
 
     int r = 0;
     for (unsigned i = 0; i < cmdb->cmd_n; i++) {
@@ -721,6 +914,14 @@ static int decode_graph(yf_cmdbuf_t *cmdb, const yf_cmdres_t *cmdr)
         case YF_CMD_SYNC:
             r = decode_sync(YF_CMDBUF_GRAPH);
             break;
+#ifdef YF_DBGUTILS
+        case YF_CMD_BLABEL:
+            decode_blabel(cmd, cmdb->ctx, cmdr->pool_res, &gdec_->lbl_n);
+            break;
+        case YF_CMD_ELABEL:
+            decode_elabel(cmdb->ctx, cmdr->pool_res, &gdec_->lbl_n);
+            break;
+#endif
         default:
             assert(0);
             abort();
@@ -731,7 +932,13 @@ static int decode_graph(yf_cmdbuf_t *cmdb, const yf_cmdres_t *cmdr)
     }
 
     if (gdec_->pass != NULL)
-        vkCmdEndRenderPass(cmdr->pool_res);
+        end_pass();
+
+#ifdef YF_DBGUTILS
+    /* labels left open are closed with the command buffer */
+    for (; gdec_->lbl_n > 0; gdec_->lbl_n--)
+        yf_dbg_endlabel(cmdb->ctx, cmdr->pool_res);
+#endif
 
     /* XXX: Clear commands are deferred until a draw is issued. When a clear
        request comes last, it is handled here. */
@@ -799,11 +1006,7 @@ static int decode_graph(yf_cmdbuf_t *cmdb, const yf_cmdres_t *cmdr)
         }
     }
 
-    free(gdec_->dtb.allocs);
-    free(gdec_->dtb.used);
-    free(gdec_->clrcol.vals);
-    free(gdec_->clrcol.used);
-    free(gdec_);
+    *tgts = gdec_->tgts;
     gdec_ = NULL;
     return r;
 }
@@ -811,26 +1014,22 @@ static int decode_graph(yf_cmdbuf_t *cmdb, const yf_cmdres_t *cmdr)
 /* Decodes a compute command buffer. */
 static int decode_comp(yf_cmdbuf_t *cmdb, const yf_cmdres_t *cmdr)
 {
-    cdec_ = calloc(1, sizeof *cdec_);
-    if (cdec_ == NULL) {
-        yf_seterr(YF_ERR_NOMEM, __func__);
+    yf_arena_t *arena = cmdb->arena;
+    cdec_t *cdec = yf_arena_calloc(arena, 1, sizeof *cdec);
+    if (cdec == NULL)
         return -1;
-    }
-    cdec_->ctx = cmdb->ctx;
-    cdec_->cmdr = cmdr;
+    cdec->ctx = cmdb->ctx;
+    cdec->cmdr = cmdr;
 
     const unsigned dtb_max = yf_getlimits(cmdb->ctx)->state.dtable_max;
-    cdec_->dtb.allocs = calloc(dtb_max, sizeof *cdec_->dtb.allocs);
-    cdec_->dtb.used = calloc(dtb_max, sizeof *cdec_->dtb.used);
-
-    if (cdec_->dtb.allocs == NULL || cdec_->dtb.used == NULL) {
-        yf_seterr(YF_ERR_NOMEM, __func__);
-        free(cdec_->dtb.allocs);
-        free(cdec_->dtb.used);
-        free(cdec_);
-        cdec_ = NULL;
+    cdec->dtb.allocs = yf_arena_calloc(arena, dtb_max,
+                                       sizeof *cdec->dtb.allocs);
+    cdec->dtb.used = yf_arena_calloc(arena, dtb_max, sizeof *cdec->dtb.used);
+
+    if (cdec->dtb.allocs == NULL || cdec->dtb.used == NULL)
         return -1;
-    }
+
+    cdec_ = cdec;
 
     int r = 0;
     for (unsigned i = 0; i < cmdb->cmd_n; i++) {
@@ -849,6 +1048,14 @@ static int decode_comp(yf_cmdbuf_t *cmdb, const yf_cmdres_t *cmdr)
         case YF_CMD_SYNC:
             r = decode_sync(YF_CMDBUF_COMP);
             break;
+#ifdef YF_DBGUTILS
+        case YF_CMD_BLABEL:
+            decode_blabel(cmd, cmdb->ctx, cmdr->pool_res, &cdec_->lbl_n);
+            break;
+        case YF_CMD_ELABEL:
+            decode_elabel(cmdb->ctx, cmdr->pool_res, &cdec_->lbl_n);
+            break;
+#endif
         default:
             assert(0);
             abort();
@@ -858,9 +1065,11 @@ static int decode_comp(yf_cmdbuf_t *cmdb, const yf_cmdres_t *cmdr)
             break;
     }
 
-    free(cdec_->dtb.allocs);
-    free(cdec_->dtb.used);
-    free(cdec_);
+#ifdef YF_DBGUTILS
+    for (; cdec_->lbl_n > 0; cdec_->lbl_n--)
+        yf_dbg_endlabel(cmdb->ctx, cmdr->pool_res);
+#endif
+
     cdec_ = NULL;
     return r;
 }
@@ -868,28 +1077,41 @@ static int decode_comp(yf_cmdbuf_t *cmdb, const yf_cmdres_t *cmdr)
 /* Decodes a transfer command buffer. */
 static int decode_xfer(yf_cmdbuf_t *cmdb, const yf_cmdres_t *cmdr)
 {
-    xdec_ = calloc(1, sizeof *xdec_);
-    if (xdec_ == NULL) {
-        yf_seterr(YF_ERR_NOMEM, __func__);
+    xdec_ = yf_arena_calloc(cmdb->arena, 1, sizeof *xdec_);
+    if (xdec_ == NULL)
         return -1;
-    }
     xdec_->ctx = cmdb->ctx;
     xdec_->cmdr = cmdr;
 
     int r = 0;
+    unsigned n;
     for (unsigned i = 0; i < cmdb->cmd_n; i++) {
         yf_cmd_t *cmd = &cmdb->cmds[i];
 
         switch (cmd->cmd) {
         case YF_CMD_CPYBUF:
-            r = decode_cpybuf(cmd);
+            /* consecutive copies between the same buffers are coalesced */
+            n = coalesce_cpybuf(cmd, cmdb->cmd_n - i);
+            r = decode_cpybuf(cmd, n);
+            i += n-1;
             break;
         case YF_CMD_CPYIMG:
-            r = decode_cpyimg(cmd);
+            /* consecutive copies between the same images are coalesced */
+            n = coalesce_cpyimg(cmd, cmdb->cmd_n - i);
+            r = decode_cpyimg(cmd, n);
+            i += n-1;
             break;
         case YF_CMD_SYNC:
             r = decode_sync(YF_CMDBUF_XFER);
             break;
+#ifdef YF_DBGUTILS
+        case YF_CMD_BLABEL:
+            decode_blabel(cmd, cmdb->ctx, cmdr->pool_res, &xdec_->lbl_n);
+            break;
+        case YF_CMD_ELABEL:
+            decode_elabel(cmdb->ctx, cmdr->pool_res, &xdec_->lbl_n);
+            break;
+#endif
         default:
             assert(0);
             abort();
@@ -899,7 +1121,11 @@ static int decode_xfer(yf_cmdbuf_t *cmdb, const yf_cmdres_t *cmdr)
             break;
     }
 
-    free(xdec_);
+#ifdef YF_DBGUTILS
+    for (; xdec_->lbl_n > 0; xdec_->lbl_n--)
+        yf_dbg_endlabel(cmdb->ctx, cmdr->pool_res);
+#endif
+
     xdec_ = NULL;
     return r;
 }
@@ -929,6 +1155,7 @@ int yf_cmdbuf_decode(yf_cmdbuf_t *cmdb)
         return -1;
     }
 
+    const tgtl_t *tgts = NULL;
     int r = 0;
     switch (cmdb->cmdbuf) {
     case YF_CMDBUF_GRAPH:
@@ -937,7 +1164,7 @@ int yf_cmdbuf_decode(yf_cmdbuf_t *cmdb)
             r = -1;
             break;
         }
-        r = decode_graph(cmdb, &cmdr);
+        r = decode_graph(cmdb, &cmdr, &tgts);
         break;
     case YF_CMDBUF_COMP:
         if (cdec_ != NULL) {
@@ -966,8 +1193,10 @@ int yf_cmdbuf_decode(yf_cmdbuf_t *cmdb)
     }
     if (r == 0)
         r = yf_cmdexec_enqueue(cmdb->ctx, &cmdr, NULL, NULL);
-    if (r != 0)
+    if (r != 0) {
         yf_cmdpool_yield(cmdb->ctx, &cmdr);
+        return r;
+    }
 
-    return r;
+    return set_pass_layouts(tgts);
 }
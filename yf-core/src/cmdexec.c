@@ -6,6 +6,7 @@
  */
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <assert.h>
 
@@ -16,6 +17,7 @@
 #include "cmdexec.h"
 #include "context.h"
 #include "cmdbuf.h"
+#include "retire.h"
 
 /* TODO: Should be defined elsewhere. */
 #define YF_CMDEMIN 1
@@ -23,6 +25,11 @@
 
 #define YF_CMDEWAIT 16666666UL
 
+/* Maximum number of entries pending completion.
+   Every entry holds a command pool resource, so this must not be less
+   than the command pool capacity. */
+#define YF_CMDEFLIGHT 64
+
 /* Queue entry. */
 typedef struct {
     yf_cmdres_t cmdr;
@@ -39,20 +46,43 @@ typedef struct {
     VkSubmitInfo subm_info;
 } cmde_t;
 
+/* Submitted entry pending completion. */
+typedef struct {
+    entry_t entry;
+    uint64_t serial;
+} flight_t;
+
 /* Submission state. */
 typedef struct {
-    VkFence fence;
+    VkSemaphore timeline;
+    uint64_t serial;
+    uint64_t completed;
     VkSemaphore prio_sem;
     VkPipelineStageFlags prio_stg;
-    yf_list_t *wait_sems;
-    yf_list_t *wait_stgs;
+    VkSemaphore wait_sems[YF_CMDEMAX];
+    VkPipelineStageFlags wait_stgs[YF_CMDEMAX];
+    unsigned wait_n;
+    VkSemaphore sig_sems[YF_CMDEMAX];
+    unsigned sig_n;
 } subm_t;
 
-/* Execution queues stored in a context. */
+/* Callback from non-priority queue submission. */
+typedef struct {
+    void (*callb)(int, void *);
+    void *arg;
+} callb_t;
+
+/* Execution queues stored in a context.
+   Submitted entries are kept in submission order, from 'flight_i' to
+   'flight_i' + 'flight_n', until their serials complete. */
 typedef struct {
     cmde_t cmde;
     cmde_t prio;
     subm_t subm;
+    flight_t flights[YF_CMDEFLIGHT];
+    unsigned flight_i;
+    unsigned flight_n;
+    yf_list_t *callbs;
 } priv_t;
 
 /* Initializes a pre-allocated queue. */
@@ -133,63 +163,135 @@ static int end_prio(yf_context_t *ctx, cmde_t *prio)
     return r;
 }
 
-/* Executes a command queue. */
-static int exec_queue(yf_context_t *ctx, cmde_t *cmde, subm_t *subm)
+/* Submits batches of commands.
+   The last batch signals the timeline semaphore with the current serial,
+   along with any semaphores set by 'signal'. */
+static int submit(yf_context_t *ctx, VkSubmitInfo *infos, unsigned info_n,
+                  subm_t *subm)
 {
     assert(ctx != NULL);
-    assert(cmde != NULL);
+    assert(infos != NULL);
+    assert(info_n > 0);
     assert(subm != NULL);
 
-    if (cmde->n < 1)
-        return 0;
-
-    int r = 0;
-    VkResult res;
-
-    cmde->subm_info.commandBufferCount = cmde->n;
-    cmde->subm_info.signalSemaphoreCount = 0;
-    cmde->subm_info.pSignalSemaphores = NULL;
-
-    const unsigned sem_n = yf_list_getlen(subm->wait_sems);
+    const uint64_t value = subm->serial++;
 
-    if (sem_n > 0) {
-        VkSemaphore sems[sem_n];
-        VkPipelineStageFlags stgs[sem_n];
-        for (unsigned i = 0; i < sem_n; i++) {
-            sems[i] = yf_list_removeat(subm->wait_sems, NULL);
-            stgs[i] = (uintptr_t)yf_list_removeat(subm->wait_stgs, NULL);
-        }
-        cmde->subm_info.waitSemaphoreCount = sem_n;
-        cmde->subm_info.pWaitSemaphores = sems;
-        cmde->subm_info.pWaitDstStageMask = stgs;
-        res = vkQueueSubmit(ctx->queue, 1, &cmde->subm_info, subm->fence);
-    } else {
-        cmde->subm_info.waitSemaphoreCount = 0;
-        cmde->subm_info.pWaitSemaphores = NULL;
-        cmde->subm_info.pWaitDstStageMask = NULL;
-        res = vkQueueSubmit(ctx->queue, 1, &cmde->subm_info, subm->fence);
+    VkSemaphore sig_sems[1+YF_CMDEMAX] = {subm->timeline};
+    uint64_t sig_vals[1+YF_CMDEMAX] = {value};
+    for (unsigned i = 0; i < subm->sig_n; i++) {
+        /* binary semaphores ignore their values */
+        sig_sems[1+i] = subm->sig_sems[i];
+        sig_vals[1+i] = 0;
     }
+    const unsigned sig_n = 1 + subm->sig_n;
+    subm->sig_n = 0;
+
+    VkTimelineSemaphoreSubmitInfo tl_info = {
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreValueCount = 0,
+        .pWaitSemaphoreValues = NULL,
+        .signalSemaphoreValueCount = sig_n,
+        .pSignalSemaphoreValues = sig_vals
+    };
+    infos[info_n-1].pNext = &tl_info;
+    infos[info_n-1].signalSemaphoreCount = sig_n;
+    infos[info_n-1].pSignalSemaphores = sig_sems;
 
+    VkResult res = vkQueueSubmit(ctx->queue, info_n, infos, VK_NULL_HANDLE);
     if (res != VK_SUCCESS) {
         yf_seterr(YF_ERR_DEVGEN, __func__);
-        r = -1;
-    } else {
-        while ((res = vkWaitForFences(ctx->device, 1, &subm->fence, VK_TRUE,
-                                      YF_CMDEWAIT)) == VK_TIMEOUT)
-            ;
-        if (res != VK_SUCCESS) {
-            yf_seterr(YF_ERR_DEVGEN, __func__);
-            r = -1;
-        }
+        /* signal from host so the serial is retired anyway */
+        VkSemaphoreSignalInfo sig_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO,
+            .pNext = NULL,
+            .semaphore = subm->timeline,
+            .value = value
+        };
+        if (vkSignalSemaphore(ctx->device, &sig_info) == VK_SUCCESS)
+            subm->completed = value;
+        return -1;
     }
 
+    return 0;
+}
+
+/* Hands the entries of a submitted queue over to the flight list.
+   If the submission failed, entries are yielded at once instead. */
+static void dispatch_queue(yf_context_t *ctx, cmde_t *cmde, int result)
+{
+    assert(ctx != NULL);
+    assert(cmde != NULL);
+
+    priv_t *priv = ctx->cmde.priv;
+    const uint64_t serial = priv->subm.serial - 1;
+
     for (unsigned i = 0; i < cmde->n; i++) {
-        yf_cmdpool_yield(ctx, &cmde->entries[i].cmdr);
-        if (cmde->entries[i].callb != NULL)
-            cmde->entries[i].callb(r, cmde->entries[i].arg);
+        entry_t *e = cmde->entries+i;
+
+        if (result == 0) {
+            assert(priv->flight_n < YF_CMDEFLIGHT);
+            const unsigned j = (priv->flight_i + priv->flight_n) %
+                               YF_CMDEFLIGHT;
+            priv->flights[j].entry = *e;
+            priv->flights[j].serial = serial;
+            priv->flight_n++;
+        } else {
+            yf_cmdpool_yield(ctx, &e->cmdr);
+            if (e->callb != NULL)
+                e->callb(result, e->arg);
+        }
     }
     cmde->n = 0;
+}
+
+/* Retires submitted entries.
+   Entries whose submissions have completed are yielded and their callbacks
+   called. If 'all' is set, every entry is retired - the caller must ensure
+   that the device is idle. */
+static void retire_flights(yf_context_t *ctx, int all)
+{
+    assert(ctx != NULL);
+
+    priv_t *priv = ctx->cmde.priv;
 
+    while (priv->flight_n > 0) {
+        flight_t *f = priv->flights+priv->flight_i;
+        if (!all && !yf_cmdexec_completed(ctx, f->serial))
+            break;
+
+        /* removed before the callback, which may submit further work */
+        entry_t e = f->entry;
+        priv->flight_i = (priv->flight_i + 1) % YF_CMDEFLIGHT;
+        priv->flight_n--;
+
+        yf_cmdpool_yield(ctx, &e.cmdr);
+        if (e.callb != NULL)
+            e.callb(0, e.arg);
+    }
+}
+
+/* Executes a command queue. */
+static int exec_queue(yf_context_t *ctx, cmde_t *cmde, subm_t *subm)
+{
+    assert(ctx != NULL);
+    assert(cmde != NULL);
+    assert(subm != NULL);
+
+    /* signals are submitted even if there are no commands */
+    if (cmde->n < 1 && subm->sig_n == 0)
+        return 0;
+
+    VkSubmitInfo info = cmde->subm_info;
+    info.commandBufferCount = cmde->n;
+    info.waitSemaphoreCount = subm->wait_n;
+    info.pWaitSemaphores = subm->wait_sems;
+    info.pWaitDstStageMask = subm->wait_stgs;
+
+    int r = submit(ctx, &info, 1, subm);
+    subm->wait_n = 0;
+
+    dispatch_queue(ctx, cmde, r);
     return r;
 }
 
@@ -208,72 +310,48 @@ static int exec_queues(yf_context_t *ctx, cmde_t *prio, cmde_t *cmde,
     if (cmde->n < 1)
         return exec_queue(ctx, prio, subm);
 
-    int r = 0;
-    VkResult res;
-
     if (subm->prio_stg == 0)
         subm->prio_stg = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
 
-    prio->subm_info.commandBufferCount = prio->n;
-    prio->subm_info.signalSemaphoreCount = 1;
-    prio->subm_info.pSignalSemaphores = &subm->prio_sem;
+    VkSubmitInfo infos[2] = {prio->subm_info, cmde->subm_info};
 
-    cmde->subm_info.waitSemaphoreCount = 1;
-    cmde->subm_info.pWaitSemaphores = &subm->prio_sem;
-    cmde->subm_info.pWaitDstStageMask = &subm->prio_stg;
-    cmde->subm_info.commandBufferCount = cmde->n;
-    cmde->subm_info.signalSemaphoreCount = 0;
-    cmde->subm_info.pSignalSemaphores = NULL;
+    infos[0].waitSemaphoreCount = subm->wait_n;
+    infos[0].pWaitSemaphores = subm->wait_sems;
+    infos[0].pWaitDstStageMask = subm->wait_stgs;
+    infos[0].commandBufferCount = prio->n;
+    infos[0].signalSemaphoreCount = 1;
+    infos[0].pSignalSemaphores = &subm->prio_sem;
 
-    const unsigned sem_n = yf_list_getlen(subm->wait_sems);
-
-    if (sem_n > 0) {
-        VkSemaphore sems[sem_n];
-        VkPipelineStageFlags stgs[sem_n];
-        for (unsigned i = 0; i < sem_n; i++) {
-            sems[i] = yf_list_removeat(subm->wait_sems, NULL);
-            stgs[i] = (uintptr_t)yf_list_removeat(subm->wait_stgs, NULL);
-        }
-        prio->subm_info.waitSemaphoreCount = sem_n;
-        prio->subm_info.pWaitSemaphores = sems;
-        prio->subm_info.pWaitDstStageMask = stgs;
-        const VkSubmitInfo subm_infos[2] = {prio->subm_info, cmde->subm_info};
-        res = vkQueueSubmit(ctx->queue, 2, subm_infos, subm->fence);
-    } else {
-        prio->subm_info.waitSemaphoreCount = 0;
-        prio->subm_info.pWaitSemaphores = NULL;
-        prio->subm_info.pWaitDstStageMask = 0;
-        const VkSubmitInfo subm_infos[2] = {prio->subm_info, cmde->subm_info};
-        res = vkQueueSubmit(ctx->queue, 2, subm_infos, subm->fence);
-    }
+    infos[1].waitSemaphoreCount = 1;
+    infos[1].pWaitSemaphores = &subm->prio_sem;
+    infos[1].pWaitDstStageMask = &subm->prio_stg;
+    infos[1].commandBufferCount = cmde->n;
 
+    int r = submit(ctx, infos, 2, subm);
+    subm->wait_n = 0;
     subm->prio_stg = 0;
 
-    if (res != VK_SUCCESS) {
-        yf_seterr(YF_ERR_DEVGEN, __func__);
-        r = -1;
-    } else {
-        while ((res = vkWaitForFences(ctx->device, 1, &subm->fence, VK_TRUE,
-                                      YF_CMDEWAIT)) == VK_TIMEOUT)
-            ;
-        if (res != VK_SUCCESS) {
-            yf_seterr(YF_ERR_DEVGEN, __func__);
-            r = -1;
-        }
-    }
+    dispatch_queue(ctx, prio, r);
+    dispatch_queue(ctx, cmde, r);
+    return r;
+}
 
-    cmde_t *cmdes[2] = {prio, cmde};
+/* Calls and clears the callbacks set for the non-priority queue. */
+static void notify_callbs(yf_context_t *ctx, int result)
+{
+    assert(ctx != NULL);
 
-    for (unsigned i = 0; i < 2; i++) {
-        for (unsigned j = 0; j < cmdes[i]->n; j++) {
-            yf_cmdpool_yield(ctx, &cmdes[i]->entries[j].cmdr);
-            if (cmdes[i]->entries[j].callb != NULL)
-                cmdes[i]->entries[j].callb(r, cmdes[i]->entries[j].arg);
-        }
-        cmdes[i]->n = 0;
-    }
+    priv_t *priv = ctx->cmde.priv;
+    if (yf_list_getlen(priv->callbs) < 1)
+        return;
 
-    return r;
+    yf_iter_t it = YF_NILIT;
+    callb_t *callb;
+    while ((callb = yf_list_next(priv->callbs, &it)) != NULL) {
+        callb->callb(result, callb->arg);
+        free(callb);
+    }
+    yf_list_clear(priv->callbs);
 }
 
 /* Resets a command queue. */
@@ -321,19 +399,19 @@ static void destroy_priv(yf_context_t *ctx)
 
     priv_t *priv = ctx->cmde.priv;
 
+    /* the device is expected to be idle at this point */
+    retire_flights(ctx, 1);
     deinit_queue(ctx, &priv->cmde);
     deinit_queue(ctx, &priv->prio);
-    vkDestroyFence(ctx->device, priv->subm.fence, NULL);
-    vkDestroySemaphore(ctx->device, priv->subm.prio_sem, NULL);
-
-    if (priv->subm.wait_sems != NULL) {
-        while (yf_list_getlen(priv->subm.wait_sems) > 0)
-            vkDestroySemaphore(ctx->device,
-                               yf_list_removeat(priv->subm.wait_sems, NULL),
-                               NULL);
-        yf_list_deinit(priv->subm.wait_sems);
+    if (priv->callbs != NULL) {
+        yf_iter_t it = YF_NILIT;
+        do
+            free(yf_list_next(priv->callbs, &it));
+        while (!YF_IT_ISNIL(it));
+        yf_list_deinit(priv->callbs);
     }
-    yf_list_deinit(priv->subm.wait_stgs);
+    vkDestroySemaphore(ctx->device, priv->subm.timeline, NULL);
+    vkDestroySemaphore(ctx->device, priv->subm.prio_sem, NULL);
 
     free(priv);
     ctx->cmde.priv = NULL;
@@ -363,32 +441,44 @@ int yf_cmdexec_create(yf_context_t *ctx, unsigned capacity)
         return -1;
     }
 
-    VkFenceCreateInfo fence_info = {
-        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+    priv->callbs = yf_list_init(NULL);
+    if (priv->callbs == NULL) {
+        destroy_priv(ctx);
+        return -1;
+    }
+
+    VkSemaphoreTypeCreateInfo type_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
         .pNext = NULL,
-        .flags = 0
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue = 0
     };
     VkSemaphoreCreateInfo sem_info = {
         .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
-        .pNext = NULL,
+        .pNext = &type_info,
         .flags = 0
     };
 
-    if (vkCreateFence(ctx->device, &fence_info, NULL,
-                      &priv->subm.fence) != VK_SUCCESS ||
-        vkCreateSemaphore(ctx->device, &sem_info, NULL,
-                          &priv->subm.prio_sem) != VK_SUCCESS) {
+    if (vkCreateSemaphore(ctx->device, &sem_info, NULL,
+                          &priv->subm.timeline) != VK_SUCCESS) {
         yf_seterr(YF_ERR_DEVGEN, __func__);
         destroy_priv(ctx);
         return -1;
     }
 
-    if ((priv->subm.wait_sems = yf_list_init(NULL)) == NULL ||
-        (priv->subm.wait_stgs = yf_list_init(NULL)) == NULL) {
+    sem_info.pNext = NULL;
+
+    if (vkCreateSemaphore(ctx->device, &sem_info, NULL,
+                          &priv->subm.prio_sem) != VK_SUCCESS) {
+        yf_seterr(YF_ERR_DEVGEN, __func__);
         destroy_priv(ctx);
         return -1;
     }
 
+    /* serial zero is always complete */
+    priv->subm.serial = 1;
+    priv->subm.completed = 0;
+
     return 0;
 }
 
@@ -402,6 +492,47 @@ int yf_cmdexec_enqueue(yf_context_t *ctx, const yf_cmdres_t *cmdr,
     return enqueue_res(&((priv_t *)ctx->cmde.priv)->cmde, cmdr, callb, arg);
 }
 
+int yf_cmdexec_setcallb(yf_context_t *ctx, void (*callb)(int res, void *arg),
+                        void *arg)
+{
+    assert(ctx != NULL);
+    assert(callb != NULL);
+    assert(ctx->cmde.priv != NULL);
+
+    callb_t *e = malloc(sizeof(callb_t));
+    if (e == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        return -1;
+    }
+    e->callb = callb;
+    e->arg = arg;
+    if (yf_list_insert(((priv_t *)ctx->cmde.priv)->callbs, e) != 0) {
+        free(e);
+        return -1;
+    }
+    return 0;
+}
+
+void yf_cmdexec_unsetcallb(yf_context_t *ctx,
+                           void (*callb)(int res, void *arg), void *arg)
+{
+    assert(ctx != NULL);
+    assert(ctx->cmde.priv != NULL);
+
+    priv_t *priv = ctx->cmde.priv;
+    yf_iter_t it = YF_NILIT;
+    callb_t *e;
+
+    while ((e = yf_list_next(priv->callbs, &it)) != NULL) {
+        if (e->callb == callb && e->arg == arg) {
+            yf_list_removeat(priv->callbs, &it);
+            free(e);
+            /* removal invalidates the iterator */
+            it = YF_NILIT;
+        }
+    }
+}
+
 int yf_cmdexec_exec(yf_context_t *ctx)
 {
     assert(ctx != NULL);
@@ -416,9 +547,12 @@ int yf_cmdexec_exec(yf_context_t *ctx)
     } else {
         reset_queue(ctx, &priv->prio);
         reset_queue(ctx, &priv->cmde);
+        priv->subm.sig_n = 0;
     }
 
     yf_cmdpool_notifyprio(ctx, r);
+    notify_callbs(ctx, r);
+    yf_cmdexec_retire(ctx);
     return r;
 }
 
@@ -431,12 +565,15 @@ int yf_cmdexec_execprio(yf_context_t *ctx)
     int r = 0;
 
     r = end_prio(ctx, &priv->prio);
-    if (r == 0)
+    if (r == 0) {
         r = exec_queue(ctx, &priv->prio, &priv->subm);
-    else
+    } else {
         reset_queue(ctx, &priv->prio);
+        priv->subm.sig_n = 0;
+    }
 
     yf_cmdpool_notifyprio(ctx, r);
+    yf_cmdexec_retire(ctx);
     return r;
 }
 
@@ -446,6 +583,7 @@ void yf_cmdexec_reset(yf_context_t *ctx)
     assert(ctx->cmde.priv != NULL);
 
     reset_queue(ctx, &((priv_t *)ctx->cmde.priv)->cmde);
+    notify_callbs(ctx, -1);
 }
 
 void yf_cmdexec_resetprio(yf_context_t *ctx)
@@ -457,17 +595,118 @@ void yf_cmdexec_resetprio(yf_context_t *ctx)
     yf_cmdpool_notifyprio(ctx, -1);
 }
 
-void yf_cmdexec_waitfor(yf_context_t *ctx, VkSemaphore sem,
-                        VkPipelineStageFlags stg_mask)
+int yf_cmdexec_canwait(yf_context_t *ctx)
 {
     assert(ctx != NULL);
     assert(ctx->cmde.priv != NULL);
 
-    yf_list_t *wait_sems = ((priv_t *)ctx->cmde.priv)->subm.wait_sems;
-    yf_list_insert(wait_sems, sem);
+    return ((priv_t *)ctx->cmde.priv)->subm.wait_n < YF_CMDEMAX;
+}
+
+int yf_cmdexec_waitfor(yf_context_t *ctx, VkSemaphore sem,
+                       VkPipelineStageFlags stg_mask)
+{
+    assert(ctx != NULL);
+    assert(ctx->cmde.priv != NULL);
+
+    subm_t *subm = &((priv_t *)ctx->cmde.priv)->subm;
+    if (subm->wait_n == YF_CMDEMAX) {
+        yf_seterr(YF_ERR_QFULL, __func__);
+        return -1;
+    }
+
+    subm->wait_sems[subm->wait_n] = sem;
+    subm->wait_stgs[subm->wait_n] =
+        stg_mask != 0 ? stg_mask : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    subm->wait_n++;
+
+    return 0;
+}
+
+int yf_cmdexec_signal(yf_context_t *ctx, VkSemaphore sem)
+{
+    assert(ctx != NULL);
+    assert(ctx->cmde.priv != NULL);
+
+    subm_t *subm = &((priv_t *)ctx->cmde.priv)->subm;
+    if (subm->sig_n == YF_CMDEMAX) {
+        yf_seterr(YF_ERR_QFULL, __func__);
+        return -1;
+    }
+
+    subm->sig_sems[subm->sig_n++] = sem;
+    return 0;
+}
+
+uint64_t yf_cmdexec_getserial(yf_context_t *ctx)
+{
+    assert(ctx != NULL);
+    assert(ctx->cmde.priv != NULL);
+
+    return ((priv_t *)ctx->cmde.priv)->subm.serial;
+}
+
+int yf_cmdexec_completed(yf_context_t *ctx, uint64_t serial)
+{
+    assert(ctx != NULL);
+    assert(ctx->cmde.priv != NULL);
+
+    subm_t *subm = &((priv_t *)ctx->cmde.priv)->subm;
+
+    if (serial <= subm->completed)
+        return 1;
+    if (serial >= subm->serial)
+        return 0;
+
+    uint64_t value;
+    if (vkGetSemaphoreCounterValue(ctx->device, subm->timeline,
+                                   &value) != VK_SUCCESS)
+        return 0;
+    subm->completed = value;
+
+    return serial <= value;
+}
+
+int yf_cmdexec_wait(yf_context_t *ctx, uint64_t serial)
+{
+    assert(ctx != NULL);
+    assert(ctx->cmde.priv != NULL);
+
+    subm_t *subm = &((priv_t *)ctx->cmde.priv)->subm;
+
+    /* nothing past the last submission can be waited for */
+    if (serial >= subm->serial)
+        serial = subm->serial - 1;
+
+    if (serial > subm->completed) {
+        VkSemaphoreWaitInfo wait_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .pNext = NULL,
+            .flags = 0,
+            .semaphoreCount = 1,
+            .pSemaphores = &subm->timeline,
+            .pValues = &serial
+        };
+        VkResult res;
+        while ((res = vkWaitSemaphores(ctx->device, &wait_info,
+                                       YF_CMDEWAIT)) == VK_TIMEOUT)
+            ;
+        if (res != VK_SUCCESS) {
+            yf_seterr(YF_ERR_DEVGEN, __func__);
+            return -1;
+        }
+        subm->completed = serial;
+    }
+
+    yf_cmdexec_retire(ctx);
+    return 0;
+}
+
+void yf_cmdexec_retire(yf_context_t *ctx)
+{
+    assert(ctx != NULL);
+    assert(ctx->cmde.priv != NULL);
 
-    yf_list_t *wait_stgs = ((priv_t *)ctx->cmde.priv)->subm.wait_stgs;
-    VkPipelineStageFlags sm;
-    sm = stg_mask != 0 ? stg_mask : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
-    yf_list_insert(wait_stgs, (void *)(uintptr_t)sm);
+    retire_flights(ctx, 0);
+    yf_retire_collect(ctx);
 }
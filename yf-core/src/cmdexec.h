@@ -8,6 +8,8 @@
 #ifndef YF_CMDEXEC_H
 #define YF_CMDEXEC_H
 
+#include <stdint.h>
+
 #include "yf-context.h"
 #include "vk.h"
 #include "cmdpool.h"
@@ -19,10 +21,24 @@ int yf_cmdexec_create(yf_context_t *ctx, unsigned capacity);
 int yf_cmdexec_enqueue(yf_context_t *ctx, const yf_cmdres_t *cmdr,
                        void (*callb)(int res, void *arg), void *arg);
 
-/* Executes all commands currently in the queue. */
+/* Sets a callback to be called when the commands currently in the
+   queue are submitted.
+   The callback receives the result of the submission, or -1 if the
+   commands are discarded instead. */
+int yf_cmdexec_setcallb(yf_context_t *ctx, void (*callb)(int res, void *arg),
+                        void *arg);
+
+/* Removes callbacks previously set by 'setcallb' with the given values. */
+void yf_cmdexec_unsetcallb(yf_context_t *ctx,
+                           void (*callb)(int res, void *arg), void *arg);
+
+/* Submits all commands currently in the queue.
+   This function does not wait for the submitted commands to complete.
+   Resources are yielded and callbacks are called as the submissions
+   complete, from calls to 'exec', 'execprio', 'wait' or 'retire'. */
 int yf_cmdexec_exec(yf_context_t *ctx);
 
-/* Executes priority commands only. */
+/* Submits priority commands only. */
 int yf_cmdexec_execprio(yf_context_t *ctx);
 
 /* Discards pending commands and yield resources. */
@@ -31,8 +47,28 @@ void yf_cmdexec_reset(yf_context_t *ctx);
 /* Discards pending priority commands and yield resources. */
 void yf_cmdexec_resetprio(yf_context_t *ctx);
 
+/* Checks whether another wait semaphore can be set. */
+int yf_cmdexec_canwait(yf_context_t *ctx);
+
 /* Sets a semaphore upon which to wait in the next submission. */
-void yf_cmdexec_waitfor(yf_context_t *ctx, VkSemaphore sem,
-                        VkPipelineStageFlags stg_mask);
+int yf_cmdexec_waitfor(yf_context_t *ctx, VkSemaphore sem,
+                       VkPipelineStageFlags stg_mask);
+
+/* Sets a binary semaphore to signal in the next submission.
+   The submission happens even if there are no commands to execute. */
+int yf_cmdexec_signal(yf_context_t *ctx, VkSemaphore sem);
+
+/* Gets the serial that the next submission will signal. */
+uint64_t yf_cmdexec_getserial(yf_context_t *ctx);
+
+/* Checks whether the submission identified by a serial has completed. */
+int yf_cmdexec_completed(yf_context_t *ctx, uint64_t serial);
+
+/* Waits for the submission identified by a serial to complete.
+   Serials not yet submitted refer to the last submission. */
+int yf_cmdexec_wait(yf_context_t *ctx, uint64_t serial);
+
+/* Retires submissions that have completed, without blocking. */
+void yf_cmdexec_retire(yf_context_t *ctx);
 
 #endif /* YF_CMDEXEC_H */
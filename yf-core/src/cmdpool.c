@@ -13,6 +13,7 @@
 #include "yf/com/yf-error.h"
 
 #include "cmdpool.h"
+#include "cmdexec.h"
 #include "cmdbuf.h"
 #include "context.h"
 
@@ -162,6 +163,13 @@ int yf_cmdpool_obtain(yf_context_t *ctx, yf_cmdres_t *cmdr)
     assert(ctx->cmdp.priv != NULL);
 
     cmdp_t *cmdp = &((priv_t *)ctx->cmdp.priv)->cmdp;
+    if (cmdp->cur_n == cmdp->cap && ctx->cmde.priv != NULL) {
+        /* resources of submitted commands are yielded on completion */
+        yf_cmdexec_retire(ctx);
+        if (cmdp->cur_n == cmdp->cap &&
+            yf_cmdexec_wait(ctx, yf_cmdexec_getserial(ctx)) != 0)
+            return -1;
+    }
     if (cmdp->cur_n == cmdp->cap) {
         yf_seterr(YF_ERR_INUSE, __func__);
         return -1;
@@ -270,6 +278,26 @@ const yf_cmdres_t *yf_cmdpool_getprio(yf_context_t *ctx,
     return &priv->prio;
 }
 
+void yf_cmdpool_unsetprio(yf_context_t *ctx, void (*callb)(int res, void *arg),
+                          void *arg)
+{
+    assert(ctx != NULL);
+    assert(ctx->cmdp.priv != NULL);
+
+    priv_t *priv = ctx->cmdp.priv;
+    yf_iter_t it = YF_NILIT;
+    callb_t *e;
+
+    while ((e = yf_list_next(priv->callbs, &it)) != NULL) {
+        if (e->callb == callb && e->arg == arg) {
+            yf_list_removeat(priv->callbs, &it);
+            free(e);
+            /* removal invalidates the iterator */
+            it = YF_NILIT;
+        }
+    }
+}
+
 void yf_cmdpool_checkprio(yf_context_t *ctx, const yf_cmdres_t **cmdr_list,
                           unsigned *cmdr_n)
 {
@@ -294,7 +322,13 @@ void yf_cmdpool_notifyprio(yf_context_t *ctx, int result)
     assert(ctx->cmdp.priv != NULL);
 
     priv_t *priv = ctx->cmdp.priv;
-    yf_cmdpool_yield(ctx, &priv->prio);
+    if (result == 0) {
+        /* the execution queue yields it once the submission completes */
+        priv->prio.pool_res = NULL;
+        priv->prio.res_id = -1;
+    } else {
+        yf_cmdpool_yield(ctx, &priv->prio);
+    }
 
     if (yf_list_getlen(priv->callbs) < 1)
         return;
@@ -35,11 +35,17 @@ const yf_cmdres_t *yf_cmdpool_getprio(yf_context_t *ctx,
                                       void (*callb)(int res, void *arg),
                                       void *arg);
 
+/* Removes callbacks previously set by 'getprio' with the given values. */
+void yf_cmdpool_unsetprio(yf_context_t *ctx, void (*callb)(int res, void *arg),
+                          void *arg);
+
 /* Checks which priority resources have been used and are pending execution. */
 void yf_cmdpool_checkprio(yf_context_t *ctx, const yf_cmdres_t **cmdr_list,
                           unsigned *cmdr_n);
 
-/* Notifies that a pending priority resource did execute. */
+/* Notifies that a pending priority resource was submitted for execution.
+   On success, the resource is left to the execution queue, which yields
+   it when the submission completes. */
 void yf_cmdpool_notifyprio(yf_context_t *ctx, int result);
 
 #endif /* YF_CMDPOOL_H */
@@ -18,6 +18,7 @@
 
 #include "yf/com/yf-util.h"
 #include "yf/com/yf-error.h"
+#include "yf/wsys/yf-platform.h"
 
 #include "context.h"
 #include "cmdpool.h"
@@ -125,10 +126,12 @@ static int set_layers(yf_context_t *ctx)
 }
 #endif /* defined(YF_DEVEL) && !defined(YF_NO_VALIDATION) */
 
-/* Sets instance extensions. */
+/* Sets instance extensions.
+   Surface extensions are enabled only if all of them are available.
+   Otherwise, the context will not support presentation. */
 static int set_inst_exts(yf_context_t *ctx)
 {
-    const char *req_exts[] = {
+    const char *pres_exts[] = {
         VK_KHR_SURFACE_EXTENSION_NAME,
 #if defined(VK_USE_PLATFORM_WAYLAND_KHR)
         VK_KHR_WAYLAND_SURFACE_EXTENSION_NAME,
@@ -143,10 +146,11 @@ static int set_inst_exts(yf_context_t *ctx)
         VK_EXT_METAL_SURFACE_EXTENSION_NAME,
 #endif
     };
-    const size_t req_n = sizeof req_exts / sizeof req_exts[0];
+    const size_t pres_n = sizeof pres_exts / sizeof pres_exts[0];
 
-    /* TODO: Optional extensions. */
-    const size_t opt_n = 0;
+    ctx->inst_exts = NULL;
+    ctx->inst_ext_n = 0;
+    ctx->pres_exts = 0;
 
     VkResult res;
     unsigned prop_n;
@@ -156,10 +160,8 @@ static int set_inst_exts(yf_context_t *ctx)
         yf_seterr(YF_ERR_DEVGEN, __func__);
         return -1;
     }
-    if (prop_n < req_n) {
-        yf_seterr(YF_ERR_UNSUP, __func__);
-        return -1;
-    }
+    if (prop_n == 0)
+        return 0;
 
     VkExtensionProperties *props =
         malloc(sizeof(VkExtensionProperties) * prop_n);
@@ -174,40 +176,64 @@ static int set_inst_exts(yf_context_t *ctx)
         return -1;
     }
 
-    ctx->inst_exts = calloc(req_n + opt_n, sizeof(char *));
+    /* presentation extensions */
+    size_t found_n = 0;
+    for (size_t i = 0; i < pres_n; i++) {
+        for (size_t j = 0; j < prop_n; j++) {
+            if (strcmp(pres_exts[i], props[j].extensionName) == 0) {
+                found_n++;
+                break;
+            }
+        }
+    }
+
+#ifdef YF_DBGUTILS
+    int dbg_found = 0;
+    for (size_t i = 0; i < prop_n; i++) {
+        if (strcmp(VK_EXT_DEBUG_UTILS_EXTENSION_NAME,
+                   props[i].extensionName) == 0) {
+            dbg_found = 1;
+            break;
+        }
+    }
+#endif
+    free(props);
+
+    ctx->inst_exts = calloc(pres_n + 1, sizeof(char *));
     if (ctx->inst_exts == NULL) {
         yf_seterr(YF_ERR_NOMEM, __func__);
-        free(props);
         return -1;
     }
-    ctx->inst_ext_n = 0;
 
-    /* required extensions */
-    for (size_t i = 0; i < req_n; i++) {
-        for (size_t j = 0; j < prop_n; j++) {
-            if (strcmp(req_exts[i], props[j].extensionName) == 0) {
-                ctx->inst_exts[i] = malloc(strlen(req_exts[i])+1);
-                if (ctx->inst_exts[i] == NULL) {
-                    yf_seterr(YF_ERR_NOMEM, __func__);
-                    free(props);
-                    return -1;
-                }
-                strcpy(ctx->inst_exts[i], req_exts[i]);
-                ctx->inst_ext_n++;
-                break;
+    /* otherwise headless */
+    if (found_n == pres_n) {
+        for (size_t i = 0; i < pres_n; i++) {
+            ctx->inst_exts[i] = malloc(strlen(pres_exts[i])+1);
+            if (ctx->inst_exts[i] == NULL) {
+                yf_seterr(YF_ERR_NOMEM, __func__);
+                return -1;
             }
+            strcpy(ctx->inst_exts[i], pres_exts[i]);
+            ctx->inst_ext_n++;
         }
-        if (ctx->inst_ext_n == i) {
-            /* not found */
-            yf_seterr(YF_ERR_UNSUP, __func__);
-            free(props);
+        ctx->pres_exts = 1;
+    }
+
+#ifdef YF_DBGUTILS
+    /* debug utils are optional */
+    if (dbg_found) {
+        const unsigned i = ctx->inst_ext_n;
+        ctx->inst_exts[i] = malloc(sizeof VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+        if (ctx->inst_exts[i] == NULL) {
+            yf_seterr(YF_ERR_NOMEM, __func__);
             return -1;
         }
+        strcpy(ctx->inst_exts[i], VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+        ctx->inst_ext_n++;
+        ctx->dbg_utils = 1;
     }
+#endif
 
-    /* TODO: Check optional extensions & realloc if any not found. */
-
-    free(props);
     return 0;
 }
 
@@ -267,13 +293,21 @@ static int init_instance(yf_context_t *ctx)
 /* Sets device extensions. */
 static int set_dev_exts(yf_context_t *ctx)
 {
-    const char *req_exts[] = {
-        VK_KHR_SWAPCHAIN_EXTENSION_NAME
+    /* swapchain is only required if the device can present */
+    const char *req_exts[1];
+    size_t req_n = 0;
+    if (ctx->pres_queue_i != -1)
+        req_exts[req_n++] = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
+
+    const char *opt_exts[] = {
+        VK_EXT_MEMORY_BUDGET_EXTENSION_NAME
+    };
+    const unsigned opt_masks[] = {
+        YF_DEVEXT_MEMBUDGET
     };
-    const size_t req_n = sizeof req_exts / sizeof req_exts[0];
+    const size_t opt_n = sizeof opt_exts / sizeof opt_exts[0];
 
-    /* TODO: Optional extensions. */
-    const size_t opt_n = 0;
+    ctx->dev_ext_mask = 0;
 
     VkResult res;
     unsigned prop_n;
@@ -288,6 +322,8 @@ static int set_dev_exts(yf_context_t *ctx)
         yf_seterr(YF_ERR_UNSUP, __func__);
         return -1;
     }
+    if (prop_n == 0)
+        return 0;
 
     VkExtensionProperties *props =
         malloc(sizeof(VkExtensionProperties) * prop_n);
@@ -334,7 +370,23 @@ static int set_dev_exts(yf_context_t *ctx)
         }
     }
 
-    /* TODO: Check optional extensions & realloc if any not found. */
+    /* optional extensions */
+    for (size_t i = 0; i < opt_n; i++) {
+        for (size_t j = 0; j < prop_n; j++) {
+            if (strcmp(opt_exts[i], props[j].extensionName) == 0) {
+                char *ext = malloc(strlen(opt_exts[i])+1);
+                if (ext == NULL) {
+                    yf_seterr(YF_ERR_NOMEM, __func__);
+                    free(props);
+                    return -1;
+                }
+                strcpy(ext, opt_exts[i]);
+                ctx->dev_exts[ctx->dev_ext_n++] = ext;
+                ctx->dev_ext_mask |= opt_masks[i];
+                break;
+            }
+        }
+    }
 
     free(props);
     return 0;
@@ -388,7 +440,54 @@ static int set_features(yf_context_t *ctx)
         return -1;
     }
 
-    /* TODO: Query newer features. */
+    /* timeline semaphores are required for command execution */
+    if (ctx->inst_version < VK_API_VERSION_1_2 ||
+        ctx->dev_prop.apiVersion < VK_API_VERSION_1_2) {
+        yf_seterr(YF_ERR_UNSUP, __func__);
+        return -1;
+    }
+
+    VkPhysicalDeviceVulkan12Features feat_v12 = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        .pNext = NULL
+    };
+    VkPhysicalDeviceFeatures2 feat2 = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+        .pNext = &feat_v12
+    };
+    vkGetPhysicalDeviceFeatures2(ctx->phy_dev, &feat2);
+
+    if (feat_v12.timelineSemaphore == VK_FALSE) {
+        yf_seterr(YF_ERR_UNSUP, __func__);
+        return -1;
+    }
+
+    ctx->features_v12.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    ctx->features_v12.pNext = NULL;
+    ctx->features_v12.timelineSemaphore = VK_TRUE;
+
+    /* descriptor indexing is optional, it enables the bindless table */
+    if (feat_v12.descriptorIndexing == VK_TRUE &&
+        feat_v12.runtimeDescriptorArray == VK_TRUE &&
+        feat_v12.shaderSampledImageArrayNonUniformIndexing == VK_TRUE &&
+        feat_v12.descriptorBindingPartiallyBound == VK_TRUE &&
+        feat_v12.descriptorBindingUpdateUnusedWhilePending == VK_TRUE &&
+        feat_v12.descriptorBindingSampledImageUpdateAfterBind == VK_TRUE &&
+        feat_v12.descriptorBindingStorageBufferUpdateAfterBind == VK_TRUE) {
+
+        ctx->features_v12.descriptorIndexing = VK_TRUE;
+        ctx->features_v12.runtimeDescriptorArray = VK_TRUE;
+        ctx->features_v12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+        ctx->features_v12.shaderStorageBufferArrayNonUniformIndexing =
+            feat_v12.shaderStorageBufferArrayNonUniformIndexing;
+        ctx->features_v12.descriptorBindingPartiallyBound = VK_TRUE;
+        ctx->features_v12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+        ctx->features_v12.descriptorBindingSampledImageUpdateAfterBind =
+            VK_TRUE;
+        ctx->features_v12.descriptorBindingStorageBufferUpdateAfterBind =
+            VK_TRUE;
+    }
 
     return 0;
 }
@@ -420,6 +519,16 @@ static int init_device(yf_context_t *ctx)
         return -1;
     }
 
+    /* devices that can present are preferred, but headless rendering
+       only requires a queue that supports graphics and compute */
+    const int can_pres = ctx->pres_exts &&
+                         yf_getplatform() != YF_PLATFORM_NONE;
+    const unsigned graph_comp = YF_QUEUE_GRAPH | YF_QUEUE_COMP;
+    VkPhysicalDevice hdl_dev = NULL;
+    VkPhysicalDeviceProperties hdl_prop = {0};
+    int hdl_queue_i = -1;
+    int found = 0;
+
     /* TODO: Consider sorting devices. */
     VkPhysicalDeviceProperties prop;
     for (size_t i = 0; i < phy_n; i++) {
@@ -439,7 +548,6 @@ static int init_device(yf_context_t *ctx)
 
         ctx->queue_i = ctx->pres_queue_i = -1;
         ctx->queue_mask = 0;
-        const unsigned graph_comp = YF_QUEUE_GRAPH | YF_QUEUE_COMP;
 
         for (unsigned i = 0; i < qf_n; i++) {
             /* there must be a queue that supports both graphics and compute,
@@ -456,26 +564,43 @@ static int init_device(yf_context_t *ctx)
                 }
             }
 
-            if (yf_canpresent(ctx->phy_dev, i))
+            if (can_pres && ctx->pres_queue_i == -1 &&
+                yf_canpresent(ctx->phy_dev, i))
                 ctx->pres_queue_i = i;
 
-            if (ctx->queue_mask == graph_comp && ctx->pres_queue_i != -1)
+            if (ctx->queue_mask == graph_comp &&
+                (ctx->pres_queue_i != -1 || !can_pres))
                 break;
         }
 
         free(qf_props);
 
-        if (ctx->queue_mask == graph_comp && ctx->pres_queue_i != -1) {
-            ctx->dev_prop = prop;
-            break;
+        if (ctx->queue_mask == graph_comp) {
+            if (ctx->pres_queue_i != -1 || !can_pres) {
+                ctx->dev_prop = prop;
+                found = 1;
+                break;
+            }
+            if (hdl_dev == NULL) {
+                hdl_dev = ctx->phy_dev;
+                hdl_prop = prop;
+                hdl_queue_i = ctx->queue_i;
+            }
         }
     }
 
     free(phy_devs);
 
-    if (ctx->queue_i == -1) {
-        yf_seterr(YF_ERR_DEVGEN, __func__);
-        return -1;
+    if (!found) {
+        if (hdl_dev == NULL) {
+            yf_seterr(YF_ERR_DEVGEN, __func__);
+            return -1;
+        }
+        ctx->phy_dev = hdl_dev;
+        ctx->dev_prop = hdl_prop;
+        ctx->queue_i = hdl_queue_i;
+        ctx->queue_mask = graph_comp;
+        ctx->pres_queue_i = -1;
     }
 
     const float priority[1] = {0.0f};
@@ -499,7 +624,7 @@ static int init_device(yf_context_t *ctx)
 
     VkDeviceCreateInfo dev_info = {
         .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-        .pNext = NULL,
+        .pNext = &ctx->features_v12,
         .flags = 0,
         .queueCreateInfoCount = queue_info_n,
         .pQueueCreateInfos = queue_infos,
@@ -599,6 +724,16 @@ void yf_context_deinit(yf_context_t *ctx)
 
     vkDeviceWaitIdle(ctx->device);
 
+    /* completes pending readbacks and the like before their owners go */
+    if (ctx->cmde.priv != NULL)
+        yf_cmdexec_retire(ctx);
+
+    if (ctx->stc.deinit_callb != NULL)
+        ctx->stc.deinit_callb(ctx);
+    if (ctx->bdls.deinit_callb != NULL)
+        ctx->bdls.deinit_callb(ctx);
+    if (ctx->rdbk.deinit_callb != NULL)
+        ctx->rdbk.deinit_callb(ctx);
     if (ctx->splr.deinit_callb != NULL)
         ctx->splr.deinit_callb(ctx);
     if (ctx->stg.deinit_callb != NULL)
@@ -609,6 +744,13 @@ void yf_context_deinit(yf_context_t *ctx)
         ctx->cmde.deinit_callb(ctx);
     if (ctx->cmdp.deinit_callb != NULL)
         ctx->cmdp.deinit_callb(ctx);
+    if (ctx->cmdb.deinit_callb != NULL)
+        ctx->cmdb.deinit_callb(ctx);
+    /* must come last since the above can retire device objects */
+    if (ctx->retr.deinit_callb != NULL)
+        ctx->retr.deinit_callb(ctx);
+    if (ctx->mem.deinit_callb != NULL)
+        ctx->mem.deinit_callb(ctx);
 
     for (unsigned i = 0; i < ctx->layer_n; i++)
         free(ctx->layers[i]);
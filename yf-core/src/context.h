@@ -35,6 +35,7 @@ struct yf_context {
     VkPhysicalDeviceProperties dev_prop;
     VkPhysicalDeviceMemoryProperties mem_prop;
     VkPhysicalDeviceFeatures features;
+    VkPhysicalDeviceVulkan12Features features_v12;
 
     VkPipelineCache pl_cache;
 
@@ -42,14 +43,26 @@ struct yf_context {
     unsigned layer_n;
     char **inst_exts;
     unsigned inst_ext_n;
+    int pres_exts;
+#ifdef YF_DBGUTILS
+    int dbg_utils;
+#endif
     char **dev_exts;
     unsigned dev_ext_n;
+#define YF_DEVEXT_MEMBUDGET 0x1
+    unsigned dev_ext_mask;
 
+    yf_ctxmgd_t cmdb;
     yf_ctxmgd_t cmdp;
     yf_ctxmgd_t cmde;
     yf_ctxmgd_t lim;
     yf_ctxmgd_t stg;
     yf_ctxmgd_t splr;
+    yf_ctxmgd_t rdbk;
+    yf_ctxmgd_t bdls;
+    yf_ctxmgd_t stc;
+    yf_ctxmgd_t retr;
+    yf_ctxmgd_t mem;
 };
 
 #endif /* YF_CONTEXT_H */
@@ -6,6 +6,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 #include "yf/com/yf-error.h"
@@ -14,8 +15,43 @@
 #include "context.h"
 #include "stage.h"
 #include "dtable.h"
+#include "retire.h"
 #include "yf-limits.h"
 
+/* Builds the cache key of a given configuration. */
+static int make_key(const yf_cconf_t *conf, yf_stkey_t *key)
+{
+    assert(conf != NULL);
+    assert(key != NULL);
+
+    const size_t sz = 1 + sizeof conf->stg.stage + sizeof conf->stg.shd +
+                      sizeof conf->stg.entry_point + sizeof conf->dtb_n +
+                      conf->dtb_n * sizeof *conf->dtbs;
+
+    /* zeroed so that entry point names are padded consistently */
+    unsigned char *dst = calloc(1, sz);
+    if (dst == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        return -1;
+    }
+    key->data = dst;
+    key->size = sz;
+
+    *dst++ = YF_STKEY_CST;
+    YF_STKEY_PUT(dst, conf->stg.stage);
+    YF_STKEY_PUT(dst, conf->stg.shd);
+    strncpy((char *)dst, conf->stg.entry_point,
+            sizeof conf->stg.entry_point - 1);
+    dst += sizeof conf->stg.entry_point;
+
+    YF_STKEY_PUT(dst, conf->dtb_n);
+    for (unsigned i = 0; i < conf->dtb_n; i++)
+        YF_STKEY_PUT(dst, conf->dtbs[i]);
+
+    assert(dst == key->data + key->size);
+    return 0;
+}
+
 yf_cstate_t *yf_cstate_init(yf_context_t *ctx, const yf_cconf_t *conf)
 {
     assert(ctx != NULL);
@@ -31,12 +67,25 @@ yf_cstate_t *yf_cstate_init(yf_context_t *ctx, const yf_cconf_t *conf)
         return NULL;
     }
 
-    yf_cstate_t *cst = calloc(1, sizeof(yf_cstate_t));
+    yf_stkey_t key;
+    if (make_key(conf, &key) != 0)
+        return NULL;
+
+    yf_cstate_t *cst = yf_stcache_get(ctx, &key);
+    if (cst != NULL) {
+        free(key.data);
+        cst->refs++;
+        return cst;
+    }
+
+    cst = calloc(1, sizeof(yf_cstate_t));
     if (cst == NULL) {
         yf_seterr(YF_ERR_NOMEM, __func__);
+        free(key.data);
         return NULL;
     }
     cst->ctx = ctx;
+    cst->key = key;
 
     memcpy(&cst->stg, &conf->stg, sizeof conf->stg);
     cst->stg.entry_point[(sizeof cst->stg.entry_point) - 1] = '\0';
@@ -116,9 +165,12 @@ yf_cstate_t *yf_cstate_init(yf_context_t *ctx, const yf_cconf_t *conf)
     if (res != VK_SUCCESS) {
         yf_seterr(YF_ERR_DEVGEN, __func__);
         yf_cstate_deinit(cst);
-        cst = NULL;
+        return NULL;
     }
 
+    /* if caching fails, the state is just not shared */
+    cst->refs = 1;
+    yf_stcache_put(ctx, &cst->key, cst);
     return cst;
 }
 
@@ -143,9 +195,16 @@ yf_dtable_t *yf_cstate_getdtb(yf_cstate_t *cst, unsigned index)
 void yf_cstate_deinit(yf_cstate_t *cst)
 {
     if (cst != NULL) {
+        if (cst->refs > 1) {
+            cst->refs--;
+            return;
+        }
+        if (cst->refs == 1 && yf_stcache_get(cst->ctx, &cst->key) == cst)
+            yf_stcache_remove(cst->ctx, &cst->key);
+        free(cst->key.data);
         free(cst->dtbs);
-        vkDestroyPipelineLayout(cst->ctx->device, cst->layout, NULL);
-        vkDestroyPipeline(cst->ctx->device, cst->pipeline, NULL);
+        yf_retire_pipeline(cst->ctx, cst->pipeline);
+        yf_retire_pllayout(cst->ctx, cst->layout);
         free(cst);
     }
 }
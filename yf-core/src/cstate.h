@@ -10,6 +10,7 @@
 
 #include "yf-cstate.h"
 #include "vk.h"
+#include "stcache.h"
 
 struct yf_cstate {
     yf_context_t *ctx;
@@ -19,6 +20,9 @@ struct yf_cstate {
 
     VkPipelineLayout layout;
     VkPipeline pipeline;
+
+    yf_stkey_t key;
+    unsigned refs;
 };
 
 #endif /* YF_CSTATE_H */
@@ -0,0 +1,121 @@
+/*
+ * YF
+ * debug.c
+ *
+ * Copyright © 2020 Gustavo C. Viegas.
+ */
+
+#include <assert.h>
+
+#include "yf-debug.h"
+#include "debug.h"
+#include "context.h"
+#include "buffer.h"
+#include "image.h"
+#include "gstate.h"
+#include "cstate.h"
+#include "dtable.h"
+
+#ifdef YF_DBGUTILS
+
+void yf_dbg_setname(yf_context_t *ctx, VkObjectType type, uint64_t handle,
+                    const char *name)
+{
+    assert(ctx != NULL);
+    assert(name != NULL);
+
+    if (!ctx->dbg_utils || handle == 0)
+        return;
+
+    VkDebugUtilsObjectNameInfoEXT info = {
+        .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+        .pNext = NULL,
+        .objectType = type,
+        .objectHandle = handle,
+        .pObjectName = name
+    };
+
+    /* naming is best effort */
+    vkSetDebugUtilsObjectNameEXT(ctx->device, &info);
+}
+
+void yf_dbg_beginlabel(yf_context_t *ctx, VkCommandBuffer cmdbuf,
+                       const char *label)
+{
+    assert(ctx != NULL);
+    assert(label != NULL);
+
+    if (!ctx->dbg_utils)
+        return;
+
+    VkDebugUtilsLabelEXT info = {
+        .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
+        .pNext = NULL,
+        .pLabelName = label,
+        .color = {0.0f, 0.0f, 0.0f, 0.0f}
+    };
+
+    vkCmdBeginDebugUtilsLabelEXT(cmdbuf, &info);
+}
+
+void yf_dbg_endlabel(yf_context_t *ctx, VkCommandBuffer cmdbuf)
+{
+    assert(ctx != NULL);
+
+    if (ctx->dbg_utils)
+        vkCmdEndDebugUtilsLabelEXT(cmdbuf);
+}
+
+void yf_buffer_setname(yf_buffer_t *buf, const char *name)
+{
+    assert(buf != NULL);
+    assert(name != NULL);
+
+    yf_dbg_setname(buf->ctx, VK_OBJECT_TYPE_BUFFER,
+                   (uint64_t)buf->buffer, name);
+}
+
+void yf_image_setname(yf_image_t *img, const char *name)
+{
+    assert(img != NULL);
+    assert(name != NULL);
+
+    yf_dbg_setname(img->ctx, VK_OBJECT_TYPE_IMAGE,
+                   (uint64_t)img->image, name);
+}
+
+void yf_gstate_setname(yf_gstate_t *gst, const char *name)
+{
+    assert(gst != NULL);
+    assert(name != NULL);
+
+    yf_dbg_setname(gst->ctx, VK_OBJECT_TYPE_PIPELINE,
+                   (uint64_t)gst->pipeline, name);
+    yf_dbg_setname(gst->ctx, VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                   (uint64_t)gst->layout, name);
+}
+
+void yf_cstate_setname(yf_cstate_t *cst, const char *name)
+{
+    assert(cst != NULL);
+    assert(name != NULL);
+
+    yf_dbg_setname(cst->ctx, VK_OBJECT_TYPE_PIPELINE,
+                   (uint64_t)cst->pipeline, name);
+    yf_dbg_setname(cst->ctx, VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                   (uint64_t)cst->layout, name);
+}
+
+void yf_dtable_setname(yf_dtable_t *dtb, const char *name)
+{
+    assert(dtb != NULL);
+    assert(name != NULL);
+
+    yf_dbg_setname(dtb->ctx, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT,
+                   (uint64_t)dtb->layout, name);
+    for (unsigned i = 0; i < dtb->set_n; i++)
+        yf_dbg_setname(dtb->ctx, VK_OBJECT_TYPE_DESCRIPTOR_SET,
+                       (uint64_t)dtb->sets[i], name);
+}
+
+#endif /* YF_DBGUTILS */
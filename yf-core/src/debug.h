@@ -0,0 +1,31 @@
+/*
+ * YF
+ * debug.h
+ *
+ * Copyright © 2020 Gustavo C. Viegas.
+ */
+
+#ifndef YF_DEBUG_H
+#define YF_DEBUG_H
+
+#include "yf-context.h"
+#include "vk.h"
+
+#ifdef YF_DBGUTILS
+
+#include <stdint.h>
+
+/* Names a device object, if debug utils are enabled in the context. */
+void yf_dbg_setname(yf_context_t *ctx, VkObjectType type, uint64_t handle,
+                    const char *name);
+
+/* Begins a label region in a command buffer. */
+void yf_dbg_beginlabel(yf_context_t *ctx, VkCommandBuffer cmdbuf,
+                       const char *label);
+
+/* Ends the last label region begun in a command buffer. */
+void yf_dbg_endlabel(yf_context_t *ctx, VkCommandBuffer cmdbuf);
+
+#endif /* YF_DBGUTILS */
+
+#endif /* YF_DEBUG_H */
@@ -5,10 +5,12 @@
  * Copyright © 2020 Gustavo C. Viegas.
  */
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 
+#include "yf/com/yf-util.h"
 #include "yf/com/yf-pubsub.h"
 #include "yf/com/yf-error.h"
 
@@ -17,6 +19,7 @@
 #include "sampler.h"
 #include "buffer.h"
 #include "image.h"
+#include "retire.h"
 #include "yf-limits.h"
 
 /* Key/value for the 'iss' dictionary. */
@@ -47,6 +50,8 @@ static void inval_iview(void *img, int pubsub, void *dtb)
     yf_iter_t it = YF_NILIT;
     kv_t *kv;
 
+    yf_dict_remove(((yf_dtable_t *)dtb)->refs, img);
+
     while ((kv = yf_dict_next(iss, &it, NULL)) != NULL) {
         const unsigned n = entries[kv->key.entry_i].elements;
         for (unsigned i = 0; i < n; i++) {
@@ -124,44 +129,72 @@ static int init_layout(yf_dtable_t *dtb)
         }
     }
 
-    const yf_limits_t *lim = yf_getlimits(dtb->ctx);
+    VkDescriptorSetLayoutBindingFlagsCreateInfo flags_info;
+    VkDescriptorBindingFlags *flags = NULL;
 
-    if (dtb->count.unif > lim->dtable.unif_max ||
-        dtb->count.mut > lim->dtable.mut_max ||
-        dtb->count.img > lim->dtable.img_max ||
-        dtb->count.spld > lim->dtable.spld_max ||
-        dtb->count.splr > lim->dtable.splr_max ||
-        dtb->count.ispl > lim->dtable.ispl_max ||
-        (dtb->count.unif + dtb->count.mut + dtb->count.img + dtb->count.spld +
-         dtb->count.splr + dtb->count.ispl) > lim->dtable.stg_res_max) {
-
-        yf_seterr(YF_ERR_LIMIT, __func__);
-        free(bindings);
-        return -1;
+    if (dtb->bindless) {
+        /* limits for these are checked on creation of the bindless table */
+        flags = malloc(dtb->entry_n * sizeof *flags);
+        if (flags == NULL) {
+            yf_seterr(YF_ERR_NOMEM, __func__);
+            free(bindings);
+            return -1;
+        }
+        for (unsigned i = 0; i < dtb->entry_n; i++)
+            flags[i] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                       VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                       VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+        flags_info.sType =
+            VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+        flags_info.pNext = NULL;
+        flags_info.bindingCount = dtb->entry_n;
+        flags_info.pBindingFlags = flags;
+
+    } else {
+        const yf_limits_t *lim = yf_getlimits(dtb->ctx);
+
+        if (dtb->count.unif > lim->dtable.unif_max ||
+            dtb->count.mut > lim->dtable.mut_max ||
+            dtb->count.img > lim->dtable.img_max ||
+            dtb->count.spld > lim->dtable.spld_max ||
+            dtb->count.splr > lim->dtable.splr_max ||
+            dtb->count.ispl > lim->dtable.ispl_max ||
+            (dtb->count.unif + dtb->count.mut + dtb->count.img +
+             dtb->count.spld + dtb->count.splr + dtb->count.ispl) >
+            lim->dtable.stg_res_max) {
+
+            yf_seterr(YF_ERR_LIMIT, __func__);
+            free(bindings);
+            return -1;
+        }
     }
 
     VkDescriptorSetLayoutCreateInfo info = {
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
+        .pNext = dtb->bindless ? &flags_info : NULL,
+        .flags = dtb->bindless ?
+                 VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT :
+                 0,
         .bindingCount = dtb->entry_n,
         .pBindings = bindings
     };
 
     VkResult res = vkCreateDescriptorSetLayout(dtb->ctx->device, &info, NULL,
                                                &dtb->layout);
+    free(flags);
+    free(bindings);
     if (res != VK_SUCCESS) {
         yf_seterr(YF_ERR_DEVGEN, __func__);
-        free(bindings);
         return -1;
     }
 
-    free(bindings);
     return 0;
 }
 
-yf_dtable_t *yf_dtable_init(yf_context_t *ctx, const yf_dentry_t *entries,
-                            unsigned entry_n)
+/* Initializes a new descriptor table. */
+static yf_dtable_t *init_dtable(yf_context_t *ctx, const yf_dentry_t *entries,
+                                unsigned entry_n, int bindless)
 {
     assert(ctx != NULL);
     assert(entries != NULL);
@@ -174,6 +207,7 @@ yf_dtable_t *yf_dtable_init(yf_context_t *ctx, const yf_dentry_t *entries,
     }
 
     dtb->ctx = ctx;
+    dtb->bindless = bindless;
 
     const size_t sz = entry_n * sizeof *entries;
     dtb->entries = malloc(sz);
@@ -194,17 +228,97 @@ yf_dtable_t *yf_dtable_init(yf_context_t *ctx, const yf_dentry_t *entries,
     return dtb;
 }
 
-int yf_dtable_alloc(yf_dtable_t *dtb, unsigned n)
+yf_dtable_t *yf_dtable_init(yf_context_t *ctx, const yf_dentry_t *entries,
+                            unsigned entry_n)
 {
-    assert(dtb != NULL);
+    return init_dtable(ctx, entries, entry_n, 0);
+}
 
-    if (n == dtb->set_n)
+yf_dtable_t *yf_dtable_initbdls(yf_context_t *ctx,
+                                const yf_dentry_t *entries, unsigned entry_n)
+{
+    return init_dtable(ctx, entries, entry_n, 1);
+}
+
+/* Counts a new reference to an image.
+   The dtable subscribes to the image's deinitialization on the first
+   reference. */
+static int ref_img(yf_dtable_t *dtb, yf_image_t *img)
+{
+    if (yf_dict_contains(dtb->refs, img)) {
+        const uintptr_t n = (uintptr_t)yf_dict_search(dtb->refs, img);
+        yf_dict_replace(dtb->refs, img, (void *)(n + 1));
         return 0;
+    }
 
-    yf_dtable_dealloc(dtb);
+    if (yf_dict_insert(dtb->refs, img, (void *)(uintptr_t)1) != 0)
+        return -1;
+    yf_subscribe(img, dtb, YF_PUBSUB_DEINIT, inval_iview, dtb);
+    return 0;
+}
 
-    if (n == 0)
-        return 0;
+/* Releases a reference to an image.
+   The dtable unsubscribes from the image when no references remain. */
+static void unref_img(yf_dtable_t *dtb, yf_image_t *img)
+{
+    const uintptr_t n = (uintptr_t)yf_dict_search(dtb->refs, img);
+    assert(n > 0);
+
+    if (n > 1) {
+        yf_dict_replace(dtb->refs, img, (void *)(n - 1));
+    } else {
+        yf_dict_remove(dtb->refs, img);
+        yf_subscribe(img, dtb, YF_PUBSUB_NONE, NULL, NULL);
+    }
+}
+
+/* Releases the resources referenced by allocations in a given range. */
+static void release_allocs(yf_dtable_t *dtb, unsigned first, unsigned last)
+{
+    for (unsigned i = 0; i < dtb->entry_n; i++) {
+        const unsigned elem_n = dtb->entries[i].elements;
+
+        for (unsigned j = first; j < last; j++) {
+            const kv_t k = {{j, i}, NULL};
+            kv_t *kv = yf_dict_search(dtb->iss, &k);
+            if (kv == NULL)
+                break;
+
+            for (unsigned e = 0; e < elem_n; e++) {
+                yf_image_t *img = kv->val[e].img;
+                if (img != NULL) {
+                    yf_image_ungetiview(img, &kv->val[e].iview);
+                    kv->val[e].img = NULL;
+                    unref_img(dtb, img);
+                }
+                if (kv->val[e].splrh != NULL) {
+                    yf_sampler_unget(dtb->ctx, kv->val[e].splrh);
+                    kv->val[e].splrh = NULL;
+                }
+            }
+        }
+    }
+}
+
+/* Removes the 'iss' entries of allocations in a given range. */
+static void remove_iss(yf_dtable_t *dtb, unsigned first, unsigned last)
+{
+    for (unsigned i = 0; i < dtb->entry_n; i++) {
+        for (unsigned j = first; j < last; j++) {
+            const kv_t k = {{j, i}, NULL};
+            kv_t *kv = yf_dict_remove(dtb->iss, &k);
+            if (kv != NULL) {
+                free(kv->val);
+                free(kv);
+            }
+        }
+    }
+}
+
+/* Chains a new descriptor pool providing a given number of allocations. */
+static int grow_pool(yf_dtable_t *dtb, unsigned n)
+{
+    assert(n > 0);
 
     VkDescriptorPoolSize sizes[6];
     unsigned sz_i = 0;
@@ -240,79 +354,88 @@ int yf_dtable_alloc(yf_dtable_t *dtb, unsigned n)
         sz_i++;
     }
 
-    VkResult res;
-
-    VkDescriptorPoolCreateInfo pool_info = {
-        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-        .pNext = NULL,
-        .flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
-        .maxSets = n,
-        .poolSizeCount = sz_i,
-        .pPoolSizes = sizes
-    };
+    if (dtb->iss == NULL && (dtb->iss = yf_dict_init(hash_kv, cmp_kv)) == NULL)
+        return -1;
+    if (dtb->refs == NULL && (dtb->refs = yf_dict_init(NULL, NULL)) == NULL)
+        return -1;
 
-    res = vkCreateDescriptorPool(dtb->ctx->device, &pool_info, NULL,
-                                 &dtb->pool);
-    if (res != VK_SUCCESS) {
-        yf_seterr(YF_ERR_DEVGEN, __func__);
+    VkDescriptorPool *pools = realloc(dtb->pools,
+                                      (dtb->pool_n + 1) * sizeof *pools);
+    if (pools == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
         return -1;
     }
+    dtb->pools = pools;
 
-    dtb->sets = malloc(n * sizeof *dtb->sets);
-    if (dtb->sets == NULL) {
+    VkDescriptorSet *sets = realloc(dtb->sets,
+                                    (dtb->set_cap + n) * sizeof *sets);
+    if (sets == NULL) {
         yf_seterr(YF_ERR_NOMEM, __func__);
-        vkDestroyDescriptorPool(dtb->ctx->device, dtb->pool, NULL);
-        dtb->pool = VK_NULL_HANDLE;
         return -1;
     }
-
-    dtb->set_n = n;
+    dtb->sets = sets;
 
     VkDescriptorSetLayout *layouts = malloc(n * sizeof dtb->layout);
     if (layouts == NULL) {
         yf_seterr(YF_ERR_NOMEM, __func__);
-        yf_dtable_dealloc(dtb);
         return -1;
     }
-
     for (unsigned i = 0; i < n; i++)
         layouts[i] = dtb->layout;
 
-    VkDescriptorSetAllocateInfo alloc_info = {
-        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+    VkResult res;
+
+    /* sets are never freed individually, they are kept for reuse instead */
+    VkDescriptorPoolCreateInfo pool_info = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
         .pNext = NULL,
-        .descriptorPool = dtb->pool,
-        .descriptorSetCount = n,
-        .pSetLayouts = layouts
+        .flags = dtb->bindless ?
+                 VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT : 0,
+        .maxSets = n,
+        .poolSizeCount = sz_i,
+        .pPoolSizes = sizes
     };
 
-    res = vkAllocateDescriptorSets(dtb->ctx->device, &alloc_info, dtb->sets);
-
+    VkDescriptorPool pool;
+    res = vkCreateDescriptorPool(dtb->ctx->device, &pool_info, NULL, &pool);
     if (res != VK_SUCCESS) {
         yf_seterr(YF_ERR_DEVGEN, __func__);
-        yf_dtable_dealloc(dtb);
         free(layouts);
         return -1;
     }
 
-    free(layouts);
+    VkDescriptorSetAllocateInfo alloc_info = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .pNext = NULL,
+        .descriptorPool = pool,
+        .descriptorSetCount = n,
+        .pSetLayouts = layouts
+    };
 
-    dtb->iss = yf_dict_init(hash_kv, cmp_kv);
-    if (dtb->iss == NULL) {
-        yf_dtable_dealloc(dtb);
+    res = vkAllocateDescriptorSets(dtb->ctx->device, &alloc_info,
+                                   dtb->sets+dtb->set_cap);
+    free(layouts);
+    if (res != VK_SUCCESS) {
+        yf_seterr(YF_ERR_DEVGEN, __func__);
+        vkDestroyDescriptorPool(dtb->ctx->device, pool, NULL);
         return -1;
     }
 
+    const unsigned first = dtb->set_cap;
+    const unsigned last = first + n;
+
     for (unsigned i = 0; i < dtb->entry_n; i++) {
         switch (dtb->entries[i].dtype) {
         case YF_DTYPE_IMAGE:
         case YF_DTYPE_SAMPLED:
         case YF_DTYPE_SAMPLER:
         case YF_DTYPE_ISAMPLER:
-            for (unsigned j = 0; j < n; j++) {
+            for (unsigned j = first; j < last; j++) {
                 kv_t *kv = calloc(1, sizeof(kv_t));
                 if (kv == NULL) {
-                    yf_dtable_dealloc(dtb);
+                    yf_seterr(YF_ERR_NOMEM, __func__);
+                    remove_iss(dtb, first, last);
+                    vkDestroyDescriptorPool(dtb->ctx->device, pool, NULL);
                     return -1;
                 }
 
@@ -321,9 +444,10 @@ int yf_dtable_alloc(yf_dtable_t *dtb, unsigned n)
 
                 kv->val = calloc(dtb->entries[i].elements, sizeof *kv->val);
                 if (kv->val == NULL || yf_dict_insert(dtb->iss, kv, kv) != 0) {
-                    yf_dtable_dealloc(dtb);
                     free(kv->val);
                     free(kv);
+                    remove_iss(dtb, first, last);
+                    vkDestroyDescriptorPool(dtb->ctx->device, pool, NULL);
                     return -1;
                 }
             }
@@ -334,6 +458,37 @@ int yf_dtable_alloc(yf_dtable_t *dtb, unsigned n)
         }
     }
 
+    dtb->pools[dtb->pool_n++] = pool;
+    dtb->set_cap = last;
+    return 0;
+}
+
+int yf_dtable_alloc(yf_dtable_t *dtb, unsigned n)
+{
+    assert(dtb != NULL);
+
+    if (n == dtb->set_n)
+        return 0;
+
+    if (n < dtb->set_n) {
+        /* removed allocations are kept for reuse */
+        release_allocs(dtb, n, dtb->set_n);
+        dtb->set_n = n;
+        return 0;
+    }
+
+    if (n > dtb->set_cap) {
+        /* existing pools are left untouched */
+        const unsigned req = n - dtb->set_cap;
+        const unsigned add = YF_MAX(req, dtb->set_cap);
+        if (grow_pool(dtb, add) != 0) {
+            /* try again with the minimum required */
+            if (add == req || grow_pool(dtb, req) != 0)
+                return -1;
+        }
+    }
+
+    dtb->set_n = n;
     return 0;
 }
 
@@ -341,7 +496,7 @@ void yf_dtable_dealloc(yf_dtable_t *dtb)
 {
     assert(dtb != NULL);
 
-    if (dtb->sets == NULL)
+    if (dtb->pools == NULL)
         return;
 
     yf_iter_t it = YF_NILIT;
@@ -349,10 +504,8 @@ void yf_dtable_dealloc(yf_dtable_t *dtb)
 
     while ((kv = yf_dict_next(dtb->iss, &it, NULL)) != NULL) {
         for (unsigned i = 0; i < dtb->entries[kv->key.entry_i].elements; i++) {
-            if (kv->val[i].img != NULL) {
-                yf_subscribe(kv->val[i].img, dtb, YF_PUBSUB_NONE, NULL, NULL);
+            if (kv->val[i].img != NULL)
                 yf_image_ungetiview(kv->val[i].img, &kv->val[i].iview);
-            }
             if (kv->val[i].splrh != NULL)
                 yf_sampler_unget(dtb->ctx, kv->val[i].splrh);
         }
@@ -363,11 +516,22 @@ void yf_dtable_dealloc(yf_dtable_t *dtb)
     yf_dict_deinit(dtb->iss);
     dtb->iss = NULL;
 
-    vkDestroyDescriptorPool(dtb->ctx->device, dtb->pool, NULL);
-    dtb->pool = VK_NULL_HANDLE;
+    yf_image_t *img;
+    it = YF_NILIT;
+    while (yf_dict_next(dtb->refs, &it, (void **)&img) != NULL)
+        yf_subscribe(img, dtb, YF_PUBSUB_NONE, NULL, NULL);
+    yf_dict_deinit(dtb->refs);
+    dtb->refs = NULL;
+
+    for (unsigned i = 0; i < dtb->pool_n; i++)
+        yf_retire_dpool(dtb->ctx, dtb->pools[i]);
+    free(dtb->pools);
+    dtb->pools = NULL;
+    dtb->pool_n = 0;
     free(dtb->sets);
     dtb->sets = NULL;
     dtb->set_n = 0;
+    dtb->set_cap = 0;
 }
 
 int yf_dtable_copybuf(yf_dtable_t *dtb, unsigned alloc_i, unsigned binding,
@@ -528,14 +692,15 @@ int yf_dtable_copyimg(yf_dtable_t *dtb, unsigned alloc_i, unsigned binding,
             return -1;
         }
 
-        yf_subscribe(imgs[i], dtb, YF_PUBSUB_DEINIT, inval_iview, dtb);
+        if (ref_img(dtb, imgs[i]) != 0) {
+            yf_image_ungetiview(imgs[i], &iview);
+            free(img_infos);
+            return -1;
+        }
 
         if (kv->val[elem_i].img != NULL) {
-            if (kv->val[elem_i].img != imgs[i])
-                yf_subscribe(kv->val[elem_i].img, dtb, YF_PUBSUB_NONE,
-                             NULL, NULL);
-
             yf_image_ungetiview(kv->val[elem_i].img, &kv->val[elem_i].iview);
+            unref_img(dtb, kv->val[elem_i].img);
         }
 
         kv->val[elem_i].iview = iview;
@@ -596,6 +761,37 @@ int yf_dtable_copyimg(yf_dtable_t *dtb, unsigned alloc_i, unsigned binding,
     return 0;
 }
 
+void yf_dtable_resetimg(yf_dtable_t *dtb, unsigned alloc_i, unsigned binding,
+                        unsigned element)
+{
+    assert(dtb != NULL);
+    assert(alloc_i < dtb->set_n);
+
+    for (unsigned i = 0; i < dtb->entry_n; i++) {
+        if (dtb->entries[i].binding != binding)
+            continue;
+
+        assert(element < dtb->entries[i].elements);
+
+        const kv_t k = {{alloc_i, i}, NULL};
+        kv_t *kv = yf_dict_search(dtb->iss, &k);
+        if (kv == NULL)
+            return;
+
+        yf_image_t *img = kv->val[element].img;
+        if (img != NULL) {
+            yf_image_ungetiview(img, &kv->val[element].iview);
+            kv->val[element].img = NULL;
+            unref_img(dtb, img);
+        }
+        if (kv->val[element].splrh != NULL) {
+            yf_sampler_unget(dtb->ctx, kv->val[element].splrh);
+            kv->val[element].splrh = NULL;
+        }
+        return;
+    }
+}
+
 void yf_dtable_deinit(yf_dtable_t *dtb)
 {
     if (dtb == NULL)
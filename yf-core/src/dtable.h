@@ -28,12 +28,26 @@ struct yf_dtable {
     } count;
 
     yf_dict_t *iss;
+    /* number of elements referencing each image */
+    yf_dict_t *refs;
     VkDescriptorSetLayout layout;
-    VkDescriptorPool pool;
+    VkDescriptorPool *pools;
+    unsigned pool_n;
     VkDescriptorSet *sets;
     unsigned set_n;
+    unsigned set_cap;
+    int bindless;
 };
 
+/* Initializes a new descriptor table whose bindings are partially bound
+   and can be updated after being set. */
+yf_dtable_t *yf_dtable_initbdls(yf_context_t *ctx,
+                                const yf_dentry_t *entries, unsigned entry_n);
+
+/* Releases the image and sampler referenced by a descriptor element. */
+void yf_dtable_resetimg(yf_dtable_t *dtb, unsigned alloc_i, unsigned binding,
+                        unsigned element);
+
 /* Converts from a 'YF_DTYPE' value. */
 #define YF_DTYPE_FROM(dtp, to) do { \
     switch (dtp) { \
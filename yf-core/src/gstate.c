@@ -18,8 +18,80 @@
 #include "stage.h"
 #include "dtable.h"
 #include "vinput.h"
+#include "retire.h"
 #include "yf-limits.h"
 
+/* Builds the cache key of a given configuration. */
+static int make_key(const yf_gconf_t *conf, yf_stkey_t *key)
+{
+    assert(conf != NULL);
+    assert(key != NULL);
+
+    const yf_stage_t *stg;
+    const yf_vinput_t *vin;
+    const yf_vattr_t *vattr;
+
+    size_t sz = 1 + sizeof conf->pass + sizeof conf->topology +
+                sizeof conf->polymode + sizeof conf->cullmode +
+                sizeof conf->winding + sizeof conf->stg_n +
+                conf->stg_n * (sizeof stg->stage + sizeof stg->shd +
+                               sizeof stg->entry_point) +
+                sizeof conf->dtb_n + conf->dtb_n * sizeof *conf->dtbs +
+                sizeof conf->vin_n;
+
+    for (unsigned i = 0; i < conf->vin_n; i++)
+        sz += sizeof vin->attr_n + sizeof vin->stride + sizeof vin->vrate +
+              conf->vins[i].attr_n * (sizeof vattr->location +
+                                      sizeof vattr->vfmt +
+                                      sizeof vattr->offset);
+
+    /* zeroed so that entry point names are padded consistently */
+    unsigned char *dst = calloc(1, sz);
+    if (dst == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        return -1;
+    }
+    key->data = dst;
+    key->size = sz;
+
+    *dst++ = YF_STKEY_GST;
+    YF_STKEY_PUT(dst, conf->pass);
+    YF_STKEY_PUT(dst, conf->topology);
+    YF_STKEY_PUT(dst, conf->polymode);
+    YF_STKEY_PUT(dst, conf->cullmode);
+    YF_STKEY_PUT(dst, conf->winding);
+
+    YF_STKEY_PUT(dst, conf->stg_n);
+    for (unsigned i = 0; i < conf->stg_n; i++) {
+        stg = conf->stgs+i;
+        YF_STKEY_PUT(dst, stg->stage);
+        YF_STKEY_PUT(dst, stg->shd);
+        strncpy((char *)dst, stg->entry_point, sizeof stg->entry_point - 1);
+        dst += sizeof stg->entry_point;
+    }
+
+    YF_STKEY_PUT(dst, conf->dtb_n);
+    for (unsigned i = 0; i < conf->dtb_n; i++)
+        YF_STKEY_PUT(dst, conf->dtbs[i]);
+
+    YF_STKEY_PUT(dst, conf->vin_n);
+    for (unsigned i = 0; i < conf->vin_n; i++) {
+        vin = conf->vins+i;
+        YF_STKEY_PUT(dst, vin->attr_n);
+        YF_STKEY_PUT(dst, vin->stride);
+        YF_STKEY_PUT(dst, vin->vrate);
+        for (unsigned j = 0; j < vin->attr_n; j++) {
+            vattr = vin->attrs+j;
+            YF_STKEY_PUT(dst, vattr->location);
+            YF_STKEY_PUT(dst, vattr->vfmt);
+            YF_STKEY_PUT(dst, vattr->offset);
+        }
+    }
+
+    assert(dst == key->data + key->size);
+    return 0;
+}
+
 yf_gstate_t *yf_gstate_init(yf_context_t *ctx, const yf_gconf_t *conf)
 {
     assert(ctx != NULL);
@@ -38,13 +110,26 @@ yf_gstate_t *yf_gstate_init(yf_context_t *ctx, const yf_gconf_t *conf)
         return NULL;
     }
 
-    yf_gstate_t *gst = calloc(1, sizeof(yf_gstate_t));
+    yf_stkey_t key;
+    if (make_key(conf, &key) != 0)
+        return NULL;
+
+    yf_gstate_t *gst = yf_stcache_get(ctx, &key);
+    if (gst != NULL) {
+        free(key.data);
+        gst->refs++;
+        return gst;
+    }
+
+    gst = calloc(1, sizeof(yf_gstate_t));
     if (gst == NULL) {
         yf_seterr(YF_ERR_NOMEM, __func__);
+        free(key.data);
         return NULL;
     }
     gst->ctx = ctx;
     gst->pass = conf->pass;
+    gst->key = key;
 
     const size_t stg_sz = conf->stg_n * sizeof *conf->stgs;
     gst->stgs = malloc(stg_sz);
@@ -405,6 +490,10 @@ yf_gstate_t *yf_gstate_init(yf_context_t *ctx, const yf_gconf_t *conf)
         yf_seterr(YF_ERR_DEVGEN, __func__);
         yf_gstate_deinit(gst);
         gst = NULL;
+    } else {
+        /* if caching fails, the state is just not shared */
+        gst->refs = 1;
+        yf_stcache_put(ctx, &gst->key, gst);
     }
 
     free(cb_atts);
@@ -447,10 +536,17 @@ yf_dtable_t *yf_gstate_getdtb(yf_gstate_t *gst, unsigned index)
 void yf_gstate_deinit(yf_gstate_t *gst)
 {
     if (gst != NULL) {
+        if (gst->refs > 1) {
+            gst->refs--;
+            return;
+        }
+        if (gst->refs == 1 && yf_stcache_get(gst->ctx, &gst->key) == gst)
+            yf_stcache_remove(gst->ctx, &gst->key);
+        free(gst->key.data);
         free(gst->stgs);
         free(gst->dtbs);
-        vkDestroyPipelineLayout(gst->ctx->device, gst->layout, NULL);
-        vkDestroyPipeline(gst->ctx->device, gst->pipeline, NULL);
+        yf_retire_pipeline(gst->ctx, gst->pipeline);
+        yf_retire_pllayout(gst->ctx, gst->layout);
         free(gst);
     }
 }
@@ -10,6 +10,7 @@
 
 #include "yf-gstate.h"
 #include "vk.h"
+#include "stcache.h"
 
 struct yf_gstate {
     yf_context_t *ctx;
@@ -21,6 +22,9 @@ struct yf_gstate {
 
     VkPipelineLayout layout;
     VkPipeline pipeline;
+
+    yf_stkey_t key;
+    unsigned refs;
 };
 
 /* Converts from a 'YF_TOPOLOGY' value. */
@@ -19,6 +19,7 @@
 #include "cmdexec.h"
 #include "cmdbuf.h"
 #include "buffer.h"
+#include "retire.h"
 #include "yf-limits.h"
 
 /* The private data of a 'yf_iview_t'. */
@@ -52,6 +53,16 @@ static void set_layout(int res, void *arg)
         img->next_layout = img->layout;
 }
 
+/* Sets image layout from recorded commands. */
+static void set_reclayout(int res, void *arg)
+{
+    yf_image_t *img = arg;
+    if (res == 0)
+        /* submitted */
+        img->layout = img->next_layout = img->rec_layout;
+    img->rec_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+}
+
 /* Hashes a 'priv_t'. */
 static size_t hash_priv(const void *x)
 {
@@ -313,6 +324,10 @@ int yf_image_copy(yf_image_t *img, yf_off3_t off, yf_dim3_t dim,
             if (yf_image_chglayout(img, VK_IMAGE_LAYOUT_GENERAL) != 0 ||
                 yf_cmdexec_execprio(img->ctx) != 0)
                 return -1;
+            /* the transition must complete before the host writes */
+            const uint64_t serial = yf_cmdexec_getserial(img->ctx) - 1;
+            if (yf_cmdexec_wait(img->ctx, serial) != 0)
+                return -1;
         }
 
         if (img->aspect != VK_IMAGE_ASPECT_COLOR_BIT &&
@@ -423,15 +438,17 @@ void yf_image_deinit(yf_image_t *img)
     yf_publish(img, YF_PUBSUB_DEINIT);
     yf_setpub(img, YF_PUBSUB_NONE);
 
-    /* cannot let 'cmdpool' call 'set_layout()' with a dangling ptr */
+    /* cannot let 'cmdpool' or 'cmdexec' call back with a dangling ptr */
     if (img->layout != img->next_layout)
-        yf_cmdexec_execprio(img->ctx);
+        yf_cmdpool_unsetprio(img->ctx, set_layout, img);
+    if (img->rec_layout != VK_IMAGE_LAYOUT_UNDEFINED)
+        yf_cmdexec_unsetcallb(img->ctx, set_reclayout, img);
 
     yf_iter_t it = YF_NILIT;
     yf_iview_t *iv;
 
     while ((iv = yf_dict_next(img->iviews, &it, NULL)) != NULL) {
-        vkDestroyImageView(img->ctx->device, iv->view, NULL);
+        yf_retire_iview(img->ctx, iv->view);
         free(iv->priv);
         free(iv);
     }
@@ -439,8 +456,8 @@ void yf_image_deinit(yf_image_t *img)
     yf_dict_deinit(img->iviews);
 
     if (!img->wrapped) {
+        yf_retire_image(img->ctx, img->image);
         yf_image_free(img);
-        vkDestroyImage(img->ctx->device, img->image, NULL);
     }
 
     free(img);
@@ -608,7 +625,7 @@ void yf_image_ungetiview(yf_image_t *img, yf_iview_t *iview)
     priv_t *priv = iv->priv;
 
     if (--priv->count == 0) {
-        vkDestroyImageView(img->ctx->device, iv->view, NULL);
+        yf_retire_iview(img->ctx, iv->view);
         yf_dict_remove(img->iviews, iv->priv);
         free(iv->priv);
         free(iv);
@@ -640,7 +657,7 @@ int yf_image_chglayout(yf_image_t *img, VkImageLayout layout)
     VkImageMemoryBarrier barrier = {
         .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
         .pNext = NULL,
-        .srcAccessMask = 0,
+        .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
         .dstAccessMask = VK_ACCESS_MEMORY_READ_BIT |
                          VK_ACCESS_MEMORY_WRITE_BIT,
         .oldLayout = img->layout,
@@ -657,9 +674,39 @@ int yf_image_chglayout(yf_image_t *img, VkImageLayout layout)
         }
     };
 
-    vkCmdPipelineBarrier(cmdr->pool_res, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+    /* previous submissions may still be using the image */
+    vkCmdPipelineBarrier(cmdr->pool_res, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
                          VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
                          0, NULL, 0, NULL, 1, &barrier);
 
     return 0;
 }
+
+int yf_image_setlayout(yf_image_t *img, VkImageLayout layout)
+{
+    assert(img != NULL);
+    assert(layout != VK_IMAGE_LAYOUT_PREINITIALIZED);
+
+    if (layout == VK_IMAGE_LAYOUT_UNDEFINED) {
+        if (img->rec_layout != VK_IMAGE_LAYOUT_UNDEFINED) {
+            yf_cmdexec_unsetcallb(img->ctx, set_reclayout, img);
+            img->rec_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        }
+        return 0;
+    }
+
+    if (img->rec_layout == VK_IMAGE_LAYOUT_UNDEFINED &&
+        yf_cmdexec_setcallb(img->ctx, set_reclayout, img) != 0)
+        return -1;
+
+    img->rec_layout = layout;
+    return 0;
+}
+
+VkImageLayout yf_image_getlayout(const yf_image_t *img)
+{
+    assert(img != NULL);
+
+    return img->rec_layout != VK_IMAGE_LAYOUT_UNDEFINED ?
+           img->rec_layout : img->next_layout;
+}
@@ -26,6 +26,8 @@ struct yf_image {
 
     VkImage image;
     VkDeviceMemory memory;
+    unsigned mem_heap;
+    size_t mem_size;
     VkFormat format;
     VkImageType type;
     VkSampleCountFlagBits samples;
@@ -36,6 +38,7 @@ struct yf_image {
     VkImageViewType view_type;
     VkImageLayout layout;
     VkImageLayout next_layout;
+    VkImageLayout rec_layout;
     void *data;
 };
 
@@ -68,6 +71,16 @@ void yf_image_ungetiview(yf_image_t *img, yf_iview_t *iview);
    'cmdpool_getprio()'. */
 int yf_image_chglayout(yf_image_t *img, VkImageLayout layout);
 
+/* Sets the layout that non-priority commands leave an image in.
+   The change is tracked once these commands are submitted, and dropped if
+   they are discarded instead. Setting 'VK_IMAGE_LAYOUT_UNDEFINED' drops
+   any change not yet submitted. */
+int yf_image_setlayout(yf_image_t *img, VkImageLayout layout);
+
+/* Gets the layout that an image will be in after the commands enqueued
+   for execution so far. */
+VkImageLayout yf_image_getlayout(const yf_image_t *img);
+
 /* Converts from a 'YF_PIXFMT' value. */
 #define YF_PIXFMT_FROM(pf, to) do { \
     switch (pf) { \
@@ -5,6 +5,8 @@
  * Copyright © 2020 Gustavo C. Viegas.
  */
 
+#include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 #include "yf/com/yf-error.h"
@@ -13,8 +15,109 @@
 #include "context.h"
 #include "buffer.h"
 #include "image.h"
+#include "retire.h"
 #include "vk.h"
 
+/* Number of allocations after which the budget is queried again. */
+#define YF_BGTPERIOD 64
+
+/* Fraction of the pressure limit above which every allocation queries
+   the budget. */
+#define YF_BGTMARGIN 0.875
+
+/* Memory accounting data stored in a context. */
+typedef struct {
+    size_t usage[YF_HEAPMAX];
+    /* last queried budgets and bytes allocated since the query */
+    yf_budget_t bgts[YF_HEAPMAX];
+    size_t bgt_alloc[YF_HEAPMAX];
+    unsigned bgt_skip;
+    float threshold;
+    void (*callb)(int, unsigned, size_t, void *);
+    void *arg;
+    int calling;
+} priv_t;
+
+/* Destroys the 'priv_t' data stored in a given context. */
+static void destroy_priv(yf_context_t *ctx)
+{
+    assert(ctx != NULL);
+
+    free(ctx->mem.priv);
+    ctx->mem.priv = NULL;
+}
+
+/* Gets the memory accounting data of a given context, creating it if
+   needed. */
+static priv_t *get_priv(yf_context_t *ctx)
+{
+    assert(ctx != NULL);
+
+    if (ctx->mem.priv != NULL)
+        return ctx->mem.priv;
+
+    priv_t *priv = calloc(1, sizeof(priv_t));
+    if (priv == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        return NULL;
+    }
+    priv->threshold = 1.0f;
+
+    ctx->mem.priv = priv;
+    ctx->mem.deinit_callb = destroy_priv;
+    return priv;
+}
+
+/* Signals memory pressure on a given heap. */
+static void signal_pressure(yf_context_t *ctx, int level, unsigned heap,
+                            size_t size)
+{
+    priv_t *priv = ctx->mem.priv;
+    if (priv == NULL || priv->callb == NULL || priv->calling)
+        return;
+
+    priv->calling = 1;
+    priv->callb(level, heap, size, priv->arg);
+    priv->calling = 0;
+
+    /* usage may have changed, so the next check queries the budget */
+    priv->bgt_skip = YF_BGTPERIOD;
+
+    /* memory of objects deinitialized by the callback may be available */
+    yf_retire_collect(ctx);
+}
+
+/* Checks whether an allocation would exceed the pressure threshold.
+   Querying the budget is not cheap, so the last query is reused while
+   the usage estimated from it stays well below the limit. */
+static void check_pressure(yf_context_t *ctx, unsigned heap, size_t size)
+{
+    priv_t *priv = ctx->mem.priv;
+    if (priv == NULL || priv->callb == NULL || priv->calling)
+        return;
+
+    yf_budget_t *bgt = priv->bgts+heap;
+    double limit = (double)bgt->budget * priv->threshold;
+    const double est = (double)bgt->usage + (double)priv->bgt_alloc[heap] +
+                       (double)size;
+
+    if (bgt->budget != 0 && priv->bgt_skip < YF_BGTPERIOD &&
+        est <= limit * YF_BGTMARGIN) {
+        priv->bgt_alloc[heap] += size;
+        priv->bgt_skip++;
+        return;
+    }
+
+    yf_getbudget(ctx, priv->bgts);
+    memset(priv->bgt_alloc, 0, sizeof priv->bgt_alloc);
+    priv->bgt_alloc[heap] = size;
+    priv->bgt_skip = 0;
+
+    limit = (double)bgt->budget * priv->threshold;
+    if ((double)bgt->usage + (double)size > limit)
+        signal_pressure(ctx, YF_PRESSURE_HIGH, heap, size);
+}
+
 /* Selects a suitable memory heap. */
 static int select_memory(yf_context_t *ctx, unsigned requirement,
                          VkFlags properties)
@@ -35,7 +138,7 @@ static int select_memory(yf_context_t *ctx, unsigned requirement,
 /* Allocates device memory. */
 static VkDeviceMemory alloc_memory(yf_context_t *ctx,
                                    const VkMemoryRequirements *requirements,
-                                   int host_visible)
+                                   int host_visible, unsigned *heap)
 {
     VkFlags prop = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
     int mem_type = -1;
@@ -61,19 +164,34 @@ static VkDeviceMemory alloc_memory(yf_context_t *ctx,
         .memoryTypeIndex = mem_type
     };
 
+    *heap = ctx->mem_prop.memoryTypes[mem_type].heapIndex;
+    check_pressure(ctx, *heap, requirements->size);
+
     VkDeviceMemory mem;
     VkResult res = vkAllocateMemory(ctx->device, &info, NULL, &mem);
+    if (res == VK_ERROR_OUT_OF_DEVICE_MEMORY ||
+        res == VK_ERROR_OUT_OF_HOST_MEMORY) {
+        signal_pressure(ctx, YF_PRESSURE_CRITICAL, *heap, requirements->size);
+        res = vkAllocateMemory(ctx->device, &info, NULL, &mem);
+    }
     if (res != VK_SUCCESS) {
         yf_seterr(YF_ERR_NOMEM, __func__);
         return NULL;
     }
+
+    priv_t *priv = get_priv(ctx);
+    if (priv != NULL)
+        priv->usage[*heap] += requirements->size;
+
     return mem;
 }
 
 /* Deallocates device memory. */
-static void free_memory(yf_context_t *ctx, VkDeviceMemory memory)
+static void free_memory(yf_context_t *ctx, VkDeviceMemory memory,
+                        unsigned heap, size_t size)
 {
     vkFreeMemory(ctx->device, memory, NULL);
+    yf_memory_release(ctx, heap, size);
 }
 
 int yf_buffer_alloc(yf_buffer_t *buf)
@@ -83,20 +201,23 @@ int yf_buffer_alloc(yf_buffer_t *buf)
 
     VkMemoryRequirements mem_req;
     vkGetBufferMemoryRequirements(buf->ctx->device, buf->buffer, &mem_req);
-    buf->memory = alloc_memory(buf->ctx, &mem_req, 1);
+    buf->memory = alloc_memory(buf->ctx, &mem_req, 1, &buf->mem_heap);
     if (buf->memory == NULL)
         return -1;
+    buf->mem_size = mem_req.size;
 
     VkResult res;
     res = vkBindBufferMemory(buf->ctx->device, buf->buffer, buf->memory, 0);
     if (res != VK_SUCCESS) {
-        free_memory(buf->ctx, buf->memory);
+        free_memory(buf->ctx, buf->memory, buf->mem_heap, buf->mem_size);
+        buf->memory = NULL;
         return -1;
     }
     res = vkMapMemory(buf->ctx->device, buf->memory, 0, VK_WHOLE_SIZE, 0,
                       &buf->data);
     if (res != VK_SUCCESS) {
-        free_memory(buf->ctx, buf->memory);
+        free_memory(buf->ctx, buf->memory, buf->mem_heap, buf->mem_size);
+        buf->memory = NULL;
         return -1;
     }
     return 0;
@@ -111,14 +232,16 @@ int yf_image_alloc(yf_image_t *img)
 
     VkMemoryRequirements mem_req;
     vkGetImageMemoryRequirements(img->ctx->device, img->image, &mem_req);
-    img->memory = alloc_memory(img->ctx, &mem_req, visible);
+    img->memory = alloc_memory(img->ctx, &mem_req, visible, &img->mem_heap);
     if (img->memory == NULL)
         return -1;
+    img->mem_size = mem_req.size;
 
     VkResult res;
     res = vkBindImageMemory(img->ctx->device, img->image, img->memory, 0);
     if (res != VK_SUCCESS) {
-        free_memory(img->ctx, img->memory);
+        free_memory(img->ctx, img->memory, img->mem_heap, img->mem_size);
+        img->memory = NULL;
         return -1;
     }
 
@@ -135,8 +258,9 @@ int yf_image_alloc(yf_image_t *img)
 
 void yf_buffer_free(yf_buffer_t *buf)
 {
-    if (buf != NULL) {
-        free_memory(buf->ctx, buf->memory);
+    if (buf != NULL && buf->memory != NULL) {
+        yf_retire_memory(buf->ctx, buf->memory);
+        yf_memory_release(buf->ctx, buf->mem_heap, buf->mem_size);
         buf->memory = NULL;
         buf->data = NULL;
     }
@@ -144,9 +268,82 @@ void yf_buffer_free(yf_buffer_t *buf)
 
 void yf_image_free(yf_image_t *img)
 {
-    if (img != NULL) {
-        free_memory(img->ctx, img->memory);
+    if (img != NULL && img->memory != NULL) {
+        yf_retire_memory(img->ctx, img->memory);
+        yf_memory_release(img->ctx, img->mem_heap, img->mem_size);
         img->memory = NULL;
         img->data = NULL;
     }
 }
+
+void yf_memory_release(yf_context_t *ctx, unsigned heap, size_t size)
+{
+    assert(ctx != NULL);
+    assert(heap < YF_HEAPMAX);
+
+    priv_t *priv = ctx->mem.priv;
+    if (priv == NULL)
+        return;
+
+    priv->usage[heap] -= size < priv->usage[heap] ? size : priv->usage[heap];
+}
+
+unsigned yf_getbudget(yf_context_t *ctx, yf_budget_t *budgets)
+{
+    assert(ctx != NULL);
+    assert(budgets != NULL);
+
+    const unsigned heap_n = ctx->mem_prop.memoryHeapCount;
+    priv_t *priv = ctx->mem.priv;
+
+    for (unsigned i = 0; i < heap_n; i++) {
+        const VkMemoryHeap *heap = ctx->mem_prop.memoryHeaps+i;
+        budgets[i].size = heap->size;
+        budgets[i].usage = priv != NULL ? priv->usage[i] : 0;
+        budgets[i].budget = heap->size;
+        budgets[i].local =
+            (heap->flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+    }
+
+    if (ctx->dev_ext_mask & YF_DEVEXT_MEMBUDGET) {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT bgt = {
+            .sType =
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT,
+            .pNext = NULL
+        };
+        VkPhysicalDeviceMemoryProperties2 prop = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+            .pNext = &bgt
+        };
+        vkGetPhysicalDeviceMemoryProperties2(ctx->phy_dev, &prop);
+
+        for (unsigned i = 0; i < heap_n; i++) {
+            budgets[i].usage = bgt.heapUsage[i];
+            budgets[i].budget = bgt.heapBudget[i];
+        }
+    }
+
+    return heap_n;
+}
+
+int yf_setpressure(yf_context_t *ctx, float threshold,
+                   void (*callb)(int level, unsigned heap, size_t size,
+                                 void *arg),
+                   void *arg)
+{
+    assert(ctx != NULL);
+
+    if (threshold < 0.0f || threshold > 1.0f) {
+        yf_seterr(YF_ERR_INVARG, __func__);
+        return -1;
+    }
+
+    priv_t *priv = get_priv(ctx);
+    if (priv == NULL)
+        return -1;
+
+    priv->threshold = threshold;
+    priv->callb = callb;
+    priv->arg = arg;
+    return 0;
+}
@@ -8,6 +8,7 @@
 #ifndef YF_MEMORY_H
 #define YF_MEMORY_H
 
+#include "yf-memory.h"
 #include "yf-buffer.h"
 #include "yf-image.h"
 
@@ -17,10 +18,17 @@ int yf_buffer_alloc(yf_buffer_t *buf);
 /* Allocates memory for an image. */
 int yf_image_alloc(yf_image_t *img);
 
-/* Deallocates memory held by a buffer. */
+/* Deallocates memory held by a buffer.
+   Deallocation is deferred until pending work completes, but the memory is
+   no longer accounted as in use. */
 void yf_buffer_free(yf_buffer_t *buf);
 
-/* Deallocates memory held by an image. */
+/* Deallocates memory held by an image.
+   Deallocation is deferred until pending work completes, but the memory is
+   no longer accounted as in use. */
 void yf_image_free(yf_image_t *img);
 
+/* Accounts for memory released from a given heap. */
+void yf_memory_release(yf_context_t *ctx, unsigned heap, size_t size);
+
 #endif /* YF_MEMORY_H */
@@ -12,6 +12,7 @@
 
 #include "pass.h"
 #include "context.h"
+#include "retire.h"
 #include "yf-limits.h"
 
 #define YF_TGTN 4
@@ -388,7 +389,7 @@ int yf_pass_unmktarget(yf_pass_t *pass, yf_target_t *tgt)
     }
     assert(index < pass->tgt_cap);
 
-    vkDestroyFramebuffer(pass->ctx->device, tgt->framebuf, NULL);
+    yf_retire_framebuf(pass->ctx, tgt->framebuf);
     for (unsigned i = 0; i < tgt->iview_n; i++)
         yf_image_ungetiview(tgt->imgs[i], tgt->iviews+i);
     free(tgt->iviews);
@@ -405,7 +406,7 @@ int yf_pass_unmktarget(yf_pass_t *pass, yf_target_t *tgt)
 void yf_pass_deinit(yf_pass_t *pass)
 {
     if (pass != NULL) {
-        vkDestroyRenderPass(pass->ctx->device, pass->ren_pass, NULL);
+        yf_retire_renpass(pass->ctx, pass->ren_pass);
         for (unsigned i = 0; i < pass->tgt_cap; i++)
             yf_pass_unmktarget(pass, pass->tgts[i]);
         free(pass->tgts);
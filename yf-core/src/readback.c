@@ -0,0 +1,417 @@
+/*
+ * YF
+ * readback.c
+ *
+ * Copyright © 2020 Gustavo C. Viegas.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "yf/com/yf-error.h"
+
+#include "yf-readback.h"
+#include "context.h"
+#include "cmdpool.h"
+#include "cmdexec.h"
+#include "buffer.h"
+#include "image.h"
+
+/* TODO: Should be defined elsewhere. */
+#define YF_RDBKMIN 4096
+#define YF_RDBKMAX 16
+
+struct yf_readback {
+    yf_context_t *ctx;
+    yf_buffer_t *buf;
+    size_t size;
+    int state;
+    int orphan;
+    void (*callb)(yf_readback_t *, int, void *);
+    void *arg;
+};
+
+/* Pool of readback buffers stored in a context. */
+typedef struct {
+    yf_buffer_t *bufs[YF_RDBKMAX];
+    unsigned n;
+} priv_t;
+
+/* Destroys the 'priv_t' data stored in a given context. */
+static void destroy_priv(yf_context_t *ctx)
+{
+    assert(ctx != NULL);
+
+    priv_t *priv = ctx->rdbk.priv;
+    if (priv == NULL)
+        return;
+
+    for (unsigned i = 0; i < priv->n; i++)
+        yf_buffer_deinit(priv->bufs[i]);
+
+    free(priv);
+    ctx->rdbk.priv = NULL;
+}
+
+/* Obtains a readback buffer from the pool. */
+static yf_buffer_t *obtain_buffer(yf_context_t *ctx, size_t size)
+{
+    assert(ctx != NULL);
+    assert(size > 0);
+
+    priv_t *priv = ctx->rdbk.priv;
+    if (priv == NULL) {
+        priv = calloc(1, sizeof(priv_t));
+        if (priv == NULL) {
+            yf_seterr(YF_ERR_NOMEM, __func__);
+            return NULL;
+        }
+        ctx->rdbk.priv = priv;
+        ctx->rdbk.deinit_callb = destroy_priv;
+    }
+
+    /* smallest buffer that fits */
+    unsigned index = priv->n;
+    for (unsigned i = 0; i < priv->n; i++) {
+        if (priv->bufs[i]->size >= size &&
+            (index == priv->n || priv->bufs[i]->size < priv->bufs[index]->size))
+            index = i;
+    }
+
+    if (index < priv->n) {
+        yf_buffer_t *buf = priv->bufs[index];
+        priv->bufs[index] = priv->bufs[--priv->n];
+        return buf;
+    }
+
+    /* buffer sizes are rounded up to powers of two to improve reuse */
+    size_t sz = YF_RDBKMIN;
+    while (sz < size && sz << 1 > sz)
+        sz <<= 1;
+    if (sz < size)
+        sz = size;
+
+    return yf_buffer_init(ctx, sz);
+}
+
+/* Yields a readback buffer back to the pool. */
+static void yield_buffer(yf_context_t *ctx, yf_buffer_t *buf)
+{
+    assert(ctx != NULL);
+
+    if (buf == NULL)
+        return;
+
+    priv_t *priv = ctx->rdbk.priv;
+    if (priv == NULL || priv->n == YF_RDBKMAX)
+        yf_buffer_deinit(buf);
+    else
+        priv->bufs[priv->n++] = buf;
+}
+
+/* Completes a readback. */
+static void complete(int res, void *arg)
+{
+    yf_readback_t *rb = arg;
+    rb->state = res == 0 ? YF_READBACK_DONE : YF_READBACK_FAILED;
+
+    if (rb->orphan) {
+        yield_buffer(rb->ctx, rb->buf);
+        free(rb);
+        return;
+    }
+
+    if (rb->callb != NULL)
+        rb->callb(rb, rb->state, rb->arg);
+}
+
+/* Creates a new readback and begins a command pool resource for it. */
+static yf_readback_t *begin_read(yf_context_t *ctx, size_t size,
+                                 void (*callb)(yf_readback_t *, int, void *),
+                                 void *arg, yf_cmdres_t *cmdr)
+{
+    assert(ctx != NULL);
+    assert(size > 0);
+    assert(cmdr != NULL);
+
+    yf_readback_t *rb = calloc(1, sizeof(yf_readback_t));
+    if (rb == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        return NULL;
+    }
+    rb->ctx = ctx;
+    rb->size = size;
+    rb->state = YF_READBACK_PENDING;
+    rb->callb = callb;
+    rb->arg = arg;
+
+    if ((rb->buf = obtain_buffer(ctx, size)) == NULL) {
+        free(rb);
+        return NULL;
+    }
+
+    if (yf_cmdpool_obtain(ctx, cmdr) != 0) {
+        yield_buffer(ctx, rb->buf);
+        free(rb);
+        return NULL;
+    }
+
+    VkCommandBufferBeginInfo info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = NULL
+    };
+
+    if (vkBeginCommandBuffer(cmdr->pool_res, &info) != VK_SUCCESS) {
+        yf_seterr(YF_ERR_DEVGEN, __func__);
+        yf_cmdpool_yield(ctx, cmdr);
+        yield_buffer(ctx, rb->buf);
+        free(rb);
+        return NULL;
+    }
+
+    /* previous writes must be visible to the copy */
+    VkMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT
+    };
+
+    vkCmdPipelineBarrier(cmdr->pool_res, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier,
+                         0, NULL, 0, NULL);
+
+    return rb;
+}
+
+/* Ends the command pool resource of a readback and enqueues it. */
+static int end_read(yf_readback_t *rb, yf_cmdres_t *cmdr)
+{
+    assert(rb != NULL);
+    assert(cmdr != NULL);
+
+    /* copied data must be visible to the host */
+    VkMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_HOST_READ_BIT
+    };
+
+    vkCmdPipelineBarrier(cmdr->pool_res, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier,
+                         0, NULL, 0, NULL);
+
+    if (vkEndCommandBuffer(cmdr->pool_res) != VK_SUCCESS) {
+        yf_seterr(YF_ERR_DEVGEN, __func__);
+        yf_cmdpool_yield(rb->ctx, cmdr);
+        return -1;
+    }
+
+    if (yf_cmdexec_enqueue(rb->ctx, cmdr, complete, rb) != 0) {
+        yf_cmdpool_yield(rb->ctx, cmdr);
+        return -1;
+    }
+
+    return 0;
+}
+
+yf_readback_t *yf_buffer_read(yf_buffer_t *buf, size_t offset, size_t size,
+                              void (*callb)(yf_readback_t *rb, int state,
+                                            void *arg),
+                              void *arg)
+{
+    assert(buf != NULL);
+
+    if (size == 0 || offset + size > buf->size) {
+        yf_seterr(YF_ERR_INVARG, __func__);
+        return NULL;
+    }
+
+    yf_cmdres_t cmdr;
+    yf_readback_t *rb = begin_read(buf->ctx, size, callb, arg, &cmdr);
+    if (rb == NULL)
+        return NULL;
+
+    VkBufferCopy region = {
+        .srcOffset = offset,
+        .dstOffset = 0,
+        .size = size
+    };
+
+    vkCmdCopyBuffer(cmdr.pool_res, buf->buffer, rb->buf->buffer, 1, &region);
+
+    if (end_read(rb, &cmdr) != 0) {
+        yield_buffer(rb->ctx, rb->buf);
+        free(rb);
+        return NULL;
+    }
+
+    return rb;
+}
+
+yf_readback_t *yf_image_read(yf_image_t *img, yf_off3_t off, yf_dim3_t dim,
+                             unsigned layer, unsigned level,
+                             void (*callb)(yf_readback_t *rb, int state,
+                                           void *arg),
+                             void *arg)
+{
+    assert(img != NULL);
+    assert(dim.width > 0 && dim.height > 0 && dim.depth > 0);
+
+    if (layer >= img->layers || level >= img->levels ||
+        off.x + dim.width > img->dim.width ||
+        off.y + dim.height > img->dim.height ||
+        off.z + dim.depth > img->dim.depth) {
+
+        yf_seterr(YF_ERR_INVARG, __func__);
+        return NULL;
+    }
+
+    if (!(img->usage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) ||
+        (img->aspect != VK_IMAGE_ASPECT_COLOR_BIT &&
+         img->aspect != VK_IMAGE_ASPECT_DEPTH_BIT &&
+         img->aspect != VK_IMAGE_ASPECT_STENCIL_BIT)) {
+
+        yf_seterr(YF_ERR_UNSUP, __func__);
+        return NULL;
+    }
+
+    size_t sz;
+    YF_PIXFMT_SIZEOF(img->pixfmt, sz);
+    sz *= dim.width * dim.height * dim.depth;
+
+    yf_cmdres_t cmdr;
+    yf_readback_t *rb = begin_read(img->ctx, sz, callb, arg, &cmdr);
+    if (rb == NULL)
+        return NULL;
+
+    VkBufferImageCopy region = {
+        .bufferOffset = 0,
+        .bufferRowLength = 0,
+        .bufferImageHeight = 0,
+        .imageSubresource = {
+            .aspectMask = img->aspect,
+            .mipLevel = level,
+            .baseArrayLayer = layer,
+            .layerCount = 1
+        },
+        .imageOffset = {off.x, off.y, off.z},
+        .imageExtent = {dim.width, dim.height, dim.depth}
+    };
+
+    /* the image is in the layout set by the commands that precede the
+       read, which is restored after the copy */
+    const VkImageLayout layout = yf_image_getlayout(img);
+    VkImageLayout src_layout = layout;
+    int layout_set = 0;
+    VkImageMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+        .oldLayout = layout,
+        .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = img->image,
+        .subresourceRange = {
+            .aspectMask = img->aspect,
+            .baseMipLevel = 0,
+            .levelCount = img->levels,
+            .baseArrayLayer = 0,
+            .layerCount = img->layers
+        }
+    };
+
+    if (layout != VK_IMAGE_LAYOUT_GENERAL &&
+        layout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
+        vkCmdPipelineBarrier(cmdr.pool_res, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL,
+                             0, NULL, 1, &barrier);
+        src_layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    }
+
+    vkCmdCopyImageToBuffer(cmdr.pool_res, img->image, src_layout,
+                           rb->buf->buffer, 1, &region);
+
+    if (src_layout != layout) {
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT |
+                                VK_ACCESS_MEMORY_WRITE_BIT;
+        barrier.oldLayout = src_layout;
+        switch (layout) {
+        case VK_IMAGE_LAYOUT_UNDEFINED:
+        case VK_IMAGE_LAYOUT_PREINITIALIZED:
+            /* cannot go back to these */
+            barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+            break;
+        default:
+            barrier.newLayout = layout;
+        }
+        vkCmdPipelineBarrier(cmdr.pool_res, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, NULL,
+                             0, NULL, 1, &barrier);
+        if (barrier.newLayout != layout) {
+            if (yf_image_setlayout(img, barrier.newLayout) != 0) {
+                yf_cmdpool_yield(img->ctx, &cmdr);
+                yield_buffer(rb->ctx, rb->buf);
+                free(rb);
+                return NULL;
+            }
+            layout_set = 1;
+        }
+    }
+
+    if (end_read(rb, &cmdr) != 0) {
+        /* no layout was previously set, since the image was not in
+           a layout that the read is able to restore */
+        if (layout_set)
+            yf_image_setlayout(img, VK_IMAGE_LAYOUT_UNDEFINED);
+        yield_buffer(rb->ctx, rb->buf);
+        free(rb);
+        return NULL;
+    }
+
+    return rb;
+}
+
+int yf_readback_poll(yf_readback_t *rb)
+{
+    assert(rb != NULL);
+
+    /* completes the readback if its submission is done */
+    if (rb->state == YF_READBACK_PENDING && rb->ctx->cmde.priv != NULL)
+        yf_cmdexec_retire(rb->ctx);
+
+    return rb->state;
+}
+
+const void *yf_readback_getdata(yf_readback_t *rb, size_t *size)
+{
+    assert(rb != NULL);
+
+    if (rb->state != YF_READBACK_DONE)
+        return NULL;
+
+    if (size != NULL)
+        *size = rb->size;
+    return rb->buf->data;
+}
+
+void yf_readback_deinit(yf_readback_t *rb)
+{
+    if (rb == NULL)
+        return;
+
+    if (rb->state == YF_READBACK_PENDING) {
+        /* 'complete()' will release it */
+        rb->orphan = 1;
+        return;
+    }
+
+    yield_buffer(rb->ctx, rb->buf);
+    free(rb);
+}
@@ -0,0 +1,322 @@
+/*
+ * YF
+ * retire.c
+ *
+ * Copyright © 2020 Gustavo C. Viegas.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "yf/com/yf-error.h"
+
+#include "retire.h"
+#include "context.h"
+#include "cmdexec.h"
+
+/* TODO: Should be defined elsewhere. */
+#define YF_RETIRECAP 64
+
+/* Types of retired handles. */
+#define YF_RETIRE_BUFFER   0
+#define YF_RETIRE_IMAGE    1
+#define YF_RETIRE_IVIEW    2
+#define YF_RETIRE_FRAMEBUF 3
+#define YF_RETIRE_MEMORY   4
+#define YF_RETIRE_PIPELINE 5
+#define YF_RETIRE_PLLAYOUT 6
+#define YF_RETIRE_DPOOL    7
+#define YF_RETIRE_RENPASS  8
+#define YF_RETIRE_SAMPLER  9
+
+/* Retired handle. */
+typedef struct {
+    int type;
+    union {
+        VkBuffer buffer;
+        VkImage image;
+        VkImageView iview;
+        VkFramebuffer framebuf;
+        VkDeviceMemory memory;
+        VkPipeline pipeline;
+        VkPipelineLayout pllayout;
+        VkDescriptorPool dpool;
+        VkRenderPass renpass;
+        VkSampler sampler;
+    } handle;
+    uint64_t serial;
+} entry_t;
+
+/* Retirement queue stored in a context.
+   Entries are kept in submission order, from 'first' to 'n'. */
+typedef struct {
+    entry_t *entries;
+    size_t first;
+    size_t n;
+    size_t cap;
+} priv_t;
+
+/* Destroys the handle of a given entry. */
+static void destroy_entry(yf_context_t *ctx, const entry_t *entry)
+{
+    assert(ctx != NULL);
+    assert(entry != NULL);
+
+    switch (entry->type) {
+    case YF_RETIRE_BUFFER:
+        vkDestroyBuffer(ctx->device, entry->handle.buffer, NULL);
+        break;
+    case YF_RETIRE_IMAGE:
+        vkDestroyImage(ctx->device, entry->handle.image, NULL);
+        break;
+    case YF_RETIRE_IVIEW:
+        vkDestroyImageView(ctx->device, entry->handle.iview, NULL);
+        break;
+    case YF_RETIRE_FRAMEBUF:
+        vkDestroyFramebuffer(ctx->device, entry->handle.framebuf, NULL);
+        break;
+    case YF_RETIRE_MEMORY:
+        vkFreeMemory(ctx->device, entry->handle.memory, NULL);
+        break;
+    case YF_RETIRE_PIPELINE:
+        vkDestroyPipeline(ctx->device, entry->handle.pipeline, NULL);
+        break;
+    case YF_RETIRE_PLLAYOUT:
+        vkDestroyPipelineLayout(ctx->device, entry->handle.pllayout, NULL);
+        break;
+    case YF_RETIRE_DPOOL:
+        vkDestroyDescriptorPool(ctx->device, entry->handle.dpool, NULL);
+        break;
+    case YF_RETIRE_RENPASS:
+        vkDestroyRenderPass(ctx->device, entry->handle.renpass, NULL);
+        break;
+    case YF_RETIRE_SAMPLER:
+        vkDestroySampler(ctx->device, entry->handle.sampler, NULL);
+        break;
+    default:
+        assert(0);
+        abort();
+    }
+}
+
+/* Destroys the 'priv_t' data stored in a given context. */
+static void destroy_priv(yf_context_t *ctx)
+{
+    assert(ctx != NULL);
+
+    priv_t *priv = ctx->retr.priv;
+    if (priv == NULL)
+        return;
+
+    /* the device is expected to be idle at this point */
+    for (size_t i = priv->first; i < priv->n; i++)
+        destroy_entry(ctx, priv->entries+i);
+
+    free(priv->entries);
+    free(priv);
+    ctx->retr.priv = NULL;
+}
+
+/* Gets the retirement queue of a given context, creating it if needed. */
+static priv_t *get_priv(yf_context_t *ctx)
+{
+    assert(ctx != NULL);
+
+    if (ctx->retr.priv != NULL)
+        return ctx->retr.priv;
+
+    priv_t *priv = calloc(1, sizeof(priv_t));
+    if (priv == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        return NULL;
+    }
+    priv->entries = malloc(YF_RETIRECAP * sizeof *priv->entries);
+    if (priv->entries == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        free(priv);
+        return NULL;
+    }
+    priv->cap = YF_RETIRECAP;
+
+    ctx->retr.priv = priv;
+    ctx->retr.deinit_callb = destroy_priv;
+    return priv;
+}
+
+/* Enqueues a retired handle. */
+static void retire(yf_context_t *ctx, const entry_t *entry)
+{
+    assert(ctx != NULL);
+    assert(entry != NULL);
+
+    if (ctx->cmde.priv == NULL) {
+        /* no submissions to wait for */
+        destroy_entry(ctx, entry);
+        return;
+    }
+
+    yf_retire_collect(ctx);
+
+    priv_t *priv = get_priv(ctx);
+    if (priv != NULL && priv->n == priv->cap) {
+        if (priv->first > 0) {
+            priv->n -= priv->first;
+            memmove(priv->entries, priv->entries+priv->first,
+                    priv->n * sizeof *priv->entries);
+            priv->first = 0;
+        } else {
+            const size_t cap = priv->cap << 1;
+            entry_t *tmp = realloc(priv->entries, cap * sizeof *tmp);
+            if (tmp == NULL) {
+                yf_seterr(YF_ERR_NOMEM, __func__);
+                priv = NULL;
+            } else {
+                priv->entries = tmp;
+                priv->cap = cap;
+            }
+        }
+    }
+
+    if (priv == NULL) {
+        /* XXX: Should not happen often. */
+        vkDeviceWaitIdle(ctx->device);
+        destroy_entry(ctx, entry);
+        return;
+    }
+
+    priv->entries[priv->n] = *entry;
+    priv->entries[priv->n].serial = yf_cmdexec_getserial(ctx);
+    priv->n++;
+}
+
+void yf_retire_buffer(yf_context_t *ctx, VkBuffer buffer)
+{
+    assert(ctx != NULL);
+
+    if (buffer == VK_NULL_HANDLE)
+        return;
+
+    entry_t entry = {.type = YF_RETIRE_BUFFER, .handle.buffer = buffer};
+    retire(ctx, &entry);
+}
+
+void yf_retire_image(yf_context_t *ctx, VkImage image)
+{
+    assert(ctx != NULL);
+
+    if (image == VK_NULL_HANDLE)
+        return;
+
+    entry_t entry = {.type = YF_RETIRE_IMAGE, .handle.image = image};
+    retire(ctx, &entry);
+}
+
+void yf_retire_iview(yf_context_t *ctx, VkImageView iview)
+{
+    assert(ctx != NULL);
+
+    if (iview == VK_NULL_HANDLE)
+        return;
+
+    entry_t entry = {.type = YF_RETIRE_IVIEW, .handle.iview = iview};
+    retire(ctx, &entry);
+}
+
+void yf_retire_framebuf(yf_context_t *ctx, VkFramebuffer framebuf)
+{
+    assert(ctx != NULL);
+
+    if (framebuf == VK_NULL_HANDLE)
+        return;
+
+    entry_t entry = {.type = YF_RETIRE_FRAMEBUF, .handle.framebuf = framebuf};
+    retire(ctx, &entry);
+}
+
+void yf_retire_memory(yf_context_t *ctx, VkDeviceMemory memory)
+{
+    assert(ctx != NULL);
+
+    if (memory == VK_NULL_HANDLE)
+        return;
+
+    entry_t entry = {.type = YF_RETIRE_MEMORY, .handle.memory = memory};
+    retire(ctx, &entry);
+}
+
+void yf_retire_pipeline(yf_context_t *ctx, VkPipeline pipeline)
+{
+    assert(ctx != NULL);
+
+    if (pipeline == VK_NULL_HANDLE)
+        return;
+
+    entry_t entry = {.type = YF_RETIRE_PIPELINE, .handle.pipeline = pipeline};
+    retire(ctx, &entry);
+}
+
+void yf_retire_pllayout(yf_context_t *ctx, VkPipelineLayout pllayout)
+{
+    assert(ctx != NULL);
+
+    if (pllayout == VK_NULL_HANDLE)
+        return;
+
+    entry_t entry = {.type = YF_RETIRE_PLLAYOUT, .handle.pllayout = pllayout};
+    retire(ctx, &entry);
+}
+
+void yf_retire_dpool(yf_context_t *ctx, VkDescriptorPool dpool)
+{
+    assert(ctx != NULL);
+
+    if (dpool == VK_NULL_HANDLE)
+        return;
+
+    entry_t entry = {.type = YF_RETIRE_DPOOL, .handle.dpool = dpool};
+    retire(ctx, &entry);
+}
+
+void yf_retire_renpass(yf_context_t *ctx, VkRenderPass renpass)
+{
+    assert(ctx != NULL);
+
+    if (renpass == VK_NULL_HANDLE)
+        return;
+
+    entry_t entry = {.type = YF_RETIRE_RENPASS, .handle.renpass = renpass};
+    retire(ctx, &entry);
+}
+
+void yf_retire_sampler(yf_context_t *ctx, VkSampler sampler)
+{
+    assert(ctx != NULL);
+
+    if (sampler == VK_NULL_HANDLE)
+        return;
+
+    entry_t entry = {.type = YF_RETIRE_SAMPLER, .handle.sampler = sampler};
+    retire(ctx, &entry);
+}
+
+void yf_retire_collect(yf_context_t *ctx)
+{
+    assert(ctx != NULL);
+
+    priv_t *priv = ctx->retr.priv;
+    if (priv == NULL || ctx->cmde.priv == NULL)
+        return;
+
+    /* serials are non-decreasing, so this can stop at the first entry
+       whose submission is still pending */
+    while (priv->first < priv->n &&
+           yf_cmdexec_completed(ctx, priv->entries[priv->first].serial)) {
+        destroy_entry(ctx, priv->entries+priv->first);
+        priv->first++;
+    }
+
+    if (priv->first == priv->n)
+        priv->first = priv->n = 0;
+}
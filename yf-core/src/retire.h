@@ -0,0 +1,52 @@
+/*
+ * YF
+ * retire.h
+ *
+ * Copyright © 2020 Gustavo C. Viegas.
+ */
+
+#ifndef YF_RETIRE_H
+#define YF_RETIRE_H
+
+#include "yf-context.h"
+#include "vk.h"
+
+/* Device objects that are no longer needed but may still be in use by
+   pending work are retired instead of destroyed. Retired handles are tagged
+   with the current submission serial and destroyed once the submission
+   identified by such serial completes. */
+
+/* Retires a buffer handle. */
+void yf_retire_buffer(yf_context_t *ctx, VkBuffer buffer);
+
+/* Retires an image handle. */
+void yf_retire_image(yf_context_t *ctx, VkImage image);
+
+/* Retires an image view handle. */
+void yf_retire_iview(yf_context_t *ctx, VkImageView iview);
+
+/* Retires a framebuffer handle. */
+void yf_retire_framebuf(yf_context_t *ctx, VkFramebuffer framebuf);
+
+/* Retires a device memory handle. */
+void yf_retire_memory(yf_context_t *ctx, VkDeviceMemory memory);
+
+/* Retires a pipeline handle. */
+void yf_retire_pipeline(yf_context_t *ctx, VkPipeline pipeline);
+
+/* Retires a pipeline layout handle. */
+void yf_retire_pllayout(yf_context_t *ctx, VkPipelineLayout pllayout);
+
+/* Retires a descriptor pool handle. */
+void yf_retire_dpool(yf_context_t *ctx, VkDescriptorPool dpool);
+
+/* Retires a render pass handle. */
+void yf_retire_renpass(yf_context_t *ctx, VkRenderPass renpass);
+
+/* Retires a sampler handle. */
+void yf_retire_sampler(yf_context_t *ctx, VkSampler sampler);
+
+/* Destroys retired handles whose submissions have completed. */
+void yf_retire_collect(yf_context_t *ctx);
+
+#endif /* YF_RETIRE_H */
@@ -15,6 +15,7 @@
 
 #include "sampler.h"
 #include "context.h"
+#include "retire.h"
 
 /* Default sampler. */
 static const yf_sampler_t splr_ = {
@@ -176,7 +177,7 @@ void yf_sampler_unget(yf_context_t *ctx, const yf_splrh_t *splrh)
 
     if (val->count == 1) {
         yf_dict_remove(splrhs, &splrh->splr);
-        vkDestroySampler(ctx->device, val->handle, NULL);
+        yf_retire_sampler(ctx, val->handle);
         free(val);
     } else {
         val->count--;
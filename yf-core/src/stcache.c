@@ -0,0 +1,76 @@
+/*
+ * YF
+ * stcache.c
+ *
+ * Copyright © 2020 Gustavo C. Viegas.
+ */
+
+#include <assert.h>
+
+#include "yf/com/yf-dict.h"
+#include "yf/com/yf-error.h"
+
+#include "stcache.h"
+#include "context.h"
+
+/* Hashes a 'yf_stkey_t'. */
+static size_t hash_key(const void *x)
+{
+    const yf_stkey_t *key = x;
+    return yf_hashv(key->data, key->size, NULL);
+}
+
+/* Compares a 'yf_stkey_t' to another. */
+static int cmp_key(const void *a, const void *b)
+{
+    const yf_stkey_t *key1 = a;
+    const yf_stkey_t *key2 = b;
+
+    return key1->size != key2->size ||
+           memcmp(key1->data, key2->data, key1->size) != 0;
+}
+
+/* Destroys the cache stored in a given context. */
+static void destroy_cache(yf_context_t *ctx)
+{
+    assert(ctx != NULL);
+
+    /* states not deinitialized by now are not destroyed */
+    yf_dict_deinit(ctx->stc.priv);
+    ctx->stc.priv = NULL;
+}
+
+void *yf_stcache_get(yf_context_t *ctx, const yf_stkey_t *key)
+{
+    assert(ctx != NULL);
+    assert(key != NULL);
+
+    if (ctx->stc.priv == NULL)
+        return NULL;
+
+    return yf_dict_search(ctx->stc.priv, key);
+}
+
+int yf_stcache_put(yf_context_t *ctx, const yf_stkey_t *key, void *state)
+{
+    assert(ctx != NULL);
+    assert(key != NULL);
+    assert(state != NULL);
+
+    if (ctx->stc.priv == NULL) {
+        if ((ctx->stc.priv = yf_dict_init(hash_key, cmp_key)) == NULL)
+            return -1;
+        ctx->stc.deinit_callb = destroy_cache;
+    }
+
+    return yf_dict_insert(ctx->stc.priv, key, state);
+}
+
+void yf_stcache_remove(yf_context_t *ctx, const yf_stkey_t *key)
+{
+    assert(ctx != NULL);
+    assert(key != NULL);
+
+    if (ctx->stc.priv != NULL)
+        yf_dict_remove(ctx->stc.priv, key);
+}
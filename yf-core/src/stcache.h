@@ -0,0 +1,45 @@
+/*
+ * YF
+ * stcache.h
+ *
+ * Copyright © 2020 Gustavo C. Viegas.
+ */
+
+#ifndef YF_STCACHE_H
+#define YF_STCACHE_H
+
+#include <stddef.h>
+#include <string.h>
+
+#include "yf-context.h"
+
+/* Pipeline states are cached in the context, keyed by a serialization of
+   the configuration used to create them. States created from identical
+   configurations are shared and reference counted. */
+
+/* Key of a cached state. */
+typedef struct {
+    unsigned char *data;
+    size_t size;
+} yf_stkey_t;
+
+/* Kinds of cached states, used as the first byte of a key. */
+#define YF_STKEY_GST 'g'
+#define YF_STKEY_CST 'c'
+
+/* Appends a value to a key being built, advancing the destination. */
+#define YF_STKEY_PUT(dst, val) do { \
+    memcpy(dst, &(val), sizeof (val)); \
+    dst += sizeof (val); } while (0)
+
+/* Gets a cached state, or 'NULL' if there is none for the given key. */
+void *yf_stcache_get(yf_context_t *ctx, const yf_stkey_t *key);
+
+/* Caches a state.
+   The key must remain valid until the state is removed. */
+int yf_stcache_put(yf_context_t *ctx, const yf_stkey_t *key, void *state);
+
+/* Removes a cached state. */
+void yf_stcache_remove(yf_context_t *ctx, const yf_stkey_t *key);
+
+#endif /* YF_STCACHE_H */
@@ -107,6 +107,12 @@ int yf_setiprocvk(VkInstance instance)
 #endif
 #ifdef VK_USE_PLATFORM_METAL_EXT
         YF_IPROCVK(instance, vkCreateMetalSurfaceEXT); /* VK_EXT_metal_surface */
+#endif
+#ifdef YF_DBGUTILS
+        /* these will be 'NULL' if the extension is not enabled */
+        YF_IPROCVK(instance, vkSetDebugUtilsObjectNameEXT);
+        YF_IPROCVK(instance, vkCmdBeginDebugUtilsLabelEXT);
+        YF_IPROCVK(instance, vkCmdEndDebugUtilsLabelEXT);
 #endif
         YF_IPROCVK(instance, vkGetDeviceProcAddr);
     }
@@ -281,6 +287,11 @@ YF_DEFVK(vkGetPhysicalDeviceXcbPresentationSupportKHR); /* VK_KHR_xcb_surface */
 #ifdef VK_USE_PLATFORM_METAL_EXT
 YF_DEFVK(vkCreateMetalSurfaceEXT); /* VK_EXT_metal_surface */
 #endif
+#ifdef YF_DBGUTILS
+YF_DEFVK(vkSetDebugUtilsObjectNameEXT); /* VK_EXT_debug_utils */
+YF_DEFVK(vkCmdBeginDebugUtilsLabelEXT); /* VK_EXT_debug_utils */
+YF_DEFVK(vkCmdEndDebugUtilsLabelEXT); /* VK_EXT_debug_utils */
+#endif
 
 /*
  * Device-level proc.
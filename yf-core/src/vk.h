@@ -18,6 +18,12 @@
 #else
 # error "Invalid platform"
 #endif /* defined(__linux__) */
+/* Debug utils are enabled in devel builds, unless 'YF_NO_DBGUTILS' is
+   defined. Other builds can enable them by defining 'YF_DBGUTILS'. */
+#if defined(YF_DEVEL) && !defined(YF_NO_DBGUTILS) && !defined(YF_DBGUTILS)
+# define YF_DBGUTILS
+#endif
+
 #define VK_NO_PROTOTYPES
 #include <vulkan/vulkan.h>
 
@@ -90,6 +96,11 @@ YF_DECLVK(vkGetPhysicalDeviceXcbPresentationSupportKHR); /* VK_KHR_xcb_surface *
 #ifdef VK_USE_PLATFORM_METAL_EXT
 YF_DECLVK(vkCreateMetalSurfaceEXT); /* VK_EXT_metal_surface */
 #endif
+#ifdef YF_DBGUTILS
+YF_DECLVK(vkSetDebugUtilsObjectNameEXT); /* VK_EXT_debug_utils */
+YF_DECLVK(vkCmdBeginDebugUtilsLabelEXT); /* VK_EXT_debug_utils */
+YF_DECLVK(vkCmdEndDebugUtilsLabelEXT); /* VK_EXT_debug_utils */
+#endif
 
 /*
  * Device-level proc.
@@ -10,6 +10,7 @@
 
 #include "yf/com/yf-util.h"
 #include "yf/com/yf-error.h"
+#include "yf/com/yf-prof.h"
 #include "yf/wsys/yf-platform.h"
 
 #include "wsi.h"
@@ -277,23 +278,32 @@ static int create_swapchain(yf_wsi_t *wsi)
     }
 
     if (wsi->imgs != NULL) {
+        /* semaphores may still be in use by pending submissions */
+        yf_cmdexec_wait(wsi->ctx, yf_cmdexec_getserial(wsi->ctx));
         for (size_t i = 0; i < wsi->img_n; i++) {
             yf_image_deinit(wsi->imgs[i]);
             wsi->imgs[i] = NULL;
             vkDestroySemaphore(wsi->ctx->device, wsi->imgs_sem[i], NULL);
             wsi->imgs_sem[i] = VK_NULL_HANDLE;
+            vkDestroySemaphore(wsi->ctx->device, wsi->imgs_pres[i], NULL);
+            wsi->imgs_pres[i] = VK_NULL_HANDLE;
         }
     }
 
     void *tmp_img = realloc(wsi->imgs, img_n * sizeof *wsi->imgs);
     void *tmp_acq = realloc(wsi->imgs_acq, img_n * sizeof *wsi->imgs_acq);
     void *tmp_sem = realloc(wsi->imgs_sem, img_n * sizeof *wsi->imgs_sem);
+    void *tmp_ser = realloc(wsi->imgs_ser, img_n * sizeof *wsi->imgs_ser);
+    void *tmp_pres = realloc(wsi->imgs_pres, img_n * sizeof *wsi->imgs_pres);
 
-    if (tmp_img == NULL || tmp_acq == NULL || tmp_sem == NULL) {
+    if (tmp_img == NULL || tmp_acq == NULL || tmp_sem == NULL ||
+        tmp_ser == NULL || tmp_pres == NULL) {
         yf_seterr(YF_ERR_NOMEM, __func__);
         free(tmp_img);
         free(tmp_acq);
         free(tmp_sem);
+        free(tmp_ser);
+        free(tmp_pres);
         free(imgs);
         return -1;
     }
@@ -301,7 +311,10 @@ static int create_swapchain(yf_wsi_t *wsi)
     wsi->imgs = tmp_img;
     wsi->imgs_acq = tmp_acq;
     wsi->imgs_sem = tmp_sem;
+    wsi->imgs_ser = tmp_ser;
+    wsi->imgs_pres = tmp_pres;
     wsi->img_n = img_n;
+    memset(wsi->imgs_pres, 0, img_n * sizeof *wsi->imgs_pres);
 
     yf_dim3_t dim = {
         wsi->sc_info.imageExtent.width,
@@ -337,9 +350,18 @@ static int create_swapchain(yf_wsi_t *wsi)
             memset(wsi->imgs_sem+i, 0, sz);
             return -1;
         }
+        res = vkCreateSemaphore(wsi->ctx->device, &sem_info, NULL,
+                                wsi->imgs_pres+i);
+        if (res != VK_SUCCESS) {
+            size_t sz = (img_n - i - 1) * sizeof *wsi->imgs_sem;
+            memset(wsi->imgs_sem+i+1, 0, sz);
+            wsi->imgs_pres[i] = VK_NULL_HANDLE;
+            return -1;
+        }
     }
 
     memset(wsi->imgs_acq, 0, img_n * sizeof *wsi->imgs_acq);
+    memset(wsi->imgs_ser, 0, img_n * sizeof *wsi->imgs_ser);
     wsi->acq_limit = 1 + img_n - wsi->min_img_n;
 
     return 0;
@@ -394,17 +416,32 @@ int yf_wsi_next(yf_wsi_t *wsi, int nonblocking)
 
     const uint64_t timeout = nonblocking ? 0 : UINT64_MAX;
 
-    VkSemaphore sem;
+    /* the wait on the acquired semaphore cannot fail after acquisition */
+    if (!yf_cmdexec_canwait(wsi->ctx)) {
+        yf_seterr(YF_ERR_QFULL, __func__);
+        return -1;
+    }
+
     unsigned sem_i = 0;
     for (;; sem_i++) {
-        if (!wsi->imgs_acq[sem_i]) {
-            sem = wsi->imgs_sem[sem_i];
+        if (!wsi->imgs_acq[sem_i])
             break;
-        }
     }
+
+    /* the last submission that waited on this semaphore must complete
+       before it can be signaled again */
+    if (!yf_cmdexec_completed(wsi->ctx, wsi->imgs_ser[sem_i]) &&
+        (nonblocking || yf_cmdexec_wait(wsi->ctx,
+                                        wsi->imgs_ser[sem_i]) != 0)) {
+        if (nonblocking)
+            yf_seterr(YF_ERR_INUSE, __func__);
+        return -1;
+    }
+
     unsigned img_i;
     VkResult res = vkAcquireNextImageKHR(wsi->ctx->device, wsi->swapchain,
-                                         timeout, sem, VK_NULL_HANDLE, &img_i);
+                                         timeout, wsi->imgs_sem[sem_i],
+                                         VK_NULL_HANDLE, &img_i);
 
     switch (res) {
     case VK_SUCCESS:
@@ -412,6 +449,9 @@ int yf_wsi_next(yf_wsi_t *wsi, int nonblocking)
             VkSemaphore tmp = wsi->imgs_sem[sem_i];
             wsi->imgs_sem[sem_i] = wsi->imgs_sem[img_i];
             wsi->imgs_sem[img_i] = tmp;
+            uint64_t ser = wsi->imgs_ser[sem_i];
+            wsi->imgs_ser[sem_i] = wsi->imgs_ser[img_i];
+            wsi->imgs_ser[img_i] = ser;
         }
         yf_cmdexec_waitfor(wsi->ctx, wsi->imgs_sem[img_i],
                            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
@@ -456,20 +496,33 @@ int yf_wsi_present(yf_wsi_t *wsi, unsigned index)
         /* TODO: May need to release the image somehow. */
         return -1;
 
+    /* presentation waits for the pending commands to execute */
+    if (yf_cmdexec_signal(wsi->ctx, wsi->imgs_pres[index]) != 0)
+        return -1;
+
     VkPresentInfoKHR info = {
         .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
         .pNext = NULL,
-        .waitSemaphoreCount = 0,
-        .pWaitSemaphores = NULL,
+        .waitSemaphoreCount = 1,
+        .pWaitSemaphores = wsi->imgs_pres+index,
         .swapchainCount = 1,
         .pSwapchains = &wsi->swapchain,
         .pImageIndices = &index,
         .pResults = NULL
     };
 
+    YF_PROF_BEGIN("wsi_present");
     int exec = yf_cmdexec_execprio(wsi->ctx);
+    if (exec != 0)
+        /* nothing will signal the semaphore - present to release the
+           image anyway */
+        info.waitSemaphoreCount = 0;
     VkResult res = vkQueuePresentKHR(wsi->ctx->pres_queue, &info);
+    YF_PROF_END();
 
+    /* the acquire semaphore was waited on by this submission or an
+       earlier one */
+    wsi->imgs_ser[index] = yf_cmdexec_getserial(wsi->ctx) - 1;
     wsi->imgs_acq[index] = 0;
 
     if (exec != 0)
@@ -503,15 +556,20 @@ void yf_wsi_deinit(yf_wsi_t *wsi)
     if (wsi != NULL) {
         /* TODO: If any image was acquired, need to submit, present and
            wait completion. */
+        if (wsi->imgs != NULL)
+            yf_cmdexec_wait(wsi->ctx, yf_cmdexec_getserial(wsi->ctx));
         vkDestroySwapchainKHR(wsi->ctx->device, wsi->swapchain, NULL);
         vkDestroySurfaceKHR(wsi->ctx->instance, wsi->surface, NULL);
         for (size_t i = 0; i < wsi->img_n; i++) {
             yf_image_deinit(wsi->imgs[i]);
             vkDestroySemaphore(wsi->ctx->device, wsi->imgs_sem[i], NULL);
+            vkDestroySemaphore(wsi->ctx->device, wsi->imgs_pres[i], NULL);
         }
         free(wsi->imgs);
         free(wsi->imgs_acq);
         free(wsi->imgs_sem);
+        free(wsi->imgs_ser);
+        free(wsi->imgs_pres);
         free(wsi);
     }
 }
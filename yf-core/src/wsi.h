@@ -8,6 +8,8 @@
 #ifndef YF_WSI_H
 #define YF_WSI_H
 
+#include <stdint.h>
+
 #include "yf-wsi.h"
 #include "vk.h"
 
@@ -24,6 +26,8 @@ struct yf_wsi {
     yf_image_t **imgs;
     int *imgs_acq;
     VkSemaphore *imgs_sem;
+    uint64_t *imgs_ser;
+    VkSemaphore *imgs_pres;
     unsigned img_n;
 };
 
@@ -0,0 +1,55 @@
+/*
+ * YF
+ * bench-cmdbuf.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include <assert.h>
+
+#include "test.h"
+#include "yf-cmdbuf.h"
+
+/* Number of copies encoded in each command buffer. */
+#define YF_BCPYN 64
+
+/* Size of each copy. */
+#define YF_BCPYSZ 16
+
+/* Benchmarks encoding and decoding of buffer copies.
+   Command buffers are reset rather than executed, so this measures the
+   host-side cost of recording only. */
+int yf_bench_cmdbufcopy(yf_bench_t *bench)
+{
+    yf_context_t *ctx = yf_context_init();
+    assert(ctx != NULL);
+
+    yf_buffer_t *src = yf_buffer_init(ctx, YF_BCPYN * YF_BCPYSZ);
+    yf_buffer_t *dst = yf_buffer_init(ctx, YF_BCPYN * YF_BCPYSZ);
+    assert(src != NULL && dst != NULL);
+
+    int r = 0;
+    yf_bench_reset(bench);
+
+    for (size_t i = 0; i < bench->n && r == 0; i += YF_BCPYN) {
+        yf_cmdbuf_t *cb = yf_cmdbuf_get(ctx, YF_CMDBUF_XFER);
+        if (cb == NULL) {
+            r = -1;
+            break;
+        }
+
+        const size_t n = bench->n - i < YF_BCPYN ? bench->n - i : YF_BCPYN;
+        for (size_t j = 0; j < n; j++) {
+            const size_t off = j * YF_BCPYSZ;
+            yf_cmdbuf_copybuf(cb, dst, off, src, off, YF_BCPYSZ);
+        }
+
+        r = yf_cmdbuf_end(cb);
+        yf_cmdbuf_reset(ctx);
+    }
+
+    yf_buffer_deinit(dst);
+    yf_buffer_deinit(src);
+    yf_context_deinit(ctx);
+    return r;
+}
@@ -16,9 +16,14 @@ int yf_test_dtable(void);
 int yf_test_gstate(void);
 int yf_test_cstate(void);
 int yf_test_cmdbuf(void);
+int yf_test_readback(void);
+int yf_test_memory(void);
+int yf_test_bindless(void);
 int yf_test_wsi(void);
 int yf_test_draw(void);
 
+int yf_bench_cmdbufcopy(yf_bench_t *bench);
+
 static const char *ids_[] = {
     "context",
     "buffer",
@@ -29,6 +34,9 @@ static const char *ids_[] = {
     "gstate",
     "cstate",
     "cmdbuf",
+    "readback",
+    "memory",
+    "bindless",
     "wsi",
     "draw"
 };
@@ -43,6 +51,9 @@ static int (*fns_[])(void) = {
     yf_test_gstate,
     yf_test_cstate,
     yf_test_cmdbuf,
+    yf_test_readback,
+    yf_test_memory,
+    yf_test_bindless,
     yf_test_wsi,
     yf_test_draw
 };
@@ -50,9 +61,23 @@ static int (*fns_[])(void) = {
 _Static_assert(sizeof ids_ / sizeof *ids_ == sizeof fns_ / sizeof *fns_,
                "!sizeof");
 
+static const char *bench_ids_[] = {
+    "cmdbuf-copy"
+};
+
+static int (*bench_fns_[])(yf_bench_t *) = {
+    yf_bench_cmdbufcopy
+};
+
+_Static_assert(sizeof bench_ids_ / sizeof *bench_ids_ ==
+               sizeof bench_fns_ / sizeof *bench_fns_, "!sizeof");
+
 const yf_test_t yf_g_test = {
     .name = "core",
     .ids = ids_,
     .fns = fns_,
-    .n = sizeof ids_ / sizeof *ids_
+    .n = sizeof ids_ / sizeof *ids_,
+    .bench_ids = bench_ids_,
+    .bench_fns = bench_fns_,
+    .bench_n = sizeof bench_ids_ / sizeof *bench_ids_
 };
@@ -0,0 +1,100 @@
+/*
+ * YF
+ * test-bindless.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+
+#include "yf/com/yf-error.h"
+
+#include "test.h"
+#include "yf-bindless.h"
+
+/* Tests bindless. */
+int yf_test_bindless(void)
+{
+    yf_context_t *ctx = yf_context_init();
+    assert(ctx != NULL);
+
+    yf_dtable_t *dtb;
+
+    YF_TEST_PRINT("getbindless", "ctx", "dtb");
+    if ((dtb = yf_getbindless(ctx)) == NULL) {
+        if (yf_geterr() != YF_ERR_UNSUP)
+            return -1;
+        puts(" (unsupported)");
+        yf_context_deinit(ctx);
+        return 0;
+    }
+
+    YF_TEST_PRINT("getbindless", "ctx", "dtb");
+    if (yf_getbindless(ctx) != dtb)
+        return -1;
+
+    const yf_dim3_t dim = {64, 64, 1};
+    yf_image_t *img = yf_image_init(ctx, YF_PIXFMT_RGBA8UNORM, dim, 2, 1, 1);
+    assert(img != NULL);
+
+    yf_buffer_t *buf = yf_buffer_init(ctx, 4096);
+    assert(buf != NULL);
+
+    unsigned img_i[3], buf_i[2];
+
+    YF_TEST_PRINT("getindex", "img, 0, NULL, img_i", "");
+    if (yf_image_getindex(img, 0, NULL, img_i) != 0)
+        return -1;
+
+    const yf_sampler_t splr = {
+        .wrapmode = {
+            .u = YF_WRAPMODE_CLAMP,
+            .v = YF_WRAPMODE_CLAMP,
+            .w = YF_WRAPMODE_CLAMP
+        },
+        .filter = {
+            .mag = YF_FILTER_NEAREST,
+            .min = YF_FILTER_NEAREST,
+            .mipmap = YF_FILTER_NEAREST
+        }
+    };
+
+    YF_TEST_PRINT("getindex", "img, 1, &splr, img_i+1", "");
+    if (yf_image_getindex(img, 1, &splr, img_i+1) != 0 || img_i[1] == img_i[0])
+        return -1;
+
+    YF_TEST_PRINT("getindex", "img, 2, NULL, img_i+2", "");
+    if (yf_image_getindex(img, 2, NULL, img_i+2) == 0)
+        return -1;
+
+    YF_TEST_PRINT("ungetindex", "img, img_i[0]", "");
+    yf_image_ungetindex(img, img_i[0]);
+
+    YF_TEST_PRINT("getindex", "img, 1, NULL, img_i+2", "");
+    if (yf_image_getindex(img, 1, NULL, img_i+2) != 0 || img_i[2] != img_i[0])
+        return -1;
+
+    YF_TEST_PRINT("getindex", "buf, buf_i", "");
+    if (yf_buffer_getindex(buf, buf_i) != 0)
+        return -1;
+
+    YF_TEST_PRINT("getindex", "buf, buf_i+1", "");
+    if (yf_buffer_getindex(buf, buf_i+1) != 0 || buf_i[1] == buf_i[0])
+        return -1;
+
+    YF_TEST_PRINT("ungetindex", "buf, buf_i[0]", "");
+    yf_buffer_ungetindex(buf, buf_i[0]);
+
+    YF_TEST_PRINT("ungetindex", "buf, buf_i[1]", "");
+    yf_buffer_ungetindex(buf, buf_i[1]);
+
+    YF_TEST_PRINT("ungetindex", "img, img_i[1]", "");
+    yf_image_ungetindex(img, img_i[1]);
+
+    /* the remaining index is released along with the context */
+    yf_buffer_deinit(buf);
+    yf_image_deinit(img);
+    yf_context_deinit(ctx);
+    return 0;
+}
@@ -6,10 +6,13 @@
  */
 
 #include <stdio.h>
+#include <stdint.h>
 #include <assert.h>
 
 #include "test.h"
 #include "yf-cmdbuf.h"
+#include "yf-readback.h"
+#include "yf-debug.h"
 
 /* Tests cmdbuf. */
 int yf_test_cmdbuf(void)
@@ -32,6 +35,12 @@ int yf_test_cmdbuf(void)
     if (xfer_cb == NULL)
         return -1;
 
+    YF_TEST_PRINT("beginlabel", "xfer_cb, \"xfer\"", "");
+    yf_cmdbuf_beginlabel(xfer_cb, "xfer");
+
+    YF_TEST_PRINT("endlabel", "xfer_cb", "");
+    yf_cmdbuf_endlabel(xfer_cb);
+
     YF_TEST_PRINT("end", "xfer_cb", "");
     if (yf_cmdbuf_end(xfer_cb) != 0)
         return -1;
@@ -44,10 +53,87 @@ int yf_test_cmdbuf(void)
     if (yf_cmdbuf_end(graph_cb) != 0)
         return -1;
 
+    YF_TEST_PRINT("getserial", "", "");
+    uint64_t serial = yf_cmdbuf_getserial(ctx);
+    if (serial == 0)
+        return -1;
+
+    YF_TEST_PRINT("completed", "serial", "");
+    if (yf_cmdbuf_completed(ctx, serial))
+        return -1;
+
+    /* execution waits for completion */
     YF_TEST_PRINT("exec", "", "");
     if (yf_cmdbuf_exec(ctx) != 0)
         return -1;
 
+    YF_TEST_PRINT("completed", "serial", "");
+    if (!yf_cmdbuf_completed(ctx, serial))
+        return -1;
+
+    YF_TEST_PRINT("wait", "serial", "");
+    if (yf_cmdbuf_wait(ctx, serial) != 0)
+        return -1;
+
+    YF_TEST_PRINT("getserial", "", "");
+    if (yf_cmdbuf_getserial(ctx) <= serial)
+        return -1;
+
+    unsigned char data[256];
+    for (unsigned i = 0; i < sizeof data; i++)
+        data[i] = i;
+
+    yf_buffer_t *src = yf_buffer_init(ctx, sizeof data);
+    yf_buffer_t *dst = yf_buffer_init(ctx, sizeof data);
+    assert(src != NULL && dst != NULL);
+    if (yf_buffer_copy(src, 0, data, sizeof data) != 0)
+        return -1;
+
+    /* reverses the order of four 64-byte blocks */
+    const yf_bufcpy_t regions[] = {
+        {0, 192, 64},
+        {64, 128, 64},
+        {128, 64, 64}
+    };
+
+    YF_TEST_PRINT("get", "CMDBUF_XFER", "xfer_cb");
+    if ((xfer_cb = yf_cmdbuf_get(ctx, YF_CMDBUF_XFER)) == NULL)
+        return -1;
+
+    YF_TEST_PRINT("copybufs", "xfer_cb, dst, src, regions, 3", "");
+    yf_cmdbuf_copybufs(xfer_cb, dst, src, regions, 3);
+
+    YF_TEST_PRINT("copybuf", "xfer_cb, dst, 192, src, 0, 64", "");
+    yf_cmdbuf_copybuf(xfer_cb, dst, 192, src, 0, 64);
+
+    YF_TEST_PRINT("end", "xfer_cb", "");
+    if (yf_cmdbuf_end(xfer_cb) != 0)
+        return -1;
+
+    yf_readback_t *rb = yf_buffer_read(dst, 0, sizeof data, NULL, NULL);
+    assert(rb != NULL);
+
+    YF_TEST_PRINT("submit", "", "");
+    serial = yf_cmdbuf_getserial(ctx);
+    if (yf_cmdbuf_submit(ctx) != 0)
+        return -1;
+
+    YF_TEST_PRINT("wait", "serial", "");
+    if (yf_cmdbuf_wait(ctx, serial) != 0 ||
+        !yf_cmdbuf_completed(ctx, serial))
+        return -1;
+
+    const unsigned char *res = yf_readback_getdata(rb, NULL);
+    if (res == NULL)
+        return -1;
+    for (unsigned i = 0; i < sizeof data; i++) {
+        if (res[i] != data[(3 - i / 64) * 64 + i % 64])
+            return -1;
+    }
+
+    yf_readback_deinit(rb);
+    yf_buffer_deinit(dst);
+    yf_buffer_deinit(src);
     yf_context_deinit(ctx);
     return 0;
 }
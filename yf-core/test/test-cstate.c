@@ -42,6 +42,18 @@ int yf_test_cstate(void)
     if (yf_cstate_getstg(cst) == NULL)
         return -1;
 
+    YF_TEST_PRINT("getdtb", "cst, 0", "");
+    if (yf_cstate_getdtb(cst, 0) != dtb)
+        return -1;
+
+    YF_TEST_PRINT("init", "&conf", "cst2");
+    yf_cstate_t *cst2 = yf_cstate_init(ctx, &conf);
+    if (cst2 != cst)
+        return -1;
+
+    YF_TEST_PRINT("deinit", "cst2", "");
+    yf_cstate_deinit(cst2);
+
     YF_TEST_PRINT("getdtb", "cst, 0", "");
     if (yf_cstate_getdtb(cst, 0) != dtb)
         return -1;
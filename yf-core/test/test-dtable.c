@@ -98,6 +98,30 @@ int yf_test_dtable(void)
     if (yf_dtable_copyimg(dtb, 1, 1, slice, imgs, lays, NULL) != 0)
         return -1;
 
+    YF_TEST_PRINT("alloc", "dtb, 5", "");
+    if (yf_dtable_alloc(dtb, 5) != 0)
+        return -1;
+
+    YF_TEST_PRINT("copyimg", "dtb, 4, 1, {0, 10}, imgs, lays, NULL", "");
+    if (yf_dtable_copyimg(dtb, 4, 1, slice, imgs, lays, NULL) != 0)
+        return -1;
+
+    YF_TEST_PRINT("alloc", "dtb, 1", "");
+    if (yf_dtable_alloc(dtb, 1) != 0)
+        return -1;
+
+    YF_TEST_PRINT("copyimg", "dtb, 1, 1, {0, 10}, imgs, lays, NULL", "");
+    if (yf_dtable_copyimg(dtb, 1, 1, slice, imgs, lays, NULL) == 0)
+        return -1;
+
+    YF_TEST_PRINT("alloc", "dtb, 3", "");
+    if (yf_dtable_alloc(dtb, 3) != 0)
+        return -1;
+
+    YF_TEST_PRINT("copyimg", "dtb, 2, 1, {0, 10}, imgs, lays, NULL", "");
+    if (yf_dtable_copyimg(dtb, 2, 1, slice, imgs, lays, NULL) != 0)
+        return -1;
+
     YF_TEST_PRINT("dealloc", "dtb", "");
     yf_dtable_dealloc(dtb);
 
@@ -74,6 +74,29 @@ int yf_test_gstate(void)
     if (yf_gstate_getdtb(gst, 0) != dtb)
         return -1;
 
+    YF_TEST_PRINT("init", "&conf", "gst2");
+    yf_gstate_t *gst2 = yf_gstate_init(ctx, &conf);
+    if (gst2 != gst)
+        return -1;
+
+    yf_gconf_t conf2 = conf;
+    conf2.cullmode = YF_CULLMODE_NONE;
+
+    YF_TEST_PRINT("init", "&conf2", "gst3");
+    yf_gstate_t *gst3 = yf_gstate_init(ctx, &conf2);
+    if (gst3 == NULL || gst3 == gst)
+        return -1;
+
+    YF_TEST_PRINT("deinit", "gst3", "");
+    yf_gstate_deinit(gst3);
+
+    YF_TEST_PRINT("deinit", "gst2", "");
+    yf_gstate_deinit(gst2);
+
+    YF_TEST_PRINT("getpass", "gst", "");
+    if (yf_gstate_getpass(gst) != pass)
+        return -1;
+
     YF_TEST_PRINT("deinit", "gst", "");
     yf_gstate_deinit(gst);
 
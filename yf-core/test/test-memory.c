@@ -0,0 +1,82 @@
+/*
+ * YF
+ * test-memory.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+
+#include "test.h"
+#include "yf-memory.h"
+#include "yf-buffer.h"
+
+/* Memory pressure callback. */
+static void on_pressure(int level, unsigned heap, size_t size, void *arg)
+{
+    assert(heap < YF_HEAPMAX);
+    assert(size > 0);
+
+    if (level == YF_PRESSURE_HIGH)
+        ++*(int *)arg;
+}
+
+/* Tests memory. */
+int yf_test_memory(void)
+{
+    yf_context_t *ctx = yf_context_init();
+    assert(ctx != NULL);
+
+    yf_budget_t bgts[YF_HEAPMAX];
+    unsigned heap_n;
+
+    YF_TEST_PRINT("getbudget", "ctx, bgts", "heap_n");
+    heap_n = yf_getbudget(ctx, bgts);
+    if (heap_n == 0 || heap_n > YF_HEAPMAX)
+        return -1;
+
+    for (unsigned i = 0; i < heap_n; i++) {
+        printf(" heap #%u: %zu/%zu (%zu)%s\n", i, bgts[i].usage,
+               bgts[i].budget, bgts[i].size, bgts[i].local ? " [local]" : "");
+        if (bgts[i].size == 0)
+            return -1;
+    }
+
+    int press_n = 0;
+
+    YF_TEST_PRINT("setpressure", "ctx, 1.5f, on_pressure, &press_n", "");
+    if (yf_setpressure(ctx, 1.5f, on_pressure, &press_n) == 0)
+        return -1;
+
+    YF_TEST_PRINT("setpressure", "ctx, 0.0f, on_pressure, &press_n", "");
+    if (yf_setpressure(ctx, 0.0f, on_pressure, &press_n) != 0)
+        return -1;
+
+    yf_buffer_t *buf = yf_buffer_init(ctx, 1 << 20);
+    assert(buf != NULL);
+    if (press_n == 0)
+        return -1;
+
+    yf_budget_t bgts2[YF_HEAPMAX];
+
+    YF_TEST_PRINT("getbudget", "ctx, bgts2", "heap_n");
+    if (yf_getbudget(ctx, bgts2) != heap_n)
+        return -1;
+
+    size_t usage = 0, usage2 = 0;
+    for (unsigned i = 0; i < heap_n; i++) {
+        usage += bgts[i].usage;
+        usage2 += bgts2[i].usage;
+    }
+    if (usage2 <= usage)
+        return -1;
+
+    YF_TEST_PRINT("setpressure", "ctx, 1.0f, NULL, NULL", "");
+    if (yf_setpressure(ctx, 1.0f, NULL, NULL) != 0)
+        return -1;
+
+    yf_buffer_deinit(buf);
+    yf_context_deinit(ctx);
+    return 0;
+}
@@ -0,0 +1,120 @@
+/*
+ * YF
+ * test-readback.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "test.h"
+#include "yf-readback.h"
+#include "yf-cmdbuf.h"
+
+/* Readback callback. */
+static void on_read(yf_readback_t *rb, int state, void *arg)
+{
+    assert(rb != NULL);
+
+    if (state == YF_READBACK_DONE)
+        ++*(int *)arg;
+}
+
+/* Tests readback. */
+int yf_test_readback(void)
+{
+    yf_context_t *ctx = yf_context_init();
+    assert(ctx != NULL);
+
+    unsigned char data[64*64*4];
+    for (size_t i = 0; i < sizeof data; i++)
+        data[i] = i & 255;
+
+    yf_buffer_t *buf = yf_buffer_init(ctx, sizeof data);
+    assert(buf != NULL);
+    if (yf_buffer_copy(buf, 0, data, sizeof data) != 0)
+        return -1;
+
+    const yf_dim3_t dim = {64, 64, 1};
+    const yf_off3_t off = {0};
+    yf_image_t *img = yf_image_init(ctx, YF_PIXFMT_RGBA8UNORM, dim, 1, 1, 1);
+    assert(img != NULL);
+    if (yf_image_copy(img, off, dim, 0, 0, data) != 0)
+        return -1;
+
+    int done = 0;
+
+    YF_TEST_PRINT("buffer_read", "buf, 1024, 2048, on_read, &done", "rb");
+    yf_readback_t *rb = yf_buffer_read(buf, 1024, 2048, on_read, &done);
+    if (rb == NULL)
+        return -1;
+
+    YF_TEST_PRINT("buffer_read", "buf, 0, sizeof data + 1, NULL, NULL", "");
+    if (yf_buffer_read(buf, 0, sizeof data + 1, NULL, NULL) != NULL)
+        return -1;
+
+    YF_TEST_PRINT("image_read", "img, {0,0,0}, {64,64,1}, 0, 0, on_read, &done",
+                  "rb2");
+    yf_readback_t *rb2 = yf_image_read(img, off, dim, 0, 0, on_read, &done);
+    if (rb2 == NULL)
+        return -1;
+
+    YF_TEST_PRINT("poll", "rb", "");
+    if (yf_readback_poll(rb) != YF_READBACK_PENDING)
+        return -1;
+
+    YF_TEST_PRINT("getdata", "rb, NULL", "");
+    if (yf_readback_getdata(rb, NULL) != NULL)
+        return -1;
+
+    const uint64_t serial = yf_cmdbuf_getserial(ctx);
+    if (yf_cmdbuf_submit(ctx) != 0 || yf_cmdbuf_wait(ctx, serial) != 0)
+        return -1;
+
+    YF_TEST_PRINT("poll", "rb", "");
+    if (yf_readback_poll(rb) != YF_READBACK_DONE || done != 2)
+        return -1;
+
+    size_t sz;
+    const void *rb_data;
+
+    YF_TEST_PRINT("getdata", "rb, &sz", "");
+    rb_data = yf_readback_getdata(rb, &sz);
+    if (rb_data == NULL || sz != 2048 || memcmp(rb_data, data+1024, sz) != 0)
+        return -1;
+
+    YF_TEST_PRINT("poll", "rb2", "");
+    if (yf_readback_poll(rb2) != YF_READBACK_DONE)
+        return -1;
+
+    YF_TEST_PRINT("getdata", "rb2, &sz", "");
+    rb_data = yf_readback_getdata(rb2, &sz);
+    if (rb_data == NULL || sz != sizeof data ||
+        memcmp(rb_data, data, sz) != 0)
+        return -1;
+
+    YF_TEST_PRINT("deinit", "rb2", "");
+    yf_readback_deinit(rb2);
+
+    YF_TEST_PRINT("deinit", "rb", "");
+    yf_readback_deinit(rb);
+
+    YF_TEST_PRINT("buffer_read", "buf, 0, 16, NULL, NULL", "rb");
+    rb = yf_buffer_read(buf, 0, 16, NULL, NULL);
+    if (rb == NULL)
+        return -1;
+
+    YF_TEST_PRINT("deinit", "rb (pending)", "");
+    yf_readback_deinit(rb);
+
+    if (yf_cmdbuf_exec(ctx) != 0)
+        return -1;
+
+    yf_image_deinit(img);
+    yf_buffer_deinit(buf);
+    yf_context_deinit(ctx);
+    return 0;
+}
@@ -8,7 +8,11 @@
 #ifndef YF_YF_VIEW_H
 #define YF_YF_VIEW_H
 
+#include <stddef.h>
+
 #include "yf/com/yf-defs.h"
+#include "yf/com/yf-types.h"
+#include "yf/com/yf-clock.h"
 #include "yf/wsys/yf-window.h"
 
 #include "yf-scene.h"
@@ -20,6 +24,9 @@ YF_DECLS_BEGIN
  *
  * A view is responsible for issuing scene rendering requests and for
  * presenting the results on its associated window.
+ *
+ * Headless views have no window. Instead, rendered frames are read back
+ * to host memory and handed to a callback.
  */
 typedef struct yf_view yf_view_t;
 
@@ -35,6 +42,37 @@ typedef struct yf_view yf_view_t;
  */
 yf_view_t *yf_view_init(yf_window_t *win);
 
+/**
+ * Initializes a new headless view.
+ *
+ * The view renders into a ring of offscreen targets. The contents of each
+ * frame are read back asynchronously, while the next frame is rendered,
+ * and then provided to 'callb'. Frame data is tightly packed, using the
+ * 'YF_PIXFMT_BGRA8UNORM' format.
+ *
+ * Since scene rendering waits for the previous frame to complete, at most
+ * one frame is in flight at any time, so the ring is capped at two targets.
+ *
+ * If a view already exists, this function fails and sets the global error
+ * to 'YF_ERR_EXIST'.
+ *
+ * @param dim: The size of the rendered frames.
+ * @param tgt_n: The number of targets in the ring. Must be at least two.
+ *  Values greater than two are treated as two.
+ * @param callb: The function to call when a frame's data is available.
+ *  'data' is 'NULL' if the frame could not be read. Data is only valid for
+ *  the duration of the call. Can be 'NULL'.
+ * @param arg: The generic argument to pass on 'callb' calls. Can be 'NULL'.
+ * @return: On success, returns a new view. Otherwise, 'NULL' is returned and
+ *  the global error is set to indicate the cause.
+ */
+yf_view_t *yf_view_initheadless(yf_dim2_t dim, unsigned tgt_n,
+                                void (*callb)(yf_view_t *view,
+                                              unsigned long frame,
+                                              const void *data, size_t size,
+                                              void *arg),
+                                void *arg);
+
 /**
  * Starts a view's rendering loop.
  *
@@ -50,10 +88,21 @@ yf_view_t *yf_view_init(yf_window_t *win);
  * @return: On success, returns zero. Otherwise, 'NULL' is returned and the
  *  global error is set to indicate the cause.
  */
-/* TODO: Replace 'fps' arg with 'vsync' and fix the pacing. */
+/* TODO: Replace 'fps' arg with 'vsync'. */
 int yf_view_loop(yf_view_t *view, yf_scene_t *scn, unsigned fps,
                  int (*update)(double elapsed_time, void *arg), void *arg);
 
+/**
+ * Gets frame time statistics of a view's loop.
+ *
+ * Statistics cover the most recent frames of the current or last loop,
+ * each frame time including the wait used for pacing.
+ *
+ * @param view: The view.
+ * @param stats: The destination for the statistics.
+ */
+void yf_view_getstats(yf_view_t *view, yf_frmstats_t *stats);
+
 /**
  * Swaps the scene in a view's loop.
  *
@@ -77,6 +126,17 @@ yf_scene_t *yf_view_swap(yf_view_t *view, yf_scene_t *scn);
  */
 int yf_view_render(yf_view_t *view, yf_scene_t *scn);
 
+/**
+ * Completes the pending frame readbacks of a headless view.
+ *
+ * NOTE: 'view_loop()' implicitly calls this function when the loop ends.
+ *
+ * @param view: The view.
+ * @return: On success, returns zero. Otherwise, a non-zero value is returned
+ *  and the global error is set to indicate the cause.
+ */
+int yf_view_flush(yf_view_t *view);
+
 /**
  * Deinitializes a view.
  *
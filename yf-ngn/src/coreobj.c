@@ -14,12 +14,22 @@
 # error "C11 atomics required"
 #endif
 
+#include "yf/core/yf-memory.h"
+#include "yf/core/yf-cmdbuf.h"
+
 #include "coreobj.h"
+#include "resmgr.h"
 #include "error.h"
 
+/* TODO: Should be defined elsewhere. */
+#define YF_PRESSTHRES 0.9f
+
 /* Context instance. */
 static yf_context_t *ctx_ = NULL;
 
+/* Whether critical memory pressure is yet to be handled. */
+static atomic_int press_ = 0;
+
 /* Pass instance (managed elsewhere). */
 /* TODO: Remove. */
 extern yf_pass_t *yf_g_pass;
@@ -29,6 +39,24 @@ void yf_unsetscn(void);
 void yf_unsetmesh(void);
 void yf_unsettex(void);
 
+/* Notifies memory pressure (defined elsewhere). */
+void yf_pressmesh(void);
+void yf_presstex(void);
+
+/* Handles device memory pressure. */
+static void handle_pressure(int level, YF_UNUSED unsigned heap,
+                            YF_UNUSED size_t size, YF_UNUSED void *arg)
+{
+    /* caches release and limit their memory on next use */
+    yf_pressmesh();
+    yf_presstex();
+
+    /* this may be called from within resource management, so eviction
+       is deferred to 'handlepress()' */
+    if (level == YF_PRESSURE_CRITICAL)
+        atomic_store(&press_, 1);
+}
+
 /* Handles deinitialization before exiting. */
 static void handle_exit(void)
 {
@@ -61,7 +89,8 @@ yf_context_t *yf_getctx(void)
     int expect = 0;
 
     if (atomic_compare_exchange_strong(&a, &expect, -1)) {
-        if (atexit(handle_exit) != 0 || (ctx_ = yf_context_init()) == NULL)
+        if (atexit(handle_exit) != 0 || (ctx_ = yf_context_init()) == NULL ||
+            yf_setpressure(ctx_, YF_PRESSTHRES, handle_pressure, NULL) != 0)
             exit_fatal(__func__);
         atomic_store(&a, 1);
     } else {
@@ -72,6 +101,17 @@ yf_context_t *yf_getctx(void)
     return ctx_;
 }
 
+void yf_handlepress(void)
+{
+    if (!atomic_exchange(&press_, 0))
+        return;
+
+    /* pending work is waited for, letting the deferred destruction of
+       evicted resources free their memory */
+    yf_resmgr_evict();
+    yf_cmdbuf_wait(ctx_, yf_cmdbuf_getserial(ctx_));
+}
+
 /* TODO: Remove. */
 yf_pass_t *yf_getpass(void)
 {
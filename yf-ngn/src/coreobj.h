@@ -14,6 +14,11 @@
 /* Gets the shared context object. */
 yf_context_t *yf_getctx(void);
 
+/* Releases unused resources if critical memory pressure was signaled.
+   Must be called where no resources are in use, such as before a scene
+   is rendered. */
+void yf_handlepress(void);
+
 /* Gets the shared pass object. */
 /* TODO: Remove. */
 yf_pass_t *yf_getpass(void);
@@ -25,6 +25,7 @@
 # include <stdio.h>
 #endif
 
+#include "yf/com/yf-mem.h"
 #include "yf/com/yf-error.h"
 
 #include "data-gltf.h"
@@ -236,7 +237,7 @@ static int parse_array(FILE *file, token_t *token,
             if (token->data[0] != ']') {
                 if (i == *n) {
                     const size_t new_n = i == 0 ? 1 : i<<1;
-                    void *tmp = realloc(*array, new_n*elem_sz);
+                    void *tmp = YF_REALLOC("gltf", *array, new_n*elem_sz);
                     if (tmp == NULL) {
                         yf_seterr(YF_ERR_NOMEM, __func__);
                         return -1;
@@ -258,7 +259,7 @@ static int parse_array(FILE *file, token_t *token,
 
     if (i < *n) {
         *n = i;
-        void *tmp = realloc(*array, i*elem_sz);
+        void *tmp = YF_REALLOC("gltf", *array, i*elem_sz);
         if (tmp != NULL)
             *array = tmp;
     }
@@ -283,7 +284,7 @@ static int parse_str(FILE *file, token_t *token, str_t *str)
         return -1;
     }
 
-    *str = malloc(1+strlen(token->data));
+    *str = YF_MALLOC("gltf", 1+strlen(token->data));
     if (*str == NULL) {
         yf_seterr(YF_ERR_NOMEM, __func__);
         return -1;
@@ -1829,7 +1830,7 @@ static int parse_material_ext(FILE *file, token_t *token, size_t index,
                     return -1;
                 }
 
-                pbrspecgloss_t *pbrsg = malloc(sizeof *pbrsg);
+                pbrspecgloss_t *pbrsg = YF_MALLOC("gltf", sizeof *pbrsg);
                 if (pbrsg == NULL) {
                     yf_seterr(YF_ERR_NOMEM, __func__);
                     return -1;
@@ -1846,7 +1847,7 @@ static int parse_material_ext(FILE *file, token_t *token, size_t index,
                 pbrsg->spec_gloss_tex.index = YF_INT_MIN;
 
                 if (parse_pbrspecgloss(file, token, pbrsg) != 0) {
-                    free(pbrsg);
+                    YF_FREE(pbrsg);
                     return -1;
                 }
                 materials->v[index].ext.pbrsg = pbrsg;
@@ -3298,95 +3299,95 @@ static void deinit_gltf(gltf_t *gltf, fdata_t *fdata, cont_t *cont)
     }
 
     for (size_t i = 0; i < gltf->ext_used_n; i++)
-        free(gltf->ext_used[i]);
-    free(gltf->ext_used);
+        YF_FREE(gltf->ext_used[i]);
+    YF_FREE(gltf->ext_used);
 
     for (size_t i = 0; i < gltf->ext_req_n; i++)
-        free(gltf->ext_req[i]);
-    free(gltf->ext_req);
+        YF_FREE(gltf->ext_req[i]);
+    YF_FREE(gltf->ext_req);
 
-    free(gltf->asset.copyright);
-    free(gltf->asset.generator);
-    free(gltf->asset.version);
-    free(gltf->asset.min_version);
+    YF_FREE(gltf->asset.copyright);
+    YF_FREE(gltf->asset.generator);
+    YF_FREE(gltf->asset.version);
+    YF_FREE(gltf->asset.min_version);
 
     for (size_t i = 0; i < gltf->scenes.n; i++) {
-        free(gltf->scenes.v[i].nodes);
-        free(gltf->scenes.v[i].name);
+        YF_FREE(gltf->scenes.v[i].nodes);
+        YF_FREE(gltf->scenes.v[i].name);
     }
-    free(gltf->scenes.v);
+    YF_FREE(gltf->scenes.v);
 
     for (size_t i = 0; i < gltf->nodes.n; i++) {
-        free(gltf->nodes.v[i].children);
-        free(gltf->nodes.v[i].weights);
-        free(gltf->nodes.v[i].name);
+        YF_FREE(gltf->nodes.v[i].children);
+        YF_FREE(gltf->nodes.v[i].weights);
+        YF_FREE(gltf->nodes.v[i].name);
     }
-    free(gltf->nodes.v);
+    YF_FREE(gltf->nodes.v);
 
     for (size_t i = 0; i < gltf->cameras.n; i++)
-        free(gltf->cameras.v[i].name);
-    free(gltf->cameras.v);
+        YF_FREE(gltf->cameras.v[i].name);
+    YF_FREE(gltf->cameras.v);
 
     for (size_t i = 0; i < gltf->meshes.n; i++) {
         for (size_t j = 0; j < gltf->meshes.v[i].primitives.n; j++)
-            free(gltf->meshes.v[i].primitives.v[j].targets.v);
-        free(gltf->meshes.v[i].primitives.v);
-        free(gltf->meshes.v[i].weights);
-        free(gltf->meshes.v[i].name);
+            YF_FREE(gltf->meshes.v[i].primitives.v[j].targets.v);
+        YF_FREE(gltf->meshes.v[i].primitives.v);
+        YF_FREE(gltf->meshes.v[i].weights);
+        YF_FREE(gltf->meshes.v[i].name);
     }
-    free(gltf->meshes.v);
+    YF_FREE(gltf->meshes.v);
 
     for (size_t i = 0; i < gltf->skins.n; i++) {
-        free(gltf->skins.v[i].joints);
-        free(gltf->skins.v[i].name);
+        YF_FREE(gltf->skins.v[i].joints);
+        YF_FREE(gltf->skins.v[i].name);
     }
-    free(gltf->skins.v);
+    YF_FREE(gltf->skins.v);
 
     for (size_t i = 0; i < gltf->materials.n; i++) {
-        free(gltf->materials.v[i].name);
-        free(gltf->materials.v[i].ext.pbrsg);
+        YF_FREE(gltf->materials.v[i].name);
+        YF_FREE(gltf->materials.v[i].ext.pbrsg);
     }
-    free(gltf->materials.v);
+    YF_FREE(gltf->materials.v);
 
     for (size_t i = 0; i < gltf->animations.n; i++) {
-        free(gltf->animations.v[i].channels.v);
-        free(gltf->animations.v[i].samplers.v);
-        free(gltf->animations.v[i].name);
+        YF_FREE(gltf->animations.v[i].channels.v);
+        YF_FREE(gltf->animations.v[i].samplers.v);
+        YF_FREE(gltf->animations.v[i].name);
     }
-    free(gltf->animations.v);
+    YF_FREE(gltf->animations.v);
 
     for (size_t i = 0; i < gltf->accessors.n; i++)
-        free(gltf->accessors.v[i].name);
-    free(gltf->accessors.v);
+        YF_FREE(gltf->accessors.v[i].name);
+    YF_FREE(gltf->accessors.v);
 
     for (size_t i = 0; i < gltf->bufferviews.n; i++)
-        free(gltf->bufferviews.v[i].name);
-    free(gltf->bufferviews.v);
+        YF_FREE(gltf->bufferviews.v[i].name);
+    YF_FREE(gltf->bufferviews.v);
 
     for (size_t i = 0; i < gltf->buffers.n; i++) {
-        free(gltf->buffers.v[i].uri);
-        free(gltf->buffers.v[i].name);
+        YF_FREE(gltf->buffers.v[i].uri);
+        YF_FREE(gltf->buffers.v[i].name);
     }
-    free(gltf->buffers.v);
+    YF_FREE(gltf->buffers.v);
 
     for (size_t i = 0; i < gltf->textures.n; i++)
-        free(gltf->textures.v[i].name);
-    free(gltf->textures.v);
+        YF_FREE(gltf->textures.v[i].name);
+    YF_FREE(gltf->textures.v);
 
     for (size_t i = 0; i < gltf->images.n; i++) {
-        free(gltf->images.v[i].uri);
-        free(gltf->images.v[i].mime_type);
-        free(gltf->images.v[i].name);
+        YF_FREE(gltf->images.v[i].uri);
+        YF_FREE(gltf->images.v[i].mime_type);
+        YF_FREE(gltf->images.v[i].name);
     }
-    free(gltf->images.v);
+    YF_FREE(gltf->images.v);
 
     for (size_t i = 0; i < gltf->samplers.n; i++)
-        free(gltf->samplers.v[i].name);
-    free(gltf->samplers.v);
+        YF_FREE(gltf->samplers.v[i].name);
+    YF_FREE(gltf->samplers.v);
 
     for (size_t i = 0; i < gltf->ext.lights.n; i++)
-        free(gltf->ext.lights.v[i].name);
-    free(gltf->ext.lights.v);
+        YF_FREE(gltf->ext.lights.v[i].name);
+    YF_FREE(gltf->ext.lights.v);
 }
 
 /* Initializes glTF contents. */
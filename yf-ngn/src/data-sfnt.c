@@ -20,6 +20,7 @@
 
 #include "yf/com/yf-util.h"
 #include "yf/com/yf-dict.h"
+#include "yf/com/yf-mem.h"
 #include "yf/com/yf-error.h"
 
 #include "data-sfnt.h"
@@ -2273,7 +2274,8 @@ static int rasterize(outline_t *outln, yf_glyph_t *glyph)
     /* rasterize */
     const uint32_t w = outln->x_max - outln->x_min;
     const uint32_t h = outln->y_max - outln->y_min;
-    uint8_t *bitmap = malloc(YF_SFNT_FIXTOINT(w)*YF_SFNT_FIXTOINT(h));
+    uint8_t *bitmap = YF_MALLOC("glyph",
+                                YF_SFNT_FIXTOINT(w)*YF_SFNT_FIXTOINT(h));
     if (bitmap == NULL) {
         yf_seterr(YF_ERR_NOMEM, __func__);
         free(segs);
@@ -12,6 +12,7 @@
 
 #include "yf/com/yf-util.h"
 #include "yf/com/yf-dict.h"
+#include "yf/com/yf-mem.h"
 #include "yf/com/yf-error.h"
 
 #include "font.h"
@@ -28,8 +29,8 @@ struct yf_font {
 /* Deinitializes a glyph. */
 static int deinit_glyph(YF_UNUSED void *key, void *val, YF_UNUSED void *arg)
 {
-    free(((yf_glyph_t *)val)->bm8);
-    free(val);
+    YF_FREE(((yf_glyph_t *)val)->bm8);
+    YF_FREE(val);
     return 0;
 }
 
@@ -45,7 +46,7 @@ yf_font_t *yf_font_init(const yf_fontdt_t *data)
 {
     assert(data != NULL);
 
-    yf_font_t *font = calloc(1, sizeof(yf_font_t));
+    yf_font_t *font = YF_CALLOC("font", 1, sizeof(yf_font_t));
     if (font == NULL) {
         yf_seterr(YF_ERR_NOMEM, __func__);
         return NULL;
@@ -55,7 +56,7 @@ yf_font_t *yf_font_init(const yf_fontdt_t *data)
     font->glyphs = yf_dict_init(NULL, NULL);
 
     if (font->glyphs == NULL) {
-        free(font);
+        YF_FREE(font);
         return NULL;
     }
 
@@ -73,7 +74,7 @@ void yf_font_deinit(yf_font_t *font)
     yf_dict_each(font->glyphs, deinit_glyph, NULL);
     yf_dict_deinit(font->glyphs);
 
-    free(font);
+    YF_FREE(font);
 }
 
 int yf_font_rasterize(yf_font_t *font, const wchar_t *str, uint16_t pt,
@@ -117,7 +118,7 @@ int yf_font_rasterize(yf_font_t *font, const wchar_t *str, uint16_t pt,
         yf_glyph_t *glyph = yf_dict_search(font->glyphs, key);
 
         if (glyph == NULL) {
-            glyph = malloc(sizeof *glyph);
+            glyph = YF_MALLOC("glyph", sizeof *glyph);
 
             if (glyph == NULL) {
                 yf_seterr(YF_ERR_NOMEM, __func__);
@@ -125,7 +126,7 @@ int yf_font_rasterize(yf_font_t *font, const wchar_t *str, uint16_t pt,
             }
 
             if (yf_dict_insert(font->glyphs, key, glyph) != 0) {
-                free(glyph);
+                YF_FREE(glyph);
                 return -1;
             }
 
@@ -173,11 +174,11 @@ int yf_font_rasterize(yf_font_t *font, const wchar_t *str, uint16_t pt,
     switch (((yf_glyph_t *)yf_dict_next(font->glyphs, NULL, NULL))->bpp) {
     case 8:
         data.pixfmt = YF_PIXFMT_R8UNORM;
-        data.data = calloc(1, dim.width * dim.height);
+        data.data = YF_CALLOC("font", 1, dim.width * dim.height);
         break;
     case 16:
         data.pixfmt = YF_PIXFMT_R16UNORM;
-        data.data = calloc(1, (dim.width * dim.height) << 1);
+        data.data = YF_CALLOC("font", 1, (dim.width * dim.height) << 1);
         break;
     default:
         assert(0);
@@ -191,7 +192,7 @@ int yf_font_rasterize(yf_font_t *font, const wchar_t *str, uint16_t pt,
     }
 
     rz->tex = yf_texture_init(&data);
-    free(data.data);
+    YF_FREE(data.data);
 
     if (rz->tex == NULL)
         return -1;
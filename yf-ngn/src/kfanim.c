@@ -16,6 +16,7 @@
 #endif
 
 #include "yf/com/yf-util.h"
+#include "yf/com/yf-mem.h"
 #include "yf/com/yf-error.h"
 
 #include "yf-kfanim.h"
@@ -122,20 +123,20 @@ yf_kfanim_t *yf_kfanim_init(const yf_kfin_t *inputs, unsigned input_n,
 
     /* TODO: Ensure that all 'inputs'/'outputs' are referenced by 'acts'. */
 
-    yf_kfanim_t *anim = calloc(1, sizeof(yf_kfanim_t));
+    yf_kfanim_t *anim = YF_CALLOC("anim", 1, sizeof(yf_kfanim_t));
     if (anim == NULL) {
         yf_seterr(YF_ERR_NOMEM, __func__);
         return NULL;
     }
-    anim->targets = calloc(act_n, sizeof(yf_node_t *));
+    anim->targets = YF_CALLOC("anim", act_n, sizeof(yf_node_t *));
     if (anim->targets == NULL) {
         yf_seterr(YF_ERR_NOMEM, __func__);
-        free(anim);
+        YF_FREE(anim);
         return NULL;
     }
 
     /* inputs */
-    anim->inputs = calloc(input_n, sizeof *inputs);
+    anim->inputs = YF_CALLOC("anim", input_n, sizeof *inputs);
     if (anim->inputs == NULL) {
         yf_seterr(YF_ERR_NOMEM, __func__);
         yf_kfanim_deinit(anim);
@@ -150,7 +151,7 @@ yf_kfanim_t *yf_kfanim_init(const yf_kfin_t *inputs, unsigned input_n,
         assert(inputs[i].timeline != NULL && inputs[i].n > 0);
 
         const size_t sz = inputs[i].n * sizeof *inputs[i].timeline;
-        anim->inputs[i].timeline = malloc(sz);
+        anim->inputs[i].timeline = YF_MALLOC("anim", sz);
         if (anim->inputs[i].timeline == NULL) {
             yf_seterr(YF_ERR_NOMEM, __func__);
             yf_kfanim_deinit(anim);
@@ -171,7 +172,7 @@ yf_kfanim_t *yf_kfanim_init(const yf_kfin_t *inputs, unsigned input_n,
     anim->duration = tm_max - tm_min;
 
     /* outputs */
-    anim->outputs = calloc(output_n, sizeof *outputs);
+    anim->outputs = YF_CALLOC("anim", output_n, sizeof *outputs);
     if (anim->outputs == NULL) {
         yf_seterr(YF_ERR_NOMEM, __func__);
         yf_kfanim_deinit(anim);
@@ -186,7 +187,7 @@ yf_kfanim_t *yf_kfanim_init(const yf_kfin_t *inputs, unsigned input_n,
         switch (outputs[i].kfprop) {
         case YF_KFPROP_T:
             sz = outputs[i].n * sizeof *outputs[i].t;
-            anim->outputs[i].t = malloc(sz);
+            anim->outputs[i].t = YF_MALLOC("anim", sz);
             if (anim->outputs[i].t == NULL) {
                 yf_seterr(YF_ERR_NOMEM, __func__);
                 yf_kfanim_deinit(anim);
@@ -197,7 +198,7 @@ yf_kfanim_t *yf_kfanim_init(const yf_kfin_t *inputs, unsigned input_n,
 
         case YF_KFPROP_R:
             sz = outputs[i].n * sizeof *outputs[i].r;
-            anim->outputs[i].r = malloc(sz);
+            anim->outputs[i].r = YF_MALLOC("anim", sz);
             if (anim->outputs[i].r == NULL) {
                 yf_seterr(YF_ERR_NOMEM, __func__);
                 yf_kfanim_deinit(anim);
@@ -208,7 +209,7 @@ yf_kfanim_t *yf_kfanim_init(const yf_kfin_t *inputs, unsigned input_n,
 
         case YF_KFPROP_S:
             sz = outputs[i].n * sizeof *outputs[i].s;
-            anim->outputs[i].s = malloc(sz);
+            anim->outputs[i].s = YF_MALLOC("anim", sz);
             if (anim->outputs[i].s == NULL) {
                 yf_seterr(YF_ERR_NOMEM, __func__);
                 yf_kfanim_deinit(anim);
@@ -229,7 +230,7 @@ yf_kfanim_t *yf_kfanim_init(const yf_kfin_t *inputs, unsigned input_n,
     }
 
     /* acts */
-    anim->acts = malloc(act_n * sizeof *acts);
+    anim->acts = YF_MALLOC("anim", act_n * sizeof *acts);
     if (anim->acts == NULL) {
         yf_seterr(YF_ERR_NOMEM, __func__);
         yf_kfanim_deinit(anim);
@@ -389,32 +390,32 @@ void yf_kfanim_deinit(yf_kfanim_t *anim)
 
     if (anim->inputs != NULL) {
         for (unsigned i = 0; i < anim->input_n; i++)
-            free(anim->inputs[i].timeline);
-        free(anim->inputs);
+            YF_FREE(anim->inputs[i].timeline);
+        YF_FREE(anim->inputs);
     }
 
     if (anim->outputs != NULL) {
         for (unsigned i = 0; i < anim->output_n; i++) {
             switch (anim->outputs[i].kfprop) {
             case YF_KFPROP_T:
-                free(anim->outputs[i].t);
+                YF_FREE(anim->outputs[i].t);
                 break;
             case YF_KFPROP_R:
-                free(anim->outputs[i].r);
+                YF_FREE(anim->outputs[i].r);
                 break;
             case YF_KFPROP_S:
-                free(anim->outputs[i].s);
+                YF_FREE(anim->outputs[i].s);
                 break;
             default:
                 break;
             }
         }
-        free(anim->outputs);
+        YF_FREE(anim->outputs);
     }
 
-    free(anim->acts);
-    free(anim->targets);
-    free(anim);
+    YF_FREE(anim->acts);
+    YF_FREE(anim->targets);
+    YF_FREE(anim);
 }
 
 /*
@@ -77,6 +77,9 @@ static yf_mesh_t *tail_ = NULL;
 /* Number of invalid meshes. */
 static size_t inval_n_ = 0;
 
+/* Indicates that device memory is under pressure. */
+static int press_ = 0;
+
 /* Resizes the buffer instance. */
 static size_t resize_buf(size_t new_len)
 {
@@ -231,6 +234,26 @@ static void try_release(void)
     }
 }
 
+/* Shrinks buffer instance to fit the meshes in use. */
+static void shrink_mem(void)
+{
+    assert(ctx_ != NULL);
+    assert(buf_ != NULL);
+
+    try_release();
+
+    /* unused memory must be contiguous and located at the end */
+    if (trim_mem() != 0 || blk_n_ != 1 || blks_[0].prev_mesh != tail_)
+        return;
+
+    const size_t used = blks_[0].offset;
+    const size_t buf_len = yf_buffer_getsize(buf_);
+    const size_t new_len = resize_buf(used);
+
+    if (new_len < buf_len)
+        blks_[0].size = new_len - used;
+}
+
 /* Copies mesh data to buffer instance and updates mesh object. */
 static int copy_data(yf_mesh_t *mesh, const void *data, size_t size)
 {
@@ -385,6 +408,11 @@ yf_mesh_t *yf_mesh_init(const yf_meshdt_t *data)
         tail_ = NULL;
 
         inval_n_ = 0;
+
+    } else if (press_) {
+        /* give unused memory back before allocating more */
+        shrink_mem();
+        press_ = 0;
     }
 
     yf_mesh_t *mesh = calloc(1, sizeof(yf_mesh_t));
@@ -632,6 +660,12 @@ void yf_mesh_draw(yf_mesh_t *mesh, yf_cmdbuf_t *cmdb, unsigned inst_n)
     }
 }
 
+/* Called by 'coreobj' on memory pressure. */
+void yf_pressmesh(void)
+{
+    press_ = 1;
+}
+
 /* Called by 'coreobj' on exit. */
 void yf_unsetmesh(void)
 {
@@ -9,6 +9,8 @@
 #include <string.h>
 #include <assert.h>
 
+#include "yf/com/yf-arena.h"
+#include "yf/com/yf-mem.h"
 #include "yf/com/yf-error.h"
 
 #include "node.h"
@@ -40,7 +42,7 @@ struct yf_node {
 
 yf_node_t *yf_node_init(void)
 {
-    yf_node_t *node = malloc(sizeof(yf_node_t));
+    yf_node_t *node = YF_MALLOC("node", sizeof(yf_node_t));
     if (node == NULL) {
         yf_seterr(YF_ERR_NOMEM, __func__);
         return NULL;
@@ -153,11 +155,15 @@ int yf_node_traverse(yf_node_t *node,
     if (node->child == NULL)
         return 0;
 
-    yf_node_t **queue = malloc(node->n * sizeof(yf_node_t *));
-    if (queue == NULL) {
-        yf_seterr(YF_ERR_NOMEM, __func__);
+    /* the queue is transient and is taken from the thread's arena */
+    yf_arena_t *arena = yf_arena_getthrd();
+    if (arena == NULL)
+        return -1;
+    const size_t mark = yf_arena_getmark(arena);
+
+    yf_node_t **queue = yf_arena_alloc(arena, node->n * sizeof(yf_node_t *));
+    if (queue == NULL)
         return -1;
-    }
 
     queue[0] = node;
     yf_node_t *next = NULL;
@@ -167,7 +173,7 @@ int yf_node_traverse(yf_node_t *node,
         next = queue[cur_i]->child;
         while (next != NULL) {
             if (fn(next, arg) != 0) {
-                free(queue);
+                yf_arena_reset(arena, mark);
                 return 0;
             }
             if (next->child != NULL)
@@ -176,7 +182,7 @@ int yf_node_traverse(yf_node_t *node,
         }
     } while (++cur_i <= last_i);
 
-    free(queue);
+    yf_arena_reset(arena, mark);
     return 0;
 }
 
@@ -292,14 +298,14 @@ int yf_node_setname(yf_node_t *node, const char *name)
     assert(node != NULL);
 
     if (name == NULL) {
-        free(node->name);
+        YF_FREE(node->name);
         node->name = NULL;
         return 0;
     }
 
     const size_t len = strlen(name);
     if (node->name == NULL) {
-        node->name = malloc(1+len);
+        node->name = YF_MALLOC("node", 1+len);
         if (node->name == NULL) {
             yf_seterr(YF_ERR_NOMEM, __func__);
             return -1;
@@ -307,7 +313,7 @@ int yf_node_setname(yf_node_t *node, const char *name)
     } else {
         const size_t cur_len = strlen(node->name);
         if (cur_len != len) {
-            void *tmp = realloc(node->name, 1+len);
+            void *tmp = YF_REALLOC("node", node->name, 1+len);
             if (tmp != NULL) {
                 node->name = tmp;
             } else if (cur_len < len) {
@@ -348,8 +354,8 @@ void yf_node_deinit(yf_node_t *node)
 
     yf_node_drop(node);
     yf_node_prune(node);
-    free(node->name);
-    free(node);
+    YF_FREE(node->name);
+    YF_FREE(node);
 }
 
 void yf_node_setobj(yf_node_t *node, int nodeobj, void *obj,
@@ -815,10 +815,14 @@ int yf_resmgr_setallocn(int resrq, unsigned n)
                 deinit_entry(resrq);
                 return -1;
             }
-            memset(tmp, 0, n);
+            /* existing allocations remain valid */
+            const unsigned cur_n = entries_[resrq].n;
+            if (n > cur_n)
+                memset(tmp+cur_n, 0, n - cur_n);
             entries_[resrq].obtained = tmp;
             entries_[resrq].n = n;
-            entries_[resrq].i = 0;
+            if (entries_[resrq].i >= n)
+                entries_[resrq].i = 0;
         } else {
             deinit_entry(resrq);
         }
@@ -860,3 +864,17 @@ void yf_resmgr_clear(void)
     yf_dtable_deinit(globl_);
     globl_ = NULL;
 }
+
+void yf_resmgr_evict(void)
+{
+    for (unsigned i = 0; i < YF_RESRQ_N; i++) {
+        if (entries_[i].gst == NULL)
+            continue;
+
+        unsigned j = 0;
+        while (j < entries_[i].n && !entries_[i].obtained[j])
+            j++;
+        if (j == entries_[i].n)
+            deinit_entry(i);
+    }
+}
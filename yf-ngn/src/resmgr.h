@@ -49,6 +49,10 @@ void yf_resmgr_dealloc(int resrq);
 /* Deallocates all resources. */
 void yf_resmgr_clear(void);
 
+/* Deallocates resources that have no obtained instance.
+   Evicted resources are allocated again on next 'obtain'. */
+void yf_resmgr_evict(void);
+
 /*
  * Conventions
  */
@@ -8,15 +8,21 @@
 /* XXX */
 #define YF_SCN_DYNAMIC
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <math.h>
 #include <assert.h>
 
 #include "yf/com/yf-util.h"
 #include "yf/com/yf-list.h"
+#include "yf/com/yf-vec.h"
 #include "yf/com/yf-dict.h"
+#include "yf/com/yf-arena.h"
+#include "yf/com/yf-prof.h"
+#include "yf/com/yf-mem.h"
 #include "yf/com/yf-error.h"
 #include "yf/core/yf-cmdbuf.h"
+#include "yf/core/yf-debug.h"
 #include "yf/core/yf-limits.h"
 
 #include "scene.h"
@@ -101,6 +107,8 @@
 #define YF_INSTCAP 16
 static_assert(YF_INSTCAP > 1);
 
+#define YF_FRAMESZ 16384
+
 struct yf_scene {
     yf_node_t *node;
     yf_camera_t *cam;
@@ -126,12 +134,16 @@ typedef struct {
     yf_list_t *res_obtd;
     yf_cmdbuf_t *cb;
     yf_dict_t *mdls;
-    yf_list_t *terrs;
-    yf_list_t *parts;
-    yf_list_t *quads;
-    yf_list_t *labls;
+    yf_vec_t *terrs;
+    yf_vec_t *parts;
+    yf_vec_t *quads;
+    yf_vec_t *labls;
     yf_light_t *lights[YF_LIGHTN];
     unsigned light_n;
+    /* storage for the current frame, released by 'clear_obj()' */
+    yf_arena_t *arena;
+    /* serial of the last execution, whose resources may be in use */
+    uint64_t serial;
 } vars_t;
 
 /* Entry in the list of obtained resources. */
@@ -172,9 +184,8 @@ static int traverse_scn(yf_node_t *node, void *arg)
 
         if (val == NULL) {
             /* new unique model */
-            val = malloc(sizeof *val);
+            val = yf_arena_alloc(vars_.arena, sizeof *val);
             if (val == NULL) {
-                yf_seterr(YF_ERR_NOMEM, __func__);
                 *(int *)arg = -1;
                 return -1;
             }
@@ -182,7 +193,6 @@ static int traverse_scn(yf_node_t *node, void *arg)
             val->key = key.key;
             if (yf_dict_insert(vars_.mdls, val, val) != 0) {
                 yf_seterr(YF_ERR_NOMEM, __func__);
-                free(val);
                 *(int *)arg = -1;
                 return -1;
             }
@@ -195,9 +205,9 @@ static int traverse_scn(yf_node_t *node, void *arg)
             /* model with shared resources */
             if (val->mdl_n == val->mdl_cap) {
                 if (val->mdl_cap == 1) {
-                    yf_model_t **mdls = malloc(YF_INSTCAP * sizeof mdl);
+                    yf_model_t **mdls =
+                        yf_arena_alloc(vars_.arena, YF_INSTCAP * sizeof mdl);
                     if (mdls == NULL) {
-                        yf_seterr(YF_ERR_NOMEM, __func__);
                         *(int *)arg = -1;
                         return -1;
                     }
@@ -207,10 +217,10 @@ static int traverse_scn(yf_node_t *node, void *arg)
                     val->mdl_cap = YF_INSTCAP;
 
                 } else {
+                    const size_t sz = val->mdl_cap * sizeof mdl;
                     yf_model_t **mdls =
-                        realloc(val->mdls, (val->mdl_cap * sizeof mdl) << 1);
+                        yf_arena_realloc(vars_.arena, val->mdls, sz, sz << 1);
                     if (mdls == NULL) {
-                        yf_seterr(YF_ERR_NOMEM, __func__);
                         *(int *)arg = -1;
                         return -1;
                     }
@@ -225,28 +235,28 @@ static int traverse_scn(yf_node_t *node, void *arg)
     } break;
 
     case YF_NODEOBJ_TERRAIN:
-        if (yf_list_insert(vars_.terrs, obj) != 0) {
+        if (yf_vec_push(vars_.terrs, &obj) != 0) {
             *(int *)arg = -1;
             return -1;
         }
         break;
 
     case YF_NODEOBJ_PARTICLE:
-        if (yf_list_insert(vars_.parts, obj) != 0) {
+        if (yf_vec_push(vars_.parts, &obj) != 0) {
             *(int *)arg = -1;
             return -1;
         }
         break;
 
     case YF_NODEOBJ_QUAD:
-        if (yf_list_insert(vars_.quads, obj) != 0) {
+        if (yf_vec_push(vars_.quads, &obj) != 0) {
             *(int *)arg = -1;
             return -1;
         }
         break;
 
     case YF_NODEOBJ_LABEL:
-        if (yf_list_insert(vars_.labls, obj) != 0) {
+        if (yf_vec_push(vars_.labls, &obj) != 0) {
             *(int *)arg = -1;
             return -1;
         }
@@ -303,10 +313,10 @@ static int prepare_res(void)
     vars_.insts[YF_RESRQ_MDL16] = 0;
     vars_.insts[YF_RESRQ_MDL32] = 0;
     vars_.insts[YF_RESRQ_MDL64] = 0;
-    vars_.insts[YF_RESRQ_TERR]  = yf_list_getlen(vars_.terrs);
-    vars_.insts[YF_RESRQ_PART]  = yf_list_getlen(vars_.parts);
-    vars_.insts[YF_RESRQ_QUAD]  = yf_list_getlen(vars_.quads);
-    vars_.insts[YF_RESRQ_LABL]  = yf_list_getlen(vars_.labls);
+    vars_.insts[YF_RESRQ_TERR]  = yf_vec_getlen(vars_.terrs);
+    vars_.insts[YF_RESRQ_PART]  = yf_vec_getlen(vars_.parts);
+    vars_.insts[YF_RESRQ_QUAD]  = yf_vec_getlen(vars_.quads);
+    vars_.insts[YF_RESRQ_LABL]  = yf_vec_getlen(vars_.labls);
 
     yf_iter_t it = YF_NILIT;
     kv_mdl_t *kv_mdl;
@@ -478,12 +488,8 @@ static yf_gstate_t *obtain_res(int resrq, unsigned *inst_alloc)
     if (gst == NULL)
         return NULL;
 
-    reso_t *reso = malloc(sizeof *reso);
+    reso_t *reso = yf_arena_alloc(vars_.arena, sizeof *reso);
     if (reso == NULL || yf_list_insert(vars_.res_obtd, reso) != 0) {
-        if (reso == NULL)
-            yf_seterr(YF_ERR_NOMEM, __func__);
-        else
-            free(reso);
         yf_resmgr_yield(resrq, *inst_alloc);
         return NULL;
     }
@@ -1077,9 +1083,12 @@ static int render_mdl(yf_scene_t *scn)
         }
     }
 
-    yf_list_t *done = yf_list_init(NULL);
+    /* entries that were fully rendered */
+    const size_t kv_n = yf_dict_getlen(vars_.mdls);
+    kv_mdl_t **done = yf_arena_alloc(vars_.arena, kv_n * sizeof *done);
     if (done == NULL)
         return -1;
+    size_t done_n = 0;
 
     yf_iter_t it = YF_NILIT;
     kv_mdl_t *val;
@@ -1124,16 +1133,16 @@ static int render_mdl(yf_scene_t *scn)
                     val->mdl_n = rem;
                     break;
                 } else {
-                    yf_list_deinit(done);
                     return -1;
                 }
             }
 
             yf_dtable_t *inst_dtb = yf_gstate_getdtb(gst, YF_RESIDX_INST);
-            if (copy_inst_mdl(scn, mdls+rem, n, inst_dtb, inst_alloc) != 0) {
-                yf_list_deinit(done);
+            YF_PROF_BEGIN("copy_inst");
+            const int r = copy_inst_mdl(scn, mdls+rem, n, inst_dtb, inst_alloc);
+            YF_PROF_END();
+            if (r != 0)
                 return -1;
-            }
 
             yf_cmdbuf_setgstate(vars_.cb, gst);
             yf_cmdbuf_setdtable(vars_.cb, YF_RESIDX_INST, inst_alloc);
@@ -1143,10 +1152,8 @@ static int render_mdl(yf_scene_t *scn)
                 /* TODO: Multiple materials. */
                 yf_material_t *matl = yf_mesh_getmatl(mesh, 0);
                 if (matl != NULL) {
-                    if (copy_matl(matl, inst_dtb, inst_alloc) != 0) {
-                        yf_list_deinit(done);
+                    if (copy_matl(matl, inst_dtb, inst_alloc) != 0)
                         return -1;
-                    }
                 } else {
                     /* TODO */
                     assert(0);
@@ -1161,22 +1168,14 @@ static int render_mdl(yf_scene_t *scn)
 
             if (rem == 0) {
                 /* cannot invalidate the dictionary iterator */
-                if (yf_list_insert(done, val) == 0)
-                    break;
-                yf_list_deinit(done);
-                return -1;
+                done[done_n++] = val;
+                break;
             }
         }
     }
 
-    while ((val = yf_list_removeat(done, NULL)) != NULL) {
-        yf_dict_remove(vars_.mdls, val);
-        if (val->mdl_cap > 1)
-            free(val->mdls);
-        free(val);
-    }
-
-    yf_list_deinit(done);
+    while (done_n > 0)
+        yf_dict_remove(vars_.mdls, done[--done_n]);
 
     return 0;
 }
@@ -1184,12 +1183,11 @@ static int render_mdl(yf_scene_t *scn)
 /* Renders terrain objects. */
 static int render_terr(yf_scene_t *scn)
 {
-    yf_iter_t it = YF_NILIT;
+    size_t n;
 
-    while (1) {
-        yf_terrain_t *terr = yf_list_next(vars_.terrs, &it);
-        if (YF_IT_ISNIL(it))
-            break;
+    /* last inserted objects are rendered first */
+    while ((n = yf_vec_getlen(vars_.terrs)) > 0) {
+        yf_terrain_t *terr = *YF_VEC_AT(vars_.terrs, yf_terrain_t *, n-1);
 
         unsigned inst_alloc;
         yf_gstate_t *gst = obtain_res(YF_RESRQ_TERR, &inst_alloc);
@@ -1204,7 +1202,10 @@ static int render_terr(yf_scene_t *scn)
         }
 
         yf_dtable_t *inst_dtb = yf_gstate_getdtb(gst, YF_RESIDX_INST);
-        if (copy_inst_terr(scn, &terr, 1, inst_dtb, inst_alloc) != 0)
+        YF_PROF_BEGIN("copy_inst");
+        const int r = copy_inst_terr(scn, &terr, 1, inst_dtb, inst_alloc);
+        YF_PROF_END();
+        if (r != 0)
             return -1;
 
         yf_texture_t *hmap = yf_terrain_gethmap(terr);
@@ -1231,8 +1232,7 @@ static int render_terr(yf_scene_t *scn)
         yf_mesh_t *mesh = yf_terrain_getmesh(terr);
         yf_mesh_draw(mesh, vars_.cb, 1);
 
-        yf_list_removeat(vars_.terrs, &it);
-        it = YF_NILIT;
+        yf_vec_pop(vars_.terrs, NULL);
     }
 
     return 0;
@@ -1241,12 +1241,11 @@ static int render_terr(yf_scene_t *scn)
 /* Renders particle system objects. */
 static int render_part(yf_scene_t *scn)
 {
-    yf_iter_t it = YF_NILIT;
+    size_t n;
 
-    while (1) {
-        yf_particle_t *part = yf_list_next(vars_.parts, &it);
-        if (YF_IT_ISNIL(it))
-            break;
+    /* last inserted objects are rendered first */
+    while ((n = yf_vec_getlen(vars_.parts)) > 0) {
+        yf_particle_t *part = *YF_VEC_AT(vars_.parts, yf_particle_t *, n-1);
 
         unsigned inst_alloc;
         yf_gstate_t *gst = obtain_res(YF_RESRQ_PART, &inst_alloc);
@@ -1261,7 +1260,10 @@ static int render_part(yf_scene_t *scn)
         }
 
         yf_dtable_t *inst_dtb = yf_gstate_getdtb(gst, YF_RESIDX_INST);
-        if (copy_inst_part(scn, &part, 1, inst_dtb, inst_alloc) != 0)
+        YF_PROF_BEGIN("copy_inst");
+        const int r = copy_inst_part(scn, &part, 1, inst_dtb, inst_alloc);
+        YF_PROF_END();
+        if (r != 0)
             return -1;
 
         yf_texture_t *tex = yf_particle_gettex(part);
@@ -1279,8 +1281,7 @@ static int render_part(yf_scene_t *scn)
         yf_mesh_t *mesh = yf_particle_getmesh(part);
         yf_mesh_draw(mesh, vars_.cb, 1);
 
-        yf_list_removeat(vars_.parts, &it);
-        it = YF_NILIT;
+        yf_vec_pop(vars_.parts, NULL);
     }
 
     return 0;
@@ -1289,12 +1290,11 @@ static int render_part(yf_scene_t *scn)
 /* Renders quad objects. */
 static int render_quad(yf_scene_t *scn)
 {
-    yf_iter_t it = YF_NILIT;
+    size_t n;
 
-    while (1) {
-        yf_quad_t *quad = yf_list_next(vars_.quads, &it);
-        if (YF_IT_ISNIL(it))
-            break;
+    /* last inserted objects are rendered first */
+    while ((n = yf_vec_getlen(vars_.quads)) > 0) {
+        yf_quad_t *quad = *YF_VEC_AT(vars_.quads, yf_quad_t *, n-1);
 
         unsigned inst_alloc;
         yf_gstate_t *gst = obtain_res(YF_RESRQ_QUAD, &inst_alloc);
@@ -1309,7 +1309,10 @@ static int render_quad(yf_scene_t *scn)
         }
 
         yf_dtable_t *inst_dtb = yf_gstate_getdtb(gst, YF_RESIDX_INST);
-        if (copy_inst_quad(scn, &quad, 1, inst_dtb, inst_alloc) != 0)
+        YF_PROF_BEGIN("copy_inst");
+        const int r = copy_inst_quad(scn, &quad, 1, inst_dtb, inst_alloc);
+        YF_PROF_END();
+        if (r != 0)
             return -1;
 
         yf_texture_t *tex = yf_quad_gettex(quad);
@@ -1327,8 +1330,7 @@ static int render_quad(yf_scene_t *scn)
         yf_mesh_t *mesh = yf_quad_getmesh(quad);
         yf_mesh_draw(mesh, vars_.cb, 1);
 
-        yf_list_removeat(vars_.quads, &it);
-        it = YF_NILIT;
+        yf_vec_pop(vars_.quads, NULL);
     }
 
     return 0;
@@ -1337,12 +1339,11 @@ static int render_quad(yf_scene_t *scn)
 /* Renders label objects. */
 static int render_labl(yf_scene_t *scn)
 {
-    yf_iter_t it = YF_NILIT;
+    size_t n;
 
-    while (1) {
-        yf_label_t *labl = yf_list_next(vars_.labls, &it);
-        if (YF_IT_ISNIL(it))
-            break;
+    /* last inserted objects are rendered first */
+    while ((n = yf_vec_getlen(vars_.labls)) > 0) {
+        yf_label_t *labl = *YF_VEC_AT(vars_.labls, yf_label_t *, n-1);
 
         unsigned inst_alloc;
         yf_gstate_t *gst = obtain_res(YF_RESRQ_LABL, &inst_alloc);
@@ -1357,7 +1358,10 @@ static int render_labl(yf_scene_t *scn)
         }
 
         yf_dtable_t *inst_dtb = yf_gstate_getdtb(gst, YF_RESIDX_INST);
-        if (copy_inst_labl(scn, &labl, 1, inst_dtb, inst_alloc) != 0)
+        YF_PROF_BEGIN("copy_inst");
+        const int r = copy_inst_labl(scn, &labl, 1, inst_dtb, inst_alloc);
+        YF_PROF_END();
+        if (r != 0)
             return -1;
 
         /* FIXME: Texture may be invalid. */
@@ -1370,8 +1374,7 @@ static int render_labl(yf_scene_t *scn)
         yf_mesh_t *mesh = yf_label_getmesh(labl);
         yf_mesh_draw(mesh, vars_.cb, 1);
 
-        yf_list_removeat(vars_.labls, &it);
-        it = YF_NILIT;
+        yf_vec_pop(vars_.labls, NULL);
     }
 
     return 0;
@@ -1395,40 +1398,26 @@ static int cmp_mdl(const void *a, const void *b)
     return kv1->key.mesh != kv2->key.mesh;
 }
 
-/* Deallocates a 'kv_mdl_t'. */
-static int dealloc_mdl(YF_UNUSED void *key, void *val, YF_UNUSED void *arg)
-{
-    kv_mdl_t *kv = val;
-
-    if (kv->mdl_cap > 1)
-        free(kv->mdls);
-
-    free(val);
-    return 0;
-}
-
 /* Yields all previously obtained resources. */
 static void yield_res(void)
 {
     reso_t *val;
-    while ((val = yf_list_removeat(vars_.res_obtd, NULL)) != NULL) {
+    while ((val = yf_list_removeat(vars_.res_obtd, NULL)) != NULL)
         yf_resmgr_yield(val->resrq, val->inst_alloc);
-        free(val);
-    }
 }
 
 /* Clears data structures of all objects. */
 static void clear_obj(void)
 {
-    if (yf_dict_getlen(vars_.mdls) != 0) {
-        yf_dict_each(vars_.mdls, dealloc_mdl, NULL);
-        yf_dict_clear(vars_.mdls);
-    }
-    yf_list_clear(vars_.terrs);
-    yf_list_clear(vars_.parts);
-    yf_list_clear(vars_.quads);
-    yf_list_clear(vars_.labls);
+    /* capacity is kept for the next frame */
+    if (yf_dict_getlen(vars_.mdls) != 0)
+        yf_dict_reset(vars_.mdls);
+    yf_vec_clear(vars_.terrs);
+    yf_vec_clear(vars_.parts);
+    yf_vec_clear(vars_.quads);
+    yf_vec_clear(vars_.labls);
     vars_.light_n = 0;
+    yf_arena_reset(vars_.arena, 0);
 }
 
 /* Deinitializes shared variables and releases resources. */
@@ -1441,14 +1430,12 @@ static void deinit_vars(void)
     yf_buffer_deinit(vars_.buf);
     yf_list_deinit(vars_.res_obtd);
 
-    if (vars_.mdls != NULL) {
-        yf_dict_each(vars_.mdls, dealloc_mdl, NULL);
-        yf_dict_deinit(vars_.mdls);
-    }
-    yf_list_deinit(vars_.terrs);
-    yf_list_deinit(vars_.parts);
-    yf_list_deinit(vars_.quads);
-    yf_list_deinit(vars_.labls);
+    yf_dict_deinit(vars_.mdls);
+    yf_vec_deinit(vars_.terrs);
+    yf_vec_deinit(vars_.parts);
+    yf_vec_deinit(vars_.quads);
+    yf_vec_deinit(vars_.labls);
+    yf_arena_deinit(vars_.arena);
 
     memset(&vars_, 0, sizeof vars_);
 }
@@ -1463,10 +1450,11 @@ static int init_vars(void)
 
     if ((vars_.res_obtd = yf_list_init(NULL)) == NULL ||
         (vars_.mdls = yf_dict_init(hash_mdl, cmp_mdl)) == NULL ||
-        (vars_.terrs = yf_list_init(NULL)) == NULL ||
-        (vars_.parts = yf_list_init(NULL)) == NULL ||
-        (vars_.quads = yf_list_init(NULL)) == NULL ||
-        (vars_.labls = yf_list_init(NULL)) == NULL) {
+        (vars_.terrs = yf_vec_init(sizeof(void *))) == NULL ||
+        (vars_.parts = yf_vec_init(sizeof(void *))) == NULL ||
+        (vars_.quads = yf_vec_init(sizeof(void *))) == NULL ||
+        (vars_.labls = yf_vec_init(sizeof(void *))) == NULL ||
+        (vars_.arena = yf_arena_init(YF_FRAMESZ)) == NULL) {
 
         deinit_vars();
         return -1;
@@ -1504,7 +1492,7 @@ static int init_vars(void)
 
 yf_scene_t *yf_scene_init(void)
 {
-    yf_scene_t *scn = calloc(1, sizeof(yf_scene_t));
+    yf_scene_t *scn = YF_CALLOC("scene", 1, sizeof(yf_scene_t));
     if (scn == NULL) {
         yf_seterr(YF_ERR_NOMEM, __func__);
         return NULL;
@@ -1553,7 +1541,7 @@ void yf_scene_deinit(yf_scene_t *scn)
 
     yf_camera_deinit(scn->cam);
     yf_node_deinit(scn->node);
-    free(scn);
+    YF_FREE(scn);
 }
 
 int yf_scene_render(yf_scene_t *scn, yf_pass_t *pass, yf_target_t *tgt,
@@ -1567,19 +1555,35 @@ int yf_scene_render(yf_scene_t *scn, yf_pass_t *pass, yf_target_t *tgt,
     if (vars_.ctx == NULL && init_vars() != 0)
         return -1;
 
+    yf_handlepress();
+
     yf_camera_adjust(scn->cam, (float)dim.width / (float)dim.height);
     YF_VIEWPORT_FROMDIM2(dim, scn->vport);
     YF_VIEWPORT_SCISSOR(scn->vport, scn->sciss);
 
     int r = 0;
+    YF_PROF_BEGIN("traverse");
     yf_node_traverse(scn->node, traverse_scn, &r);
+    YF_PROF_END();
+    if (r != 0) {
+        clear_obj();
+        return -1;
+    }
+
+    /* the previous frame must complete before its resources are updated */
+    YF_PROF_BEGIN("wait");
+    r = yf_cmdbuf_wait(vars_.ctx, vars_.serial);
+    YF_PROF_END();
     if (r != 0) {
         clear_obj();
         return -1;
     }
 
 #ifdef YF_SCN_DYNAMIC
-    if (prepare_res() != 0) {
+    YF_PROF_BEGIN("prepare_res");
+    r = prepare_res();
+    YF_PROF_END();
+    if (r != 0) {
         clear_obj();
         return -1;
     }
@@ -1588,13 +1592,13 @@ int yf_scene_render(yf_scene_t *scn, yf_pass_t *pass, yf_target_t *tgt,
     unsigned pend = YF_PEND_NONE;
     if (yf_dict_getlen(vars_.mdls) != 0)
         pend |= YF_PEND_MDL;
-    if (yf_list_getlen(vars_.terrs) != 0)
+    if (yf_vec_getlen(vars_.terrs) != 0)
         pend |= YF_PEND_TERR;
-    if (yf_list_getlen(vars_.parts) != 0)
+    if (yf_vec_getlen(vars_.parts) != 0)
         pend |= YF_PEND_PART;
-    if (yf_list_getlen(vars_.quads) != 0)
+    if (yf_vec_getlen(vars_.quads) != 0)
         pend |= YF_PEND_QUAD;
-    if (yf_list_getlen(vars_.labls) != 0)
+    if (yf_vec_getlen(vars_.labls) != 0)
         pend |= YF_PEND_LABL;
 
     if ((vars_.cb = yf_cmdbuf_get(vars_.ctx, YF_CMDBUF_GRAPH)) == NULL) {
@@ -1644,6 +1648,7 @@ int yf_scene_render(yf_scene_t *scn, yf_pass_t *pass, yf_target_t *tgt,
         yf_cmdbuf_setsciss(vars_.cb, 0, scn->sciss);
 
         if (pend & YF_PEND_MDL) {
+            yf_cmdbuf_beginlabel(vars_.cb, "models");
             if (render_mdl(scn) != 0) {
                 yf_cmdbuf_end(vars_.cb);
                 yf_cmdbuf_reset(vars_.ctx);
@@ -1651,11 +1656,13 @@ int yf_scene_render(yf_scene_t *scn, yf_pass_t *pass, yf_target_t *tgt,
                 clear_obj();
                 return -1;
             }
+            yf_cmdbuf_endlabel(vars_.cb);
             if (yf_dict_getlen(vars_.mdls) == 0)
                 pend &= ~YF_PEND_MDL;
         }
 
         if (pend & YF_PEND_TERR) {
+            yf_cmdbuf_beginlabel(vars_.cb, "terrain");
             if (render_terr(scn) != 0) {
                 yf_cmdbuf_end(vars_.cb);
                 yf_cmdbuf_reset(vars_.ctx);
@@ -1663,11 +1670,13 @@ int yf_scene_render(yf_scene_t *scn, yf_pass_t *pass, yf_target_t *tgt,
                 clear_obj();
                 return -1;
             }
-            if (yf_list_getlen(vars_.terrs) == 0)
+            yf_cmdbuf_endlabel(vars_.cb);
+            if (yf_vec_getlen(vars_.terrs) == 0)
                 pend &= ~YF_PEND_TERR;
         }
 
         if (pend & YF_PEND_PART) {
+            yf_cmdbuf_beginlabel(vars_.cb, "particles");
             if (render_part(scn) != 0) {
                 yf_cmdbuf_end(vars_.cb);
                 yf_cmdbuf_reset(vars_.ctx);
@@ -1675,11 +1684,13 @@ int yf_scene_render(yf_scene_t *scn, yf_pass_t *pass, yf_target_t *tgt,
                 clear_obj();
                 return -1;
             }
-            if (yf_list_getlen(vars_.parts) == 0)
+            yf_cmdbuf_endlabel(vars_.cb);
+            if (yf_vec_getlen(vars_.parts) == 0)
                 pend &= ~YF_PEND_PART;
         }
 
         if (pend & YF_PEND_QUAD) {
+            yf_cmdbuf_beginlabel(vars_.cb, "quads");
             if (render_quad(scn) != 0) {
                 yf_cmdbuf_end(vars_.cb);
                 yf_cmdbuf_reset(vars_.ctx);
@@ -1687,11 +1698,13 @@ int yf_scene_render(yf_scene_t *scn, yf_pass_t *pass, yf_target_t *tgt,
                 clear_obj();
                 return -1;
             }
-            if (yf_list_getlen(vars_.quads) == 0)
+            yf_cmdbuf_endlabel(vars_.cb);
+            if (yf_vec_getlen(vars_.quads) == 0)
                 pend &= ~YF_PEND_QUAD;
         }
 
         if (pend & YF_PEND_LABL) {
+            yf_cmdbuf_beginlabel(vars_.cb, "labels");
             if (render_labl(scn) != 0) {
                 yf_cmdbuf_end(vars_.cb);
                 yf_cmdbuf_reset(vars_.ctx);
@@ -1699,16 +1712,19 @@ int yf_scene_render(yf_scene_t *scn, yf_pass_t *pass, yf_target_t *tgt,
                 clear_obj();
                 return -1;
             }
-            if (yf_list_getlen(vars_.labls) == 0)
+            yf_cmdbuf_endlabel(vars_.cb);
+            if (yf_vec_getlen(vars_.labls) == 0)
                 pend &= ~YF_PEND_LABL;
         }
 
         if (yf_cmdbuf_end(vars_.cb) == 0) {
-            if (yf_cmdbuf_exec(vars_.ctx) != 0) {
+            const uint64_t serial = yf_cmdbuf_getserial(vars_.ctx);
+            if (yf_cmdbuf_submit(vars_.ctx) != 0) {
                 yield_res();
                 clear_obj();
                 return -1;
             }
+            vars_.serial = serial;
         } else {
             yf_cmdbuf_reset(vars_.ctx);
             yield_res();
@@ -1723,6 +1739,11 @@ int yf_scene_render(yf_scene_t *scn, yf_pass_t *pass, yf_target_t *tgt,
         yield_res();
 
         if (pend != YF_PEND_NONE) {
+            /* remaining objects reuse the resources just submitted */
+            if (yf_cmdbuf_wait(vars_.ctx, vars_.serial) != 0) {
+                clear_obj();
+                return -1;
+            }
             vars_.cb = yf_cmdbuf_get(vars_.ctx, YF_CMDBUF_GRAPH);
             if (vars_.cb == NULL) {
                 clear_obj();
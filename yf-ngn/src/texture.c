@@ -13,6 +13,7 @@
 # include <stdio.h>
 #endif
 
+#include "yf/com/yf-util.h"
 #include "yf/com/yf-dict.h"
 #include "yf/com/yf-error.h"
 #include "yf/core/yf-image.h"
@@ -61,6 +62,9 @@ static yf_context_t *ctx_ = NULL;
 /* Dictionary containing all created images. */
 static yf_dict_t *imgs_ = NULL;
 
+/* Indicates that device memory is under pressure. */
+static int press_ = 0;
+
 /* Copies texture data to image and updates texture object. */
 static int copy_data(yf_texture_t *tex, const yf_texdt_t *data)
 {
@@ -81,13 +85,17 @@ static int copy_data(yf_texture_t *tex, const yf_texdt_t *data)
         val = &kv->val;
         dim = (yf_dim3_t){data->dim.width, data->dim.height, 1};
 
-        val->img = yf_image_init(ctx_, data->pixfmt, dim, YF_LAYCAP, 1, 1);
+        /* avoid reserving layers when memory is scarce */
+        layers = press_ ? 1 : YF_LAYCAP;
+        press_ = 0;
+
+        val->img = yf_image_init(ctx_, data->pixfmt, dim, layers, 1, 1);
         if (val->img == NULL) {
             free(kv);
             return -1;
         }
 
-        val->lay_used = calloc(YF_LAYCAP, sizeof *val->lay_used);
+        val->lay_used = calloc(layers, sizeof *val->lay_used);
         if (val->lay_used == NULL) {
             yf_seterr(YF_ERR_NOMEM, __func__);
             yf_image_deinit(val->img);
@@ -106,8 +114,6 @@ static int copy_data(yf_texture_t *tex, const yf_texdt_t *data)
             return -1;
         }
 
-        layers = YF_LAYCAP;
-
     } else {
         /* check layer cap. */
         val = &kv->val;
@@ -117,7 +123,11 @@ static int copy_data(yf_texture_t *tex, const yf_texdt_t *data)
         yf_image_getval(val->img, &pixfmt, &dim, &layers, &levels, &samples);
 
         if (val->lay_n == layers) {
-            const unsigned new_lay_cap = layers << 1;
+            /* growth is limited when memory is scarce */
+            const unsigned new_lay_cap = press_ ?
+                                         layers + YF_MIN(layers, YF_LAYCAP) :
+                                         layers << 1;
+            press_ = 0;
             yf_image_t *new_img = yf_image_init(ctx_, pixfmt, dim, new_lay_cap,
                                                 levels, samples);
             if (new_img == NULL)
@@ -144,7 +154,7 @@ static int copy_data(yf_texture_t *tex, const yf_texdt_t *data)
                 return -1;
             }
 
-            /* XXX: Will crash if old image is in use. */
+            /* destruction is deferred while the old image is in use */
             yf_image_deinit(val->img);
             val->img = new_img;
 
@@ -335,6 +345,12 @@ int yf_texture_copyres2(const yf_texref_t *ref, yf_dtable_t *dtb,
                              &tex->img->img, &tex->layer, &ref->splr);
 }
 
+/* Called by 'coreobj' on memory pressure. */
+void yf_presstex(void)
+{
+    press_ = 1;
+}
+
 /* Called by 'coreobj' on exit. */
 void yf_unsettex(void)
 {
@@ -5,7 +5,9 @@
  * Copyright © 2020 Gustavo C. Viegas.
  */
 
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 #ifndef __STDC_NO_ATOMICS__
@@ -14,10 +16,13 @@
 # error "C11 atomics required"
 #endif
 
+#include "yf/com/yf-util.h"
 #include "yf/com/yf-clock.h"
 #include "yf/com/yf-error.h"
 #include "yf/core/yf-image.h"
 #include "yf/core/yf-wsi.h"
+#include "yf/core/yf-readback.h"
+#include "yf/core/yf-cmdbuf.h"
 #include "yf/wsys/yf-event.h"
 
 #include "yf-view.h"
@@ -33,11 +38,36 @@ struct yf_view {
     yf_target_t **tgts;
     unsigned tgt_n;
     yf_scene_t *scn;
+    yf_frmhist_t *hist;
+
+    /* headless only */
+    yf_dim2_t dim;
+    yf_image_t **clr_imgs;
+    yf_readback_t **rbs;
+    unsigned long *frms;
+    uint64_t *sers;
+    unsigned long frame;
+    void (*callb)(yf_view_t *, unsigned long, const void *, size_t, void *);
+    void *arg;
 };
 
 /* Global pass instance. */
 yf_pass_t *yf_g_pass = NULL;
 
+/* Color format of the global pass. */
+static int pass_fmt_ = YF_PIXFMT_UNDEF;
+
+/* Color format used by headless views. */
+#define YF_HEADLESS_PIXFMT YF_PIXFMT_BGRA8UNORM
+
+/* Maximum number of targets used by headless views.
+   'scene_render()' waits for the previous frame before rendering, so no
+   more than one frame is ever in flight. */
+#define YF_HEADLESS_TGTMAX 2
+
+/* Number of frames whose times are kept by a view's loop. */
+#define YF_FRMWINDOW 600
+
 /* Flag to disallow the creation of multiple views. */
 static atomic_flag flag_ = ATOMIC_FLAG_INIT;
 
@@ -110,6 +140,7 @@ yf_view_t *yf_view_init(yf_window_t *win)
             return NULL;
         }
         yf_g_pass = view->pass;
+        pass_fmt_ = pres_fmt;
 
     } else {
         /* TODO: Ensure that the global pass is compatible with this view. */
@@ -144,7 +175,138 @@ yf_view_t *yf_view_init(yf_window_t *win)
     return view;
 }
 
-/* TODO: Replace 'fps' arg with 'vsync' and fix the pacing. */
+/* Delivers the frame of a completed readback. */
+static void deliver_frame(yf_readback_t *rb, int state, void *arg)
+{
+    yf_view_t *view = arg;
+
+    unsigned i = 0;
+    while (i < view->tgt_n && view->rbs[i] != rb)
+        i++;
+    assert(i < view->tgt_n);
+
+    if (view->callb == NULL)
+        return;
+
+    size_t size = 0;
+    const void *data = NULL;
+    if (state == YF_READBACK_DONE)
+        data = yf_readback_getdata(rb, &size);
+
+    view->callb(view, view->frms[i], data, size, view->arg);
+}
+
+yf_view_t *yf_view_initheadless(yf_dim2_t dim, unsigned tgt_n,
+                                void (*callb)(yf_view_t *view,
+                                              unsigned long frame,
+                                              const void *data, size_t size,
+                                              void *arg),
+                                void *arg)
+{
+    if (dim.width == 0 || dim.height == 0 || tgt_n < 2) {
+        yf_seterr(YF_ERR_INVARG, __func__);
+        return NULL;
+    }
+
+    if (atomic_flag_test_and_set(&flag_)) {
+        yf_seterr(YF_ERR_EXIST, __func__);
+        return NULL;
+    }
+
+    yf_view_t *view = calloc(1, sizeof(yf_view_t));
+    if (view == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        atomic_flag_clear(&flag_);
+        return NULL;
+    }
+    if ((view->ctx = yf_getctx()) == NULL) {
+        yf_view_deinit(view);
+        return NULL;
+    }
+    view->dim = dim;
+    view->callb = callb;
+    view->arg = arg;
+
+    const yf_dim3_t dim3 = {dim.width, dim.height, 1};
+    view->depth_img = yf_image_init(view->ctx, YF_PIXFMT_D16UNORM, dim3, 1,
+                                    1, 1);
+    if (view->depth_img == NULL) {
+        yf_view_deinit(view);
+        return NULL;
+    }
+
+    if (yf_g_pass == NULL) {
+        const yf_colordsc_t clr_dsc = {
+            .pixfmt = YF_HEADLESS_PIXFMT,
+            .samples = 1,
+            /* TODO */
+            .loadop = YF_LOADOP_LOAD,
+            .storeop = YF_STOREOP_STORE
+        };
+        const yf_depthdsc_t dep_dsc = {
+            .pixfmt = YF_PIXFMT_D16UNORM,
+            .samples = 1,
+            .depth_loadop = YF_LOADOP_UNDEF,
+            .depth_storeop = YF_STOREOP_UNDEF,
+            .stencil_loadop = YF_LOADOP_UNDEF,
+            .stencil_storeop = YF_STOREOP_UNDEF
+        };
+
+        view->pass = yf_pass_init(view->ctx, &clr_dsc, 1, NULL, &dep_dsc);
+        if (view->pass == NULL) {
+            yf_view_deinit(view);
+            return NULL;
+        }
+        yf_g_pass = view->pass;
+        pass_fmt_ = YF_HEADLESS_PIXFMT;
+
+    } else if (pass_fmt_ != YF_HEADLESS_PIXFMT) {
+        /* XXX: The global pass cannot be replaced. */
+        yf_seterr(YF_ERR_UNSUP, __func__);
+        yf_view_deinit(view);
+        return NULL;
+
+    } else {
+        view->pass = yf_g_pass;
+    }
+
+    tgt_n = YF_MIN(tgt_n, YF_HEADLESS_TGTMAX);
+    view->tgts = calloc(tgt_n, sizeof(yf_target_t *));
+    view->clr_imgs = calloc(tgt_n, sizeof(yf_image_t *));
+    view->rbs = calloc(tgt_n, sizeof(yf_readback_t *));
+    view->frms = calloc(tgt_n, sizeof(unsigned long));
+    view->sers = calloc(tgt_n, sizeof(uint64_t));
+    if (view->tgts == NULL || view->clr_imgs == NULL || view->rbs == NULL ||
+        view->frms == NULL || view->sers == NULL) {
+        yf_seterr(YF_ERR_NOMEM, __func__);
+        yf_view_deinit(view);
+        return NULL;
+    }
+    view->tgt_n = tgt_n;
+
+    const yf_attach_t dep_att = {view->depth_img, 0};
+
+    for (unsigned i = 0; i < tgt_n; i++) {
+        view->clr_imgs[i] = yf_image_init(view->ctx, YF_HEADLESS_PIXFMT, dim3,
+                                          1, 1, 1);
+        if (view->clr_imgs[i] == NULL) {
+            yf_view_deinit(view);
+            return NULL;
+        }
+
+        const yf_attach_t clr_att = {view->clr_imgs[i], 0};
+        view->tgts[i] = yf_pass_maketarget(view->pass, dim, 1, &clr_att, NULL,
+                                           &dep_att);
+        if (view->tgts[i] == NULL) {
+            yf_view_deinit(view);
+            return NULL;
+        }
+    }
+
+    return view;
+}
+
+/* TODO: Replace 'fps' arg with 'vsync'. */
 int yf_view_loop(yf_view_t *view, yf_scene_t *scn, unsigned fps,
                  int (*update)(double elapsed_time, void *arg), void *arg)
 {
@@ -157,28 +319,50 @@ int yf_view_loop(yf_view_t *view, yf_scene_t *scn, unsigned fps,
         return -1;
     }
 
+    if (view->hist == NULL) {
+        if ((view->hist = yf_frmhist_init(YF_FRMWINDOW)) == NULL)
+            return -1;
+    } else {
+        yf_frmhist_clear(view->hist);
+    }
+
     view->scn = scn;
-    const double rate = (fps == 0) ? (0.0) : (1.0 / (double)fps);
-    double dt = 0.0;
-    double tm = yf_gettime();
+    const uint64_t rate = (fps == 0) ? (0) : (1000000000 / fps);
+    uint64_t dt = 0;
+    uint64_t tm = yf_getns();
     int r = 0;
 
-    while (update(dt, arg) == 0) {
+    while (update((double)dt * 1.0e-9, arg) == 0) {
         if ((r = yf_view_render(view, view->scn)) != 0)
             break;
 
-        if ((dt = yf_gettime() - tm) < rate) {
-            yf_sleep(rate - dt);
-            dt = yf_gettime() - tm;
+        if ((dt = yf_getns() - tm) < rate) {
+            yf_waituntil(tm + rate);
+            dt = yf_getns() - tm;
         }
 
         tm += dt;
+        yf_frmhist_add(view->hist, dt);
     }
 
+    if (r == 0 && view->wsi == NULL)
+        r = yf_view_flush(view);
+
     view->scn = NULL;
     return r;
 }
 
+void yf_view_getstats(yf_view_t *view, yf_frmstats_t *stats)
+{
+    assert(view != NULL);
+    assert(stats != NULL);
+
+    if (view->hist == NULL)
+        memset(stats, 0, sizeof *stats);
+    else
+        yf_frmhist_getstats(view->hist, stats);
+}
+
 yf_scene_t *yf_view_swap(yf_view_t *view, yf_scene_t *scn)
 {
     assert(view != NULL);
@@ -190,11 +374,52 @@ yf_scene_t *yf_view_swap(yf_view_t *view, yf_scene_t *scn)
     return cur;
 }
 
+/* Renders a scene in a headless view. */
+static int render_headless(yf_view_t *view, yf_scene_t *scn)
+{
+    assert(view != NULL);
+    assert(scn != NULL);
+
+    const unsigned next = view->frame % view->tgt_n;
+
+    /* readbacks are executed along with their frames, so the target
+       being reused only has to wait for the frame rendered 'tgt_n'
+       calls ago, while the latest one may still be in flight */
+    if (view->rbs[next] != NULL) {
+        if (yf_readback_poll(view->rbs[next]) == YF_READBACK_PENDING &&
+            yf_cmdbuf_wait(view->ctx, view->sers[next]) != 0)
+            return -1;
+        yf_readback_deinit(view->rbs[next]);
+        view->rbs[next] = NULL;
+    }
+
+    if (yf_scene_render(scn, view->pass, view->tgts[next], view->dim) != 0)
+        return -1;
+
+    const yf_off3_t off = {0};
+    const yf_dim3_t dim = {view->dim.width, view->dim.height, 1};
+    view->frms[next] = view->frame;
+    view->rbs[next] = yf_image_read(view->clr_imgs[next], off, dim, 0, 0,
+                                    deliver_frame, view);
+    if (view->rbs[next] == NULL)
+        return -1;
+
+    view->sers[next] = yf_cmdbuf_getserial(view->ctx);
+    if (yf_cmdbuf_submit(view->ctx) != 0)
+        return -1;
+
+    view->frame++;
+    return 0;
+}
+
 int yf_view_render(yf_view_t *view, yf_scene_t *scn)
 {
     assert(view != NULL);
     assert(scn != NULL);
 
+    if (view->wsi == NULL)
+        return render_headless(view, scn);
+
     yf_pollevt(YF_EVT_ANY);
 
     int next = yf_wsi_next(view->wsi, 0);
@@ -225,19 +450,47 @@ int yf_view_render(yf_view_t *view, yf_scene_t *scn)
     return 0;
 }
 
+int yf_view_flush(yf_view_t *view)
+{
+    assert(view != NULL);
+
+    if (view->wsi != NULL)
+        return 0;
+
+    for (unsigned i = 0; i < view->tgt_n; i++) {
+        if (view->rbs[i] != NULL &&
+            yf_readback_poll(view->rbs[i]) == YF_READBACK_PENDING &&
+            yf_cmdbuf_wait(view->ctx, view->sers[i]) != 0)
+            return -1;
+    }
+
+    return 0;
+}
+
 void yf_view_deinit(yf_view_t *view)
 {
     if (view == NULL)
         return;
 
+    for (unsigned i = 0; i < view->tgt_n && view->rbs != NULL; i++)
+        yf_readback_deinit(view->rbs[i]);
+    free(view->rbs);
+    free(view->frms);
+    free(view->sers);
+
     for (unsigned i = 0; i < view->tgt_n; i++)
         yf_pass_unmktarget(view->pass, view->tgts[i]);
     free(view->tgts);
 
+    for (unsigned i = 0; i < view->tgt_n && view->clr_imgs != NULL; i++)
+        yf_image_deinit(view->clr_imgs[i]);
+    free(view->clr_imgs);
+
     /* XXX: Pass deinitialization handled on 'coreobj'. */
 
     yf_image_deinit(view->depth_img);
     yf_wsi_deinit(view->wsi);
+    yf_frmhist_deinit(view->hist);
 
     free(view);
 
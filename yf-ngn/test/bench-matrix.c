@@ -0,0 +1,54 @@
+/*
+ * YF
+ * bench-matrix.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include "test.h"
+#include "yf-matrix.h"
+
+/* Destination of results, so that operations cannot be elided. */
+static volatile float sink_;
+
+/* Initializes an invertible matrix. */
+static void init_mat(yf_mat4_t m)
+{
+    yf_mat4_rotz(m, 0.5f);
+    m[12] = 1.0f;
+    m[13] = -2.0f;
+    m[14] = 3.0f;
+}
+
+/* Benchmarks 4x4 matrix multiplication. */
+int yf_bench_mat4mul(yf_bench_t *bench)
+{
+    yf_mat4_t a, b, m;
+    init_mat(a);
+    yf_mat4_iden(b);
+    yf_bench_reset(bench);
+
+    for (size_t i = 0; i < bench->n; i++) {
+        yf_mat4_mul(m, a, b);
+        yf_mat4_copy(b, m);
+    }
+
+    sink_ = b[0];
+    return 0;
+}
+
+/* Benchmarks 4x4 matrix inversion. */
+int yf_bench_mat4inv(yf_bench_t *bench)
+{
+    yf_mat4_t a, m;
+    init_mat(a);
+    yf_bench_reset(bench);
+
+    for (size_t i = 0; i < bench->n; i++) {
+        yf_mat4_inv(m, a);
+        yf_mat4_copy(a, m);
+    }
+
+    sink_ = a[0];
+    return 0;
+}
@@ -8,6 +8,7 @@
 #include "test.h"
 
 int yf_test_node(void);
+int yf_test_headless(void);
 int yf_test_view(void);
 int yf_test_vector(void);
 int yf_test_matrix(void);
@@ -29,8 +30,12 @@ int yf_test_collection(void);
 int yf_test_rendering(void);
 int yf_test_composition(void);
 
+int yf_bench_mat4mul(yf_bench_t *bench);
+int yf_bench_mat4inv(yf_bench_t *bench);
+
 static const char *ids_[] = {
     "node",
+    "headless",
     "view",
     "vector",
     "matrix",
@@ -55,6 +60,7 @@ static const char *ids_[] = {
 
 static int (*fns_[])(void) = {
     yf_test_node,
+    yf_test_headless,
     yf_test_view,
     yf_test_vector,
     yf_test_matrix,
@@ -80,9 +86,25 @@ static int (*fns_[])(void) = {
 _Static_assert(sizeof ids_ / sizeof *ids_ == sizeof fns_ / sizeof *fns_,
                "!sizeof");
 
+static const char *bench_ids_[] = {
+    "mat4-mul",
+    "mat4-inv"
+};
+
+static int (*bench_fns_[])(yf_bench_t *) = {
+    yf_bench_mat4mul,
+    yf_bench_mat4inv
+};
+
+_Static_assert(sizeof bench_ids_ / sizeof *bench_ids_ ==
+               sizeof bench_fns_ / sizeof *bench_fns_, "!sizeof");
+
 const yf_test_t yf_g_test = {
     .name = "ngn",
     .ids = ids_,
     .fns = fns_,
-    .n = sizeof ids_ / sizeof *ids_
+    .n = sizeof ids_ / sizeof *ids_,
+    .bench_ids = bench_ids_,
+    .bench_fns = bench_fns_,
+    .bench_n = sizeof bench_ids_ / sizeof *bench_ids_
 };
@@ -16,6 +16,7 @@
 static yf_view_t *view_ = NULL;
 static yf_window_t *wins_[2] = {0};
 static yf_scene_t *scns_[2] = {0};
+static unsigned long frm_n_ = 0;
 
 static int update(double elapsed_time, void *arg)
 {
@@ -44,6 +45,18 @@ static int update(double elapsed_time, void *arg)
     return 0;
 }
 
+static void deliver(yf_view_t *view, unsigned long frame, const void *data,
+                    size_t size, void *arg)
+{
+    assert(view == view_);
+    assert(arg == scns_[0]);
+
+    if (data == NULL || size != 240 * 150 * 4 || frame != frm_n_)
+        assert(0);
+
+    frm_n_++;
+}
+
 /* Tests view. */
 int yf_test_view(void)
 {
@@ -95,3 +108,37 @@ int yf_test_view(void)
 
     return 0;
 }
+
+/* Tests headless view.
+   No window is created, so this must work without a window system. */
+int yf_test_headless(void)
+{
+    scns_[0] = yf_scene_init();
+    assert(scns_[0] != NULL);
+
+    yf_scene_setcolor(scns_[0], YF_COLOR_BLUE);
+    frm_n_ = 0;
+
+    YF_TEST_PRINT("initheadless", "{240, 150}, 3, deliver, scns_[0]", "view_");
+    view_ = yf_view_initheadless((yf_dim2_t){240, 150}, 3, deliver, scns_[0]);
+    if (view_ == NULL)
+        return -1;
+
+    for (size_t i = 0; i < 10; i++) {
+        YF_TEST_PRINT("render", "view_, scns_[0]", "");
+        if (yf_view_render(view_, scns_[0]) != 0)
+            return -1;
+    }
+
+    YF_TEST_PRINT("flush", "view_", "");
+    if (yf_view_flush(view_) != 0 || frm_n_ != 10)
+        return -1;
+
+    YF_TEST_PRINT("deinit", "view_", "");
+    yf_view_deinit(view_);
+
+    yf_scene_deinit(scns_[0]);
+    scns_[0] = NULL;
+
+    return 0;
+}
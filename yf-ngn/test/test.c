@@ -0,0 +1 @@
+../../test/test.c
\ No newline at end of file
@@ -0,0 +1,27 @@
+/*
+ * YF
+ * bench-event.c
+ *
+ * Copyright © 2021 Gustavo C. Viegas.
+ */
+
+#include "test.h"
+#include "yf-event.h"
+#include "yf-window.h"
+
+/* Benchmarks event polling with no pending events. */
+int yf_bench_pollevt(yf_bench_t *bench)
+{
+    yf_window_t *win = yf_window_init(240, 240, "BENCH", YF_WINCREAT_HIDDEN);
+    if (win == NULL)
+        return -1;
+
+    int r = 0;
+    yf_bench_reset(bench);
+
+    for (size_t i = 0; i < bench->n && r == 0; i++)
+        r = yf_pollevt(YF_EVT_ANY);
+
+    yf_window_deinit(win);
+    return r;
+}
@@ -10,6 +10,8 @@
 int yf_test_window(void);
 int yf_test_event(void);
 
+int yf_bench_pollevt(yf_bench_t *bench);
+
 static const char *ids_[] = {
     "window",
     "event"
@@ -23,9 +25,23 @@ static int (*fns_[])(void) = {
 _Static_assert(sizeof ids_ / sizeof *ids_ == sizeof fns_ / sizeof *fns_,
                "!sizeof");
 
+static const char *bench_ids_[] = {
+    "pollevt"
+};
+
+static int (*bench_fns_[])(yf_bench_t *) = {
+    yf_bench_pollevt
+};
+
+_Static_assert(sizeof bench_ids_ / sizeof *bench_ids_ ==
+               sizeof bench_fns_ / sizeof *bench_fns_, "!sizeof");
+
 const yf_test_t yf_g_test = {
     .name = "wsys",
     .ids = ids_,
     .fns = fns_,
-    .n = sizeof ids_ / sizeof *ids_
+    .n = sizeof ids_ / sizeof *ids_,
+    .bench_ids = bench_ids_,
+    .bench_fns = bench_fns_,
+    .bench_n = sizeof bench_ids_ / sizeof *bench_ids_
 };